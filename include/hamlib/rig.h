@@ -210,6 +210,7 @@ enum rig_errcode_e {
     RIG_EPOWER,     /*!< \c 20 Rig not powered on */
     RIG_ELIMIT,     /*!< \c 21 Limit exceeded */
     RIG_EACCESS,    /*!< \c 22 Access denied -- e.g. port already in use */
+    RIG_ECANCELED,  /*!< \c 23 Operation cancelled before it was run */
     RIG_EEND        // MUST BE LAST ITEM IN LAST
 };
 
@@ -1878,6 +1879,158 @@ struct rig_spectrum_line
     unsigned char *spectrum_data; /*!< 8-bit spectrum data covering bandwidth of either the span_freq in center mode or from low edge to high edge in fixed mode. A higher value represents higher signal strength. */
 };
 
+/**
+ * \brief Method used to merge adjacent spectrum bins when a line is reduced to a narrower output width
+ */
+enum rig_spectrum_decimation_e {
+    RIG_SPECTRUM_DECIMATION_MAX = 0,    /*!< Keep the strongest of the merged bins, narrow signals stay visible */
+    RIG_SPECTRUM_DECIMATION_MEAN,       /*!< Use the mean of the merged bins */
+};
+
+/**
+ * \brief Configuration of a spectrum post-processing stage
+ *
+ * A zeroed struct is valid and passes the lines through unchanged.
+ *
+ * \sa rig_spectrum_proc_init(), rig_spectrum_proc_add()
+ */
+struct rig_spectrum_proc_config
+{
+    int output_width;       /*!< Number of bins in the output line, 0 or anything wider than the source line keeps the source width */
+    int min_interval_ms;    /*!< Minimum time between two output lines, lines in between are still averaged, 0 outputs every line */
+    enum rig_spectrum_decimation_e decimation; /*!< How bins are merged when the output is narrower than the source line */
+    float average_factor;   /*!< Weight of the newest line in the exponential average, 0 or 1 disables averaging */
+    float peak_decay;       /*!< Peak-hold decay in dB per source line, 0 holds peaks until reset, negative disables peak-hold */
+};
+
+/**
+ * \brief Output of a spectrum post-processing stage
+ *
+ * The line carries the metadata of the source line, its spectrum data holds
+ * the averaged levels reduced to the output width. The buffers are owned by the
+ * processing stage and are only valid until the next line is processed.
+ */
+struct rig_spectrum_proc_output
+{
+    struct rig_spectrum_line line;  /*!< Processed line with the same level scale as the source line */
+    const float *average_db;        /*!< Averaged signal strength per output bin in dB, mapped through signal_strength_min/max */
+    const float *peak_db;           /*!< Peak-hold signal strength per output bin in dB, NULL if peak-hold is disabled */
+    unsigned int dropped;           /*!< Output lines replaced by this one because the subscriber was busy, see rig_spectrum_subscribe() */
+    const struct rig_spectrum_signals *signals; /*!< Signals the detector found in the source line, NULL if the detector is off, see rig_set_spectrum_detector() */
+};
+
+/**
+ * \brief Configuration of the spectrum signal detector
+ *
+ * A zeroed struct selects the defaults.
+ *
+ * \sa rig_set_spectrum_detector()
+ */
+struct rig_spectrum_detector_config
+{
+    float threshold_db;     /*!< Minimum level above the noise floor in dB for a bin to be occupied, 0 uses 6 dB */
+    float noise_percentile; /*!< Percentile of each bin's level history used as its noise estimate, 0 uses 0.5 (running median) */
+    float noise_step_db;    /*!< Adaptation step of the noise estimate in dB per line, 0 uses 0.5 dB */
+    int merge_gap;          /*!< Number of quiet bins allowed inside one signal before it is split in two */
+};
+
+/**
+ * \brief A signal found by the spectrum signal detector
+ */
+struct rig_spectrum_signal
+{
+    freq_t freq;        /*!< Power-weighted center frequency of the signal in Hz */
+    freq_t bandwidth;   /*!< Occupied bandwidth in Hz */
+    float peak_db;      /*!< Strongest bin of the signal in dB */
+    float snr_db;       /*!< Strongest bin above the noise floor in dB */
+};
+
+#define HAMLIB_MAX_SPECTRUM_SIGNALS 64 /* max number of signals reported for a spectrum line */
+
+/**
+ * \brief Occupied channels found in one spectrum line
+ */
+struct rig_spectrum_signals
+{
+    int id;                 /*!< Spectrum scope ID of the line, see struct rig_spectrum_line */
+    float noise_floor_db;   /*!< Median noise floor across the line in dB */
+    int count;              /*!< Number of entries in signals */
+    struct rig_spectrum_signal signals[HAMLIB_MAX_SPECTRUM_SIGNALS]; /*!< Signals in ascending frequency order, the strongest ones if there are more than fit */
+};
+
+//! @cond Doxygen_Suppress
+typedef struct rig_spectrum_proc rig_spectrum_proc_t;
+typedef struct rig_spectrum_detector rig_spectrum_detector_t;
+//! @endcond
+
+/**
+ * \brief State of one VFO in a rig_vfo_snapshot
+ */
+struct rig_vfo_snapshot_entry {
+    vfo_t vfo;          /*!< VFO described, set by rig_get_vfo_snapshot() */
+    freq_t freq;        /*!< Frequency */
+    rmode_t mode;       /*!< Mode */
+    pbwidth_t width;    /*!< Passband width */
+    int cached;         /*!< 1 if a value came from the cache because the rig cannot report it without swapping VFOs */
+};
+
+/**
+ * \brief Frequency, mode, split and PTT of both VFOs, see rig_get_vfo_snapshot()
+ */
+struct rig_vfo_snapshot {
+    struct rig_vfo_snapshot_entry vfos[2];  /*!< VFOA/Main, VFOB/Sub */
+    vfo_t current_vfo;  /*!< VFO the rig is receiving on */
+    split_t split;      /*!< Split state */
+    vfo_t tx_vfo;       /*!< Transmit VFO */
+    ptt_t ptt;          /*!< PTT state */
+};
+
+/**
+ * \brief Operation of a rig_request
+ */
+typedef enum rig_request_type_e {
+    RIG_REQ_GET_FREQ = 0,   /*!< rig_get_freq(), result in \a freq */
+    RIG_REQ_SET_FREQ,       /*!< rig_set_freq() with \a freq */
+    RIG_REQ_GET_MODE,       /*!< rig_get_mode(), result in \a mode and \a width */
+    RIG_REQ_SET_MODE,       /*!< rig_set_mode() with \a mode and \a width */
+    RIG_REQ_GET_LEVEL,      /*!< rig_get_level() of \a setting, result in \a val */
+    RIG_REQ_SET_LEVEL,      /*!< rig_set_level() of \a setting to \a val */
+    RIG_REQ_GET_FUNC,       /*!< rig_get_func() of \a setting, result in \a status */
+    RIG_REQ_SET_FUNC,       /*!< rig_set_func() of \a setting to \a status */
+    RIG_REQ_GET_PTT,        /*!< rig_get_ptt(), result in \a ptt */
+    RIG_REQ_SET_PTT,        /*!< rig_set_ptt() with \a ptt */
+} rig_request_type_t;
+
+/**
+ * \brief Descriptor of one rig operation, see rig_vfo_batch() and rig_submit()
+ */
+struct rig_request {
+    rig_request_type_t type;    /*!< Operation */
+    vfo_t vfo;                  /*!< Target VFO */
+    freq_t freq;                /*!< Frequency */
+    rmode_t mode;               /*!< Mode */
+    pbwidth_t width;            /*!< Passband width */
+    setting_t setting;          /*!< Level or function */
+    value_t val;                /*!< Level value */
+    int status;                 /*!< Function state */
+    ptt_t ptt;                  /*!< PTT state */
+    int retcode;                /*!< Result of the operation, RIG_OK or a negative error code */
+    int id;                     /*!< Identifier returned by rig_submit() */
+};
+
+/**
+ * \brief Completion callback of rig_submit()
+ *
+ * Called on the rig's request worker thread with the completed request.
+ * The request is only valid during the call.
+ */
+typedef void (*rig_request_cb_t)(RIG *, struct rig_request *, rig_ptr_t);
+
+/**
+ * \brief Set of rigs operated in parallel, see rig_group_run()
+ */
+typedef struct rig_group RIG_GROUP;
+
 /**
  * Config item for deferred processing
  *  (Funky names to avoid clash with perl keywords. Sheesh.)
@@ -2226,6 +2379,7 @@ struct rig_caps {
     int (*get_lock_mode)(RIG *rig, int *mode);
     short timeout_retry;    /*!< number of retries to make in case of read timeout errors, some serial interfaces may require this, 0 to use default value, -1 to disable */
     short morse_qsize;  /*!< max length of morse message rig can accept in one command */
+    int (*get_vfo_snapshot)(RIG *rig, struct rig_vfo_snapshot *snapshot); /*!< Fill the VFOs named in snapshot->vfos[], split and PTT without swapping VFOs, -RIG_ENIMPL to let the frontend do it */
 //    int (*bandwidth2rig)(RIG  *rig, enum bandwidth_t bandwidth);
 //    enum bandwidth_t (*rig2bandwidth)(RIG  *rig, int rigbandwidth);
 };
@@ -2500,6 +2654,12 @@ typedef int (*pltune_cb_t)(RIG *,
 typedef int (*spectrum_cb_t)(RIG *,
                              struct rig_spectrum_line *,
                              rig_ptr_t);
+typedef int (*spectrum_proc_cb_t)(RIG *,
+                                  const struct rig_spectrum_proc_output *,
+                                  rig_ptr_t);
+typedef int (*spectrum_signals_cb_t)(RIG *,
+                                     const struct rig_spectrum_signals *,
+                                     rig_ptr_t);
 
 //! @endcond
 /**
@@ -2615,6 +2775,55 @@ rig_get_freq(RIG *rig,
              freq_t *freq);
 #endif
 
+extern HAMLIB_EXPORT(int)
+rig_set_freq_coalescing(RIG *rig,
+                        int min_interval_ms);
+extern HAMLIB_EXPORT(int)
+rig_wait_set_freq(RIG *rig,
+                  vfo_t vfo,
+                  int timeout_ms);
+extern HAMLIB_EXPORT(int)
+rig_get_freqs(RIG *rig,
+              freq_t *freqA,
+              freq_t *freqB);
+extern HAMLIB_EXPORT(int)
+rig_get_vfo_snapshot(RIG *rig,
+                     struct rig_vfo_snapshot *snapshot);
+extern HAMLIB_EXPORT(int)
+rig_vfo_batch(RIG *rig,
+              struct rig_request *requests,
+              int count,
+              int *swaps_saved);
+extern HAMLIB_EXPORT(int)
+rig_submit(RIG *rig,
+           const struct rig_request *request,
+           int timeout_ms,
+           rig_request_cb_t cb,
+           rig_ptr_t arg);
+extern HAMLIB_EXPORT(int)
+rig_cancel(RIG *rig,
+           int id);
+extern HAMLIB_EXPORT(int)
+rig_request_fd(RIG *rig);
+extern HAMLIB_EXPORT(int)
+rig_request_reap(RIG *rig,
+                 struct rig_request *done,
+                 int max);
+
+extern HAMLIB_EXPORT(RIG_GROUP *)
+rig_group_create(void);
+extern HAMLIB_EXPORT(int)
+rig_group_add(RIG_GROUP *group,
+              RIG *rig);
+extern HAMLIB_EXPORT(int)
+rig_group_count(const RIG_GROUP *group);
+extern HAMLIB_EXPORT(int)
+rig_group_run(RIG_GROUP *group,
+              struct rig_request *requests,
+              int timeout_ms);
+extern HAMLIB_EXPORT(void)
+rig_group_destroy(RIG_GROUP *group);
+
 extern HAMLIB_EXPORT(int)
 rig_set_mode(RIG *rig,
              vfo_t vfo,
@@ -3150,6 +3359,56 @@ rig_set_spectrum_callback(RIG *,
                           spectrum_cb_t,
                           rig_ptr_t);
 
+extern HAMLIB_EXPORT(rig_spectrum_proc_t *)
+rig_spectrum_proc_init(const struct rig_spectrum_proc_config *config);
+
+extern HAMLIB_EXPORT(void)
+rig_spectrum_proc_cleanup(rig_spectrum_proc_t *proc);
+
+extern HAMLIB_EXPORT(void)
+rig_spectrum_proc_reset(rig_spectrum_proc_t *proc);
+
+extern HAMLIB_EXPORT(int)
+rig_spectrum_proc_process(rig_spectrum_proc_t *proc,
+                          const struct rig_spectrum_line *line,
+                          struct rig_spectrum_proc_output *output);
+
+extern HAMLIB_EXPORT(const char *)
+rig_spectrum_proc_kernel_name(void);
+
+extern HAMLIB_EXPORT(int)
+rig_spectrum_proc_add(RIG *rig,
+                      const struct rig_spectrum_proc_config *config,
+                      spectrum_proc_cb_t cb,
+                      rig_ptr_t arg);
+
+extern HAMLIB_EXPORT(int)
+rig_spectrum_subscribe(RIG *rig,
+                       const struct rig_spectrum_proc_config *config,
+                       spectrum_proc_cb_t cb,
+                       rig_ptr_t arg);
+
+extern HAMLIB_EXPORT(int)
+rig_spectrum_proc_remove(RIG *rig,
+                         int handle);
+
+extern HAMLIB_EXPORT(rig_spectrum_detector_t *)
+rig_spectrum_detector_init(const struct rig_spectrum_detector_config *config);
+
+extern HAMLIB_EXPORT(void)
+rig_spectrum_detector_cleanup(rig_spectrum_detector_t *detector);
+
+extern HAMLIB_EXPORT(int)
+rig_spectrum_detector_process(rig_spectrum_detector_t *detector,
+                              const struct rig_spectrum_line *line,
+                              struct rig_spectrum_signals *signals);
+
+extern HAMLIB_EXPORT(int)
+rig_set_spectrum_detector(RIG *rig,
+                          const struct rig_spectrum_detector_config *config,
+                          spectrum_signals_cb_t cb,
+                          rig_ptr_t arg);
+
 extern HAMLIB_EXPORT(int)
 rig_set_twiddle(RIG *rig,
                 int seconds);
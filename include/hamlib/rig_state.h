@@ -236,7 +236,20 @@ struct rig_state {
     struct timespec freq_event_elapsed;     /*!< Time struct used by various caches. */
     int freq_skip; /*!< allow frequency skip for gpredict RX/TX freq set */
     client_t client;        /*!< Client application of the library. */
-    pthread_mutex_t api_mutex;      /*!< Lock for any API entry. */
+    pthread_mutex_t api_mutex;      /*!< Lock for any API entry and CAT port transaction lock, see rig_lock(). */
+    void *spectrum_proc_priv_data;  /*!< Spectrum post-processing stages attached with rig_spectrum_proc_add(). */
+    void *spectrum_detector_priv_data; /*!< Spectrum signal detector enabled with rig_set_spectrum_detector(). */
+    void *network_cmd_priv_data;    /*!< Results of multicast commands waiting for the next snapshot. */
+    void *freq_coalesce_priv_data;  /*!< Frequency change sender enabled with rig_set_freq_coalescing(). */
+    int trusted_set;                /*!< A successful set_freq puts the requested frequency in the cache instead of reading it back. */
+    int trusted_set_verify_ms;      /*!< Delay before a trusted set_freq is read back in the background, 0 to never verify. */
+    void *trusted_set_priv_data;    /*!< Background verification of trusted set_freq. */
+    void *submit_priv_data;         /*!< Request worker and queue of rig_submit(). */
+    pthread_mutex_t ptt_mutex;      /*!< Lock of a PTT line on a port of its own, taken by rig_set_ptt() instead of api_mutex. */
+    pthread_mutex_t dcd_mutex;      /*!< Lock of a DCD line on a port of its own. */
+    pthread_mutex_t state_mutex;    /*!< Short-held lock of the cache, no I/O is done while holding it. */
+    int multicast_cmd_exec;         /*!< Execute the commands received by the multicast command server, off by default. */
+    int multicast_min_interval_ms;  /*!< Minimum time between two published rig state changes, changes in between go out together. */
 // New rig_state items go before this line ============================================
 };
 
@@ -30,6 +30,7 @@
 #include "hamlib/port.h"
 #include "hamlib/rig_state.h"
 #include "iofunc.h"
+#include "network.h"
 #include "misc.h"
 #include "token.h"
 
@@ -84,6 +85,8 @@ static int flrig_set_split_vfo(RIG *rig, vfo_t vfo, split_t split,
                                vfo_t tx_vfo);
 static int flrig_get_split_vfo(RIG *rig, vfo_t vfo, split_t *split,
                                vfo_t *tx_vfo);
+static int flrig_get_vfo_snapshot(RIG *rig,
+                                  struct rig_vfo_snapshot *snapshot);
 static int flrig_set_split_freq_mode(RIG *rig, vfo_t vfo, freq_t freq,
                                      rmode_t mode, pbwidth_t width);
 static int flrig_get_split_freq_mode(RIG *rig, vfo_t vfo, freq_t *freq,
@@ -102,6 +105,16 @@ static int flrig_mW2power(RIG *rig, float *power, unsigned int mwpower,
 static int flrig_set_powerstat(RIG *rig, powerstat_t status);
 
 
+#define FLRIG_MULTICALL_MAX 8
+
+/* One call of a system.multicall and its answer */
+struct flrig_call
+{
+    const char *cmd;
+    char value[MAXARGLEN];
+    int status;
+};
+
 struct flrig_priv_data
 {
     vfo_t curr_vfo;
@@ -127,6 +140,10 @@ struct flrig_priv_data
     int has_get_modeB; /* True if this function is available */
     int has_get_bwB; /* True if this function is available */
     int has_set_bwB; /* True if this function is available */
+    int closed; /* flrig is closing the connection, reconnect before the next call */
+    int no_multicall; /* flrig answered system.multicall with a fault */
+    struct flrig_call *prefetch; /* answers flrig_transaction serves, see flrig_get_vfo_snapshot */
+    int prefetch_count;
 };
 
 /* level's and parm's tokens */
@@ -149,7 +166,7 @@ struct rig_caps flrig_caps =
     RIG_MODEL(RIG_MODEL_FLRIG),
     .model_name = "FLRig",
     .mfg_name = "FLRig",
-    .version = "20260130.0",
+    .version = "20261018.0",
     .copyright = "LGPL",
     .status = RIG_STATUS_STABLE,
     .rig_type = RIG_TYPE_TRANSCEIVER,
@@ -221,6 +238,7 @@ struct rig_caps flrig_caps =
     .power2mW =   flrig_power2mW,
     .mW2power =   flrig_mW2power,
     .set_powerstat = flrig_set_powerstat,
+    .get_vfo_snapshot = flrig_get_vfo_snapshot,
     .hamlib_check_rig_caps = HAMLIB_CHECK_RIG_CAPS
 };
 
@@ -321,7 +339,8 @@ static char *xml_build(RIG *rig, char *cmd, char *value, char *xmlbuf,
 
     header =
         "POST /RPC2 HTTP/1.1\r\n" "User-Agent: XMLRPC++ 0.8\r\n"
-        "Host: 127.0.0.1:12345\r\n" "Content-type: text/xml\r\n";
+        "Host: 127.0.0.1:12345\r\n" "Content-type: text/xml\r\n"
+        "Connection: keep-alive\r\n";
     SNPRINTF(xmlbuf, xmlbuflen, "%s", header);
 
     SNPRINTF(xml, sizeof(xml),
@@ -345,193 +364,271 @@ static char *xml_build(RIG *rig, char *cmd, char *value, char *xmlbuf,
     return xmlbuf;
 }
 
+/*
+* xml_tag
+* True if the tag starting at p is name, with or without attributes
+*/
+static int xml_tag(const char *p, const char *name)
+{
+    size_t len = strlen(name);
+
+    return strncmp(p, name, len) == 0
+           && (p[len] == '>' || p[len] == ' ' || p[len] == '/');
+}
+
+/*
+* xml_append
+* Adds len chars of text to the pipe delimited value
+*/
+static void xml_append(char *value, int value_len, const char *text,
+                       size_t len)
+{
+    size_t n = strlen(value);
+
+    if (n + len + 2 > value_len)
+    {
+        // we'll just stop adding stuff
+        rig_debug(RIG_DEBUG_ERR, "%s: max value length exceeded\n", __func__);
+        return;
+    }
+
+    if (n > 0) { value[n++] = '|'; }
+
+    memcpy(value + n, text, len);
+    value[n + len] = 0;
+}
+
 /*This is a very crude xml parse specific to what we need from FLRig
 * This works for strings, doubles, I4-type values, and arrays
 * Arrays are returned pipe delimited
+* One pass over the methodResponse, nothing is copied but the values
+* With calls!=NULL the response is a system.multicall one: each element
+* of the outer array answers the next call and its values go to that call
+* A fault struct gives -RIG_ENAVAIL for an unknown method, else -RIG_EPROTO,
+* as status of its call or, for the response as a whole, as return value
 */
-static char *xml_parse2(char *xml, char *value, int valueLen)
+static int xml_scan(const char *xml, char *value, int value_len,
+                    struct flrig_call *calls, int ncalls)
 {
-    char *delims = "<>\r\n";
-    char *xmltmp = strdup(xml);
-    //rig_debug(RIG_DEBUG_TRACE, "%s: xml='%s'\n", __func__,xml);
-    char *pr = xml;
-    char *p = strtok_r(xmltmp, delims, &pr);
-    value[0] = 0;
+    char fault_text[MAXARGLEN];
+    const char *p = xml;
+    int *fault_status = NULL;
+    int retval = RIG_OK;
+    int arrays = 0;
+    int structs = 0;
+    int result = -1;
+
+    if (value) { value[0] = 0; }
 
-    while (p)
+    fault_text[0] = 0;
+
+    while ((p = strchr(p, '<')) != NULL)
     {
-        if (streq(p, "value"))
-        {
-            p = strtok_r(NULL, delims, &pr);
+        const char *tag = p + 1;
+        const char *text;
+        size_t len;
 
-            if (streq(p, "array")) { continue; }
+        p = strchr(tag, '>');
 
-            if (streq(p, "/value")) { continue; } // empty value
+        if (p == NULL) { break; }
 
-            if (streq(p, "i4") || streq(p, "double") || streq(p, "int")
-                    || streq(p, "string"))
+        text = ++p;
+
+        if (xml_tag(tag, "array"))
+        {
+            // the outer array holds a one element array per call
+            if (++arrays == 2 && calls && structs == 0 && ++result < ncalls)
             {
-                p = strtok_r(NULL, delims, &pr);
+                calls[result].value[0] = 0;
+                calls[result].status = RIG_OK;
             }
-            else if (streq(p, "array"))
+
+            continue;
+        }
+
+        if (xml_tag(tag, "/array"))
+        {
+            arrays--;
+            continue;
+        }
+
+        if (xml_tag(tag, "struct"))
+        {
+            if (structs++ == 0 && arrays == (calls ? 1 : 0))
             {
-                strtok_r(NULL, delims, &pr);
-                p = strtok_r(NULL, delims, &pr);
+                fault_status = &retval;
+
+                if (calls && ++result < ncalls)
+                {
+                    calls[result].value[0] = 0;
+                    fault_status = &calls[result].status;
+                }
+
+                fault_text[0] = 0;
             }
 
-            if (strlen(value) + strlen(p) + 1 < valueLen)
-            {
-                if (value[0] != 0) { strcat(value, "|"); }
+            continue;
+        }
 
-                strcat(value, p);
+        if (xml_tag(tag, "/struct"))
+        {
+            if (--structs == 0 && fault_status)
+            {
+                rig_debug(RIG_DEBUG_ERR, "%s: fault '%s'\n", __func__, fault_text);
+                *fault_status = strstr(fault_text, "unknown") ? -RIG_ENAVAIL :
+                                -RIG_EPROTO;
+                fault_status = NULL;
             }
-            else   // we'll just stop adding stuff
+
+            continue;
+        }
+
+        // a value's text is untyped or inside one of these
+        if (!xml_tag(tag, "value") && !xml_tag(tag, "i4") && !xml_tag(tag, "int")
+                && !xml_tag(tag, "double") && !xml_tag(tag, "string")
+                && !xml_tag(tag, "boolean"))
+        {
+            continue;
+        }
+
+        p = strchr(text, '<');
+
+        if (p == NULL) { break; }
+
+        len = p - text;
+
+        if (len == 0) { continue; } // empty value
+
+        if (structs > 0)
+        {
+            xml_append(fault_text, sizeof(fault_text), text, len);
+        }
+        else if (calls)
+        {
+            if (result >= 0 && result < ncalls)
             {
-                rig_debug(RIG_DEBUG_ERR, "%s: max value length exceeded\n", __func__);
+                xml_append(calls[result].value, sizeof(calls[result].value), text, len);
             }
         }
-        else
+        else if (value)
         {
-            p = strtok_r(NULL, delims, &pr);
+            xml_append(value, value_len, text, len);
         }
     }
 
-    rig_debug(RIG_DEBUG_TRACE, "%s: value returned='%s'\n", __func__, value);
-
-    if (rig_need_debug(RIG_DEBUG_WARN) && value != NULL && strlen(value) == 0)
+    if (value)
     {
-        rig_debug(RIG_DEBUG_ERR, "%s: xml='%s'\n", __func__, xml);
+        rig_debug(RIG_DEBUG_TRACE, "%s: value returned='%s'\n", __func__, value);
     }
 
-    free(xmltmp);
-    return value;
+    return retval;
 }
 
 /*
-* xml_parse
-* Assumes xml!=NULL, value!=NULL, value_len big enough
-* returns the string value contained in the xml string
+* flrig_reconnect
+* Opens a new connection when flrig dropped or announced closing ours
 */
-static char *xml_parse(char *xml, char *value, int value_len)
+static int flrig_reconnect(RIG *rig)
 {
-    char *next;
-    char *pxml;
-
-    /* first off we should have an OK on the 1st line */
-    if (strstr(xml, " 200 OK") == NULL)
-    {
-        return (NULL);
-    }
-
-    rig_debug(RIG_DEBUG_TRACE, "%s XML:\n%s\n", __func__, xml);
-
-    // find the xml skipping the other stuff above it
-    pxml = strstr(xml, "<?xml");
-
-    if (pxml == NULL)
-    {
-        return (NULL);
-    }
+    hamlib_port_t *rp = RIGPORT(rig);
+    struct flrig_priv_data *priv = (struct flrig_priv_data *) STATE(rig)->priv;
+    int retval;
 
-    next = strchr(pxml + 1, '<');
+    rig_debug(RIG_DEBUG_VERBOSE, "%s: reconnecting to %s\n", __func__,
+              rp->pathname);
 
-    if (value != NULL)
-    {
-        xml_parse2(next, value, value_len);
-    }
+    network_close(rp);
+    retval = network_open(rp, 12345);
 
-    if (value && strstr(value, "faultString"))
-    {
-        rig_debug(RIG_DEBUG_ERR, "%s error:\n%s\n", __func__, value);
-        value[0] = 0; /* truncate to give empty response */
-    }
+    if (retval == RIG_OK) { priv->closed = 0; }
 
-    return (value);
+    return retval;
 }
 
 /*
 * read_transaction
+* Reads one HTTP response, the header lines and then exactly Content-length
+* bytes of body, so the connection is ready for the next request
 * Assumes rig!=NULL, xml!=NULL, xml_len>=MAXXMLLEN
+* Returns the body in xml
 */
 static int read_transaction(RIG *rig, char *xml, int xml_len)
 {
-    int retval;
-    int retry;
-    char *delims;
-    char *terminator = "</methodResponse>";
+    hamlib_port_t *rp = RIGPORT(rig);
+    struct flrig_priv_data *priv = (struct flrig_priv_data *) STATE(rig)->priv;
+    char line[256];
+    int content_length = -1;
+    int status_line = 1;
+    int len;
 
     ENTERFUNC;
 
-    retry = 2;
-    delims = "\n";
     xml[0] = 0;
 
-    do
+    for (;;)
     {
-        char tmp_buf[MAXXMLLEN];        // plenty big for expected flrig responses hopefully
+        len = read_string(rp, (unsigned char *) line, sizeof(line), "\n", 1, 0, 1);
 
-        if (retry < 2)
+        if (len <= 0)
         {
-            rig_debug(RIG_DEBUG_WARN, "%s: retry needed? retry=%d\n", __func__, retry);
+            rig_debug(RIG_DEBUG_ERR, "%s: read_string error=%d\n", __func__, len);
+            RETURNFUNC(len < 0 ? len : -RIG_EIO);
         }
 
-        rig_debug(RIG_DEBUG_TRACE, "%s: before read_string\n", __func__);
-        int len = read_string(RIGPORT(rig), (unsigned char *) tmp_buf, sizeof(tmp_buf),
-                              delims,
-                              strlen(delims), 0, 1);
-//                              "</methodResponse>", 17,0,1);
-        rig_debug(RIG_DEBUG_TRACE, "%s: string='%s'\n", __func__, tmp_buf);
+        rig_debug(RIG_DEBUG_TRACE, "%s: string='%s'\n", __func__, line);
 
-        // if our first response we should see the HTTP header
-        if (strlen(xml) == 0 && strstr(tmp_buf, "HTTP/1.1 200 OK") == NULL)
+        if (status_line)
         {
-            rig_debug(RIG_DEBUG_ERR, "%s: Expected 'HTTP/1.1 200 OK', got '%s'\n", __func__,
-                      tmp_buf);
-            continue; // we'll try again
-        }
+            status_line = 0;
 
-        if (len > 0) { retry = 3; }
+            if (strstr(line, " 200 OK") == NULL)
+            {
+                rig_debug(RIG_DEBUG_ERR, "%s: Expected 'HTTP/1.1 200 OK', got '%s'\n",
+                          __func__, line);
+                priv->closed = 1; // we can't tell where this response ends
+                RETURNFUNC(-RIG_EPROTO);
+            }
 
-        if (len <= 0)
-        {
-            rig_debug(RIG_DEBUG_ERR, "%s: read_string error=%d\n", __func__, len);
             continue;
         }
 
-        if (strlen(xml) + strlen(tmp_buf) < xml_len - 1)
+        if (strcmp(line, "\r\n") == 0 || strcmp(line, "\n") == 0)
         {
-            strncat(xml, tmp_buf, xml_len - 1);
+            break;
         }
-        else
+
+        if (strncasecmp(line, "Content-length:", 15) == 0)
         {
-            rig_debug(RIG_DEBUG_ERR,
-                      "%s: xml buffer overflow!!\nTrying to add len=%d\nTo len=%d\n", __func__,
-                      (int)strlen(tmp_buf), (int)strlen(xml));
-            RETURNFUNC(-RIG_EPROTO);
+            content_length = atoi(line + 15);
+        }
+        else if (strncasecmp(line, "Connection:", 11) == 0
+                 && (strstr(line, "close") || strstr(line, "Close")))
+        {
+            priv->closed = 1;
         }
     }
-    while (retry-- > 0 && strstr(xml, terminator) == NULL);
 
-    if (retry == 0)
+    if (content_length < 0 || content_length >= xml_len)
     {
-        rig_debug(RIG_DEBUG_WARN, "%s: retry timeout\n", __func__);
-        RETURNFUNC(-RIG_ETIMEOUT);
+        rig_debug(RIG_DEBUG_ERR, "%s: bad Content-length %d\n", __func__,
+                  content_length);
+        priv->closed = 1;
+        RETURNFUNC(-RIG_EPROTO);
     }
 
-    if (strstr(xml, terminator))
-    {
-        rig_debug(RIG_DEBUG_TRACE, "%s: got %s\n", __func__, terminator);
-        // Slow down just a bit -- not sure this is needed anymore but not a big deal here
-        // hl_usleep(2 * 1000); // try without this
-        retval = RIG_OK;
-    }
-    else
+    len = read_block(rp, (unsigned char *) xml, content_length);
+
+    if (len < 0)
     {
-        rig_debug(RIG_DEBUG_VERBOSE, "%s: did not get %s\n", __func__, terminator);
-        retval = -(101 + RIG_EPROTO);
+        rig_debug(RIG_DEBUG_ERR, "%s: read_block error=%d\n", __func__, len);
+        priv->closed = 1;
+        RETURNFUNC(len);
     }
 
-    RETURNFUNC(retval);
+    xml[len] = 0;
+    rig_debug(RIG_DEBUG_TRACE, "%s XML:\n%s\n", __func__, xml);
+
+    RETURNFUNC(RIG_OK);
 }
 
 /*
@@ -574,61 +671,112 @@ static int write_transaction(RIG *rig, char *xml, int xml_len)
     RETURNFUNC(retval);
 }
 
+/*
+* flrig_exchange
+* Sends one request on the persistent connection, reconnecting first if
+* flrig closed it, and reads the response body into xml
+*/
+static int flrig_exchange(RIG *rig, char *cmd, char *cmd_arg, char *xml,
+                          int xml_len)
+{
+    struct flrig_priv_data *priv = (struct flrig_priv_data *) STATE(rig)->priv;
+    char *pxml;
+    int retval;
+
+    if (priv->closed && flrig_reconnect(rig) != RIG_OK)
+    {
+        xml[0] = 0;
+        return -RIG_EIO;
+    }
+
+    pxml = xml_build(rig, cmd, cmd_arg, xml, xml_len);
+    retval = write_transaction(rig, pxml, strlen(pxml));
+
+    if (retval != RIG_OK)
+    {
+        rig_debug(RIG_DEBUG_ERR, "%s: write_transaction error=%d\n", __func__, retval);
+        xml[0] = 0;
+    }
+    else
+    {
+        retval = read_transaction(rig, xml, xml_len);
+    }
+
+    // if we get RIG_EIO the socket has probably disappeared, e.g. flrig
+    // was restarted, so we open a new one for the next try
+    if (retval == -RIG_EIO)
+    {
+        priv->closed = 1;
+    }
+
+    return retval;
+}
+
 static int flrig_transaction(RIG *rig, char *cmd, char *cmd_arg, char *value,
                              int value_len)
 {
     char xml[MAXXMLLEN];
     int retry = 3;
+    int retval;
+    struct flrig_priv_data *priv = (struct flrig_priv_data *) STATE(rig)->priv;
 
     ENTERFUNC;
     ELAPSED1;
 
-    set_transaction_active(rig);
-
     if (value)
     {
+        int i;
+
         value[0] = 0;
+
+        // answered by the multicall of flrig_get_vfo_snapshot
+        for (i = 0; cmd_arg == NULL && i < priv->prefetch_count; i++)
+        {
+            if (priv->prefetch[i].status == RIG_OK && priv->prefetch[i].value[0]
+                    && streq(priv->prefetch[i].cmd, cmd))
+            {
+                SNPRINTF(value, value_len, "%s", priv->prefetch[i].value);
+                RETURNFUNC(RIG_OK);
+            }
+        }
     }
 
+    set_transaction_active(rig);
+
     do
     {
-        char *pxml;
-        int retval;
-
         if (retry != 3)
         {
             rig_debug(RIG_DEBUG_VERBOSE, "%s: cmd=%s, retry=%d\n", __func__, cmd, retry);
         }
 
-        pxml = xml_build(rig, cmd, cmd_arg, xml, sizeof(xml));
-        retval = write_transaction(rig, pxml, strlen(pxml));
+        retval = flrig_exchange(rig, cmd, cmd_arg, xml, sizeof(xml));
 
-        if (retval != RIG_OK)
+        if (retval != RIG_OK && retval != -RIG_EIO)
         {
-            rig_debug(RIG_DEBUG_ERR, "%s: write_transaction error=%d\n", __func__, retval);
-
-            // if we get RIG_EIO the socket has probably disappeared
-            // so bubble up the error so port can re re-opened
-            if (retval == -RIG_EIO) { set_transaction_inactive(rig); RETURNFUNC(retval); }
-
             hl_usleep(50 * 1000); // 50ms sleep if error
         }
 
-        read_transaction(rig, xml, sizeof(xml)); // this might time out -- that's OK
-
         // we get an unknown response if function does not exist
         if (strstr(xml, "unknown")) { set_transaction_inactive(rig); RETURNFUNC(-RIG_ENAVAIL); }
 
         if (strstr(xml, "get_bw") && strstr(xml, "NONE")) { set_transaction_inactive(rig); RETURNFUNC(-RIG_ENAVAIL); }
 
-        if (value)
+        if (value && retval == RIG_OK)
         {
-            xml_parse(xml, value, value_len);
+            retval = xml_scan(xml, value, value_len, NULL, 0);
+
+            if (retval != RIG_OK) { set_transaction_inactive(rig); RETURNFUNC(retval); }
         }
     }
     while (((value && strlen(value) == 0) || (strlen(xml) == 0))
             && retry--); // we'll do retries if needed
 
+    if (retval == -RIG_EIO)
+    {
+        set_transaction_inactive(rig); RETURNFUNC(retval);
+    }
+
     if (value && strlen(value) == 0)
     {
         rig_debug(RIG_DEBUG_ERR, "%s: no value returned\n", __func__);
@@ -640,6 +788,50 @@ static int flrig_transaction(RIG *rig, char *cmd, char *cmd_arg, char *value,
     RETURNFUNC(RIG_OK);
 }
 
+/*
+* flrig_multicall
+* Makes the calls, none of which takes arguments, in one system.multicall
+* request, leaving each answer and its status in the flrig_call
+*/
+static int flrig_multicall(RIG *rig, struct flrig_call *calls, int ncalls)
+{
+    char xml[MAXXMLLEN];
+    char params[MAXXMLLEN];
+    int retval;
+    int i;
+
+    ENTERFUNC;
+
+    strcpy(params, "<params><param><value><array><data>\r\n");
+
+    for (i = 0; i < ncalls; i++)
+    {
+        strncat(params, "<value><struct><member><name>methodName</name><value>",
+                sizeof(params) - strlen(params) - 1);
+        strncat(params, calls[i].cmd, sizeof(params) - strlen(params) - 1);
+        strncat(params, "</value></member><member><name>params</name>"
+                "<value><array><data></data></array></value></member></struct></value>\r\n",
+                sizeof(params) - strlen(params) - 1);
+        calls[i].value[0] = 0;
+        calls[i].status = -RIG_EPROTO; // unless the response has an answer
+    }
+
+    strncat(params, "</data></array></value></param></params>\r\n",
+            sizeof(params) - strlen(params) - 1);
+
+    set_transaction_active(rig);
+    retval = flrig_exchange(rig, "system.multicall", params, xml, sizeof(xml));
+
+    if (retval == RIG_OK)
+    {
+        retval = xml_scan(xml, NULL, 0, calls, ncalls);
+    }
+
+    set_transaction_inactive(rig);
+
+    RETURNFUNC(retval);
+}
+
 /*
 * flrig_init
 * Assumes rig!=NULL
@@ -1412,11 +1604,9 @@ static int flrig_set_ptt(RIG *rig, vfo_t vfo, ptt_t ptt)
 static int flrig_get_ptt(RIG *rig, vfo_t vfo, ptt_t *ptt)
 {
     char value[MAXCMDLEN];
-    char xml[MAXXMLLEN];
     struct flrig_priv_data *priv = (struct flrig_priv_data *) STATE(rig)->priv;
 
     ENTERFUNC;
-    xml[0] = 0;
     value[0] = 0;
     rig_debug(RIG_DEBUG_TRACE, "%s: vfo=%s\n", __func__,
               rig_strvfo(vfo));
@@ -1432,7 +1622,6 @@ static int flrig_get_ptt(RIG *rig, vfo_t vfo, ptt_t *ptt)
 
     if (strlen(value) > 0)
     {
-        xml_parse(xml, value, sizeof(value));
         *ptt = atoi(value);
         rig_debug(RIG_DEBUG_TRACE, "%s: '%s'\n", __func__, value);
 
@@ -2173,6 +2362,96 @@ static int flrig_get_split_vfo(RIG *rig, vfo_t vfo, split_t *split,
     RETURNFUNC(RIG_OK);
 }
 
+/*
+* flrig_get_vfo_snapshot
+* Asks for PTT, split and the frequency, mode and bandwidth of both VFOs in
+* one system.multicall, whose answers the usual getters then decode
+*/
+static int flrig_get_vfo_snapshot(RIG *rig, struct rig_vfo_snapshot *snapshot)
+{
+    struct flrig_priv_data *priv = (struct flrig_priv_data *) STATE(rig)->priv;
+    struct flrig_call calls[FLRIG_MULTICALL_MAX];
+    int ncalls = 0;
+    vfo_t tx_vfo;
+    int retval;
+    int i;
+
+    ENTERFUNC;
+
+    // without rig.get_modeA VFOB's mode needs a VFO swap, the frontend does that
+    if (!priv->has_get_modeA || priv->no_multicall)
+    {
+        RETURNFUNC(-RIG_ENIMPL);
+    }
+
+    calls[ncalls++].cmd = "rig.get_ptt";
+    calls[ncalls++].cmd = "rig.get_split";
+    calls[ncalls++].cmd = "rig.get_vfoA";
+    calls[ncalls++].cmd = "rig.get_vfoB";
+    calls[ncalls++].cmd = "rig.get_modeA";
+
+    if (priv->has_get_modeB) { calls[ncalls++].cmd = "rig.get_modeB"; }
+
+    if (priv->has_get_bwA) { calls[ncalls++].cmd = "rig.get_bwA"; }
+
+    if (priv->has_get_bwB) { calls[ncalls++].cmd = "rig.get_bwB"; }
+
+    retval = flrig_multicall(rig, calls, ncalls);
+
+    if (retval == -RIG_ENAVAIL)
+    {
+        rig_debug(RIG_DEBUG_VERBOSE, "%s: does not have system.multicall\n",
+                  __func__);
+        priv->no_multicall = 1;
+        RETURNFUNC(-RIG_ENIMPL);
+    }
+
+    if (retval != RIG_OK)
+    {
+        RETURNFUNC(retval);
+    }
+
+    // calls that failed in the multicall are made again one by one
+    priv->prefetch = calls;
+    priv->prefetch_count = ncalls;
+
+    retval = flrig_get_ptt(rig, RIG_VFO_CURR, &snapshot->ptt);
+
+    if (retval == RIG_OK)
+    {
+        retval = flrig_get_split_vfo(rig, RIG_VFO_A, &snapshot->split, &tx_vfo);
+    }
+
+    for (i = 0; i < 2 && retval == RIG_OK; i++)
+    {
+        struct rig_vfo_snapshot_entry *entry = &snapshot->vfos[i];
+        vfo_t vfo = i == 0 ? RIG_VFO_A : RIG_VFO_B;
+
+        retval = flrig_get_freq(rig, vfo, &entry->freq);
+
+        // rig.get_modeA is all flrig_get_mode could ask for VFOB
+        if (retval != RIG_OK || (vfo == RIG_VFO_B && !priv->has_get_modeB))
+        {
+            entry->cached = 1;
+            continue;
+        }
+
+        retval = flrig_get_mode(rig, vfo, &entry->mode, &entry->width);
+    }
+
+    priv->prefetch = NULL;
+    priv->prefetch_count = 0;
+
+    if (retval != RIG_OK)
+    {
+        RETURNFUNC(retval);
+    }
+
+    snapshot->tx_vfo = snapshot->vfos[tx_vfo == RIG_VFO_B ? 1 : 0].vfo;
+
+    RETURNFUNC(RIG_OK);
+}
+
 /*
 * flrig_set_split_freq_mode
 * assumes rig!=NULL
@@ -34,7 +34,9 @@
 #include "cal.h"
 #include "idx_builtin.h"
 
-#define BACKEND_VER "20250718.2"
+#include "rigctl_pipe.h"
+
+#define BACKEND_VER "20261018.0"
 
 #define TRUE 1
 #define FALSE 0
@@ -289,6 +291,75 @@ static int gqrx_transaction(RIG *rig, char *cmd, char *value,
 }
 
 
+/*
+* gqrx_pipe
+* Runs the commands through the shared rigctld-protocol client, each reply
+* read as a whole however many lines it has
+* GQRX handles one command per network read, so they go one at a time
+*/
+static int gqrx_pipe(RIG *rig, struct rigctl_pipe_cmd *cmds, int count)
+{
+    int retval;
+
+    set_transaction_active(rig);
+    retval = rigctl_pipe(rig, cmds, count, 1);
+    set_transaction_inactive(rig);
+
+    return retval;
+}
+
+
+/*
+* gqrx_parse_mode
+* Assumes s!=NULL, mode!=NULL
+*/
+static int gqrx_parse_mode(const char *s, rmode_t *mode)
+{
+    if (strcmp(s, "AM") == 0)
+    {
+        *mode = RIG_MODE_AM;
+    }
+    else if (strcmp(s, "AMS") == 0)
+    {
+        *mode = RIG_MODE_AMS;
+    }
+    else if (strcmp(s, "LSB") == 0)
+    {
+        *mode = RIG_MODE_LSB;
+    }
+    else if (strcmp(s, "USB") == 0)
+    {
+        *mode = RIG_MODE_USB;
+    }
+    else if (strcmp(s, "CWU") == 0)
+    {
+        *mode = RIG_MODE_CW;
+    }
+    else if (strcmp(s, "CWL") == 0)
+    {
+        *mode = RIG_MODE_CWR;
+    }
+    else if (strcmp(s, "FM") == 0)
+    {
+        *mode = RIG_MODE_FM;
+    }
+    else if (strcmp(s, "WFM") == 0)
+    {
+        *mode = RIG_MODE_WFM;
+    }
+    else if (strcmp(s, "WFM_ST") == 0)
+    {
+        *mode = RIG_MODE_WFMS;
+    }
+    else
+    {
+        return -RIG_EPROTO;
+    }
+
+    return RIG_OK;
+}
+
+
 /*
 * gqrx_init
 * Assumes rig!=NULL
@@ -407,26 +478,47 @@ static int gqrx_get_freq(RIG *rig, vfo_t vfo, freq_t *freq)
 static int gqrx_open(RIG *rig)
 {
     int retval;
-    char value[MAXARGLEN];
+    struct rigctl_pipe_cmd cmds[3];
+    struct gqrx_priv_data *priv = (struct gqrx_priv_data *) STATE(rig)->priv;
 
     ENTERFUNC;
-    value[0] = '?';
-    value[1] = 0;
 
-    freq_t freq;
-    retval = gqrx_get_freq(rig, RIG_VFO_CURR, &freq);
+    // frequency, mode and DSP state in one go
+    memset(cmds, 0, sizeof(cmds));
+    SNPRINTF(cmds[0].cmd, sizeof(cmds[0].cmd), "f\n");
+    cmds[0].lines = 1;
+    SNPRINTF(cmds[1].cmd, sizeof(cmds[1].cmd), "m\n");
+    cmds[1].lines = 2;
+    SNPRINTF(cmds[2].cmd, sizeof(cmds[2].cmd), "u DSP\n");
+    cmds[2].lines = 1;
 
-    if (retval != RIG_OK)
+    retval = gqrx_pipe(rig, cmds, 3);
+
+    if (retval != RIG_OK || cmds[0].status
+            || sscanf(cmds[0].reply[0], "%lf", &priv->curr_freq) != 1
+            || priv->curr_freq == 0)
     {
         rig_debug(RIG_DEBUG_ERR, "%s: gqrx_get_freq not working!!\n", __func__);
         RETURNFUNC(-RIG_EPROTO);
     }
 
+    if (!cmds[1].status
+            && gqrx_parse_mode(cmds[1].reply[0], &priv->curr_mode) == RIG_OK)
+    {
+        priv->curr_width = atol(cmds[1].reply[1]);
+    }
+
+    if (!cmds[2].status)
+    {
+        priv->curr_power = (cmds[2].reply[0][0] == '1');
+    }
+
     STATE(rig)->current_vfo = RIG_VFO_A;
-    rig_debug(RIG_DEBUG_TRACE, "%s: currvfo=%s value=%s\n", __func__,
-              rig_strvfo(STATE(rig)->current_vfo), value);
+    rig_debug(RIG_DEBUG_TRACE, "%s: currvfo=%s freq=%.0f mode=%s width=%ld\n",
+              __func__, rig_strvfo(STATE(rig)->current_vfo), priv->curr_freq,
+              rig_strrmode(priv->curr_mode), priv->curr_width);
 
-    RETURNFUNC(retval);
+    RETURNFUNC(RIG_OK);
 }
 
 
@@ -633,9 +725,8 @@ static int gqrx_set_mode(RIG *rig, vfo_t vfo, rmode_t mode, pbwidth_t width)
 static int gqrx_get_mode(RIG *rig, vfo_t vfo, rmode_t *mode, pbwidth_t *width)
 {
     int retval;
-    char value[MAXARGLEN];
-    char modeStr[MAXARGLEN];
-    int pbwidth;
+    struct rigctl_pipe_cmd cmd;
+    pbwidth_t pbwidth;
     struct gqrx_priv_data *priv = (struct gqrx_priv_data *) STATE(rig)->priv;
 
     ENTERFUNC;
@@ -656,9 +747,17 @@ static int gqrx_get_mode(RIG *rig, vfo_t vfo, rmode_t *mode, pbwidth_t *width)
                   __func__, rig_strvfo(vfo));
     }
 
-    char *cmd = "m\n";
+    // the mode and the passband come on two lines
+    memset(&cmd, 0, sizeof(cmd));
+    SNPRINTF(cmd.cmd, sizeof(cmd.cmd), "m\n");
+    cmd.lines = 2;
 
-    retval = gqrx_transaction(rig, cmd, value, sizeof(value));
+    retval = gqrx_pipe(rig, &cmd, 1);
+
+    if (retval == RIG_OK && cmd.status)
+    {
+        retval = -RIG_EPROTO;
+    }
 
     if (retval != RIG_OK)
     {
@@ -667,52 +766,16 @@ static int gqrx_get_mode(RIG *rig, vfo_t vfo, rmode_t *mode, pbwidth_t *width)
         RETURNFUNC(retval);
     }
 
-    sscanf(value, "%s\n%d", &modeStr[0], &pbwidth);
-
-    if (strcmp(&modeStr[0], "AM") == 0)
-    {
-        *mode = RIG_MODE_AM;
-    }
-    else if (strcmp(&modeStr[0], "AMS") == 0)
-    {
-        *mode = RIG_MODE_AMS;
-    }
-    else if (strcmp(&modeStr[0], "LSB") == 0)
-    {
-        *mode = RIG_MODE_LSB;
-    }
-    else if (strcmp(&modeStr[0], "USB") == 0)
-    {
-        *mode = RIG_MODE_USB;
-    }
-    else if (strcmp(&modeStr[0], "CWU") == 0)
-    {
-        *mode = RIG_MODE_CW;
-    }
-    else if (strcmp(&modeStr[0], "CWL") == 0)
-    {
-        *mode = RIG_MODE_CWR;
-    }
-    else if (strcmp(&modeStr[0], "FM") == 0)
-    {
-        *mode = RIG_MODE_FM;
-    }
-    else if (strcmp(&modeStr[0], "WFM") == 0)
-    {
-        *mode = RIG_MODE_WFM;
-    }
-    else if (strcmp(&modeStr[0], "WFM_ST") == 0)
-    {
-        *mode = RIG_MODE_WFMS;
-    }
-    else
+    if (gqrx_parse_mode(cmd.reply[0], mode) != RIG_OK)
     {
         rig_debug(RIG_DEBUG_ERR, "%s: value=%s\n", __func__,
-                  value);
+                  cmd.reply[0]);
         RETURNFUNC(-RIG_EPROTO);
     }
-    
-    rig_debug(RIG_DEBUG_TRACE, "%s: mode=%s\n", __func__, modeStr);
+
+    pbwidth = atol(cmd.reply[1]);
+
+    rig_debug(RIG_DEBUG_TRACE, "%s: mode=%s\n", __func__, cmd.reply[0]);
 
     if (vfo == RIG_VFO_A)
     {
@@ -22,6 +22,8 @@
 #include "hamlib/config.h"
 #include <stdio.h>
 #include <stdlib.h>
+#include <ctype.h>
+#include <errno.h>
 #include <string.h>  /* String function definitions */
 #include <unistd.h>  /* UNIX standard function definitions */
 
@@ -33,6 +35,7 @@
 #include "num_stdio.h"
 
 #include "dummy.h"
+#include "rigctl_pipe.h"
 
 #define CMD_MAX 64
 #define BUF_MAX 1024
@@ -246,58 +249,265 @@ int parse_array_double(const char *s, const char *delim, double *array,
 
 
 
-static int netrigctl_open(RIG *rig)
+/*
+ * Where the \dump_state answer is read from: the port, or a copy already
+ * in memory from the blob or the disk cache
+ */
+struct netrigctl_dump
 {
-    int ret, i;
-    struct rig_state *rs = STATE(rig);
-    hamlib_port_t *rp = RIGPORT(rig);
-    int prot_ver;
-    char cmd[CMD_MAX];
-    char buf[BUF_MAX];
-    struct netrigctl_priv_data *priv;
+    char *text;         /* NULL to read from the port */
+    size_t pos;
+};
 
+static int netrigctl_dump_line(RIG *rig, struct netrigctl_dump *dump,
+                               char *buf, int buflen)
+{
+    const char *line;
+    size_t len, copy;
 
-    ENTERFUNC;
+    if (dump->text == NULL)
+    {
+        return read_string(RIGPORT(rig), (unsigned char *) buf, buflen, "\n", 1, 0,
+                           1);
+    }
 
-    priv = (struct netrigctl_priv_data *)STATE(rig)->priv;
-    priv->rx_vfo = RIG_VFO_A;
-    priv->tx_vfo = RIG_VFO_B;
+    line = dump->text + dump->pos;
+    len = strcspn(line, "\n");
 
-    SNPRINTF(cmd, sizeof(cmd), "\\chk_vfo\n");
-    ret = netrigctl_transaction(rig, cmd, strlen(cmd), buf);
+    if (line[len] == '\n') { len++; }
+
+    copy = len < buflen - 1 ? len : buflen - 1;
+    memcpy(buf, line, copy);
+    buf[copy] = '\0';
+    dump->pos += len;
 
-    if (sscanf(buf, "%d", &priv->rigctld_vfo_mode) == 1)
+    return copy;
+}
+
+/*
+ * The \dump_state answer is cached on disk per rigctld address, so that
+ * a reconnect only confirms its hash instead of transferring it again
+ */
+#define NETRIGCTL_DUMP_BLOB_VER 1
+static int netrigctl_dump_cache_path(RIG *rig, char *path, int pathlen)
+{
+    const char *cachedir = getenv("XDG_CACHE_HOME");
+    const char *home = getenv("HOME");
+    char name[HAMLIB_FILPATHLEN];
+    int i;
+
+    if (home == NULL)
     {
-        STATE(rig)->vfo_opt = priv->rigctld_vfo_mode;
-        rig_debug(RIG_DEBUG_TRACE, "%s: chkvfo=%d\n", __func__, priv->rigctld_vfo_mode);
+        home = getenv("HOMEPATH");
     }
-    else if (ret == 2)
+
+    SNPRINTF(name, sizeof(name), "%s", RIGPORT(rig)->pathname);
+
+    for (i = 0; name[i] != '\0'; i++)
     {
-        if (buf[0]) { sscanf(buf, "%d", &priv->rigctld_vfo_mode); }
+        if (!isalnum((unsigned char) name[i]) && name[i] != '.' && name[i] != '-')
+        {
+            name[i] = '_';
+        }
     }
-    else if (ret < 0)
+
+    if (cachedir)
     {
-        rig_debug(RIG_DEBUG_WARN, "%s: chk_vfo error: %s\n", __func__,
-                  rigerror(ret));
+        SNPRINTF(path, pathlen, "%s/hamlib_netrigctl_%s.dump", cachedir, name);
+    }
+    else if (home)
+    {
+        SNPRINTF(path, pathlen, "%s/.cache", home);
+
+        if (access(path, F_OK) != -1)
+        {
+            SNPRINTF(path, pathlen, "%s/.cache/hamlib_netrigctl_%s.dump", home, name);
+        }
+        else
+        {
+            SNPRINTF(path, pathlen, "%s/.hamlib_netrigctl_%s.dump", home, name);
+        }
     }
     else
     {
-        rig_debug(RIG_DEBUG_ERR, "%s:  unknown value returned from netrigctl_transaction=%d\n",
-                  __func__, ret);
+        return -RIG_ENAVAIL;
     }
 
-    rig_debug(RIG_DEBUG_VERBOSE, "%s: vfo_mode=%d\n", __func__,
-              priv->rigctld_vfo_mode);
+    return RIG_OK;
+}
 
-    SNPRINTF(cmd, sizeof(cmd), "\\dump_state\n");
+/* Returns the cached answer if its model and hash match, else NULL */
+static char *netrigctl_dump_cache_load(RIG *rig, int model, unsigned long hash)
+{
+    char path[1024];
+    char *text;
+    FILE *fp;
+    int ver, cached_model;
+    unsigned long cached_hash, len;
 
-    ret = netrigctl_transaction(rig, cmd, strlen(cmd), buf);
+    if (netrigctl_dump_cache_path(rig, path, sizeof(path)) != RIG_OK)
+    {
+        return NULL;
+    }
+
+    fp = fopen(path, "rb");
+
+    if (fp == NULL)
+    {
+        return NULL;
+    }
+
+    if (fscanf(fp, "%d %d %lx %lu\n", &ver, &cached_model, &cached_hash,
+               &len) != 4
+            || ver != NETRIGCTL_DUMP_BLOB_VER || cached_model != model
+            || cached_hash != hash || len == 0 || len > 1024 * 1024)
+    {
+        rig_debug(RIG_DEBUG_VERBOSE, "%s: %s is stale\n", __func__, path);
+        fclose(fp);
+        return NULL;
+    }
+
+    text = malloc(len + 1);
+
+    if (text != NULL && (fread(text, 1, len, fp) != len
+                         || CRC32_function((uint8_t *) text, len) != hash))
+    {
+        rig_debug(RIG_DEBUG_WARN, "%s: %s is damaged\n", __func__, path);
+        free(text);
+        text = NULL;
+    }
+    else if (text != NULL)
+    {
+        text[len] = '\0';
+        rig_debug(RIG_DEBUG_VERBOSE, "%s: using %s\n", __func__, path);
+    }
+
+    fclose(fp);
+
+    return text;
+}
+
+static void netrigctl_dump_cache_save(RIG *rig, int model, unsigned long hash,
+                                      const char *text, size_t len)
+{
+    char path[1024];
+    char tmp_path[1100];
+    FILE *fp;
+    int failed;
+
+    if (netrigctl_dump_cache_path(rig, path, sizeof(path)) != RIG_OK)
+    {
+        return;
+    }
+
+    // written aside and renamed over the old one, so that another client
+    // never reads a half written file
+    SNPRINTF(tmp_path, sizeof(tmp_path), "%s.%d.tmp", path, (int) getpid());
+
+    fp = fopen(tmp_path, "wb");
+
+    if (fp == NULL)
+    {
+        rig_debug(RIG_DEBUG_WARN, "%s: %s: %s\n", __func__, tmp_path,
+                  strerror(errno));
+        return;
+    }
+
+    failed = fprintf(fp, "%d %d 0x%08lx %lu\n", NETRIGCTL_DUMP_BLOB_VER, model,
+                     hash, (unsigned long) len) < 0;
+    failed |= fwrite(text, 1, len, fp) != len;
+    failed |= fclose(fp) != 0;
+
+#ifdef _WIN32
+    // rename() does not replace an existing file on Windows
+    if (!failed)
+    {
+        remove(path);
+    }
+
+#endif
+
+    if (failed || rename(tmp_path, path) != 0)
+    {
+        rig_debug(RIG_DEBUG_WARN, "%s: %s: %s\n", __func__, path, strerror(errno));
+        remove(tmp_path);
+    }
+}
+
+/*
+ * Fetch the \dump_state answer as one block, its hash checked against the
+ * one the server announced. Returns a malloc'ed copy, NULL on error.
+ */
+static char *netrigctl_dump_blob(RIG *rig, int model, unsigned long hash)
+{
+    struct rigctl_pipe_cmd cmd;
+    int ver, blob_model;
+    unsigned long blob_hash, len;
+    char *text;
+    int ret;
+
+    memset(&cmd, 0, sizeof(cmd));
+    SNPRINTF(cmd.cmd, sizeof(cmd.cmd), "\\dump_state_blob\n");
+    cmd.lines = 1;
+
+    ret = rigctl_pipe(rig, &cmd, 1, 1);
+
+    if (ret != RIG_OK || cmd.status
+            || sscanf(cmd.reply[0], "%d %d %lx %lu", &ver, &blob_model, &blob_hash,
+                      &len) != 4
+            || ver != NETRIGCTL_DUMP_BLOB_VER || blob_model != model
+            || blob_hash != hash || len == 0 || len > 1024 * 1024)
+    {
+        rig_debug(RIG_DEBUG_ERR, "%s: bad blob header '%s'\n", __func__,
+                  cmd.reply[0]);
+        return NULL;
+    }
+
+    text = malloc(len + 1);
+
+    if (text == NULL)
+    {
+        return NULL;
+    }
+
+    ret = read_block(RIGPORT(rig), (unsigned char *) text, len);
+
+    if (ret != (int) len || CRC32_function((uint8_t *) text, len) != hash)
+    {
+        rig_debug(RIG_DEBUG_ERR, "%s: blob of %lu bytes not received intact\n",
+                  __func__, len);
+        free(text);
+        return NULL;
+    }
+
+    text[len] = '\0';
+    netrigctl_dump_cache_save(rig, model, hash, text, len);
+
+    return text;
+}
+
+static int netrigctl_parse_dump_state(RIG *rig, struct netrigctl_dump *dump)
+{
+    int ret, i;
+    struct rig_state *rs = STATE(rig);
+    int prot_ver;
+    char buf[BUF_MAX];
+
+    ENTERFUNC;
+
+    ret = netrigctl_dump_line(rig, dump, buf, BUF_MAX);
 
     if (ret <= 0)
     {
         RETURNFUNC((ret < 0) ? ret : -RIG_EPROTO);
     }
 
+    if (strncmp(buf, NETRIGCTL_RET, strlen(NETRIGCTL_RET)) == 0)
+    {
+        ret = atoi(buf + strlen(NETRIGCTL_RET));
+        RETURNFUNC(ret < 0 ? ret : -RIG_EPROTO);
+    }
+
     prot_ver = atoi(buf);
 #define RIGCTLD_PROT_VER 0
 
@@ -306,14 +516,14 @@ static int netrigctl_open(RIG *rig)
         RETURNFUNC(-RIG_EPROTO);
     }
 
-    ret = read_string(rp, (unsigned char *) buf, BUF_MAX, "\n", 1, 0, 1);
+    ret = netrigctl_dump_line(rig, dump, buf, BUF_MAX);
 
     if (ret <= 0)
     {
         RETURNFUNC((ret < 0) ? ret : -RIG_EPROTO);
     }
 
-    ret = read_string(rp, (unsigned char *) buf, BUF_MAX, "\n", 1, 0, 1);
+    ret = netrigctl_dump_line(rig, dump, buf, BUF_MAX);
 
     if (ret <= 0)
     {
@@ -324,7 +534,7 @@ static int netrigctl_open(RIG *rig)
 
     for (i = 0; i < HAMLIB_FRQRANGESIZ; i++)
     {
-        ret = read_string(rp, (unsigned char *) buf, BUF_MAX, "\n", 1, 0, 1);
+        ret = netrigctl_dump_line(rig, dump, buf, BUF_MAX);
 
         if (ret <= 0)
         {
@@ -354,7 +564,7 @@ static int netrigctl_open(RIG *rig)
 
     for (i = 0; i < HAMLIB_FRQRANGESIZ; i++)
     {
-        ret = read_string(rp, (unsigned char *) buf, BUF_MAX, "\n", 1, 0, 1);
+        ret = netrigctl_dump_line(rig, dump, buf, BUF_MAX);
 
         if (ret <= 0)
         {
@@ -396,7 +606,7 @@ static int netrigctl_open(RIG *rig)
 
     for (i = 0; i < HAMLIB_TSLSTSIZ; i++)
     {
-        ret = read_string(rp, (unsigned char *) buf, BUF_MAX, "\n", 1, 0, 1);
+        ret = netrigctl_dump_line(rig, dump, buf, BUF_MAX);
 
         if (ret <= 0)
         {
@@ -420,7 +630,7 @@ static int netrigctl_open(RIG *rig)
 
     for (i = 0; i < HAMLIB_FLTLSTSIZ; i++)
     {
-        ret = read_string(rp, (unsigned char *) buf, BUF_MAX, "\n", 1, 0, 1);
+        ret = netrigctl_dump_line(rig, dump, buf, BUF_MAX);
 
         if (ret <= 0)
         {
@@ -447,7 +657,7 @@ static int netrigctl_open(RIG *rig)
     chan_t chan_list[HAMLIB_CHANLSTSIZ]; /*!< Channel list, zero ended */
 #endif
 
-    ret = read_string(rp, (unsigned char *) buf, BUF_MAX, "\n", 1, 0, 1);
+    ret = netrigctl_dump_line(rig, dump, buf, BUF_MAX);
 
     if (ret <= 0)
     {
@@ -456,7 +666,7 @@ static int netrigctl_open(RIG *rig)
 
     rig->caps->max_rit = rs->max_rit = atol(buf);
 
-    ret = read_string(rp, (unsigned char *) buf, BUF_MAX, "\n", 1, 0, 1);
+    ret = netrigctl_dump_line(rig, dump, buf, BUF_MAX);
 
     if (ret <= 0)
     {
@@ -465,7 +675,7 @@ static int netrigctl_open(RIG *rig)
 
     rig->caps->max_xit = rs->max_xit = atol(buf);
 
-    ret = read_string(rp, (unsigned char *) buf, BUF_MAX, "\n", 1, 0, 1);
+    ret = netrigctl_dump_line(rig, dump, buf, BUF_MAX);
 
     if (ret <= 0)
     {
@@ -474,7 +684,7 @@ static int netrigctl_open(RIG *rig)
 
     rig->caps->max_ifshift = rs->max_ifshift = atol(buf);
 
-    ret = read_string(rp, (unsigned char *) buf, BUF_MAX, "\n", 1, 0, 1);
+    ret = netrigctl_dump_line(rig, dump, buf, BUF_MAX);
 
     if (ret <= 0)
     {
@@ -483,7 +693,7 @@ static int netrigctl_open(RIG *rig)
 
     rs->announces = atoi(buf);
 
-    ret = read_string(rp, (unsigned char *) buf, BUF_MAX, "\n", 1, 0, 1);
+    ret = netrigctl_dump_line(rig, dump, buf, BUF_MAX);
 
     if (ret <= 0)
     {
@@ -510,7 +720,7 @@ static int netrigctl_open(RIG *rig)
 
     rig->caps->preamp[ret] = rs->preamp[ret] = RIG_DBLST_END;
 
-    ret = read_string(rp, (unsigned char *) buf, BUF_MAX, "\n", 1, 0, 1);
+    ret = netrigctl_dump_line(rig, dump, buf, BUF_MAX);
 
     if (ret <= 0)
     {
@@ -537,7 +747,7 @@ static int netrigctl_open(RIG *rig)
 
     rig->caps->attenuator[ret] = rs->attenuator[ret] = RIG_DBLST_END;
 
-    ret = read_string(rp, (unsigned char *) buf, BUF_MAX, "\n", 1, 0, 1);
+    ret = netrigctl_dump_line(rig, dump, buf, BUF_MAX);
 
     if (ret <= 0)
     {
@@ -546,7 +756,7 @@ static int netrigctl_open(RIG *rig)
 
     rig->caps->has_get_func = rs->has_get_func = strtoll(buf, NULL, 0);
 
-    ret = read_string(rp, (unsigned char *) buf, BUF_MAX, "\n", 1, 0, 1);
+    ret = netrigctl_dump_line(rig, dump, buf, BUF_MAX);
 
     if (ret <= 0)
     {
@@ -555,7 +765,7 @@ static int netrigctl_open(RIG *rig)
 
     rig->caps->has_set_func = rs->has_set_func = strtoll(buf, NULL, 0);
 
-    ret = read_string(rp, (unsigned char *) buf, BUF_MAX, "\n", 1, 0, 1);
+    ret = netrigctl_dump_line(rig, dump, buf, BUF_MAX);
 
     if (ret <= 0)
     {
@@ -577,7 +787,7 @@ static int netrigctl_open(RIG *rig)
 
 #endif
 
-    ret = read_string(rp, (unsigned char *) buf, BUF_MAX, "\n", 1, 0, 1);
+    ret = netrigctl_dump_line(rig, dump, buf, BUF_MAX);
 
     if (ret <= 0)
     {
@@ -586,7 +796,7 @@ static int netrigctl_open(RIG *rig)
 
     rig->caps->has_set_level = rs->has_set_level = strtoll(buf, NULL, 0);
 
-    ret = read_string(rp, (unsigned char *) buf, BUF_MAX, "\n", 1, 0, 1);
+    ret = netrigctl_dump_line(rig, dump, buf, BUF_MAX);
 
     if (ret <= 0)
     {
@@ -595,7 +805,7 @@ static int netrigctl_open(RIG *rig)
 
     rs->has_get_parm = strtoll(buf, NULL, 0);
 
-    ret = read_string(rp, (unsigned char *) buf, BUF_MAX, "\n", 1, 0, 1);
+    ret = netrigctl_dump_line(rig, dump, buf, BUF_MAX);
 
     if (ret <= 0)
     {
@@ -634,7 +844,7 @@ static int netrigctl_open(RIG *rig)
     {
         char setting[32], value[1024];
         hamlib_port_t *pttp = PTTPORT(rig);
-        ret = read_string(rp, (unsigned char *) buf, BUF_MAX, "\n", 1, 0, 1);
+        ret = netrigctl_dump_line(rig, dump, buf, BUF_MAX);
         strtok(buf, "\r\n"); // chop the EOL
 
         rig_debug(RIG_DEBUG_VERBOSE, "## %s\n", buf);
@@ -924,6 +1134,99 @@ static int netrigctl_open(RIG *rig)
     RETURNFUNC(RIG_OK);
 }
 
+static int netrigctl_open(RIG *rig)
+{
+    int ret;
+    int model;
+    unsigned long hash;
+    struct rigctl_pipe_cmd cmds[2];
+    struct netrigctl_dump dump = { NULL, 0 };
+    struct netrigctl_priv_data *priv;
+
+
+    ENTERFUNC;
+
+    priv = (struct netrigctl_priv_data *)STATE(rig)->priv;
+    priv->rx_vfo = RIG_VFO_A;
+    priv->tx_vfo = RIG_VFO_B;
+
+    // an older rigctld ignores \dump_state_hash, the second \chk_vfo
+    // answers in its place
+    memset(cmds, 0, sizeof(cmds));
+    SNPRINTF(cmds[0].cmd, sizeof(cmds[0].cmd), "\\chk_vfo\n");
+    cmds[0].lines = 1;
+    SNPRINTF(cmds[1].cmd, sizeof(cmds[1].cmd), "\\dump_state_hash\n\\chk_vfo\n");
+    cmds[1].lines = 1;
+
+    ret = rigctl_pipe(rig, cmds, 2, RIGCTL_PIPE_WINDOW);
+
+    if (ret != RIG_OK)
+    {
+        RETURNFUNC(ret);
+    }
+
+    if (cmds[0].status)
+    {
+        rig_debug(RIG_DEBUG_WARN, "%s: chk_vfo error: %s\n", __func__,
+                  rigerror(cmds[0].retval));
+    }
+    else if (sscanf(cmds[0].reply[0], "%d", &priv->rigctld_vfo_mode) == 1)
+    {
+        STATE(rig)->vfo_opt = priv->rigctld_vfo_mode;
+        rig_debug(RIG_DEBUG_TRACE, "%s: chkvfo=%d\n", __func__, priv->rigctld_vfo_mode);
+    }
+    else
+    {
+        rig_debug(RIG_DEBUG_ERR, "%s: unknown chk_vfo answer '%s'\n", __func__,
+                  cmds[0].reply[0]);
+    }
+
+    rig_debug(RIG_DEBUG_VERBOSE, "%s: vfo_mode=%d\n", __func__,
+              priv->rigctld_vfo_mode);
+
+    if (cmds[1].status
+            || sscanf(cmds[1].reply[0], "%*d %d %lx", &model, &hash) == 2)
+    {
+        char buf[BUF_MAX];
+
+        // the answer of the second \chk_vfo is still to come
+        ret = read_string(RIGPORT(rig), (unsigned char *) buf, BUF_MAX, "\n", 1, 0,
+                          1);
+
+        if (ret <= 0)
+        {
+            RETURNFUNC((ret < 0) ? ret : -RIG_EPROTO);
+        }
+
+        if (!cmds[1].status)
+        {
+            dump.text = netrigctl_dump_cache_load(rig, model, hash);
+
+            if (dump.text == NULL)
+            {
+                dump.text = netrigctl_dump_blob(rig, model, hash);
+            }
+        }
+    }
+
+    if (dump.text == NULL)
+    {
+        rig_debug(RIG_DEBUG_VERBOSE, "%s: reading \\dump_state from the server\n",
+                  __func__);
+        ret = write_block(RIGPORT(rig), (unsigned char *) "\\dump_state\n", 12);
+
+        if (ret != RIG_OK)
+        {
+            RETURNFUNC(ret);
+        }
+    }
+
+    ret = netrigctl_parse_dump_state(rig, &dump);
+    free(dump.text);
+
+    RETURNFUNC(ret);
+}
+
 static int netrigctl_close(RIG *rig)
 {
     const struct rig_state *rs = STATE(rig);
@@ -1787,6 +2090,28 @@ static int netrigctl_get_split_vfo(RIG *rig, vfo_t vfo, split_t *split,
     return RIG_OK;
 }
 
+static int netrigctl_get_vfo_snapshot(RIG *rig,
+                                      struct rig_vfo_snapshot *snapshot)
+{
+    struct netrigctl_priv_data *priv;
+    int ret;
+
+    rig_debug(RIG_DEBUG_VERBOSE, "%s called\n", __func__);
+
+    priv = (struct netrigctl_priv_data *)STATE(rig)->priv;
+
+    ret = rigctl_pipe_vfo_snapshot(rig, snapshot,
+                                   STATE(rig)->vfo_opt || priv->rigctld_vfo_mode,
+                                   netrigctl_vfostr);
+
+    if (ret == RIG_OK && snapshot->current_vfo != RIG_VFO_NONE)
+    {
+        priv->vfo_curr = snapshot->current_vfo;
+    }
+
+    return ret;
+}
+
 static int netrigctl_set_rit(RIG *rig, vfo_t vfo, shortfreq_t rit)
 {
     int ret;
@@ -2826,7 +3151,7 @@ struct rig_caps netrigctl_caps =
     RIG_MODEL(RIG_MODEL_NETRIGCTL),
     .model_name =     "NET rigctl",
     .mfg_name =       "Hamlib",
-    .version =        "20250211.0",
+    .version =        "20261018.1",
     .copyright =      "LGPL",
     .status =         RIG_STATUS_STABLE,
     .rig_type =       RIG_TYPE_OTHER,
@@ -2934,6 +3259,7 @@ struct rig_caps netrigctl_caps =
     .password =   netrigctl_password,
     .set_lock_mode = netrigctl_set_lock_mode,
     .get_lock_mode = netrigctl_get_lock_mode,
+    .get_vfo_snapshot = netrigctl_get_vfo_snapshot,
 
     .hamlib_check_rig_caps = HAMLIB_CHECK_RIG_CAPS
 };
@@ -33,6 +33,7 @@
 #include "num_stdio.h"
 
 #include "dummy.h"
+#include "rigctl_pipe.h"
 
 #define CMD_MAX 64
 #define BUF_MAX 1024
@@ -1714,6 +1715,27 @@ static int quisk_get_split_vfo(RIG *rig, vfo_t vfo, split_t *split,
 }
 #endif
 
+static int quisk_get_vfo_snapshot(RIG *rig, struct rig_vfo_snapshot *snapshot)
+{
+    struct quisk_priv_data *priv;
+    int ret;
+
+    rig_debug(RIG_DEBUG_VERBOSE, "%s called\n", __func__);
+
+    priv = (struct quisk_priv_data *)STATE(rig)->priv;
+
+    ret = rigctl_pipe_vfo_snapshot(rig, snapshot,
+                                   STATE(rig)->vfo_opt || priv->rigctld_vfo_mode,
+                                   quisk_vfostr);
+
+    if (ret == RIG_OK && snapshot->current_vfo != RIG_VFO_NONE)
+    {
+        priv->vfo_curr = snapshot->current_vfo;
+    }
+
+    return ret;
+}
+
 static int quisk_set_rit(RIG *rig, vfo_t vfo, shortfreq_t rit)
 {
     int ret;
@@ -2758,7 +2780,7 @@ struct rig_caps quisk_caps =
     RIG_MODEL(RIG_MODEL_QUISK),
     .model_name =     "Quisk",
     .mfg_name =       "N2ADR James Ahlstrom",
-    .version =        "20230709.0",
+    .version =        "20261018.0",
     .copyright =      "LGPL",
     .status =         RIG_STATUS_STABLE,
     .rig_type =       RIG_TYPE_OTHER,
@@ -2866,6 +2888,7 @@ struct rig_caps quisk_caps =
     .password =   quisk_password,
 //    .set_lock_mode = quisk_set_lock_mode,
 //    .get_lock_mode = quisk_get_lock_mode,
+    .get_vfo_snapshot = quisk_get_vfo_snapshot,
 
     .hamlib_check_rig_caps = HAMLIB_CHECK_RIG_CAPS
 };
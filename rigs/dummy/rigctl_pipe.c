@@ -0,0 +1,309 @@
+/*
+ *  Hamlib Dummy backend - pipelined client for rigctld-style line protocols
+ *  Copyright (c) 2000-2026 The Hamlib Group
+ *
+ *
+ *   This library is free software; you can redistribute it and/or
+ *   modify it under the terms of the GNU Lesser General Public
+ *   License as published by the Free Software Foundation; either
+ *   version 2.1 of the License, or (at your option) any later version.
+ *
+ *   This library is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *   Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public
+ *   License along with this library; if not, write to the Free Software
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "hamlib/rig.h"
+#include "hamlib/rig_state.h"
+#include "iofunc.h"
+#include "misc.h"
+#include "num_stdio.h"
+
+#include "rigctl_pipe.h"
+
+#define RIGCTL_PIPE_BUF 1024
+
+/*
+ * Send commands first..last-1 in as few writes as they fit in
+ */
+static int rigctl_pipe_send(hamlib_port_t *rp, const struct rigctl_pipe_cmd *cmds,
+                            int first, int last)
+{
+    char buf[RIGCTL_PIPE_BUF];
+    int len = 0;
+    int i;
+
+    for (i = first; i < last; i++)
+    {
+        int cmd_len = strlen(cmds[i].cmd);
+
+        if (len > 0 && len + cmd_len > sizeof(buf))
+        {
+            int ret = write_block(rp, (unsigned char *) buf, len);
+
+            if (ret != RIG_OK) { return ret; }
+
+            len = 0;
+        }
+
+        memcpy(buf + len, cmds[i].cmd, cmd_len);
+        len += cmd_len;
+    }
+
+    return len > 0 ? write_block(rp, (unsigned char *) buf, len) : RIG_OK;
+}
+
+/*
+ * Run the commands with up to window of them outstanding, the server
+ * answering in order. Each reply is read into its rigctl_pipe_cmd, the
+ * status of the command left in its retval.
+ * The answer of the last command may be longer than its lines, e.g.
+ * \dump_state: the caller reads the rest of it from the port.
+ * Returns RIG_OK once every reply was read, or the I/O error that left
+ * the rest of them unread.
+ */
+int rigctl_pipe(RIG *rig, struct rigctl_pipe_cmd *cmds, int count, int window)
+{
+    hamlib_port_t *rp = RIGPORT(rig);
+    char buf[RIGCTL_PIPE_BUF];
+    int sent = 0;
+    int ret = RIG_OK;
+    int i;
+
+    rig_debug(RIG_DEBUG_VERBOSE, "%s: count=%d, window=%d\n", __func__, count,
+              window);
+
+    if (window < 1) { window = 1; }
+
+    /* flush anything in the read buffer before the commands are sent */
+    rig_flush(rp);
+
+    for (i = 0; i < count; i++)
+    {
+        int line;
+
+        // keep the window full, the replies come back in order
+        if (sent < count && sent - i < window)
+        {
+            int last = i + window < count ? i + window : count;
+
+            ret = rigctl_pipe_send(rp, cmds, sent, last);
+
+            if (ret != RIG_OK) { break; }
+
+            sent = last;
+        }
+
+        cmds[i].retval = RIG_OK;
+        cmds[i].status = 0;
+
+        for (line = 0; line < cmds[i].lines && line < RIGCTL_PIPE_LINES; line++)
+        {
+            ret = read_string(rp, (unsigned char *) buf, sizeof(buf), "\n", 1, 0, 1);
+
+            if (ret <= 0)
+            {
+                ret = ret < 0 ? ret : -RIG_EPROTO;
+                break;
+            }
+
+            buf[strcspn(buf, "\r\n")] = '\0';
+            SNPRINTF(cmds[i].reply[line], sizeof(cmds[i].reply[line]), "%s", buf);
+            ret = RIG_OK;
+
+            if (line == 0 && strncmp(buf, NETRIGCTL_RET, strlen(NETRIGCTL_RET)) == 0)
+            {
+                cmds[i].retval = atoi(buf + strlen(NETRIGCTL_RET));
+                cmds[i].status = 1;
+                break;
+            }
+        }
+
+        if (ret != RIG_OK) { break; }
+    }
+
+    if (ret != RIG_OK)
+    {
+        rig_debug(RIG_DEBUG_ERR, "%s: command %d of %d: %s\n", __func__, i + 1, count,
+                  rigerror(ret));
+
+        // the replies still in flight would answer the next commands
+        for (; i < count; i++)
+        {
+            cmds[i].retval = ret;
+        }
+
+        rig_flush(rp);
+    }
+
+    return ret;
+}
+
+/*
+ * Status of an answer carrying a value, a NETRIGCTL_RET line is an error
+ */
+static int rigctl_pipe_value(const struct rigctl_pipe_cmd *cmd)
+{
+    if (!cmd->status)
+    {
+        return RIG_OK;
+    }
+
+    return cmd->retval < 0 ? cmd->retval : -RIG_EPROTO;
+}
+
+/* Same for a value the server may not have */
+static int rigctl_pipe_optional(const struct rigctl_pipe_cmd *cmd)
+{
+    int ret = rigctl_pipe_value(cmd);
+
+    return ret == -RIG_ENAVAIL || ret == -RIG_ENIMPL ? RIG_OK : ret;
+}
+
+/*
+ * get_vfo_snapshot for rigctld-protocol servers: current VFO, frequency
+ * and mode, split and PTT in one pipelined round.
+ * Without VFO mode the commands cannot name a VFO, so only the current
+ * one is read and the other entry is left to the cache. The queries the
+ * backend has no get function for are not sent.
+ */
+int rigctl_pipe_vfo_snapshot(RIG *rig, struct rig_vfo_snapshot *snapshot,
+                             int vfo_mode,
+                             int (*vfostr)(RIG *rig, char *vfostr, int len, vfo_t vfo))
+{
+    const struct rig_caps *caps = rig->caps;
+    struct rigctl_pipe_cmd cmds[7];
+    struct rigctl_pipe_cmd *get_vfo = NULL, *get_split = NULL, *get_ptt = NULL;
+    struct rigctl_pipe_cmd *get_freq[2] = { NULL, NULL };
+    char vfoarg[16];
+    int nvfo = vfo_mode ? 2 : 1;
+    int count = 0;
+    int ret, i;
+
+    memset(cmds, 0, sizeof(cmds));
+
+    if (caps->get_vfo)
+    {
+        get_vfo = &cmds[count++];
+        SNPRINTF(get_vfo->cmd, sizeof(get_vfo->cmd), "v\n");
+        get_vfo->lines = 1;
+    }
+
+    for (i = 0; i < nvfo; i++)
+    {
+        ret = vfostr(rig, vfoarg, sizeof(vfoarg), snapshot->vfos[i].vfo);
+
+        if (ret != RIG_OK) { return ret; }
+
+        get_freq[i] = &cmds[count];
+        SNPRINTF(cmds[count].cmd, sizeof(cmds[count].cmd), "f%s\n", vfoarg);
+        cmds[count++].lines = 1;
+        SNPRINTF(cmds[count].cmd, sizeof(cmds[count].cmd), "m%s\n", vfoarg);
+        cmds[count++].lines = 2;
+    }
+
+    ret = vfostr(rig, vfoarg, sizeof(vfoarg), RIG_VFO_A);
+
+    if (ret != RIG_OK) { return ret; }
+
+    if (caps->get_split_vfo)
+    {
+        get_split = &cmds[count++];
+        SNPRINTF(get_split->cmd, sizeof(get_split->cmd), "s%s\n", vfoarg);
+        get_split->lines = 2;
+    }
+
+    if (caps->get_ptt)
+    {
+        get_ptt = &cmds[count++];
+        SNPRINTF(get_ptt->cmd, sizeof(get_ptt->cmd), "t%s\n", vfoarg);
+        get_ptt->lines = 1;
+    }
+
+    ret = rigctl_pipe(rig, cmds, count, RIGCTL_PIPE_WINDOW);
+
+    if (ret != RIG_OK) { return ret; }
+
+    if (get_vfo)
+    {
+        ret = rigctl_pipe_optional(get_vfo);
+
+        if (ret != RIG_OK) { return ret; }
+
+        if (!get_vfo->status)
+        {
+            snapshot->current_vfo = rig_parse_vfo(get_vfo->reply[0]);
+        }
+    }
+
+    for (i = 0; i < 2; i++)
+    {
+        struct rig_vfo_snapshot_entry *entry = &snapshot->vfos[i];
+        const struct rigctl_pipe_cmd *freq = get_freq[i];
+
+        if (!vfo_mode)
+        {
+            // with the current VFO unknown the first one is assumed
+            int current = entry->vfo == snapshot->current_vfo
+                          || (i == 0 && snapshot->vfos[1].vfo != snapshot->current_vfo);
+
+            freq = current ? get_freq[0] : NULL;
+        }
+
+        if (freq == NULL)
+        {
+            entry->cached = 1;
+            continue;
+        }
+
+        ret = rigctl_pipe_value(&freq[0]);
+
+        if (ret == RIG_OK) { ret = rigctl_pipe_value(&freq[1]); }
+
+        if (ret != RIG_OK) { return ret; }
+
+        if (num_sscanf(freq[0].reply[0], "%"SCNfreq, &entry->freq) != 1)
+        {
+            return -RIG_EPROTO;
+        }
+
+        entry->mode = rig_parse_mode(freq[1].reply[0]);
+        entry->width = atol(freq[1].reply[1]);
+    }
+
+    if (get_split)
+    {
+        ret = rigctl_pipe_optional(get_split);
+
+        if (ret != RIG_OK) { return ret; }
+
+        if (!get_split->status)
+        {
+            snapshot->split = atoi(get_split->reply[0]);
+            snapshot->tx_vfo = rig_parse_vfo(get_split->reply[1]);
+        }
+    }
+
+    if (get_ptt)
+    {
+        ret = rigctl_pipe_optional(get_ptt);
+
+        if (ret != RIG_OK) { return ret; }
+
+        if (!get_ptt->status)
+        {
+            snapshot->ptt = atoi(get_ptt->reply[0]);
+        }
+    }
+
+    return RIG_OK;
+}
@@ -0,0 +1,52 @@
+/*
+ *  Hamlib Dummy backend - pipelined client for rigctld-style line protocols
+ *  Copyright (c) 2000-2026 The Hamlib Group
+ *
+ *
+ *   This library is free software; you can redistribute it and/or
+ *   modify it under the terms of the GNU Lesser General Public
+ *   License as published by the Free Software Foundation; either
+ *   version 2.1 of the License, or (at your option) any later version.
+ *
+ *   This library is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *   Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public
+ *   License along with this library; if not, write to the Free Software
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+#ifndef _RIGCTL_PIPE_H
+#define _RIGCTL_PIPE_H 1
+
+#include "hamlib/rig.h"
+
+#define RIGCTL_PIPE_WINDOW 8        /* default number of commands outstanding */
+#define RIGCTL_PIPE_CMD_MAX 64
+#define RIGCTL_PIPE_LINES 4
+#define RIGCTL_PIPE_LINE_MAX 256
+
+/*
+ * One command of a rigctl_pipe() call.
+ * The server answers either with the lines of a value, or with a single
+ * NETRIGCTL_RET line carrying a status code: set commands always, get
+ * commands when they fail.
+ */
+struct rigctl_pipe_cmd
+{
+    char cmd[RIGCTL_PIPE_CMD_MAX];  /* command, newline terminated */
+    int lines;                      /* lines of the answer when there is a value */
+    int retval;                     /* status code of a NETRIGCTL_RET line, else RIG_OK */
+    int status;                     /* 1 if the answer was a NETRIGCTL_RET line */
+    char reply[RIGCTL_PIPE_LINES][RIGCTL_PIPE_LINE_MAX];   /* lines without EOL */
+};
+
+int rigctl_pipe(RIG *rig, struct rigctl_pipe_cmd *cmds, int count, int window);
+int rigctl_pipe_vfo_snapshot(RIG *rig, struct rig_vfo_snapshot *snapshot,
+                             int vfo_mode,
+                             int (*vfostr)(RIG *rig, char *vfostr, int len, vfo_t vfo));
+
+#endif /* _RIGCTL_PIPE_H */
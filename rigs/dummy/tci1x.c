@@ -30,6 +30,7 @@
 #include "iofunc.h"
 #include "misc.h"
 #include "token.h"
+#include "event.h"
 
 #include "dummy_common.h"
 
@@ -59,6 +60,22 @@
 
 #define streq(s1,s2) (strcmp(s1,s2)==0)
 
+/* WebSocket opcodes */
+#define TCI1X_WS_CONTINUATION 0
+#define TCI1X_WS_TEXT 1
+#define TCI1X_WS_CLOSE 8
+
+/* Parts of the state the server has told us about */
+#define TCI1X_STATE_FREQA    (1 << 0)
+#define TCI1X_STATE_FREQB    (1 << 1)
+#define TCI1X_STATE_MODE     (1 << 2)
+#define TCI1X_STATE_FILTER   (1 << 3)
+#define TCI1X_STATE_PTT      (1 << 4)
+#define TCI1X_STATE_SPLIT    (1 << 5)
+#define TCI1X_STATE_DRIVE    (1 << 6)
+#define TCI1X_STATE_SMETER   (1 << 7)
+#define TCI1X_STATE_TX_POWER (1 << 8)
+
 static int tci1x_init(RIG *rig);
 static int tci1x_open(RIG *rig);
 static int tci1x_close(RIG *rig);
@@ -84,10 +101,15 @@ static int tci1x_set_split_freq_mode(RIG *rig, vfo_t vfo, freq_t freq,
                                      rmode_t mode, pbwidth_t width);
 static int tci1x_get_split_freq_mode(RIG *rig, vfo_t vfo, freq_t *freq,
                                      rmode_t *mode, pbwidth_t *width);
-#ifdef XXNOTIMPLEMENTED
-static int tci1x_set_level(RIG *rig, vfo_t vfo, setting_t level, value_t val);
 static int tci1x_get_level(RIG *rig, vfo_t vfo, setting_t level, value_t *val);
-
+static int tci1x_read_frame_direct(RIG *rig, size_t buffer_length,
+                                   const unsigned char *buffer);
+static int tci1x_is_async_frame(RIG *rig, size_t frame_length,
+                                const unsigned char *frame);
+static int tci1x_process_async_frame(RIG *rig, size_t frame_length,
+                                     const unsigned char *frame);
+static int tci1x_set_level(RIG *rig, vfo_t vfo, setting_t level, value_t val);
+#ifdef XXNOTIMPLEMENTED
 static int tci1x_set_ext_parm(RIG *rig, hamlib_token_t token, value_t val);
 static int tci1x_get_ext_parm(RIG *rig, hamlib_token_t token, value_t *val);
 #endif
@@ -118,6 +140,13 @@ struct tci1x_priv_data
     float powermeter_scale;  /* So we can scale power meter to 0-1 */
     value_t parms[RIG_SETTING_MAX];
     struct ext_list *ext_parms;
+    int state; /* TCI1X_STATE_* bits of what has been received */
+    int drive; /* 0-100 */
+    double smeter; /* dBm */
+    double tx_power; /* W */
+    double tx_swr;
+    char pending[MAXARGLEN]; /* start of the reply a transaction waits for */
+    int ws_opcode; /* type of a continued WebSocket frame */
 };
 
 /* level's and parm's tokens */
@@ -140,7 +169,7 @@ struct rig_caps tci1x_caps =
     RIG_MODEL(RIG_MODEL_TCI1X),
     .model_name = "TCI1.X",
     .mfg_name = "Expert Elec",
-    .version = "20211125.0",
+    .version = "20261018.1",
     .copyright = "LGPL",
     .status = RIG_STATUS_BETA,
     .rig_type = RIG_TYPE_TRANSCEIVER,
@@ -155,7 +184,7 @@ struct rig_caps tci1x_caps =
     .has_get_func = RIG_FUNC_NONE,
     .has_set_func = RIG_FUNC_NONE,
     .has_get_level = TCI1X_LEVELS,
-    .has_set_level = RIG_LEVEL_SET(TCI1X_LEVELS),
+    .has_set_level = RIG_LEVEL_RFPOWER,
     .has_get_parm =    TCI1X_PARM,
     .has_set_parm =    RIG_PARM_SET(TCI1X_PARM),
 
@@ -204,9 +233,13 @@ struct rig_caps tci1x_caps =
     .get_split_vfo = tci1x_get_split_vfo,
     .set_split_freq_mode = tci1x_set_split_freq_mode,
     .get_split_freq_mode = tci1x_get_split_freq_mode,
-#ifdef XXNOTIMPLEMENTED
     .set_level = tci1x_set_level,
     .get_level = tci1x_get_level,
+    .async_data_supported = 1,
+    .read_frame_direct = tci1x_read_frame_direct,
+    .is_async_frame = tci1x_is_async_frame,
+    .process_async_frame = tci1x_process_async_frame,
+#ifdef XXNOTIMPLEMENTED
     .set_ext_parm =  tci1x_set_ext_parm,
     .get_ext_parm =  tci1x_get_ext_parm,
 #endif
@@ -243,6 +276,28 @@ static struct s_modeMap modeMap[] =
     {0, NULL}
 };
 
+//TCI names the modulations the same whatever the radio
+struct tci1x_modulation
+{
+    const char *name;
+    rmode_t mode;
+};
+
+static const struct tci1x_modulation tci1x_modulations[] =
+{
+    {"am", RIG_MODE_AM},
+    {"sam", RIG_MODE_SAM},
+    {"dsb", RIG_MODE_DSB},
+    {"lsb", RIG_MODE_LSB},
+    {"usb", RIG_MODE_USB},
+    {"cw", RIG_MODE_CW},
+    {"nfm", RIG_MODE_FM},
+    {"wfm", RIG_MODE_WFM},
+    {"digl", RIG_MODE_PKTLSB},
+    {"digu", RIG_MODE_PKTUSB},
+    {NULL, RIG_MODE_NONE}
+};
+
 /*
 * check_vfo
 * No assumptions
@@ -268,51 +323,412 @@ static int check_vfo(vfo_t vfo)
     return (TRUE);
 }
 
+/*
+* tci1x_mode
+* Return the hamlib mode for a TCI modulation name
+*/
+static rmode_t tci1x_mode(const char *name)
+{
+    int i;
+
+    for (i = 0; tci1x_modulations[i].name != NULL; ++i)
+    {
+        if (strcasecmp(tci1x_modulations[i].name, name) == 0)
+        {
+            return (tci1x_modulations[i].mode);
+        }
+    }
+
+    rig_debug(RIG_DEBUG_VERBOSE, "%s: unknown modulation '%s'\n", __func__, name);
+    return (RIG_MODE_NONE);
+}
+
+/*
+* tci1x_modulation
+* Return the TCI modulation name for a hamlib mode, NULL if none
+*/
+static const char *tci1x_modulation(rmode_t mode)
+{
+    int i;
+
+    for (i = 0; tci1x_modulations[i].name != NULL; ++i)
+    {
+        if (tci1x_modulations[i].mode == mode)
+        {
+            return (tci1x_modulations[i].name);
+        }
+    }
+
+    return (NULL);
+}
+
+/*
+* tci1x_decode
+* Updates the state from one message, e.g. "vfo:0,0,14074000", whether
+* the server pushed it or we asked
+* The cache and the event callbacks only follow the state when the async
+* data handler keeps it current
+* Only receiver 0 is followed
+*/
+static void tci1x_decode(RIG *rig, const char *msg)
+{
+    struct tci1x_priv_data *priv = (struct tci1x_priv_data *) STATE(rig)->priv;
+    int fire = RIGPORT(rig)->asyncio;
+    char name[32];
+    char args[MAXARGLEN];
+    char word[16];
+    int rx, chan, n;
+    double d1, d2, d3, d4;
+
+    if (sscanf(msg, "%31[^:]:%127[^;]", name, args) != 2)
+    {
+        return;
+    }
+
+    if (streq(name, "vfo")
+            && sscanf(args, "%d,%d,%lf", &rx, &chan, &d1) == 3 && rx == 0)
+    {
+        if (chan == 0)
+        {
+            priv->curr_freqA = d1;
+            priv->state |= TCI1X_STATE_FREQA;
+        }
+        else
+        {
+            priv->curr_freqB = d1;
+            priv->state |= TCI1X_STATE_FREQB;
+        }
+
+        if (fire)
+        {
+            rig_fire_freq_event(rig, chan == 0 ? RIG_VFO_A : RIG_VFO_B, d1);
+        }
+    }
+    else if (streq(name, "modulation")
+             && sscanf(args, "%d,%15s", &rx, word) == 2 && rx == 0)
+    {
+        // both channels of a receiver share its modulation
+        priv->curr_modeA = priv->curr_modeB = tci1x_mode(word);
+        priv->state |= TCI1X_STATE_MODE;
+
+        if (fire)
+        {
+            rig_fire_mode_event(rig, RIG_VFO_A, priv->curr_modeA,
+                                priv->state & TCI1X_STATE_FILTER ? priv->curr_widthA :
+                                RIG_PASSBAND_NOCHANGE);
+        }
+    }
+    else if (streq(name, "rx_filter_band")
+             && sscanf(args, "%d,%lf,%lf", &rx, &d1, &d2) == 3 && rx == 0)
+    {
+        priv->curr_widthA = priv->curr_widthB = (pbwidth_t)(d2 - d1);
+        priv->state |= TCI1X_STATE_FILTER;
+
+        if (fire && (priv->state & TCI1X_STATE_MODE))
+        {
+            rig_fire_mode_event(rig, RIG_VFO_A, priv->curr_modeA, priv->curr_widthA);
+        }
+    }
+    else if (streq(name, "trx")
+             && sscanf(args, "%d,%15[^,]", &rx, word) == 2 && rx == 0)
+    {
+        priv->ptt = streq(word, "true") ? RIG_PTT_ON : RIG_PTT_OFF;
+        priv->state |= TCI1X_STATE_PTT;
+
+        if (fire)
+        {
+            rig_fire_ptt_event(rig, RIG_VFO_CURR, priv->ptt);
+        }
+    }
+    else if (streq(name, "split_enable")
+             && sscanf(args, "%d,%15[^,]", &rx, word) == 2 && rx == 0)
+    {
+        priv->split = streq(word, "true") ? RIG_SPLIT_ON : RIG_SPLIT_OFF;
+        priv->state |= TCI1X_STATE_SPLIT;
+    }
+    else if (streq(name, "drive"))
+    {
+        // TCI 1.5 puts the transceiver first: drive:0,50
+        n = sscanf(args, "%lf,%lf", &d1, &d2);
+
+        if (n >= 1)
+        {
+            priv->drive = n == 2 ? d2 : d1;
+            priv->state |= TCI1X_STATE_DRIVE;
+        }
+    }
+    else if (streq(name, "rx_smeter")
+             && sscanf(args, "%d,%d,%lf", &rx, &chan, &d1) == 3 && rx == 0 && chan == 0)
+    {
+        priv->smeter = d1;
+        priv->state |= TCI1X_STATE_SMETER;
+    }
+    else if (streq(name, "tx_sensors")
+             && sscanf(args, "%d,%lf,%lf,%lf,%lf", &rx, &d1, &d2, &d3, &d4) == 5
+             && rx == 0)
+    {
+        priv->tx_power = d2;
+        priv->tx_swr = d4;
+        priv->state |= TCI1X_STATE_TX_POWER;
+    }
+    else if (streq(name, "tx_power") && sscanf(args, "%lf", &d1) == 1)
+    {
+        priv->tx_power = d1;
+        priv->state |= TCI1X_STATE_TX_POWER;
+    }
+    else if (streq(name, "tx_swr") && sscanf(args, "%lf", &d1) == 1)
+    {
+        priv->tx_swr = d1;
+    }
+}
+
+/*
+* tci1x_decode_frame
+* A text frame may hold several ';' terminated messages
+*/
+static void tci1x_decode_frame(RIG *rig, const char *frame, size_t frame_len)
+{
+    char buf[MAXBUFLEN];
+    char *msg;
+    char *pr = NULL;
+
+    if (frame_len >= sizeof(buf))
+    {
+        frame_len = sizeof(buf) - 1;
+    }
+
+    memcpy(buf, frame, frame_len);
+    buf[frame_len] = 0;
+
+    for (msg = strtok_r(buf, ";\r\n", &pr); msg != NULL;
+            msg = strtok_r(NULL, ";\r\n", &pr))
+    {
+        tci1x_decode(rig, msg);
+    }
+}
+
+/*
+* tci1x_ws_skip
+* Drops the rest of a frame nobody needs, e.g. IQ or audio data
+*/
+static int tci1x_ws_skip(hamlib_port_t *rp, unsigned long long len)
+{
+    unsigned char buf[4096];
+
+    while (len > 0)
+    {
+        int n = len < sizeof(buf) ? (int) len : (int) sizeof(buf);
+        int retval = read_block_direct(rp, buf, n);
+
+        if (retval < 0)
+        {
+            return retval;
+        }
+
+        len -= n;
+    }
+
+    return RIG_OK;
+}
+
+/*
+* tci1x_read_ws_frame
+* Reads WebSocket frames until a text one and returns its payload
+* Binary frames, the IQ and audio streams, and control frames are skipped
+* Returns the payload length, -RIG_EIO if the server closes
+*/
+static int tci1x_read_ws_frame(RIG *rig, unsigned char *buf, int buf_len)
+{
+    struct tci1x_priv_data *priv = (struct tci1x_priv_data *) STATE(rig)->priv;
+    hamlib_port_t *rp = RIGPORT(rig);
+
+    for (;;)
+    {
+        unsigned char hdr[8];
+        unsigned char mask[4] = { 0, 0, 0, 0 };
+        unsigned long long len;
+        int opcode, masked;
+        int retval;
+        int i, n;
+
+        retval = read_block_direct(rp, hdr, 2);
+
+        if (retval < 0)
+        {
+            return retval;
+        }
+
+        opcode = hdr[0] & 0x0f;
+        masked = hdr[1] & 0x80;
+        len = hdr[1] & 0x7f;
+
+        if (len >= 126)
+        {
+            n = len == 126 ? 2 : 8;
+            retval = read_block_direct(rp, hdr, n);
+
+            if (retval < 0)
+            {
+                return retval;
+            }
+
+            for (len = 0, i = 0; i < n; i++)
+            {
+                len = len << 8 | hdr[i];
+            }
+        }
+
+        if (masked)
+        {
+            retval = read_block_direct(rp, mask, 4);
+
+            if (retval < 0)
+            {
+                return retval;
+            }
+        }
+
+        // a continuation frame is of the type of the frame it continues
+        if (opcode == TCI1X_WS_CONTINUATION)
+        {
+            opcode = priv->ws_opcode;
+        }
+        else if (opcode < TCI1X_WS_CLOSE)
+        {
+            priv->ws_opcode = opcode;
+        }
+
+        if (opcode == TCI1X_WS_CLOSE)
+        {
+            rig_debug(RIG_DEBUG_ERR, "%s: server closed the connection\n", __func__);
+            return -RIG_EIO;
+        }
+
+        if (opcode != TCI1X_WS_TEXT)
+        {
+            retval = tci1x_ws_skip(rp, len);
+
+            if (retval < 0)
+            {
+                return retval;
+            }
+
+            continue;
+        }
+
+        n = len < (unsigned long long) buf_len ? (int) len : buf_len - 1;
+        retval = n > 0 ? read_block_direct(rp, buf, n) : 0;
+
+        if (retval >= 0)
+        {
+            retval = tci1x_ws_skip(rp, len - n);
+        }
+
+        if (retval < 0)
+        {
+            return retval;
+        }
+
+        for (i = 0; i < n; i++)
+        {
+            buf[i] ^= mask[i % 4];
+        }
+
+        buf[n] = 0;
+
+        if (n > 0)
+        {
+            return n;
+        }
+    }
+}
+
+/*
+* tci1x_write_ws_frame
+* Sends a message as a masked client text frame
+*/
+static int tci1x_write_ws_frame(RIG *rig, const char *msg)
+{
+    unsigned char frame[2 + 4 + 125];
+    size_t len = strlen(msg);
+    size_t i, n = 0;
+
+    if (len > 125)
+    {
+        rig_debug(RIG_DEBUG_ERR, "%s: message too long '%s'\n", __func__, msg);
+        return -RIG_EINVAL;
+    }
+
+    frame[n++] = 0x80 | TCI1X_WS_TEXT; // final frame
+    frame[n++] = 0x80 | len; // masked
+
+    for (i = 0; i < 4; i++)
+    {
+        frame[n++] = rand() & 0xff;
+    }
+
+    for (i = 0; i < len; i++)
+    {
+        frame[n++] = msg[i] ^ frame[2 + i % 4];
+    }
+
+    return write_block(RIGPORT(rig), frame, n);
+}
+
 /*
 *
 * read_transaction
+* Reads messages until the one the transaction waits for, decoding all
+* of them on the way
 * Assumes rig!=NULL, buf!=NULL, buf_len big enough to hold response
 */
 static int read_transaction(RIG *rig, unsigned char *buf, int buf_len)
 {
-    int retry;
-    char *delims = ";";
+    struct tci1x_priv_data *priv = (struct tci1x_priv_data *) STATE(rig)->priv;
+    hamlib_port_t *rp = RIGPORT(rig);
+    struct timespec start;
 
     ENTERFUNC;
 
-    retry = 0;
+    elapsed_ms(&start, HAMLIB_ELAPSED_SET);
 
     do
     {
-        if (retry < 2)
+        int len;
+
+        if (rp->asyncio)
         {
-            rig_debug(RIG_DEBUG_WARN, "%s: retry needed? retry=%d\n", __func__, retry);
+            // the async data handler has taken the message out of its frame
+            len = read_string(rp, buf, buf_len, ";", 1, 0, 1);
+        }
+        else
+        {
+            len = tci1x_read_ws_frame(rig, buf, buf_len);
         }
 
-        int len = read_string(RIGPORT(rig), buf, buf_len, delims,
-                              strlen(delims), 0, 1);
-        rig_debug(RIG_DEBUG_TRACE, "%s: string='%s'\n", __func__, buf);
-
-        if (len <= 0)
+        if (len < 0)
         {
-            rig_debug(RIG_DEBUG_ERR, "%s: read_string error=%d\n", __func__, len);
-            continue;
+            rig_debug(RIG_DEBUG_ERR, "%s: read error=%d\n", __func__, len);
+            RETURNFUNC(len);
         }
 
-    }
-    while (retry-- > 0 && strlen((char *) buf) == 0);
+        rig_debug(RIG_DEBUG_TRACE, "%s: string='%s'\n", __func__, buf);
+        tci1x_decode_frame(rig, (char *) buf, len);
 
-    if (retry == 0)
-    {
-        rig_debug(RIG_DEBUG_WARN, "%s: retry timeout\n", __func__);
-        RETURNFUNC(-RIG_ETIMEOUT);
+        if (strncmp((char *) buf, priv->pending, strlen(priv->pending)) == 0)
+        {
+            RETURNFUNC(RIG_OK);
+        }
     }
+    while (elapsed_ms(&start, HAMLIB_ELAPSED_GET) < rp->timeout);
 
-    RETURNFUNC(RIG_OK);
+    rig_debug(RIG_DEBUG_WARN, "%s: no reply to '%s'\n", __func__, priv->pending);
+    RETURNFUNC(-RIG_ETIMEOUT);
 }
 
 /*
 * write_transaction
+* Sends raw data, used for the WebSocket handshake
 * Assumes rig!=NULL, xml!=NULL, xml_len=total size of xml for response
 */
 static int write_transaction(RIG *rig, const unsigned char *buf, int buf_len)
@@ -351,68 +767,99 @@ static int write_transaction(RIG *rig, const unsigned char *buf, int buf_len)
     RETURNFUNC(retval);
 }
 
+/*
+* tci1x_transaction
+* Sends cmd, e.g. "vfo:0,0;", and with value!=NULL waits for the message
+* answering it, "vfo:0,0,14074000;"
+*/
 static int tci1x_transaction(RIG *rig, char *cmd, char *cmd_arg, char *value,
                              int value_len)
 {
-    int retry = 0;
-    unsigned char frame[1024];
+    struct tci1x_priv_data *priv = (struct tci1x_priv_data *) STATE(rig)->priv;
+    int retval;
 
     ENTERFUNC;
 
-    memset(frame, 0, sizeof(frame));
-
     if (value)
     {
+        char *p;
+
         value[0] = 0;
+
+        // the async data handler passes messages starting like this to us
+        SNPRINTF(priv->pending, sizeof(priv->pending), "%s", cmd);
+        p = strchr(priv->pending, ';');
+
+        if (p) { *p = 0; }
     }
 
-    frame[0] = 0x81;
-    frame[1] = strlen(cmd);
-    frame[2] = 0x00;
-    frame[3] = 0x00;
-    frame[4] = 0x00;
-    frame[5] = 0x00;
-    frame[6] = 0x00;
-    frame[7] = 0x00;
-    frame[8] = 0x00;
-    frame[9] = 0x00;
-    frame[10] = 0x00;
-    frame[11] = 0x00;
-    strcat((char *) &frame[12], cmd);
+    rig_debug(RIG_DEBUG_VERBOSE, "%s: cmd=%s\n", __func__, cmd);
 
-    do
+    retval = tci1x_write_ws_frame(rig, cmd);
+
+    if (retval != RIG_OK)
     {
-        int retval;
+        rig_debug(RIG_DEBUG_ERR, "%s: write error=%d\n", __func__, retval);
 
-        if (retry < 2)
-        {
-            rig_debug(RIG_DEBUG_VERBOSE, "%s: cmd=%s, retry=%d\n", __func__, cmd, retry);
-        }
+        // if we get RIG_EIO the socket has probably disappeared
+        // so bubble up the error so port can re re-opened
+        priv->pending[0] = 0;
+        RETURNFUNC(retval);
+    }
 
-        retval = write_transaction(rig, frame, strlen(cmd) + 12);
+    if (value)
+    {
+        retval = read_transaction(rig, (unsigned char *) value, value_len);
+        priv->pending[0] = 0;
+    }
 
-        if (retval != RIG_OK)
-        {
-            rig_debug(RIG_DEBUG_ERR, "%s: write_transaction error=%d\n", __func__, retval);
+    RETURNFUNC(retval);
+}
 
-            // if we get RIG_EIO the socket has probably disappeared
-            // so bubble up the error so port can re re-opened
-            if (retval == -RIG_EIO) { RETURNFUNC(retval); }
+/*
+* tci1x_read_frame_direct
+* Gives the async data handler the payload of the next text frame
+*/
+static int tci1x_read_frame_direct(RIG *rig, size_t buffer_length,
+                                   const unsigned char *buffer)
+{
+    return tci1x_read_ws_frame(rig, (unsigned char *) buffer, buffer_length);
+}
 
-            hl_usleep(50 * 1000); // 50ms sleep if error
-        }
+/*
+* tci1x_is_async_frame
+* The server pushes every change, a message is a reply only when it
+* answers the pending transaction
+*/
+static int tci1x_is_async_frame(RIG *rig, size_t frame_length,
+                                const unsigned char *frame)
+{
+    const struct tci1x_priv_data *priv = (struct tci1x_priv_data *) STATE(
+            rig)->priv;
+    size_t len = strlen(priv->pending);
 
-        read_transaction(rig, (unsigned char *) value, value_len);
+    return len == 0 || frame_length < len
+           || strncmp((const char *) frame, priv->pending, len) != 0;
+}
 
-        rig_debug(RIG_DEBUG_VERBOSE, "%s: value=%s\n", __func__, value);
+static int tci1x_process_async_frame(RIG *rig, size_t frame_length,
+                                     const unsigned char *frame)
+{
+    tci1x_decode_frame(rig, (const char *) frame, frame_length);
 
-    }
-    while ((value && (strlen(value) == 0))
-            && retry--); // we'll do retries if needed
+    return RIG_OK;
+}
 
-    if (value && strlen(value) == 0) { RETURNFUNC(-RIG_EPROTO); }
+/*
+* tci1x_pushed
+* True if the async data handler keeps these parts of the state current
+*/
+static int tci1x_pushed(RIG *rig, int parts)
+{
+    const struct tci1x_priv_data *priv = (struct tci1x_priv_data *) STATE(
+            rig)->priv;
 
-    RETURNFUNC(RIG_OK);
+    return RIGPORT(rig)->asyncio && (priv->state & parts) == parts;
 }
 
 /*
@@ -451,6 +898,9 @@ static int tci1x_init(RIG *rig)
     priv->curr_widthA = -1;
     priv->curr_widthB = -1;
 
+    // the server pushes every change, async_data_enable=0 goes back to asking
+    STATE(rig)->async_data_enabled = 1;
+
     if (!rig->caps)
     {
         RETURNFUNC(-RIG_EINVAL);
@@ -469,38 +919,6 @@ static int tci1x_init(RIG *rig)
     RETURNFUNC(RIG_OK);
 }
 
-/*
-* modeMapGetTCI
-* Assumes mode!=NULL
-* Return the string for TCI for the given hamlib mode
-*/
-static const char *modeMapGetTCI(rmode_t modeHamlib)
-{
-    int i;
-
-    rig_debug(RIG_DEBUG_TRACE, "%s: called\n", __func__);
-
-    for (i = 0; modeMap[i].mode_hamlib != 0; ++i)
-    {
-        if (modeMap[i].mode_tci1x == NULL) { continue; }
-
-        rig_debug(RIG_DEBUG_TRACE,
-                  "%s: checking modeMap[%d]=%.0f to modeHamlib=%.0f, mode_tci1x='%s'\n", __func__,
-                  i, (double)modeMap[i].mode_hamlib, (double)modeHamlib, modeMap[i].mode_tci1x);
-
-        if (modeMap[i].mode_hamlib == modeHamlib && strlen(modeMap[i].mode_tci1x) > 0)
-        {
-            rig_debug(RIG_DEBUG_TRACE, "%s matched mode=%.0f, returning '%s'\n", __func__,
-                      (double)modeHamlib, modeMap[i].mode_tci1x);
-            return (modeMap[i].mode_tci1x);
-        }
-    }
-
-    rig_debug(RIG_DEBUG_ERR, "%s: FlRig does not have mode: %s\n", __func__,
-              rig_strrmode(modeHamlib));
-    return ("ERROR");
-}
-
 /*
 * modeMapGetHamlib
 * Assumes mode!=NULL
@@ -597,7 +1015,8 @@ static int tci1x_open(RIG *rig)
     rmode_t modes;
     char *p;
     char *pr;
-    //struct tci1x_priv_data *priv = (struct tci1x_priv_data *) STATE(rig)->priv;
+    struct tci1x_priv_data *priv = (struct tci1x_priv_data *) STATE(rig)->priv;
+    struct timespec start;
     arg[0] = '?';
     arg[1] = 0;
 
@@ -607,15 +1026,41 @@ static int tci1x_open(RIG *rig)
 
     write_transaction(rig, (unsigned char *) websocket, strlen(websocket));
 
+    // HTTP response headers up to the blank line
     do
     {
-        retval = read_transaction(rig, (unsigned char *) value, sizeof(value));
+        retval = read_string(RIGPORT(rig), (unsigned char *) value, sizeof(value),
+                             "\n", 1, 0, 1);
         rig_debug(RIG_DEBUG_VERBOSE, "%s: value=%s\n", __func__, value);
     }
-    while (retval == RIG_OK && strlen(value) > 0);
+    while (retval > 0 && strspn(value, "\r\n") != strlen(value));
+
+    if (retval < 0)
+    {
+        RETURNFUNC2(retval);
+    }
+
+    // the server sends its whole state and then "ready;"
+    elapsed_ms(&start, HAMLIB_ELAPSED_SET);
+
+    do
+    {
+        retval = tci1x_read_ws_frame(rig, (unsigned char *) value, sizeof(value));
+
+        if (retval < 0)
+        {
+            break;
+        }
+
+        tci1x_decode_frame(rig, value, retval);
+    }
+    while (strncmp(value, "ready", 5) != 0
+            && elapsed_ms(&start, HAMLIB_ELAPSED_GET) < RIGPORT(rig)->timeout);
+
+    rig_debug(RIG_DEBUG_VERBOSE, "%s: initial state=0x%x\n", __func__,
+              priv->state);
 
     retval = tci1x_transaction(rig, "device;", NULL, value, sizeof(value));
-    dump_hex((unsigned char *)value, strlen(value));
 
     if (retval != RIG_OK)
     {
@@ -624,7 +1069,7 @@ static int tci1x_open(RIG *rig)
         // we fall through and assume old version
     }
 
-    sscanf(&value[2], "device:%8191s", value);
+    sscanf(value, "device:%8191[^;]", arg);
 
     rig_debug(RIG_DEBUG_VERBOSE, "%s: TCI Device is %s\n", __func__, arg);
 
@@ -637,8 +1082,8 @@ static int tci1x_open(RIG *rig)
                   rigerror(retval));
     }
 
-    sscanf(&value[2], "receive_only:%8191s", value);
-    rig_debug(RIG_DEBUG_VERBOSE, "%s: readonly is %8191s\n", __func__, arg);
+    sscanf(value, "receive_only:%8191[^;]", arg);
+    rig_debug(RIG_DEBUG_VERBOSE, "%s: readonly is %s\n", __func__, arg);
 
     // TRX count
     retval = tci1x_transaction(rig, "trx_count;", NULL, value, sizeof(value));
@@ -649,7 +1094,7 @@ static int tci1x_open(RIG *rig)
                   rigerror(retval));
     }
 
-    sscanf(&value[2], "trx_count:%d", &trx_count);
+    sscanf(value, "trx_count:%d", &trx_count);
     rig_debug(RIG_DEBUG_VERBOSE, "Trx count=%d\n", trx_count);
 
     freq_t freq;
@@ -860,22 +1305,25 @@ static int tci1x_get_freq(RIG *rig, vfo_t vfo, freq_t *freq)
                   __func__, rig_strvfo(vfo));
     }
 
-    char *cmd = vfo == RIG_VFO_A ? "vfo:0:0;" : "vfo:0:1:";
-    int retval;
-    int n;
+    int part = vfo == RIG_VFO_A ? TCI1X_STATE_FREQA : TCI1X_STATE_FREQB;
 
-    retval = tci1x_transaction(rig, cmd, NULL, value, sizeof(value));
-
-    if (retval != RIG_OK)
+    if (!tci1x_pushed(rig, part))
     {
-        rig_debug(RIG_DEBUG_ERR, "%s: tci1x_transaction failed retval=%s\n", __func__,
-                  rigerror(retval));
-        RETURNFUNC(retval);
+        char *cmd = vfo == RIG_VFO_A ? "vfo:0,0;" : "vfo:0,1;";
+        int retval;
+
+        // the reply is decoded into the state like a pushed message
+        retval = tci1x_transaction(rig, cmd, NULL, value, sizeof(value));
+
+        if (retval != RIG_OK)
+        {
+            rig_debug(RIG_DEBUG_ERR, "%s: tci1x_transaction failed retval=%s\n", __func__,
+                      rigerror(retval));
+            RETURNFUNC(retval);
+        }
     }
 
-    n = sscanf(&value[2], "vfo:%*d,%*d,%lf", freq);
-    rig_debug(RIG_DEBUG_VERBOSE, "%s: got '%s', scanned %d items\n", __func__,
-              value, n);
+    *freq = vfo == RIG_VFO_A ? priv->curr_freqA : priv->curr_freqB;
 
     if (*freq == 0)
     {
@@ -888,15 +1336,6 @@ static int tci1x_get_freq(RIG *rig, vfo_t vfo, freq_t *freq)
         rig_debug(RIG_DEBUG_TRACE, "%s: freq=%.0f\n", __func__, *freq);
     }
 
-    if (vfo == RIG_VFO_A)
-    {
-        priv->curr_freqA = *freq;
-    }
-    else
-    {
-        priv->curr_freqB = *freq;
-    }
-
     RETURNFUNC(RIG_OK);
 }
 
@@ -907,8 +1346,7 @@ static int tci1x_get_freq(RIG *rig, vfo_t vfo, freq_t *freq)
 static int tci1x_set_freq(RIG *rig, vfo_t vfo, freq_t freq)
 {
     int retval;
-    char cmd_arg[MAXARGLEN];
-    char *cmd;
+    char cmd[MAXARGLEN];
     struct tci1x_priv_data *priv = (struct tci1x_priv_data *) STATE(rig)->priv;
 
     ENTERFUNC;
@@ -931,37 +1369,23 @@ static int tci1x_set_freq(RIG *rig, vfo_t vfo, freq_t freq)
         vfo = RIG_VFO_B; // if split always TX on VFOB
     }
 
-    SNPRINTF(cmd_arg, sizeof(cmd_arg),
-             "<params><param><value><double>%.0f</double></value></param></params>", freq);
+    // VFOA and VFOB are channels 0 and 1 of receiver 0
+    SNPRINTF(cmd, sizeof(cmd), "vfo:0,%d,%.0f;", vfo == RIG_VFO_B ? 1 : 0, freq);
 
-    value_t val;
-    rig_get_ext_parm(rig, TOK_TCI1X_VERIFY_FREQ, &val);
-    rig_debug(RIG_DEBUG_VERBOSE, "%s: set_verify_vfoA/B=%d\n", __func__, val.i);
+    retval = tci1x_transaction(rig, cmd, NULL, NULL, 0);
 
-    if (vfo == RIG_VFO_A)
+    if (retval != RIG_OK)
     {
-        cmd = "rig.set_vfoA";
-
-        if (val.i) { cmd = "rig.set_verify_vfoA"; }
-
-        rig_debug(RIG_DEBUG_TRACE, "%s %.0f\n", cmd, freq);
-        priv->curr_freqA = freq;
+        RETURNFUNC(retval);
     }
-    else
-    {
-        cmd = "rig.set_vfoB";
 
-        if (val.i) { cmd = "rig.set_verify_vfoB"; }
-
-        rig_debug(RIG_DEBUG_TRACE, "%s %.0f\n", cmd, freq);
+    if (vfo == RIG_VFO_B)
+    {
         priv->curr_freqB = freq;
     }
-
-    retval = tci1x_transaction(rig, cmd, cmd_arg, NULL, 0);
-
-    if (retval != RIG_OK)
+    else
     {
-        RETURNFUNC(retval);
+        priv->curr_freqA = freq;
     }
 
     RETURNFUNC(RIG_OK);
@@ -974,7 +1398,6 @@ static int tci1x_set_freq(RIG *rig, vfo_t vfo, freq_t freq)
 static int tci1x_set_ptt(RIG *rig, vfo_t vfo, ptt_t ptt)
 {
     int retval;
-    char cmd_arg[MAXARGLEN];
     struct tci1x_priv_data *priv = (struct tci1x_priv_data *) STATE(rig)->priv;
 
     ENTERFUNC;
@@ -988,18 +1411,8 @@ static int tci1x_set_ptt(RIG *rig, vfo_t vfo, ptt_t ptt)
         RETURNFUNC(-RIG_EINVAL);
     }
 
-    SNPRINTF(cmd_arg, sizeof(cmd_arg),
-             "<params><param><value><i4>%d</i4></value></param></params>",
-             ptt);
-
-    value_t val;
-    char *cmd = "rig.set_ptt";
-    rig_get_ext_parm(rig, TOK_TCI1X_VERIFY_FREQ, &val);
-    rig_debug(RIG_DEBUG_VERBOSE, "%s: fast_set_ptt=%d\n", __func__, val.i);
-
-    if (val.i) { cmd = "rig.set_ptt_fast"; }
-
-    retval = tci1x_transaction(rig, cmd, cmd_arg, NULL, 0);
+    retval = tci1x_transaction(rig, ptt ? "trx:0,true;" : "trx:0,false;", NULL,
+                               NULL, 0);
 
     if (retval != RIG_OK)
     {
@@ -1017,26 +1430,25 @@ static int tci1x_set_ptt(RIG *rig, vfo_t vfo, ptt_t ptt)
 */
 static int tci1x_get_ptt(RIG *rig, vfo_t vfo, ptt_t *ptt)
 {
-    char value[MAXCMDLEN];
+    char value[MAXARGLEN];
     struct tci1x_priv_data *priv = (struct tci1x_priv_data *) STATE(rig)->priv;
 
     ENTERFUNC;
     rig_debug(RIG_DEBUG_TRACE, "%s: vfo=%s\n", __func__,
               rig_strvfo(vfo));
 
-    int retval;
-
-    retval = tci1x_transaction(rig, "rig.get_ptt", NULL, value, sizeof(value));
-
-    if (retval != RIG_OK)
+    if (!tci1x_pushed(rig, TCI1X_STATE_PTT))
     {
-        RETURNFUNC(retval);
-    }
+        int retval = tci1x_transaction(rig, "trx:0;", NULL, value, sizeof(value));
 
-    *ptt = atoi(value);
-    rig_debug(RIG_DEBUG_TRACE, "%s: '%s'\n", __func__, value);
+        if (retval != RIG_OK)
+        {
+            RETURNFUNC(retval);
+        }
+    }
 
-    priv->ptt = *ptt;
+    *ptt = priv->ptt;
+    rig_debug(RIG_DEBUG_TRACE, "%s: ptt=%d\n", __func__, *ptt);
 
     RETURNFUNC(RIG_OK);
 }
@@ -1086,37 +1498,20 @@ static int tci1x_set_split_mode(RIG *rig, vfo_t vfo, rmode_t mode,
 
 /*
 * tci1x_set_mode
+* Both channels of the receiver share the modulation and the filter
 * Assumes rig!=NULL
 */
 static int tci1x_set_mode(RIG *rig, vfo_t vfo, rmode_t mode, pbwidth_t width)
 {
     int retval;
-    int needBW;
-    int vfoSwitched;
-    char cmd_arg[MAXCMDLEN];
-    char *p;
-    char *pttmode;
-    char *ttmode = NULL;
+    char cmd[MAXARGLEN];
+    const char *name;
     struct tci1x_priv_data *priv = (struct tci1x_priv_data *) STATE(rig)->priv;
 
     ENTERFUNC;
     rig_debug(RIG_DEBUG_TRACE, "%s: vfo=%s mode=%s width=%d\n",
               __func__, rig_strvfo(vfo), rig_strrmode(mode), (int)width);
 
-
-    // if ptt is on do not set mode
-    if (priv->ptt)
-    {
-        rig_debug(RIG_DEBUG_TRACE, "%s: returning because priv->ptt=%d\n", __func__,
-                  (int)priv->ptt);
-        RETURNFUNC(RIG_OK);
-    }
-
-    if (vfo == RIG_VFO_CURR)
-    {
-        vfo = STATE(rig)->current_vfo;
-    }
-
     if (check_vfo(vfo) == FALSE)
     {
         rig_debug(RIG_DEBUG_ERR, "%s: unsupported VFO %s\n",
@@ -1130,163 +1525,67 @@ static int tci1x_set_mode(RIG *rig, vfo_t vfo, rmode_t mode, pbwidth_t width)
         RETURNFUNC(RIG_OK);  // just return OK and ignore this
     }
 
-    // Switch to VFOB if appropriate since we can't set mode directly
-    // MDB
-    vfoSwitched = 0;
-    rig_debug(RIG_DEBUG_TRACE, "%s: curr_vfo = %s\n", __func__,
-              rig_strvfo(STATE(rig)->current_vfo));
+    name = tci1x_modulation(mode);
 
-    // If we don't have the get_bwA call we have to switch VFOs ourself
-    if (!priv->has_get_bwA && vfo == RIG_VFO_B
-            && STATE(rig)->current_vfo != RIG_VFO_B)
+    if (name == NULL)
     {
-        vfoSwitched = 1;
-        rig_debug(RIG_DEBUG_TRACE, "%s: switch to VFOB = %d\n", __func__,
-                  vfoSwitched);
-    }
-
-    if (vfoSwitched)   // swap to B and we'll swap back later
-    {
-        rig_debug(RIG_DEBUG_TRACE, "%s: switching to VFOB = %d\n", __func__,
-                  vfoSwitched);
-        retval = tci1x_set_vfo(rig, RIG_VFO_B);
-
-        if (retval < 0)
-        {
-            RETURNFUNC(retval);
-        }
-    }
-
-    // Set the mode
-    if (modeMapGetTCI(mode))
-    {
-        ttmode = strdup(modeMapGetTCI(mode));
-    }
-    else
-    {
-        rig_debug(RIG_DEBUG_ERR, "%s: modeMapGetFlRig failed on mode=%d\n", __func__,
-                  (int)mode);
+        rig_debug(RIG_DEBUG_ERR, "%s: TCI has no modulation for mode %s\n", __func__,
+                  rig_strrmode(mode));
         RETURNFUNC(-RIG_EINVAL);
     }
 
-    rig_debug(RIG_DEBUG_TRACE, "%s: got ttmode = %s\n", __func__,
-              ttmode == NULL ? "NULL" : ttmode);
-
-    if (ttmode == NULL)
-    {
-        rig_debug(RIG_DEBUG_ERR, "%s: strdup failed\n", __func__);
-        RETURNFUNC(-RIG_EINTERNAL);
-    }
-
-//   if (strncmp(ttmode,"ERROR",5)==0) RETURNFUNC(-RIG_EINTERN);
-
-    pttmode = ttmode;
-
-    if (ttmode[0] == '|') { pttmode = &ttmode[1]; } // remove first pipe symbol
-
-    p = strchr(pttmode, '|');
-
-    if (p) { *p = 0; } // remove any other pipe
-
-    SNPRINTF(cmd_arg, sizeof(cmd_arg),
-             "<params><param><value>%s</value></param></params>", pttmode);
-    free(ttmode);
-
-    if (!priv->has_get_modeA)
-    {
-        retval = tci1x_transaction(rig, "rig.set_mode", cmd_arg, NULL, 0);
-    }
-    else
+    if (mode != priv->curr_modeA)
     {
-        char *cmd = "rig.set_modeA";
+        SNPRINTF(cmd, sizeof(cmd), "modulation:0,%s;", name);
+        retval = tci1x_transaction(rig, cmd, NULL, NULL, 0);
 
-        if (vfo == RIG_VFO_B)
-        {
-            cmd = "rig.set_modeB";
-        }
-        else
+        if (retval != RIG_OK)
         {
-            // we make VFO_B mode unknown so it expires the cache
-            priv->curr_modeB = RIG_MODE_NONE;
+            rig_debug(RIG_DEBUG_ERR, "%s: failed: %s\n", __func__,
+                      rigerror(retval));
+            RETURNFUNC(retval);
         }
 
-        retval = tci1x_transaction(rig, cmd, cmd_arg, NULL, 0);
-    }
-
-
-    if (retval != RIG_OK)
-    {
-        rig_debug(RIG_DEBUG_ERR, "%s: failed: %s\n", __func__,
-                  rigerror(retval));
-        RETURNFUNC(retval);
-    }
-
-    // Determine if we need to update the bandwidth
-    needBW = 0;
-
-    if (vfo == RIG_VFO_A)
-    {
-        needBW = priv->curr_widthA != width;
-        rig_debug(RIG_DEBUG_TRACE, "%s: bw change on VFOA, curr width=%d  needBW=%d\n",
-                  __func__, (int)width, needBW);
-    }
-    else if (vfo == RIG_VFO_B)
-    {
-        needBW = priv->curr_widthB != width;
-        rig_debug(RIG_DEBUG_TRACE, "%s: bw change on VFOB, curr width=%d  needBW=%d\n",
-                  __func__, (int)width, needBW);
-    }
-    else
-    {
-        rig_debug(RIG_DEBUG_TRACE, "%s: needBW unknown vfo=%s\n", __func__,
-                  rig_strvfo(vfo));
+        priv->curr_modeA = priv->curr_modeB = mode;
     }
 
-    // Need to update the bandwidth
-    if (width > 0 && needBW)
+    // the filter edges are offsets from the carrier
+    if (width > 0 && width != priv->curr_widthA)
     {
-        SNPRINTF(cmd_arg, sizeof(cmd_arg),
-                 "<params><param><value><i4>%ld</i4></value></param></params>",
-                 width);
-
-        retval = tci1x_transaction(rig, "rig.set_bandwidth", cmd_arg, NULL, 0);
+        int lo, hi;
 
-        if (retval < 0)
+        switch (mode)
         {
-            RETURNFUNC(retval);
+        case RIG_MODE_LSB:
+        case RIG_MODE_PKTLSB:
+            lo = -width;
+            hi = 0;
+            break;
+
+        case RIG_MODE_USB:
+        case RIG_MODE_PKTUSB:
+            lo = 0;
+            hi = width;
+            break;
+
+        default:
+            lo = -width / 2;
+            hi = width / 2;
         }
-    }
-
-    // Return to VFOA if needed
-    rig_debug(RIG_DEBUG_TRACE, "%s: switch to VFOA? = %d\n", __func__,
-              vfoSwitched);
 
-    if (vfoSwitched)
-    {
-        rig_debug(RIG_DEBUG_TRACE, "%s: switching to VFOA\n", __func__);
-        retval = tci1x_set_vfo(rig, RIG_VFO_A);
+        SNPRINTF(cmd, sizeof(cmd), "rx_filter_band:0,%d,%d;", lo, hi);
+        retval = tci1x_transaction(rig, cmd, NULL, NULL, 0);
 
-        if (retval < 0)
+        if (retval != RIG_OK)
         {
             RETURNFUNC(retval);
         }
-    }
 
-    if (vfo == RIG_VFO_A)
-    {
-        priv->curr_modeA = mode;
-        priv->curr_widthA = width;
-    }
-    else
-    {
-        priv->curr_modeB = mode;
-        priv->curr_widthB = width;
+        priv->curr_widthA = priv->curr_widthB = hi - lo;
     }
 
-    rig_debug(RIG_DEBUG_TRACE,
-              "%s: Return modeA=%s, widthA=%d\n,modeB=%s, widthB=%d\n", __func__,
-              rig_strrmode(priv->curr_modeA), (int)priv->curr_widthA,
-              rig_strrmode(priv->curr_modeB), (int)priv->curr_widthB);
+    rig_debug(RIG_DEBUG_TRACE, "%s: mode=%s, width=%d\n", __func__,
+              rig_strrmode(priv->curr_modeA), (int)priv->curr_widthA);
     RETURNFUNC(RIG_OK);
 }
 
@@ -1297,11 +1596,7 @@ static int tci1x_set_mode(RIG *rig, vfo_t vfo, rmode_t mode, pbwidth_t width)
 static int tci1x_get_mode(RIG *rig, vfo_t vfo, rmode_t *mode, pbwidth_t *width)
 {
     int retval;
-    int vfoSwitched;
-    char value[MAXCMDLEN];
-    char *cmdp;
-    vfo_t curr_vfo;
-    rmode_t my_mode;
+    char value[MAXARGLEN];
     struct tci1x_priv_data *priv = (struct tci1x_priv_data *) STATE(rig)->priv;
 
     ENTERFUNC;
@@ -1315,8 +1610,6 @@ static int tci1x_get_mode(RIG *rig, vfo_t vfo, rmode_t *mode, pbwidth_t *width)
         RETURNFUNC(-RIG_EINVAL);
     }
 
-    curr_vfo = STATE(rig)->current_vfo;
-
     if (vfo == RIG_VFO_CURR)
     {
         vfo = STATE(rig)->current_vfo;
@@ -1325,120 +1618,23 @@ static int tci1x_get_mode(RIG *rig, vfo_t vfo, rmode_t *mode, pbwidth_t *width)
     rig_debug(RIG_DEBUG_TRACE, "%s: using vfo=%s\n", __func__,
               rig_strvfo(vfo));
 
-    if (priv->ptt)
-    {
-        if (vfo == RIG_VFO_A) { *mode = priv->curr_modeA; }
-        else { *mode = priv->curr_modeB; }
-
-        rig_debug(RIG_DEBUG_VERBOSE, "%s call not made as PTT=1\n", __func__);
-        RETURNFUNC(RIG_OK);  // just return OK and ignore this
-    }
-
-    // Switch to VFOB if appropriate
-    vfoSwitched = 0;
-
-    if (priv->has_get_modeA == 0 && vfo == RIG_VFO_B && curr_vfo != RIG_VFO_B)
-    {
-        vfoSwitched = 1;
-    }
-
-    if (vfoSwitched)
+    // both channels of the receiver share the modulation and the filter
+    if (!tci1x_pushed(rig, TCI1X_STATE_MODE))
     {
-        rig_debug(RIG_DEBUG_TRACE, "%s switch to VFOB=%d\n", __func__,
-                  priv->has_get_modeA);
-        retval = tci1x_set_vfo(rig, RIG_VFO_B);
+        retval = tci1x_transaction(rig, "modulation:0;", NULL, value, sizeof(value));
 
-        if (retval < 0)
+        if (retval != RIG_OK)
         {
+            rig_debug(RIG_DEBUG_ERR, "%s: modulation failed: %s\n", __func__,
+                      rigerror(retval));
             RETURNFUNC(retval);
         }
     }
 
-    cmdp = "rig.get_mode"; /* default to old way */
-
-    if (priv->has_get_modeA)   /* change to new way if we can */
-    {
-        /* calling this way reduces VFO swapping */
-        /* we get the cached value in tci1x */
-        /* vfo B may not be getting polled though in TCI */
-        /* so we may not be 100% accurate if op is twiddling knobs */
-        cmdp = "rig.get_modeA";
-
-        if (vfo == RIG_VFO_B) { cmdp = "rig.get_modeB"; }
-    }
-
-    retval = tci1x_transaction(rig, cmdp, NULL, value, sizeof(value));
-
-    if (retval != RIG_OK)
-    {
-        rig_debug(RIG_DEBUG_ERR, "%s: %s failed: %s\n", __func__, cmdp,
-                  rigerror(retval));
-        RETURNFUNC(retval);
-    }
-
-    my_mode = modeMapGetHamlib(value);
-    *mode = my_mode;
-    rig_debug(RIG_DEBUG_TRACE, "%s: mode='%s'\n", __func__,
-              rig_strrmode(*mode));
-
-    if (vfo == RIG_VFO_A)
-    {
-        priv->curr_modeA = *mode;
-    }
-    else
-    {
-        priv->curr_modeB = *mode;
-    }
-
-
-    /* Get the bandwidth */
-    cmdp = "rig.get_bw"; /* default to old way */
-
-    if (priv->has_get_bwA)   /* change to new way if we can */
-    {
-        /* calling this way reduces VFO swapping */
-        /* we get the cached value in tci1x */
-        /* vfo B may not be getting polled though in TCI */
-        /* so we may not be 100% accurate if op is twiddling knobs */
-        cmdp = "rig.get_bwA";
-
-        if (vfo == RIG_VFO_B) { cmdp = "rig.get_bwB"; }
-    }
-
-    retval = tci1x_transaction(rig, cmdp, NULL, value, sizeof(value));
-
-    if (retval != RIG_OK)
-    {
-        RETURNFUNC(retval);
-    }
-
-    rig_debug(RIG_DEBUG_TRACE, "%s: mode=%s width='%s'\n", __func__,
-              rig_strrmode(*mode), value);
-
-    // we get 2 entries pipe separated for bandwidth, lower and upper
-    if (strlen(value) > 0)
-    {
-        char *p = value;
-
-        /* we might get two values and then we want the 2nd one */
-        if (strchr(value, '|') != NULL) { p = strchr(value, '|') + 1; }
-
-        *width = atoi(p);
-    }
-
-    if (vfo == RIG_VFO_A)
-    {
-        priv->curr_widthA = *width;
-    }
-    else
-    {
-        priv->curr_widthB = *width;
-    }
-
-    // Return to VFOA if needed
-    if (vfoSwitched)
+    if (!tci1x_pushed(rig, TCI1X_STATE_FILTER))
     {
-        retval = tci1x_set_vfo(rig, RIG_VFO_A);
+        retval = tci1x_transaction(rig, "rx_filter_band:0;", NULL, value,
+                                   sizeof(value));
 
         if (retval != RIG_OK)
         {
@@ -1446,6 +1642,12 @@ static int tci1x_get_mode(RIG *rig, vfo_t vfo, rmode_t *mode, pbwidth_t *width)
         }
     }
 
+    *mode = vfo == RIG_VFO_A ? priv->curr_modeA : priv->curr_modeB;
+    *width = vfo == RIG_VFO_A ? priv->curr_widthA : priv->curr_widthB;
+
+    rig_debug(RIG_DEBUG_TRACE, "%s: mode=%s width=%d\n", __func__,
+              rig_strrmode(*mode), (int) *width);
+
     RETURNFUNC(RIG_OK);
 }
 
@@ -1455,11 +1657,7 @@ static int tci1x_get_mode(RIG *rig, vfo_t vfo, rmode_t *mode, pbwidth_t *width)
 */
 static int tci1x_set_vfo(RIG *rig, vfo_t vfo)
 {
-    int retval;
-    char cmd_arg[MAXBUFLEN];
     struct rig_state *rs = STATE(rig);
-    const struct tci1x_priv_data *priv = (struct tci1x_priv_data *) STATE(
-            rig)->priv;
 
     ENTERFUNC;
     rig_debug(RIG_DEBUG_TRACE, "%s: vfo=%s\n", __func__,
@@ -1481,39 +1679,13 @@ static int tci1x_set_vfo(RIG *rig, vfo_t vfo)
 
     if (vfo == RIG_VFO_CURR)
     {
-        vfo = STATE(rig)->current_vfo;
-    }
-
-    SNPRINTF(cmd_arg, sizeof(cmd_arg),
-             "<params><param><value>%s</value></param></params>",
-             vfo == RIG_VFO_A ? "A" : "B");
-    retval = tci1x_transaction(rig, "rig.set_AB", cmd_arg, NULL, 0);
-
-    if (retval != RIG_OK)
-    {
-        rig_debug(RIG_DEBUG_ERR, "%s: rig.set_AB failed: %s\n", __func__,
-                  rigerror(retval));
-        RETURNFUNC(retval);
+        vfo = rs->current_vfo;
     }
 
-    STATE(rig)->current_vfo = vfo;
+    // TCI has no current VFO, every command names its channel
+    rs->current_vfo = vfo;
     rs->tx_vfo = RIG_VFO_B; // always VFOB
 
-    /* for some rigs TCI turns off split when VFOA is selected */
-    /* so if we are in split and asked for A we have to turn split back on */
-    if (priv->split && vfo == RIG_VFO_A)
-    {
-        SNPRINTF(cmd_arg, sizeof(cmd_arg),
-                 "<params><param><value><i4>%d</i4></value></param></params>",
-                 priv->split);
-        retval = tci1x_transaction(rig, "rig.set_split", cmd_arg, NULL, 0);
-
-        if (retval < 0)
-        {
-            RETURNFUNC(retval);
-        }
-    }
-
     RETURNFUNC(RIG_OK);
 }
 
@@ -1523,44 +1695,10 @@ static int tci1x_set_vfo(RIG *rig, vfo_t vfo)
 */
 static int tci1x_get_vfo(RIG *rig, vfo_t *vfo)
 {
-    char value[MAXCMDLEN];
-
     ENTERFUNC;
 
-
-    int retval;
-    retval = tci1x_transaction(rig, "rig.get_AB", NULL, value, sizeof(value));
-
-    if (retval < 0)
-    {
-        RETURNFUNC(retval);
-    }
-
-    rig_debug(RIG_DEBUG_TRACE, "%s: vfo value=%s\n", __func__, value);
-
-    switch (value[0])
-    {
-    case 'A':
-        *vfo = RIG_VFO_A;
-        break;
-
-    case 'B':
-        *vfo = RIG_VFO_B;
-        break;
-
-    default:
-        *vfo = RIG_VFO_CURR;
-        RETURNFUNC(-RIG_EINVAL);
-    }
-
-    if (check_vfo(*vfo) == FALSE)
-    {
-        rig_debug(RIG_DEBUG_ERR, "%s: unsupported VFO %s\n",
-                  __func__, rig_strvfo(*vfo));
-        RETURNFUNC(-RIG_EINVAL);
-    }
-
-    STATE(rig)->current_vfo = *vfo;
+    // TCI has no current VFO, channel 0 of the receiver is what we tune
+    *vfo = STATE(rig)->current_vfo;
 
     rig_debug(RIG_DEBUG_TRACE, "%s: vfo=%s\n", __func__,
               rig_strvfo(*vfo));
@@ -1575,9 +1713,7 @@ static int tci1x_get_vfo(RIG *rig, vfo_t *vfo)
 static int tci1x_set_split_freq(RIG *rig, vfo_t vfo, freq_t tx_freq)
 {
     int retval;
-    char cmd_arg[MAXBUFLEN];
     freq_t qtx_freq;
-    struct tci1x_priv_data *priv = (struct tci1x_priv_data *) STATE(rig)->priv;
 
     ENTERFUNC;
     rig_debug(RIG_DEBUG_TRACE, "%s: vfo=%s freq=%.1f\n", __func__,
@@ -1597,19 +1733,9 @@ static int tci1x_set_split_freq(RIG *rig, vfo_t vfo, freq_t tx_freq)
 
     if (tx_freq == qtx_freq) { RETURNFUNC(RIG_OK); }
 
-    SNPRINTF(cmd_arg, sizeof(cmd_arg),
-             "<params><param><value><double>%.6f</double></value></param></params>",
-             tx_freq);
-    retval = tci1x_transaction(rig, "rig.set_vfoB", cmd_arg, NULL, 0);
-
-    if (retval < 0)
-    {
-        RETURNFUNC(retval);
-    }
+    retval = tci1x_set_freq(rig, RIG_VFO_B, tx_freq);
 
-    priv->curr_freqB = tx_freq;
-
-    RETURNFUNC(RIG_OK);
+    RETURNFUNC(retval);
 }
 
 /*
@@ -1640,7 +1766,6 @@ static int tci1x_set_split_vfo(RIG *rig, vfo_t vfo, split_t split, vfo_t tx_vfo)
     vfo_t qtx_vfo;
     split_t qsplit;
     struct tci1x_priv_data *priv = (struct tci1x_priv_data *) STATE(rig)->priv;
-    char cmd_arg[MAXBUFLEN];
 
     ENTERFUNC;
     rig_debug(RIG_DEBUG_TRACE, "%s: tx_vfo=%s\n", __func__,
@@ -1658,10 +1783,8 @@ static int tci1x_set_split_vfo(RIG *rig, vfo_t vfo, split_t split, vfo_t tx_vfo)
         RETURNFUNC(RIG_OK);  // just return OK and ignore this
     }
 
-    SNPRINTF(cmd_arg, sizeof(cmd_arg),
-             "<params><param><value><i4>%d</i4></value></param></params>",
-             split);
-    retval = tci1x_transaction(rig, "rig.set_split", cmd_arg, NULL, 0);
+    retval = tci1x_transaction(rig,
+                               split ? "split_enable:0,true;" : "split_enable:0,false;", NULL, NULL, 0);
 
     if (retval < 0)
     {
@@ -1680,22 +1803,24 @@ static int tci1x_set_split_vfo(RIG *rig, vfo_t vfo, split_t split, vfo_t tx_vfo)
 static int tci1x_get_split_vfo(RIG *rig, vfo_t vfo, split_t *split,
                                vfo_t *tx_vfo)
 {
-    char value[MAXCMDLEN];
+    char value[MAXARGLEN];
     struct tci1x_priv_data *priv = (struct tci1x_priv_data *) STATE(rig)->priv;
 
     ENTERFUNC;
 
-    int retval;
-    retval = tci1x_transaction(rig, "rig.get_split", NULL, value, sizeof(value));
-
-    if (retval < 0)
+    if (!tci1x_pushed(rig, TCI1X_STATE_SPLIT))
     {
-        RETURNFUNC(retval);
+        int retval = tci1x_transaction(rig, "split_enable:0;", NULL, value,
+                                       sizeof(value));
+
+        if (retval < 0)
+        {
+            RETURNFUNC(retval);
+        }
     }
 
     *tx_vfo = RIG_VFO_B;
-    *split = atoi(value);
-    priv->split = *split;
+    *split = priv->split;
     rig_debug(RIG_DEBUG_TRACE, "%s tx_vfo=%s, split=%d\n", __func__,
               rig_strvfo(*tx_vfo), *split);
     RETURNFUNC(RIG_OK);
@@ -1776,52 +1901,40 @@ static int tci1x_get_split_freq_mode(RIG *rig, vfo_t vfo, freq_t *freq,
     RETURNFUNC(retval);
 }
 
-#ifdef XXNOTIMPLEMENTED
+/*
+* tci1x_set_level
+* Assumes rig!=NULL, STATE(rig)->priv!=NULL
+*/
 static int tci1x_set_level(RIG *rig, vfo_t vfo, setting_t level, value_t val)
 {
     int retval;
-    char cmd_arg[MAXARGLEN];
-    char *cmd;
-    char *param_type = "i4";
+    char cmd[MAXARGLEN];
+    struct tci1x_priv_data *priv = (struct tci1x_priv_data *) STATE(rig)->priv;
 
     ENTERFUNC;
     rig_debug(RIG_DEBUG_TRACE, "%s: vfo=%s level=%d, val=%f\n", __func__,
               rig_strvfo(vfo), (int)level, val.f);
 
-    if (check_vfo(vfo) == FALSE)
-    {
-        rig_debug(RIG_DEBUG_ERR, "%s: unsupported VFO %s\n",
-                  __func__, rig_strvfo(vfo));
-        RETURNFUNC(-RIG_EINVAL);
-    }
-
     switch (level)
     {
-    case RIG_LEVEL_RF: cmd = "rig.set_rfgain"; val.f *= 100; break;
-
-    case RIG_LEVEL_AF: cmd = "rig.set_volume"; val.f *= 100; break;
-
-    case RIG_LEVEL_MICGAIN: cmd = "rig.set_micgain"; val.f *= 100; break;
-
-    case RIG_LEVEL_RFPOWER: cmd = "rig.set_power"; val.f *= 100; break;
+    case RIG_LEVEL_RFPOWER:
+        SNPRINTF(cmd, sizeof(cmd), "drive:%d;", (int)(val.f * 100 + 0.5));
+        break;
 
     default:
         rig_debug(RIG_DEBUG_ERR, "%s: invalid level=%d\n", __func__, (int)level);
         RETURNFUNC(-RIG_EINVAL);
     }
 
-    SNPRINTF(cmd_arg, sizeof(cmd_arg),
-             "<params><param><value><%s>%d</%s></value></param></params>",
-             param_type, (int)val.f, param_type);
-
-
-    retval = tci1x_transaction(rig, cmd, cmd_arg, NULL, 0);
+    retval = tci1x_transaction(rig, cmd, NULL, NULL, 0);
 
     if (retval < 0)
     {
         RETURNFUNC(retval);
     }
 
+    priv->drive = (int)(val.f * 100 + 0.5);
+
     RETURNFUNC(RIG_OK);
 }
 
@@ -1832,8 +1945,8 @@ static int tci1x_set_level(RIG *rig, vfo_t vfo, setting_t level, value_t val)
 static int tci1x_get_level(RIG *rig, vfo_t vfo, setting_t level, value_t *val)
 {
     char value[MAXARGLEN];
-    char *cmd;
-    int retval;
+    char *cmd = NULL;
+    int part;
     const struct tci1x_priv_data *priv = (struct tci1x_priv_data *) STATE(
             rig)->priv;
 
@@ -1841,69 +1954,58 @@ static int tci1x_get_level(RIG *rig, vfo_t vfo, setting_t level, value_t *val)
     rig_debug(RIG_DEBUG_TRACE, "%s: vfo=%s\n", __func__,
               rig_strvfo(vfo));
 
-
     switch (level)
     {
-    case RIG_LEVEL_AF: cmd = "rig.get_volume"; break;
-
-    case RIG_LEVEL_RF: cmd = "rig.get_rfgain"; break;
+    case RIG_LEVEL_STRENGTH: cmd = "rx_smeter:0,0;"; part = TCI1X_STATE_SMETER; break;
 
-    case RIG_LEVEL_MICGAIN: cmd = "rig.get_micgain"; break;
-
-    case RIG_LEVEL_STRENGTH: cmd = "rig.get_smeter"; break;
-
-    case RIG_LEVEL_RFPOWER: cmd = "rig.get_power"; break;
+    case RIG_LEVEL_RFPOWER: cmd = "drive:0;"; part = TCI1X_STATE_DRIVE; break;
 
+    // only ever pushed while transmitting
     case RIG_LEVEL_RFPOWER_METER_WATTS:
-    case RIG_LEVEL_RFPOWER_METER: cmd = "rig.get_pwrmeter"; break;
+    case RIG_LEVEL_RFPOWER_METER: part = 0; break;
 
     default:
         rig_debug(RIG_DEBUG_ERR, "%s: unknown level=%d\n", __func__, (int)level);
         RETURNFUNC(-RIG_EINVAL);
     }
 
-    retval = tci1x_transaction(rig, cmd, NULL, value, sizeof(value));
-
-    if (retval != RIG_OK)
+    if (cmd && !tci1x_pushed(rig, part))
     {
-        rig_debug(RIG_DEBUG_ERR, "%s: tci1x_transaction failed retval=%s\n", __func__,
-                  rigerror(retval));
-        RETURNFUNC(retval);
+        int retval = tci1x_transaction(rig, cmd, NULL, value, sizeof(value));
+
+        if (retval != RIG_OK)
+        {
+            rig_debug(RIG_DEBUG_ERR, "%s: tci1x_transaction failed retval=%s\n", __func__,
+                      rigerror(retval));
+            RETURNFUNC(retval);
+        }
     }
 
-    // most levels are 0-100 -- may have to allow for different ranges
     switch (level)
     {
     case RIG_LEVEL_STRENGTH:
-        val->i = atoi(value) - 54;
-        //if (val->i > 0) val->i /= 10;
-        rig_debug(RIG_DEBUG_TRACE, "%s: val.i='%s'(%d)\n", __func__, value, val->i);
+        // S9 is -73dBm
+        val->i = (int)(priv->smeter + 73);
+        rig_debug(RIG_DEBUG_TRACE, "%s: val.i=%d\n", __func__, val->i);
         break;
 
     case RIG_LEVEL_RFPOWER:
-        val->f = atof(value) / 100.0 * priv->powermeter_scale;
-        rig_debug(RIG_DEBUG_TRACE, "%s: val.f='%s'(%g)\n", __func__, value, val->f);
+        val->f = priv->drive / 100.0;
+        rig_debug(RIG_DEBUG_TRACE, "%s: val.f=%g\n", __func__, val->f);
         break;
 
     case RIG_LEVEL_RFPOWER_METER:
-        val->f = atof(value) / 100.0 * priv->powermeter_scale;
-        rig_debug(RIG_DEBUG_TRACE, "%s: val.f='%s'(%g)\n", __func__, value, val->f);
-        break;
-
-    case RIG_LEVEL_RFPOWER_METER_WATTS:
-        val->f = atof(value) * priv->powermeter_scale;
-        rig_debug(RIG_DEBUG_TRACE, "%s: val.f='%s'(%g)\n", __func__, value, val->f);
+        val->f = priv->tx_power / 100.0;
+        rig_debug(RIG_DEBUG_TRACE, "%s: val.f=%g\n", __func__, val->f);
         break;
 
     default:
-        val->f = atof(value) / 100;
-        rig_debug(RIG_DEBUG_TRACE, "%s: val.f='%s'(%f)\n", __func__, value, val->f);
+        val->f = priv->tx_power;
+        rig_debug(RIG_DEBUG_TRACE, "%s: val.f=%g\n", __func__, val->f);
     }
 
-
     RETURNFUNC(RIG_OK);
 }
-#endif
 
 /*
 * tci1x_get_info
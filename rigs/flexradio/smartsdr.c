@@ -22,6 +22,9 @@
 
 #include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <pthread.h>
 
 #include "hamlib/rig.h"
 #include "hamlib/port.h"
@@ -31,6 +34,7 @@
 #include "bandplan.h"
 #include "cache.h"
 #include "network.h"
+#include "event.h"
 
 static int smartsdr_set_freq(RIG *rig, vfo_t vfo, freq_t freq);
 static int smartsdr_get_freq(RIG *rig, vfo_t vfo, freq_t *freq);
@@ -47,7 +51,28 @@ static int smartsdr_get_mode(RIG *rig, vfo_t vfo, rmode_t *mode,
                              pbwidth_t *width);
 static int smartsdr_send_morse(RIG *rig, vfo_t vfo, const char *msg);
 static int smartsdr_stop_morse(RIG *rig, vfo_t vfo);
-//static int smartsdr_set_level(RIG *rig, vfo_t vfo, setting_t level, value_t val);
+static int smartsdr_set_level(RIG *rig, vfo_t vfo, setting_t level,
+                              value_t val);
+static int smartsdr_get_level(RIG *rig, vfo_t vfo, setting_t level,
+                              value_t *val);
+static int smartsdr_read_frame_direct(RIG *rig, size_t buffer_length,
+                                      const unsigned char *buffer);
+static int smartsdr_is_async_frame(RIG *rig, size_t frame_length,
+                                   const unsigned char *frame);
+static int smartsdr_process_async_frame(RIG *rig, size_t frame_length,
+                                        const unsigned char *frame);
+
+#define SMARTSDR_PENDING_MAX 8
+
+// a command waiting for its R reply
+struct smartsdr_reply
+{
+    int in_use;
+    int seq;
+    int done;
+    unsigned int code; // 0 or a SmartSDR error code
+    char msg[64];
+};
 
 struct smartsdr_priv_data
 {
@@ -61,13 +86,21 @@ struct smartsdr_priv_data
     rmode_t modeB;
     int widthA;
     int widthB;
+    int filter_lo;
+    int filter_hi;
+    int rfpower; // 0-100
+    pthread_mutex_t mutex; // protects pending
+    pthread_cond_t cond; // signals a completed reply
+    struct smartsdr_reply pending[SMARTSDR_PENDING_MAX];
+    char line[4096]; // status line being received
+    int line_len;
 };
 
 
 #define DEFAULTPATH "127.0.0.1:4992"
 
 #define SMARTSDR_FUNC  RIG_FUNC_MUTE
-#define SMARTSDR_LEVEL RIG_LEVEL_PREAMP
+#define SMARTSDR_LEVEL (RIG_LEVEL_PREAMP|RIG_LEVEL_RFPOWER)
 #define SMARTSDR_PARM  RIG_PARM_NONE
 
 #define SMARTSDR_MODES (RIG_MODE_USB|RIG_MODE_LSB|RIG_MODE_PKTUSB|RIG_MODE_PKTLSB|RIG_MODE_CW|RIG_MODE_AM|RIG_MODE_FM|RIG_MODE_FMN|RIG_MODE_SAM)
@@ -76,8 +109,6 @@ struct smartsdr_priv_data
 
 #define SMARTSDR_ANTS 3
 
-static int smartsdr_parse_S(RIG *rig, char *s);
-
 struct rig_caps smartsdr_a_rig_caps =
 {
     RIG_MODEL(RIG_MODEL_SMARTSDR_A),
@@ -183,98 +214,482 @@ int smartsdr_init(RIG *rig)
     }
 
     priv->ptt = 0;
+    pthread_mutex_init(&priv->mutex, NULL);
+    pthread_cond_init(&priv->cond, NULL);
+
+    // the radio pushes the subscribed status, async=0 goes back to polling
+    rs->async_data_enabled = 1;
 
     RETURNFUNC(RIG_OK);
 }
 
-// flush any messages in the queue and process them too
-// return 0 if OK, otherwise SMARTSDR error code
-static int smartsdr_flush(RIG *rig)
+/* Example response to "sub slice 0"
+511+511+35
+S67319A86|slice 0 in_use=1 sample_rate=24000 RF_frequency=10.137000 client_handle=0x76AF7C73 index_letter=A rit_on=0 rit_freq=0 xit_on=0 xit_freq=0 rxant=ANT2 mode=DIGU wide=0 filter_lo=0 filter_hi=3510 step=10 step_list=1,5,10,20,100,250,500,1000 agc_mode=fast agc_threshold=65 agc_off_level=10 pan=0x40000000 txant=ANT2 loopa=0 loopb=0 qsk=0 dax=1 dax_clients=1 lock=0 tx=1 active=1 audio_level=100 audio_pan=51 audio_mute=1 record=0 play=disabled record_time=0.0 anf=0 anf_level=0 nr=0 nr_level=0 nb=0 nb_lev direct=1 el=50 wnb=0 wnb_level=100 apf=0 apf_level=0 squelch=1 squelch_level=20 diversity=0 diversity_parent=0 diversity_child=0 diversity_index=1342177293 ant_list=ANT1,ANT2,RX_A,RX_B,XVTA,XVTB mode_list=LSB,USB,AM,CW,DIGL,DIGU,SAM,FM,NFM,DFM,RTTY fm_tone_mode=OFF fm_tone_value=67.0 fm_repeater_offset_freq=0.000000 tx_offset_freq=0.000000 repeater_offset_dir=SIMPLEX fm_tone_burst=0 fm_deviation=5000 dfm_pre_de_emphasis=0 post_demod_low=300 post_demod_high=3300 rtty_mark=2125 rtty_shift=170 digl_offset=2210 digu_offset=1500 post_demod_bypass=0 rfgain=24  tx_ant_list=ANT1,ANT2,XVTA,XVTB
+S67319A86|waveform installed_list=
+R0|0|
+
+Later status lines only carry the keys that changed, e.g.
+S67319A86|slice 0 RF_frequency=10.138000
+S67319A86|interlock state=TRANSMITTING source=SW
+S67319A86|transmit rfpower=50 tunepower=10
+*/
+
+static rmode_t smartsdr_mode(const char *mode)
+{
+    if (strcmp(mode, "USB") == 0) { return RIG_MODE_USB; }
+    else if (strcmp(mode, "LSB") == 0) { return RIG_MODE_LSB; }
+    else if (strcmp(mode, "DIGU") == 0) { return RIG_MODE_PKTUSB; }
+    else if (strcmp(mode, "DIGL") == 0) { return RIG_MODE_PKTLSB; }
+    else if (strcmp(mode, "AM") == 0) { return RIG_MODE_AM; }
+    else if (strcmp(mode, "CW") == 0) { return RIG_MODE_CW; }
+    else if (strcmp(mode, "SAM") == 0) { return RIG_MODE_SAM; }
+    else if (strcmp(mode, "FM") == 0) { return RIG_MODE_FM; }
+    else if (strcmp(mode, "FMN") == 0) { return RIG_MODE_FMN; }
+    else if (strcmp(mode, "NFM") == 0) { return RIG_MODE_FMN; }
+    else if (strcmp(mode, "RTTY") == 0) { return RIG_MODE_RTTY; }
+
+    rig_debug(RIG_DEBUG_ERR, "%s: unknown mode=%s\n", __func__, mode);
+    return RIG_MODE_NONE;
+}
+
+/*
+ * Applies the keys of one status line to the state, only the keys the
+ * line carries change
+ */
+static int smartsdr_parse_S(RIG *rig, char *s)
+{
+    struct smartsdr_priv_data *priv = (struct smartsdr_priv_data *)STATE(rig)->priv;
+    int fire = RIGPORT(rig)->asyncio;
+    int gotFreq = 0, gotMode = 0, gotPtt = 0;
+    char *sep = " \r\n";
+    char *saveptr = NULL;
+    char *p;
+    int num;
+
+    p = strchr(s, '|');
+
+    if (p == NULL)
+    {
+        return -RIG_EPROTO;
+    }
+
+    p = strtok_r(p + 1, sep, &saveptr);
+
+    if (p == NULL)
+    {
+        return RIG_OK;
+    }
+
+    if (strcmp(p, "slice") == 0)
+    {
+        p = strtok_r(NULL, sep, &saveptr);
+
+        // other slices belong to other models
+        if (p == NULL || sscanf(p, "%d", &num) != 1 || num != priv->slicenum)
+        {
+            return RIG_OK;
+        }
+
+        while ((p = strtok_r(NULL, sep, &saveptr)))
+        {
+            char mode[16];
+            double freq;
+
+            if (sscanf(p, "RF_frequency=%lf", &freq) == 1)
+            {
+                priv->freqA = freq * 1e6;
+                gotFreq = 1;
+            }
+            else if (sscanf(p, "filter_lo=%d", &priv->filter_lo) == 1
+                     || sscanf(p, "filter_hi=%d", &priv->filter_hi) == 1)
+            {
+                priv->widthA = priv->filter_hi - priv->filter_lo;
+                gotMode = 1;
+            }
+            else if (sscanf(p, "mode=%15s", mode) == 1)
+            {
+                priv->modeA = smartsdr_mode(mode);
+                gotMode = 1;
+            }
+            else if (sscanf(p, "tx=%d", &priv->tx) == 1)
+            {
+                rig_debug(RIG_DEBUG_VERBOSE, "%s: tx=%d\n", __func__, priv->tx);
+            }
+        }
+    }
+    else if (strcmp(p, "interlock") == 0)
+    {
+        while ((p = strtok_r(NULL, sep, &saveptr)))
+        {
+            char state[16];
+
+            if (sscanf(p, "state=%15s", state) == 1)
+            {
+                priv->ptt = strcmp(state, "TRANSMITTING") == 0;
+                gotPtt = 1;
+                rig_debug(RIG_DEBUG_VERBOSE, "%s: PTT state=%s, ptt=%d\n", __func__, state,
+                          priv->ptt);
+            }
+        }
+    }
+    else if (strcmp(p, "transmit") == 0)
+    {
+        while ((p = strtok_r(NULL, sep, &saveptr)))
+        {
+            sscanf(p, "rfpower=%d", &priv->rfpower);
+        }
+    }
+
+    rig_debug(RIG_DEBUG_VERBOSE, "%s gotFreq=%d, gotMode=%d\n", __func__, gotFreq,
+              gotMode);
+
+    // the cache and the callbacks only follow pushed state
+    if (fire && gotFreq)
+    {
+        rig_fire_freq_event(rig, RIG_VFO_A, priv->freqA);
+    }
+
+    if (fire && gotMode && priv->modeA != RIG_MODE_NONE)
+    {
+        rig_fire_mode_event(rig, RIG_VFO_A, priv->modeA, priv->widthA);
+    }
+
+    if (fire && gotPtt && priv->tx)
+    {
+        rig_fire_ptt_event(rig, RIG_VFO_A, priv->ptt);
+    }
+
+    return RIG_OK;
+}
+
+/*
+ * R<seq>|<hex error code>|<message>
+ * completes the command sent with that sequence number
+ */
+static int smartsdr_parse_R(RIG *rig, const char *s)
+{
+    struct smartsdr_priv_data *priv = (struct smartsdr_priv_data *)STATE(rig)->priv;
+    unsigned int code = 0;
+    char msg[64] = "";
+    int seq;
+    int i;
+
+    if (sscanf(s, "R%d|%x|%63[^\r\n]", &seq, &code, msg) < 2)
+    {
+        rig_debug(RIG_DEBUG_WARN, "%s: bad reply '%s'\n", __func__, s);
+        return -RIG_EPROTO;
+    }
+
+    pthread_mutex_lock(&priv->mutex);
+
+    for (i = 0; i < SMARTSDR_PENDING_MAX; i++)
+    {
+        struct smartsdr_reply *reply = &priv->pending[i];
+
+        if (reply->in_use && !reply->done && reply->seq == seq)
+        {
+            reply->code = code;
+            memcpy(reply->msg, msg, sizeof(reply->msg));
+            reply->done = 1;
+            pthread_cond_broadcast(&priv->cond);
+            break;
+        }
+    }
+
+    pthread_mutex_unlock(&priv->mutex);
+
+    if (i == SMARTSDR_PENDING_MAX)
+    {
+        rig_debug(RIG_DEBUG_VERBOSE, "%s: nobody waits for R%d\n", __func__, seq);
+    }
+
+    return RIG_OK;
+}
+
+static void smartsdr_parse_line(RIG *rig, char *line)
+{
+    rig_debug(RIG_DEBUG_TRACE, "%s: '%s'\n", __func__, line);
+
+    switch (line[0])
+    {
+    case 'S': smartsdr_parse_S(rig, line); break;
+
+    case 'R': smartsdr_parse_R(rig, line); break;
+
+    case 'V': // protocol version and our client handle
+    case 'H':
+    case 'M': // radio message
+        rig_debug(RIG_DEBUG_VERBOSE, "%s: %s\n", __func__, line);
+        break;
+
+    default:
+        rig_debug(RIG_DEBUG_WARN, "%s: Unknown packet type=%s\n", __func__, line);
+    }
+}
+
+/*
+ * Status lines can be longer than what one read returns, so the bytes are
+ * collected until the end of the line before parsing
+ */
+static void smartsdr_feed(RIG *rig, const char *buf, int len)
+{
+    struct smartsdr_priv_data *priv = (struct smartsdr_priv_data *)STATE(rig)->priv;
+    int i;
+
+    for (i = 0; i < len; i++)
+    {
+        if (buf[i] == '\n')
+        {
+            priv->line[priv->line_len] = 0;
+
+            if (priv->line_len > 0) { smartsdr_parse_line(rig, priv->line); }
+
+            priv->line_len = 0;
+        }
+        else if (priv->line_len < (int) sizeof(priv->line) - 1)
+        {
+            priv->line[priv->line_len++] = buf[i];
+        }
+    }
+}
+
+// read the status lines already received, only needed without async data
+static void smartsdr_flush(RIG *rig)
 {
     char buf[8192];
     int buf_len = 8192;
     char stopset[1] = { 0x0a };
     int len = 0;
-    int retval = RIG_OK;
-    ENTERFUNC;
-#if 0
-    // for this flush routine we expect at least one message for sure -- might be more
-    len = read_string(RIGPORT(rig), (unsigned char *)buf, buf_len, stopset, 1, 0,
-                      1);
 
-    if (buf[0] == 'S') { smartsdr_parse_S(rig, buf); }
-
-    rig_debug(RIG_DEBUG_VERBOSE, "%s: read %d bytes\n", __func__, len);
-#endif
+    if (RIGPORT(rig)->asyncio)
+    {
+        return;
+    }
 
     do
     {
         buf[0] = 0;
         len = network_flush2(RIGPORT(rig), (unsigned char *)stopset, buf, buf_len);
-
-        if (buf[0] == 'S') { smartsdr_parse_S(rig, buf); }
-
-        else if (buf[0] == 'R') { sscanf(buf, "R%d", &retval); }
-
-        else if (strlen(buf) > 0) { rig_debug(RIG_DEBUG_WARN, "%s: Unknown packet type=%s\n", __func__, buf); }
+        smartsdr_feed(rig, buf, strlen(buf));
     }
     while (len > 0);
-
-    RETURNFUNC(retval);
 }
 
-static int smartsdr_transaction(RIG *rig, char *buf)
+/*
+ * Sends a command without waiting for its reply, so several commands can
+ * be outstanding. *seq is for smartsdr_wait().
+ */
+static int smartsdr_send(RIG *rig, const char *buf, int *seq)
 {
     struct smartsdr_priv_data *priv = (struct smartsdr_priv_data *)STATE(rig)->priv;
+    struct smartsdr_reply *reply = NULL;
     char cmd[4096];
     int retval;
+    int i;
+
+    pthread_mutex_lock(&priv->mutex);
+
+    for (i = 0; i < SMARTSDR_PENDING_MAX; i++)
+    {
+        if (!priv->pending[i].in_use)
+        {
+            reply = &priv->pending[i];
+            break;
+        }
+    }
+
+    if (reply == NULL)
+    {
+        pthread_mutex_unlock(&priv->mutex);
+        rig_debug(RIG_DEBUG_ERR, "%s: too many outstanding commands\n", __func__);
+        return -RIG_ENAVAIL;
+    }
 
     if (priv->seqnum > 999999) { priv->seqnum = 0; }
 
-    if (buf)
+    memset(reply, 0, sizeof(*reply));
+    reply->in_use = 1;
+    reply->seq = priv->seqnum++;
+    *seq = reply->seq;
+
+    pthread_mutex_unlock(&priv->mutex);
+
+    SNPRINTF(cmd, sizeof(cmd), "C%d|%s%c", *seq, buf, 0x0a);
+    retval = write_block(RIGPORT(rig), (unsigned char *) cmd, strlen(cmd));
+
+    if (retval != RIG_OK)
     {
-        sprintf(cmd, "C%d|%s%c", priv->seqnum++, buf, 0x0a);
-        retval = write_block(RIGPORT(rig), (unsigned char *) cmd, strlen(cmd));
+        rig_debug(RIG_DEBUG_ERR, "%s: SmartSDR write_block err=0x%x\n", __func__,
+                  retval);
+        pthread_mutex_lock(&priv->mutex);
+        reply->in_use = 0;
+        pthread_mutex_unlock(&priv->mutex);
+    }
 
-        if (retval != RIG_OK)
+    return retval;
+}
+
+/*
+ * Waits for the reply to the command sent with seq, the async data handler
+ * delivers it, or without async data the status lines and the replies to
+ * other commands are read on the way
+ */
+static int smartsdr_wait(RIG *rig, int seq)
+{
+    struct smartsdr_priv_data *priv = (struct smartsdr_priv_data *)STATE(rig)->priv;
+    hamlib_port_t *rp = RIGPORT(rig);
+    struct smartsdr_reply *reply = NULL;
+    struct timespec deadline;
+    int retval = RIG_OK;
+    int i;
+
+    pthread_mutex_lock(&priv->mutex);
+
+    for (i = 0; i < SMARTSDR_PENDING_MAX; i++)
+    {
+        if (priv->pending[i].in_use && priv->pending[i].seq == seq)
         {
-            rig_debug(RIG_DEBUG_ERR, "%s: SmartSDR write_block err=0x%x\n", __func__,
-                      retval);
+            reply = &priv->pending[i];
+            break;
         }
     }
 
-    retval = smartsdr_flush(rig);
+    if (reply == NULL)
+    {
+        pthread_mutex_unlock(&priv->mutex);
+        return -RIG_EINTERNAL;
+    }
+
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_sec += rp->timeout / 1000;
+    deadline.tv_nsec += (long)(rp->timeout % 1000) * 1000000L;
 
-    if (retval != 0)
+    if (deadline.tv_nsec >= 1000000000L)
     {
-        rig_debug(RIG_DEBUG_ERR, "%s: SmartSDR flush err=0x%x\n", __func__, retval);
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000L;
+    }
+
+    while (!reply->done && retval == RIG_OK)
+    {
+        if (rp->asyncio)
+        {
+            if (pthread_cond_timedwait(&priv->cond, &priv->mutex,
+                                       &deadline) == ETIMEDOUT)
+            {
+                retval = -RIG_ETIMEOUT;
+            }
+        }
+        else
+        {
+            char buf[1024];
+            int len;
+
+            pthread_mutex_unlock(&priv->mutex);
+            len = read_string(rp, (unsigned char *) buf, sizeof(buf), "\n", 1, 0, 1);
+
+            if (len > 0)
+            {
+                smartsdr_feed(rig, buf, len);
+            }
+
+            pthread_mutex_lock(&priv->mutex);
+
+            if (len < 0)
+            {
+                retval = len;
+            }
+        }
+    }
+
+    if (reply->done && reply->code != 0)
+    {
+        rig_debug(RIG_DEBUG_ERR, "%s: SmartSDR error 0x%08x %s\n", __func__,
+                  reply->code, reply->msg);
         retval = -RIG_EPROTO;
     }
 
+    reply->in_use = 0;
+    pthread_mutex_unlock(&priv->mutex);
+
+    return retval;
+}
+
+static int smartsdr_transaction(RIG *rig, char *buf)
+{
+    int seq;
+    int retval;
+
+    if (buf == NULL)
+    {
+        smartsdr_flush(rig);
+        return RIG_OK;
+    }
+
+    retval = smartsdr_send(rig, buf, &seq);
+
+    if (retval == RIG_OK)
+    {
+        retval = smartsdr_wait(rig, seq);
+    }
+
+    return retval;
+}
+
+/*
+ * Sends all the commands before waiting for any of the replies
+ * Returns the first error
+ */
+static int smartsdr_transaction_list(RIG *rig, char *cmds[], int ncmds)
+{
+    int seq[SMARTSDR_PENDING_MAX];
+    int retval = RIG_OK;
+    int sent;
+    int i;
+
+    for (sent = 0; sent < ncmds && sent < SMARTSDR_PENDING_MAX; sent++)
+    {
+        retval = smartsdr_send(rig, cmds[sent], &seq[sent]);
+
+        if (retval != RIG_OK)
+        {
+            break;
+        }
+    }
+
+    for (i = 0; i < sent; i++)
+    {
+        int result = smartsdr_wait(rig, seq[i]);
+
+        if (retval == RIG_OK) { retval = result; }
+    }
+
     return retval;
 }
 
 int smartsdr_open(RIG *rig)
 {
     struct smartsdr_priv_data *priv = (struct smartsdr_priv_data *)STATE(rig)->priv;
-    char cmd[64];
-    int loops = 20;
+    char sub_slice[64];
+    char *cmds[] = { sub_slice, "sub tx all" };
+    int retval;
     ENTERFUNC;
-    // Once we've connected and hit here we should have two messages queued from the initial connect
 
-    sprintf(cmd, "sub slice %d", priv->slicenum);
-    //sprintf(cmd, "sub slice all");
-    smartsdr_transaction(rig, cmd);
+    // the status dump of a subscription comes before its reply
+    sprintf(sub_slice, "sub slice %d", priv->slicenum);
+    retval = smartsdr_transaction_list(rig, cmds, 2);
 
-    do
+    if (retval != RIG_OK)
     {
-        hl_usleep(100 * 1000);
-        smartsdr_transaction(rig, NULL);
+        RETURNFUNC(retval);
     }
-    while (priv->freqA == 0 && --loops > 0);
 
-    //smartsdr_transaction(rig, "info", buf, sizeof(buf));
-    //rig_debug(RIG_DEBUG_VERBOSE, "%s: info=%s", __func__, buf);
+    if (priv->freqA == 0)
+    {
+        rig_debug(RIG_DEBUG_WARN, "%s: slice %d not in use\n", __func__,
+                  priv->slicenum);
+    }
 
     RETURNFUNC(RIG_OK);
 }
@@ -294,6 +709,8 @@ int smartsdr_cleanup(RIG *rig)
 
     if (priv)
     {
+        pthread_cond_destroy(&priv->cond);
+        pthread_mutex_destroy(&priv->mutex);
         free(priv);
     }
 
@@ -302,93 +719,42 @@ int smartsdr_cleanup(RIG *rig)
     RETURNFUNC(RIG_OK);
 }
 
-#if 0
-typedef struct smartsdr_data_handler_args_s
+static int smartsdr_read_frame_direct(RIG *rig, size_t buffer_length,
+                                      const unsigned char *buffer)
 {
-    RIG *rig;
-} smartsdr_data_handler_args;
-
-typedef struct smartsdr_data_handler_priv_data_s
-{
-    pthread_t thread_id;
-    smartsdr_data_handler_args args;
-    int smartsdr_data_handler_thread_run;
-} smartsdr_data_handler_priv_data;
+    return read_string_direct(RIGPORT(rig), (unsigned char *) buffer,
+                              buffer_length, "\n", 1, 0, 1);
+}
 
-void *smartsdr_data_handler(void *arg)
+// status lines and replies alike are handled by smartsdr_feed()
+static int smartsdr_is_async_frame(RIG *rig, size_t frame_length,
+                                   const unsigned char *frame)
 {
-    struct smartsdr_priv_data *priv;
-    struct smartsdr_data_handler_args_s *args =
-        (struct smartsdr_data_handler_args_s *) arg;
-    smartsdr_data_handler_priv_data *smartsdr_data_handler_priv;
-    //RIG *rig = args->rig;
-    //const struct rig_state *rs = STATE(rig);
-    //int result;
-
-    rig_debug(RIG_DEBUG_VERBOSE, "%s: Starting morse data handler thread\n",
-              __func__);
-
-    while (priv->smartsdr_data_handler_priv_data->smartsdr_data_handler_thread_run)
-    {
-    }
-
-    pthread_exit(NULL);
-    return NULL;
+    return 1;
 }
 
-static int smartsdr_data_handler_start(RIG *rig)
+static int smartsdr_process_async_frame(RIG *rig, size_t frame_length,
+                                        const unsigned char *frame)
 {
-    struct smartsdr_priv_data *priv;
-    smartsdr_data_handler_priv_data *smartsdr_data_handler_priv;
-
-    ENTERFUNC;
-
-    priv->smartsdr_data_handler_thread_run = 1;
-    priv->smartsdr_data_handler_priv_data = calloc(1,
-                                            sizeof(smartsdr_data_handler_priv_data));
-
-    if (priv->smartsdr_data_handler_priv_data == NULL)
-    {
-        RETURNFUNC(-RIG_ENOMEM);
-    }
-
-    smartsdr_data_handler_priv = (smartsdr_data_handler_priv_data *)
-                                 priv->smartsdr_data_handler_priv_data;
-    smartsdr_data_handler_priv->args.rig = rig;
-    int err = pthread_create(&smartsdr_data_handler_priv->thread_id, NULL,
-                             smartsdr_data_handler, &smartsdr_data_handler_priv->args);
-
-    if (err)
-    {
-        rig_debug(RIG_DEBUG_ERR, "%s: pthread_create error: %s\n", __func__,
-                  strerror(errno));
-        RETURNFUNC(-RIG_EINTERNAL);
-    }
-
-    RETURNFUNC(RIG_OK);
-    fset = 1500 post_demod_bypass = 0 rfgain = 24  tx_ant_list = ANT1, ANT2, XVTA,
-    XVTB
+    smartsdr_feed(rig, (const char *) frame, frame_length);
 
+    return RIG_OK;
 }
-#endif
-
-/* Example response to "sub slice 0"
-511+511+35
-S67319A86|slice 0 in_use=1 sample_rate=24000 RF_frequency=10.137000 client_handle=0x76AF7C73 index_letter=A rit_on=0 rit_freq=0 xit_on=0 xit_freq=0 rxant=ANT2 mode=DIGU wide=0 filter_lo=0 filter_hi=3510 step=10 step_list=1,5,10,20,100,250,500,1000 agc_mode=fast agc_threshold=65 agc_off_level=10 pan=0x40000000 txant=ANT2 loopa=0 loopb=0 qsk=0 dax=1 dax_clients=1 lock=0 tx=1 active=1 audio_level=100 audio_pan=51 audio_mute=1 record=0 play=disabled record_time=0.0 anf=0 anf_level=0 nr=0 nr_level=0 nb=0 nb_lev direct=1 el=50 wnb=0 wnb_level=100 apf=0 apf_level=0 squelch=1 squelch_level=20 diversity=0 diversity_parent=0 diversity_child=0 diversity_index=1342177293 ant_list=ANT1,ANT2,RX_A,RX_B,XVTA,XVTB mode_list=LSB,USB,AM,CW,DIGL,DIGU,SAM,FM,NFM,DFM,RTTY fm_tone_mode=OFF fm_tone_value=67.0 fm_repeater_offset_freq=0.000000 tx_offset_freq=0.000000 repeater_offset_dir=SIMPLEX fm_tone_burst=0 fm_deviation=5000 dfm_pre_de_emphasis=0 post_demod_low=300 post_demod_high=3300 rtty_mark=2125 rtty_shift=170 digl_offset=2210 digu_offset=1500 post_demod_bypass=0 rfgain=24  tx_ant_list=ANT1,ANT2,XVTA,XVTB
-S67319A86|waveform installed_list=
-R0|0|
-*/
-
 
 int smartsdr_set_freq(RIG *rig, vfo_t vfo, freq_t freq)
 {
     struct smartsdr_priv_data *priv = (struct smartsdr_priv_data *)STATE(rig)->priv;
-    char buf[4096];
     char cmd[64];
+    int retval;
     ENTERFUNC;
     sprintf(cmd, "slice tune %d %.6f autopan=1", priv->slicenum, freq / 1e6);
-    smartsdr_transaction(rig, cmd);
-    rig_debug(RIG_DEBUG_VERBOSE, "%s: set_freq answer: %s", __func__, buf);
+    retval = smartsdr_transaction(rig, cmd);
+
+    if (retval != RIG_OK)
+    {
+        RETURNFUNC(retval);
+    }
+
     rig_set_cache_freq(rig, vfo, freq);
 
     if (vfo == RIG_VFO_A)
@@ -403,79 +769,6 @@ int smartsdr_set_freq(RIG *rig, vfo_t vfo, freq_t freq)
     RETURNFUNC(RIG_OK);
 }
 
-static int smartsdr_parse_S(RIG *rig, char *s)
-{
-    struct smartsdr_priv_data *priv = (struct smartsdr_priv_data *)STATE(rig)->priv;
-    freq_t freq;
-    char mode[16];
-    char state[16];
-    char *s2 = strdup(s);
-    char *sep = "| \n";
-    char *p = strtok(s2, sep);
-    int gotFreq = 0, gotMode = 0;
-
-    do
-    {
-        rig_debug(RIG_DEBUG_VERBOSE, "%s: parsing '%s'\n", __func__, p);
-
-        if (sscanf(p, "RF_frequency=%lf", &freq) == 1)
-        {
-            priv->freqA = freq * 1e6;
-            rig_debug(RIG_DEBUG_VERBOSE, "%s: got freq=%.0f\n", __func__, priv->freqA);
-            gotFreq = 1;
-            rig_set_cache_freq(rig, RIG_VFO_A, priv->freqA);
-        }
-        else if (sscanf(p, "filter_hi=%d\n", &priv->widthA) == 1)
-        {
-            rig_debug(RIG_DEBUG_VERBOSE, "%s: got width=%d\n", __func__, priv->widthA);
-            rig_set_cache_mode(rig, RIG_VFO_A, priv->modeA, priv->widthA);
-        }
-        else if (sscanf(p, "mode=%s\n", mode) == 1)
-        {
-            if (strcmp(mode, "USB") == 0) { priv->modeA = RIG_MODE_USB; }
-            else if (strcmp(mode, "LSB") == 0) { priv->modeA = RIG_MODE_LSB; }
-            else if (strcmp(mode, "DIGU") == 0) { priv->modeA = RIG_MODE_PKTUSB; }
-            else if (strcmp(mode, "DIGL") == 0) { priv->modeA = RIG_MODE_PKTLSB; }
-            else if (strcmp(mode, "AM") == 0) { priv->modeA = RIG_MODE_AM; }
-            else if (strcmp(mode, "CW") == 0) { priv->modeA = RIG_MODE_CW; }
-            else if (strcmp(mode, "SAM") == 0) { priv->modeA = RIG_MODE_SAM; }
-            else if (strcmp(mode, "FM") == 0) { priv->modeA = RIG_MODE_FM; }
-            else if (strcmp(mode, "FMN") == 0) { priv->modeA = RIG_MODE_FMN; }
-            else if (strcmp(mode, "RTTY") == 0) { priv->modeA = RIG_MODE_RTTY; }
-            else
-            {
-                priv->modeA = RIG_MODE_NONE;
-                rig_debug(RIG_DEBUG_ERR, "%s: unknown mode=%s\n", __func__, mode);
-                return -RIG_EPROTO;
-            }
-
-            rig_set_cache_mode(rig, RIG_VFO_A, priv->modeA, priv->widthA);
-            gotMode = 1;
-            rig_debug(RIG_DEBUG_VERBOSE, "%s: got mode=%s\n", __func__,
-                      rig_strrmode(priv->modeA));
-        }
-        else if (sscanf(p, "state=%s\n", state) == 1)
-        {
-            if (strcmp(state, "TRANSMITTING") == 0) { priv->ptt = 1; }
-            else { priv->ptt = 0; }
-
-            rig_debug(RIG_DEBUG_VERBOSE, "%s: PTT state=%s, ptt=%d\n", __func__, state,
-                      priv->ptt);
-        }
-        else if (sscanf(p, "tx=%d\n", &priv->tx) == 1)
-        {
-            rig_debug(RIG_DEBUG_VERBOSE, "%s: tx=%d\n", __func__, priv->tx);
-        }
-    }
-    while ((p = strtok(NULL, sep)));
-
-    free(s2);
-
-    rig_debug(RIG_DEBUG_VERBOSE, "%s gotFreq=%d, gotMode=%d\n", __func__, gotFreq,
-              gotMode);
-    return RIG_OK;
-}
-
 int smartsdr_get_freq(RIG *rig, vfo_t vfo, freq_t *freq)
 {
     struct smartsdr_priv_data *priv = (struct smartsdr_priv_data *)STATE(rig)->priv;
@@ -507,7 +800,11 @@ int smartsdr_reset(RIG *rig, reset_t reset)
 int smartsdr_set_ptt(RIG *rig, vfo_t vfo, ptt_t ptt)
 {
     struct smartsdr_priv_data *priv = (struct smartsdr_priv_data *)STATE(rig)->priv;
-    char cmd[64];
+    char dax[64];
+    char tx[64];
+    char xmit[64];
+    char *cmds[] = { tx, xmit };
+    char *cmds_dax[] = { dax, tx, xmit };
     char slicechar[] = { '?', 'A', 'B', 'C', 'D', 'E', 'F', 'G', 'H' };
     ENTERFUNC;
 
@@ -521,18 +818,17 @@ int smartsdr_set_ptt(RIG *rig, vfo_t vfo, ptt_t ptt)
 
     priv->ptt = ptt;
 
+    sprintf(dax, "dax audio set %d tx=1", priv->slicenum + 1);
+    sprintf(tx, "slice set %d tx=1", priv->slicenum);
+    sprintf(xmit, "xmit %d", ptt);
+
+    // the radio runs the commands in order, no need to wait in between
     if (ptt)
     {
-        sprintf(cmd, "dax audio set %d tx=1", priv->slicenum + 1);
-        smartsdr_transaction(rig, cmd);
-        rig_debug(RIG_DEBUG_VERBOSE, "%s: slice set answer: %s", __func__, cmd);
+        RETURNFUNC(smartsdr_transaction_list(rig, cmds_dax, 3));
     }
 
-    sprintf(cmd, "slice set %d tx=1", priv->slicenum);
-    smartsdr_transaction(rig, cmd);
-    sprintf(cmd, "xmit %d", ptt);
-    smartsdr_transaction(rig, cmd);
-    RETURNFUNC(RIG_OK);
+    RETURNFUNC(smartsdr_transaction_list(rig, cmds, 2));
 }
 
 int smartsdr_get_ptt(RIG *rig, vfo_t vfo, ptt_t *ptt)
@@ -597,11 +893,50 @@ int smartsdr_get_mode(RIG *rig, vfo_t vfo, rmode_t *mode, pbwidth_t *width)
 {
     struct smartsdr_priv_data *priv = (struct smartsdr_priv_data *)STATE(rig)->priv;
     ENTERFUNC;
+    smartsdr_transaction(rig, NULL);
     *mode = priv->modeA;
     *width = priv->widthA;
     RETURNFUNC(RIG_OK);
 }
 
+int smartsdr_set_level(RIG *rig, vfo_t vfo, setting_t level, value_t val)
+{
+    char cmd[64];
+    ENTERFUNC;
+
+    switch (level)
+    {
+    case RIG_LEVEL_RFPOWER:
+        sprintf(cmd, "transmit set rfpower=%d", (int)(val.f * 100 + 0.5));
+        break;
+
+    default:
+        RETURNFUNC(-RIG_EINVAL);
+    }
+
+    RETURNFUNC(smartsdr_transaction(rig, cmd));
+}
+
+int smartsdr_get_level(RIG *rig, vfo_t vfo, setting_t level, value_t *val)
+{
+    struct smartsdr_priv_data *priv = (struct smartsdr_priv_data *)STATE(rig)->priv;
+    ENTERFUNC;
+
+    switch (level)
+    {
+    case RIG_LEVEL_RFPOWER:
+        // from the transmit status
+        smartsdr_transaction(rig, NULL);
+        val->f = priv->rfpower / 100.0;
+        break;
+
+    default:
+        RETURNFUNC(-RIG_EINVAL);
+    }
+
+    RETURNFUNC(RIG_OK);
+}
+
 #if 0
 int sdr1k_set_level(RIG *rig, vfo_t vfo, setting_t level, value_t val)
 {
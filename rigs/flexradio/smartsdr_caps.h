@@ -1,5 +1,5 @@
     .mfg_name =       "FlexRadio",
-    .version =        "20240814.0",
+    .version =        "20261018.0",
     .copyright =      "LGPL",
     .status =         RIG_STATUS_STABLE,
     .rig_type =       RIG_TYPE_TRANSCEIVER,
@@ -73,8 +73,13 @@
     .set_ptt  =     smartsdr_set_ptt,
     .get_ptt  =     smartsdr_get_ptt,
 //  .reset    =     smartsdr_reset,
-//  .set_level =     smartsdr_set_level,
+    .set_level =    smartsdr_set_level,
+    .get_level =    smartsdr_get_level,
 //  .set_func =     _set_func,
     .send_morse =  smartsdr_send_morse,
     .stop_morse = smartsdr_stop_morse,
+    .async_data_supported = 1,
+    .read_frame_direct = smartsdr_read_frame_direct,
+    .is_async_frame = smartsdr_is_async_frame,
+    .process_async_frame = smartsdr_process_async_frame,
     .hamlib_check_rig_caps = HAMLIB_CHECK_RIG_CAPS
\ No newline at end of file
@@ -0,0 +1,600 @@
+/*
+ *  Hamlib CI-V backend - several radios sharing one CI-V bus
+ *  Copyright (c) 2000-2026 The Hamlib Group
+ *
+ *
+ *   This library is free software; you can redistribute it and/or
+ *   modify it under the terms of the GNU Lesser General Public
+ *   License as published by the Free Software Foundation; either
+ *   version 2.1 of the License, or (at your option) any later version.
+ *
+ *   This library is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *   Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public
+ *   License along with this library; if not, write to the Free Software
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+/*
+ * Several radios on one CI-V line, e.g. behind a CT-17, used to need one
+ * RIG handle per radio, each with the port open and reading whatever
+ * arrived. Replies for one radio were consumed by another handle, and
+ * two handles sending at once collided on the bus.
+ *
+ * With the "civ_bus" option the handles for the same port share a bus.
+ * The first one to attach hands its file descriptor over to the bus, the
+ * others close theirs. A reader thread owns all the reads:
+ *  - transceive frames are processed at once for the radio that sent them,
+ *  - other frames are queued for the radio found in the source or, for the
+ *    echo of our own commands, the destination address,
+ *  - jammer (0xfc) frames go to the radio currently transmitting.
+ * Transactions take turns in FIFO order, and a frame is only sent once
+ * the bus has been quiet for a few character times.
+ */
+
+#include "hamlib/config.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#ifdef HAVE_SYS_TIME_H
+#include <sys/time.h>
+#endif
+
+#include <pthread.h>
+
+#include "hamlib/rig.h"
+#include "hamlib/port.h"
+#include "iofunc.h"
+#include "serial.h"
+#include "misc.h"
+#include "icom.h"
+#include "icom_defs.h"
+#include "frame.h"
+#include "civ_bus.h"
+
+#define CIV_BUS_MEMBERS_MAX 8
+#define CIV_BUS_QUEUE_LEN 16        /* frames kept for a radio nobody reads */
+#define CIV_BUS_POLL_MS 100         /* how often the reader checks for stop */
+#define CIV_BUS_GAP_CHARS 3         /* quiet time before sending */
+
+struct civ_bus_member
+{
+    struct civ_bus *bus;
+    RIG *rig;
+    unsigned char addr;
+    int head;
+    int count;
+    int frame_len[CIV_BUS_QUEUE_LEN];
+    unsigned char frames[CIV_BUS_QUEUE_LEN][MAXFRAMELEN];
+};
+
+struct civ_bus
+{
+    struct civ_bus *next;
+    hamlib_port_t port;             /* the serial port, owned by the bus */
+    pthread_t thread_id;
+    pthread_mutex_t mutex;
+    pthread_mutex_t dispatch_mutex; /* held while a transceive frame is processed */
+    pthread_cond_t rx_cond;         /* a frame has been queued */
+    pthread_cond_t turn_cond;       /* the transmitter has been released */
+    volatile int run;
+    unsigned int next_ticket;
+    unsigned int now_serving;
+    struct civ_bus_member *active;  /* radio holding the transmitter */
+    struct timeval last_rx;
+    int gap_us;
+    int member_count;
+    struct civ_bus_member *members[CIV_BUS_MEMBERS_MAX];
+};
+
+static pthread_mutex_t civ_bus_list_mutex = PTHREAD_MUTEX_INITIALIZER;
+static struct civ_bus *civ_bus_list;
+
+static struct civ_bus_member *civ_bus_member_of(RIG *rig)
+{
+    const struct icom_priv_data *priv = (struct icom_priv_data *) STATE(rig)->priv;
+
+    return priv->civ_bus;
+}
+
+static struct civ_bus_member *civ_bus_find(struct civ_bus *bus,
+        unsigned char addr)
+{
+    int i;
+
+    for (i = 0; i < bus->member_count; i++)
+    {
+        if (bus->members[i]->addr == addr)
+        {
+            return bus->members[i];
+        }
+    }
+
+    return NULL;
+}
+
+static void civ_bus_route(struct civ_bus *bus, const unsigned char *frame,
+                          int frame_len)
+{
+    struct civ_bus_member *member;
+    int async = 0;
+    int i = 0;
+
+    // the second preamble byte sometimes goes missing
+    while (i < frame_len && frame[i] == PR)
+    {
+        i++;
+    }
+
+    pthread_mutex_lock(&bus->mutex);
+
+    gettimeofday(&bus->last_rx, NULL);
+
+    if (frame[frame_len - 1] == COL || frame_len - i < 4)
+    {
+        member = bus->active;
+    }
+    else
+    {
+        member = civ_bus_find(bus, frame[i + 1]);
+
+        if (member != NULL)
+        {
+            async = icom_is_async_frame(member->rig, frame_len, frame);
+        }
+        else
+        {
+            member = civ_bus_find(bus, frame[i]);
+        }
+    }
+
+    if (member == NULL)
+    {
+        pthread_mutex_unlock(&bus->mutex);
+        rig_debug(RIG_DEBUG_TRACE, "%s: no radio for frame\n", __func__);
+        dump_hex(frame, frame_len);
+        return;
+    }
+
+    if (async)
+    {
+        RIG *rig = member->rig;
+
+        // detaching waits for dispatch_mutex, so rig stays valid
+        pthread_mutex_lock(&bus->dispatch_mutex);
+        pthread_mutex_unlock(&bus->mutex);
+        icom_process_async_frame(rig, frame_len, frame);
+        pthread_mutex_unlock(&bus->dispatch_mutex);
+        return;
+    }
+
+    if (member->count == CIV_BUS_QUEUE_LEN)
+    {
+        rig_debug(RIG_DEBUG_WARN, "%s: queue of CI-V %#x full, dropping oldest\n",
+                  __func__, member->addr);
+        member->head = (member->head + 1) % CIV_BUS_QUEUE_LEN;
+        member->count--;
+    }
+
+    i = (member->head + member->count) % CIV_BUS_QUEUE_LEN;
+    member->frame_len[i] = frame_len < MAXFRAMELEN ? frame_len : MAXFRAMELEN;
+    memcpy(member->frames[i], frame, member->frame_len[i]);
+    member->count++;
+    pthread_cond_broadcast(&bus->rx_cond);
+
+    pthread_mutex_unlock(&bus->mutex);
+}
+
+static void *civ_bus_reader(void *arg)
+{
+    struct civ_bus *bus = (struct civ_bus *) arg;
+    unsigned char frame[MAXFRAMELEN];
+
+    while (bus->run)
+    {
+        int frame_len = read_icom_frame(&bus->port, frame, sizeof(frame));
+
+        if (frame_len == -RIG_ETIMEOUT || frame_len == 0)
+        {
+            continue;
+        }
+
+        if (frame_len < 0)
+        {
+            rig_debug(RIG_DEBUG_WARN, "%s: %s: %s\n", __func__, bus->port.pathname,
+                      rigerror(frame_len));
+            hl_usleep(CIV_BUS_POLL_MS * 1000);
+            continue;
+        }
+
+        civ_bus_route(bus, frame, frame_len);
+    }
+
+    return NULL;
+}
+
+/* Create a bus on the open port of the first radio, civ_bus_list_mutex held */
+static struct civ_bus *civ_bus_create(hamlib_port_t *rp)
+{
+    struct civ_bus *bus;
+    int err;
+
+    bus = calloc(1, sizeof(struct civ_bus));
+
+    if (bus == NULL)
+    {
+        return NULL;
+    }
+
+    bus->port = *rp;
+    bus->port.asyncio = 0;
+    bus->port.timeout = CIV_BUS_POLL_MS;
+    bus->port.timeout_retry = 0;
+    bus->port.retry = 0;
+
+    // 10 bits per character
+    if (rp->parm.serial.rate > 0)
+    {
+        bus->gap_us = CIV_BUS_GAP_CHARS * 10 * 1000000 / rp->parm.serial.rate;
+    }
+
+    if (bus->gap_us < 1000)
+    {
+        bus->gap_us = 1000;
+    }
+
+    pthread_mutex_init(&bus->mutex, NULL);
+    pthread_mutex_init(&bus->dispatch_mutex, NULL);
+    pthread_cond_init(&bus->rx_cond, NULL);
+    pthread_cond_init(&bus->turn_cond, NULL);
+    bus->run = 1;
+
+    err = pthread_create(&bus->thread_id, NULL, civ_bus_reader, bus);
+
+    if (err)
+    {
+        rig_debug(RIG_DEBUG_ERR, "%s: pthread_create error: %s\n", __func__,
+                  strerror(err));
+        pthread_cond_destroy(&bus->turn_cond);
+        pthread_cond_destroy(&bus->rx_cond);
+        pthread_mutex_destroy(&bus->dispatch_mutex);
+        pthread_mutex_destroy(&bus->mutex);
+        free(bus);
+        return NULL;
+    }
+
+    // the bus closes the port when the last radio leaves
+    rp->fd = -1;
+
+    bus->next = civ_bus_list;
+    civ_bus_list = bus;
+
+    return bus;
+}
+
+static void civ_bus_destroy(struct civ_bus *bus)
+{
+    struct civ_bus **link;
+
+    for (link = &civ_bus_list; *link != NULL; link = &(*link)->next)
+    {
+        if (*link == bus)
+        {
+            *link = bus->next;
+            break;
+        }
+    }
+
+    bus->run = 0;
+    pthread_join(bus->thread_id, NULL);
+
+    ser_close(&bus->port);
+
+    pthread_cond_destroy(&bus->turn_cond);
+    pthread_cond_destroy(&bus->rx_cond);
+    pthread_mutex_destroy(&bus->dispatch_mutex);
+    pthread_mutex_destroy(&bus->mutex);
+    free(bus);
+}
+
+/*
+ * Join the bus of the rig's serial port, creating it for the first radio.
+ * Called on the first transaction, with the port open.
+ */
+int civ_bus_attach(RIG *rig)
+{
+    struct rig_state *rs = STATE(rig);
+    struct icom_priv_data *priv = (struct icom_priv_data *) rs->priv;
+    hamlib_port_t *rp = RIGPORT(rig);
+    struct civ_bus_member *member;
+    struct civ_bus *bus;
+
+    ENTERFUNC;
+
+    if (priv->civ_bus != NULL)
+    {
+        RETURNFUNC(RIG_OK);
+    }
+
+    if (rp->type.rig != RIG_PORT_SERIAL || rp->fd < 0)
+    {
+        rig_debug(RIG_DEBUG_ERR, "%s: a CI-V bus needs an open serial port\n",
+                  __func__);
+        RETURNFUNC(-RIG_EINVAL);
+    }
+
+    member = calloc(1, sizeof(struct civ_bus_member));
+
+    if (member == NULL)
+    {
+        RETURNFUNC(-RIG_ENOMEM);
+    }
+
+    member->rig = rig;
+    member->addr = priv->re_civ_addr;
+
+    pthread_mutex_lock(&civ_bus_list_mutex);
+
+    for (bus = civ_bus_list; bus != NULL; bus = bus->next)
+    {
+        if (strcmp(bus->port.pathname, rp->pathname) == 0)
+        {
+            break;
+        }
+    }
+
+    if (bus == NULL)
+    {
+        bus = civ_bus_create(rp);
+
+        if (bus == NULL)
+        {
+            pthread_mutex_unlock(&civ_bus_list_mutex);
+            free(member);
+            RETURNFUNC(-RIG_EINTERNAL);
+        }
+    }
+    else
+    {
+        if (bus->member_count == CIV_BUS_MEMBERS_MAX
+                || civ_bus_find(bus, member->addr) != NULL)
+        {
+            pthread_mutex_unlock(&civ_bus_list_mutex);
+            rig_debug(RIG_DEBUG_ERR, "%s: CI-V %#x already on %s or bus full\n",
+                      __func__, member->addr, rp->pathname);
+            free(member);
+            RETURNFUNC(-RIG_EINVAL);
+        }
+
+        if (bus->port.parm.serial.rate != rp->parm.serial.rate)
+        {
+            rig_debug(RIG_DEBUG_WARN, "%s: %s is used at %d bauds, not %d\n", __func__,
+                      rp->pathname, bus->port.parm.serial.rate, rp->parm.serial.rate);
+        }
+
+        // only the bus reads the port now
+        ser_close(rp);
+    }
+
+    member->bus = bus;
+
+    pthread_mutex_lock(&bus->mutex);
+    bus->members[bus->member_count++] = member;
+    pthread_mutex_unlock(&bus->mutex);
+
+    pthread_mutex_unlock(&civ_bus_list_mutex);
+
+    // generic flushes and reads must leave the bus alone
+    rp->type.rig = RIG_PORT_NONE;
+
+    // the bus reader processes transceive frames
+    rs->async_data_enabled = 0;
+
+    priv->civ_bus = member;
+
+    rig_debug(RIG_DEBUG_VERBOSE, "%s: CI-V %#x attached to %s, %d radio(s)\n",
+              __func__, member->addr, rp->pathname, bus->member_count);
+
+    RETURNFUNC(RIG_OK);
+}
+
+/* Leave the bus, closing the port after the last radio */
+void civ_bus_detach(RIG *rig)
+{
+    struct icom_priv_data *priv = (struct icom_priv_data *) STATE(rig)->priv;
+    struct civ_bus_member *member = priv->civ_bus;
+    struct civ_bus *bus;
+    int i;
+
+    if (member == NULL)
+    {
+        return;
+    }
+
+    bus = member->bus;
+
+    pthread_mutex_lock(&civ_bus_list_mutex);
+    pthread_mutex_lock(&bus->mutex);
+
+    for (i = 0; i < bus->member_count; i++)
+    {
+        if (bus->members[i] == member)
+        {
+            bus->members[i] = bus->members[--bus->member_count];
+            break;
+        }
+    }
+
+    pthread_mutex_unlock(&bus->mutex);
+
+    pthread_mutex_lock(&bus->dispatch_mutex);
+    pthread_mutex_unlock(&bus->dispatch_mutex);
+
+    if (bus->member_count == 0)
+    {
+        civ_bus_destroy(bus);
+    }
+
+    pthread_mutex_unlock(&civ_bus_list_mutex);
+
+    RIGPORT(rig)->type.rig = RIG_PORT_SERIAL;
+    priv->civ_bus = NULL;
+    free(member);
+}
+
+/* Wait for our turn to use the bus, in FIFO order */
+void civ_bus_acquire(RIG *rig)
+{
+    struct civ_bus_member *member = civ_bus_member_of(rig);
+    struct civ_bus *bus;
+    unsigned int ticket;
+
+    if (member == NULL)
+    {
+        return;
+    }
+
+    bus = member->bus;
+
+    pthread_mutex_lock(&bus->mutex);
+
+    ticket = bus->next_ticket++;
+
+    while (ticket != bus->now_serving)
+    {
+        pthread_cond_wait(&bus->turn_cond, &bus->mutex);
+    }
+
+    bus->active = member;
+
+    pthread_mutex_unlock(&bus->mutex);
+}
+
+void civ_bus_release(RIG *rig)
+{
+    struct civ_bus_member *member = civ_bus_member_of(rig);
+    struct civ_bus *bus;
+
+    if (member == NULL)
+    {
+        return;
+    }
+
+    bus = member->bus;
+
+    pthread_mutex_lock(&bus->mutex);
+    bus->active = NULL;
+    bus->now_serving++;
+    pthread_cond_broadcast(&bus->turn_cond);
+    pthread_mutex_unlock(&bus->mutex);
+}
+
+/*
+ * Send a frame once the bus is quiet.
+ * Frames still queued for the radio are stale by now and dropped.
+ */
+int civ_bus_write(RIG *rig, const unsigned char *frame, int frame_len)
+{
+    struct civ_bus_member *member = civ_bus_member_of(rig);
+    struct civ_bus *bus = member->bus;
+
+    for (;;)
+    {
+        struct timeval now, quiet;
+        long quiet_us;
+
+        gettimeofday(&now, NULL);
+
+        pthread_mutex_lock(&bus->mutex);
+        timersub(&now, &bus->last_rx, &quiet);
+        pthread_mutex_unlock(&bus->mutex);
+
+        quiet_us = quiet.tv_sec * 1000000L + quiet.tv_usec;
+
+        if (quiet.tv_sec > 0 || quiet_us >= bus->gap_us)
+        {
+            break;
+        }
+
+        hl_usleep(bus->gap_us - quiet_us);
+    }
+
+    civ_bus_flush(rig);
+
+    return write_block(&bus->port, frame, frame_len);
+}
+
+/*
+ * Next frame received for the radio, waiting up to the rig's timeout.
+ * Returns the frame length like read_icom_frame()
+ */
+int civ_bus_read(RIG *rig, unsigned char *buf, size_t buf_len)
+{
+    struct civ_bus_member *member = civ_bus_member_of(rig);
+    struct civ_bus *bus = member->bus;
+    int timeout_ms = RIGPORT(rig)->timeout;
+    struct timespec deadline;
+    int frame_len;
+
+    memset(buf, 0, buf_len);
+
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_sec += timeout_ms / 1000;
+    deadline.tv_nsec += (long)(timeout_ms % 1000) * 1000000L;
+
+    if (deadline.tv_nsec >= 1000000000L)
+    {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000L;
+    }
+
+    pthread_mutex_lock(&bus->mutex);
+
+    while (member->count == 0)
+    {
+        if (pthread_cond_timedwait(&bus->rx_cond, &bus->mutex,
+                                   &deadline) == ETIMEDOUT)
+        {
+            break;
+        }
+    }
+
+    if (member->count == 0)
+    {
+        pthread_mutex_unlock(&bus->mutex);
+        return -RIG_ETIMEOUT;
+    }
+
+    frame_len = member->frame_len[member->head];
+
+    if ((size_t) frame_len > buf_len)
+    {
+        frame_len = buf_len;
+    }
+
+    memcpy(buf, member->frames[member->head], frame_len);
+    member->head = (member->head + 1) % CIV_BUS_QUEUE_LEN;
+    member->count--;
+
+    pthread_mutex_unlock(&bus->mutex);
+
+    return frame_len;
+}
+
+/* Drop the frames queued for the radio */
+void civ_bus_flush(RIG *rig)
+{
+    struct civ_bus_member *member = civ_bus_member_of(rig);
+    struct civ_bus *bus = member->bus;
+
+    pthread_mutex_lock(&bus->mutex);
+    member->head = 0;
+    member->count = 0;
+    pthread_mutex_unlock(&bus->mutex);
+}
@@ -0,0 +1,45 @@
+/*
+ *  Hamlib CI-V backend - several radios sharing one CI-V bus
+ *  Copyright (c) 2000-2026 The Hamlib Group
+ *
+ *
+ *   This library is free software; you can redistribute it and/or
+ *   modify it under the terms of the GNU Lesser General Public
+ *   License as published by the Free Software Foundation; either
+ *   version 2.1 of the License, or (at your option) any later version.
+ *
+ *   This library is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *   Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public
+ *   License along with this library; if not, write to the Free Software
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+#ifndef _CIV_BUS_H
+#define _CIV_BUS_H 1
+
+#include <stddef.h>
+
+#include "rig.h"
+
+/*
+ * A CI-V bus is shared by all the RIG handles with the "civ_bus" option
+ * set and the same rig_pathname, each with its own CI-V address.
+ * The bus owns the serial port: one reader thread sorts the received
+ * frames into per-radio queues, and the radios take turns to transmit.
+ */
+struct civ_bus;
+
+int civ_bus_attach(RIG *rig);
+void civ_bus_detach(RIG *rig);
+void civ_bus_acquire(RIG *rig);
+void civ_bus_release(RIG *rig);
+int civ_bus_write(RIG *rig, const unsigned char *frame, int frame_len);
+int civ_bus_read(RIG *rig, unsigned char *buf, size_t buf_len);
+void civ_bus_flush(RIG *rig);
+
+#endif /* _CIV_BUS_H */
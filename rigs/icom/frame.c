@@ -34,6 +34,7 @@
 #include "icom.h"
 #include "icom_defs.h"
 #include "frame.h"
+#include "civ_bus.h"
 
 /*
  * Build a CI-V frame.
@@ -113,6 +114,138 @@ int icom_frame_fix_preamble(int frame_len, unsigned char *frame)
     return frame_len;
 }
 
+/*
+ * Port access for icom_one_transaction(), through the shared CI-V bus
+ * when the rig is attached to one
+ */
+static int icom_write_frame(RIG *rig, const unsigned char *frame, int frame_len)
+{
+    const struct icom_priv_data *priv = (struct icom_priv_data *) STATE(rig)->priv;
+
+    if (priv->civ_bus)
+    {
+        return civ_bus_write(rig, frame, frame_len);
+    }
+
+    return write_block(RIGPORT(rig), frame, frame_len);
+}
+
+static int icom_read_frame(RIG *rig, unsigned char *buf, size_t buf_len)
+{
+    const struct icom_priv_data *priv = (struct icom_priv_data *) STATE(rig)->priv;
+
+    if (priv->civ_bus)
+    {
+        return civ_bus_read(rig, buf, buf_len);
+    }
+
+    return read_icom_frame(RIGPORT(rig), buf, buf_len);
+}
+
+enum icom_frame_class
+{
+    ICOM_FRAME_ECHO,    /* what we just sent */
+    ICOM_FRAME_REPLY,   /* our radio answering our command, or a bus problem */
+    ICOM_FRAME_OTHER,   /* transceive data, stale replies, other controllers */
+};
+
+/*
+ * Sort a frame received while waiting for the reply to sendbuf.
+ * Frames the transaction cannot make sense of (collisions, fragments)
+ * count as replies so that the caller reports them.
+ */
+static enum icom_frame_class icom_frame_classify(RIG *rig,
+        const unsigned char *frame, int frame_len,
+        const unsigned char *sendbuf, int send_len, int subcmd)
+{
+    const struct icom_priv_data *priv = (struct icom_priv_data *) STATE(rig)->priv;
+    int i = 0, j = 0;
+
+    // the number of preamble bytes varies, e.g. after a power up 0xfe string
+    while (i < frame_len && frame[i] == PR) { i++; }
+
+    while (j < send_len && sendbuf[j] == PR) { j++; }
+
+    if (frame_len - i == send_len - j
+            && memcmp(frame + i, sendbuf + j, send_len - j) == 0)
+    {
+        return ICOM_FRAME_ECHO;
+    }
+
+    if (frame[frame_len - 1] != FI || frame_len - i < ACKFRMLEN - 2)
+    {
+        return ICOM_FRAME_REPLY;
+    }
+
+    if (icom_is_async_frame(rig, frame_len, frame))
+    {
+        return ICOM_FRAME_OTHER;
+    }
+
+    // addressed from our radio to us
+    if (frame[i + 1] != priv->re_civ_addr || frame[i] != sendbuf[j + 1])
+    {
+        return ICOM_FRAME_OTHER;
+    }
+
+    if (frame[i + 2] == ACK || frame[i + 2] == NAK)
+    {
+        return ICOM_FRAME_REPLY;
+    }
+
+    if (frame[i + 2] != sendbuf[j + 2])
+    {
+        return ICOM_FRAME_OTHER;
+    }
+
+    if (subcmd != -1 && frame_len - i > 4 && frame[i + 3] != sendbuf[j + 3])
+    {
+        return ICOM_FRAME_OTHER;
+    }
+
+    return ICOM_FRAME_REPLY;
+}
+
+static void icom_frame_defer(RIG *rig, const unsigned char *frame,
+                             int frame_len)
+{
+    struct icom_priv_data *priv = (struct icom_priv_data *) STATE(rig)->priv;
+    struct icom_frame_ring *ring = &priv->async_frames;
+    int n;
+
+    if (ring->count == ICOM_FRAME_RING_LEN)
+    {
+        rig_debug(RIG_DEBUG_WARN, "%s: too many frames, dropping oldest\n",
+                  __func__);
+        ring->head = (ring->head + 1) % ICOM_FRAME_RING_LEN;
+        ring->count--;
+    }
+
+    n = (ring->head + ring->count) % ICOM_FRAME_RING_LEN;
+    ring->frame_len[n] = frame_len < MAXFRAMELEN ? frame_len : MAXFRAMELEN;
+    memcpy(ring->frames[n], frame, ring->frame_len[n]);
+    ring->count++;
+}
+
+/* Hand the frames set aside during the transaction to the async processing */
+static void icom_frame_dispatch(RIG *rig)
+{
+    struct icom_priv_data *priv = (struct icom_priv_data *) STATE(rig)->priv;
+    struct icom_frame_ring *ring = &priv->async_frames;
+
+    while (ring->count > 0)
+    {
+        unsigned char frame[MAXFRAMELEN];
+        int frame_len = ring->frame_len[ring->head];
+
+        memcpy(frame, ring->frames[ring->head], frame_len);
+        ring->head = (ring->head + 1) % ICOM_FRAME_RING_LEN;
+        ring->count--;
+
+        icom_process_async_frame(rig, frame_len, frame);
+    }
+}
+
 /*
  * icom_one_transaction
  *
@@ -139,6 +272,8 @@ static int icom_one_transaction(RIG *rig, unsigned char cmd, int subcmd,
     unsigned char buf[200];
     unsigned char sendbuf[MAXFRAMELEN];
     int frm_len, frm_data_len, retval;
+    int send_len;
+    enum icom_frame_class frame_class;
     unsigned char ctrl_id;
     int collision_retry = 0;
 
@@ -156,21 +291,14 @@ static int icom_one_transaction(RIG *rig, unsigned char cmd, int subcmd,
 
 collision_retry:
 
-    // The IC7100 cannot separate the CI-V port from the USB CI-V
-    // We see async packets coming in so we'll try and do the flush
-    // This also means the IC7100 will not support async packets anymore
-    if (rig->caps->rig_model == RIG_MODEL_IC7100)
-    {
-        rig_flush(rp);
-    }
-
     frm_len = make_cmd_frame(sendbuf, priv->re_civ_addr, ctrl_id, cmd,
                              subcmd, payload, payload_len);
+    send_len = frm_len;
 
 
     if (data_len) { *data_len = 0; }
 
-    retval = write_block(rp, sendbuf, frm_len);
+    retval = icom_write_frame(rig, sendbuf, frm_len);
 
     if (retval != RIG_OK)
     {
@@ -191,7 +319,7 @@ collision_retry:
          */
 
 again1:
-        retval = read_icom_frame(rp, buf, sizeof(buf));
+        retval = icom_read_frame(rig, buf, sizeof(buf));
 
         if (retval == -RIG_ETIMEOUT || retval == 0)
         {
@@ -213,25 +341,12 @@ again1:
             RETURNFUNC(-RIG_EPROTO);
         }
 
-        if (icom_is_async_frame(rig, frm_len, buf))
-        {
-            icom_process_async_frame(rig, frm_len, buf);
-            goto again1;
-        }
-
-        // if we get a reply that is not our cmd/subcmd we should just ignore it and retry the read.
-        // this should somewhat allow splitting the COM port between two controllers
-        if (cmd != buf[4])
-        {
-            rig_debug(RIG_DEBUG_VERBOSE, "%s: cmd x%02x != buf x%02x so retry read\n",
-                      __func__, cmd, buf[4]);
-            goto again1;
-        }
-
-        if (subcmd != -1 && subcmd != buf[5])
+        // transceive data and frames of other controllers sharing the port
+        // may arrive before our echo
+        if (icom_frame_classify(rig, buf, retval, sendbuf, send_len,
+                                subcmd) == ICOM_FRAME_OTHER)
         {
-            rig_debug(RIG_DEBUG_VERBOSE, "%s: subcmd x%02x != buf x%02x so retry read\n",
-                      __func__, subcmd, buf[5]);
+            icom_frame_defer(rig, buf, retval);
             goto again1;
         }
 
@@ -313,7 +428,6 @@ again1:
 
     gettimeofday(&start_time, NULL);
 
-read_another_frame:
     /*
      * wait for ACK ...
      * FIXME: handle padding/collisions
@@ -322,7 +436,7 @@ read_another_frame:
     priv->serial_USB_echo_off = 1;
 again2:
     buf[0] = 0;
-    frm_len = read_icom_frame(rp, buf, sizeof(buf));
+    frm_len = icom_read_frame(rig, buf, sizeof(buf));
 
     if (frm_len <= 0)
     {
@@ -330,38 +444,37 @@ again2:
         RETURNFUNC(frm_len);
     }
 
-    if (frm_len > 4 && memcmp(buf, sendbuf, frm_len) == 0)
+    frame_class = icom_frame_classify(rig, buf, frm_len, sendbuf, send_len,
+                                      subcmd);
+
+    if (frame_class == ICOM_FRAME_ECHO)
     {
         priv->serial_USB_echo_off = 0;
         goto again2;
     }
 
     // https://github.com/Hamlib/Hamlib/issues/1575
-    // these types of async can interrupt the cmd we sent
-    // if our host number changes must not be for us
-    if (icom_is_async_frame(rig, frm_len, buf))
+    // transceive data (the IC-7100 has no separate CI-V port for it),
+    // stale replies and e.g. the IC-PW2 talking to the radio are not
+    // our reply; they are processed once the transaction is over
+    if (frame_class == ICOM_FRAME_OTHER)
     {
-        icom_process_async_frame(rig, frm_len, buf);
-        goto again2;
-    }
+        int elapsedms;
 
-    // IC-PW2 was sending fe fe 94 aa 1c 03
-    if (buf[3] == 0xaa || buf[2] == 0xaa)
-    {
-        goto again2;
-    }
+        icom_frame_defer(rig, buf, frm_len);
 
-    if (sendbuf[3] != buf[2])
-    {
-        rig_debug(RIG_DEBUG_VERBOSE, "%s: unknown async?  read again\n", __func__);
-        hl_usleep(100);
-        rig_flush(rp);
-        collision_retry++;
+        gettimeofday(&current_time, NULL);
+        timersub(&current_time, &start_time, &elapsed_time);
+
+        elapsedms = (int)(elapsed_time.tv_sec * 1000 + elapsed_time.tv_usec / 1000);
 
-        if (collision_retry < 2)
+        if (elapsedms > rp->timeout)
         {
-            goto collision_retry;
+            set_transaction_inactive(rig);
+            RETURNFUNC(-RIG_ETIMEOUT);
         }
+
+        goto again2;
     }
 
 
@@ -470,26 +583,6 @@ again2:
         RETURNFUNC(-RIG_EPROTO);
     }
 
-    // TODO: Does ctrlid (detected by icom_is_async_frame) vary (seeing some code above using 0x80 for non-full-duplex)?
-    if (icom_is_async_frame(rig, frm_len, buf))
-    {
-        int elapsedms;
-        icom_process_async_frame(rig, frm_len, buf);
-
-        gettimeofday(&current_time, NULL);
-        timersub(&current_time, &start_time, &elapsed_time);
-
-        elapsedms = (int)(elapsed_time.tv_sec * 1000 + elapsed_time.tv_usec / 1000);
-
-        if (elapsedms > rp->timeout)
-        {
-            set_transaction_inactive(rig);
-            RETURNFUNC(-RIG_ETIMEOUT);
-        }
-
-        goto read_another_frame;
-    }
-
     set_transaction_inactive(rig);
 
     *data_len = frm_data_len;
@@ -520,6 +613,7 @@ int icom_transaction(RIG *rig, int cmd, int subcmd,
                      const unsigned char *payload, int payload_len, unsigned char *data,
                      int *data_len)
 {
+    struct icom_priv_data *priv = (struct icom_priv_data *) STATE(rig)->priv;
     int retval, retry;
 
     ENTERFUNC;
@@ -527,12 +621,28 @@ int icom_transaction(RIG *rig, int cmd, int subcmd,
               "%s: cmd=0x%02x, subcmd=0x%02x, payload_len=%d\n", __func__,
               cmd, subcmd, payload_len);
 
+    // rig_open() may talk to the rig before icom_rig_open()
+    if (priv->civ_bus_enabled && priv->civ_bus == NULL)
+    {
+        retval = civ_bus_attach(rig);
+
+        if (retval != RIG_OK)
+        {
+            RETURNFUNC(retval);
+        }
+    }
+
     retry = RIGPORT(rig)->retry;
 
     do
     {
+        // other radios on the bus wait until we have our reply
+        civ_bus_acquire(rig);
         retval = icom_one_transaction(rig, cmd, subcmd, payload, payload_len, data,
                                       data_len);
+        civ_bus_release(rig);
+
+        icom_frame_dispatch(rig);
 
         // codes that make us return immediately
         if (retval == RIG_OK || retval == -RIG_ERJCTED || retval == -RIG_BUSERROR)
@@ -556,6 +666,163 @@ int icom_transaction(RIG *rig, int cmd, int subcmd,
     RETURNFUNC(retval);
 }
 
+/*
+ * icom_transaction_pipe
+ *
+ * Send cmd/subcmd once per request with up to window of them outstanding,
+ * for links that carry both directions at once (USB, LAN). The rig
+ * answers in order, so a reply, ACK or NAK goes to the oldest outstanding
+ * request. A reply is checked against that request by the payload the
+ * rig repeats after cmd/subcmd, e.g. the channel number of 0x1a 0x00.
+ * Each request gets its own retval. Returns RIG_OK, or the write error
+ * that stopped the transaction.
+ */
+int icom_transaction_pipe(RIG *rig, int cmd, int subcmd,
+                          struct icom_pipe_req *reqs, int count, int window)
+{
+    struct icom_priv_data *priv = (struct icom_priv_data *) STATE(rig)->priv;
+    const struct icom_priv_caps *priv_caps = (struct icom_priv_caps *)
+            rig->caps->priv;
+    unsigned char buf[200];
+    unsigned char sendbuf[MAXFRAMELEN];
+    unsigned char ctrl_id;
+    int head = subcmd == -1 ? 3 : 4;
+    int sent = 0, oldest = 0;
+    int retval = RIG_OK;
+    int i;
+
+    ENTERFUNC;
+    rig_debug(RIG_DEBUG_VERBOSE, "%s: cmd=0x%02x, subcmd=0x%02x, count=%d, window=%d\n",
+              __func__, cmd, subcmd, count, window);
+
+    if (priv->civ_bus_enabled && priv->civ_bus == NULL)
+    {
+        retval = civ_bus_attach(rig);
+
+        if (retval != RIG_OK)
+        {
+            RETURNFUNC(retval);
+        }
+    }
+
+    if (window < 1) { window = 1; }
+
+    ctrl_id = priv_caps->serial_full_duplex == 0 ? CTRLID : 0x80;
+
+    for (i = 0; i < count; i++)
+    {
+        reqs[i].data_len = 0;
+        reqs[i].retval = -RIG_ETIMEOUT;
+    }
+
+    civ_bus_acquire(rig);
+    set_transaction_active(rig);
+
+    while (oldest < count)
+    {
+        int frm_len, j;
+
+        // keep the window full
+        while (sent < count && sent - oldest < window)
+        {
+            int send_len = make_cmd_frame(sendbuf, priv->re_civ_addr, ctrl_id, cmd,
+                                              subcmd, reqs[sent].payload, reqs[sent].payload_len);
+
+            retval = icom_write_frame(rig, sendbuf, send_len);
+
+            if (retval != RIG_OK) { break; }
+
+            sent++;
+        }
+
+        if (retval != RIG_OK)
+        {
+            for (i = 0; i < count; i++)
+            {
+                if (reqs[i].retval == -RIG_ETIMEOUT) { reqs[i].retval = retval; }
+            }
+
+            break;
+        }
+
+        frm_len = icom_read_frame(rig, buf, sizeof(buf));
+
+        if (frm_len <= 0)
+        {
+            // the unanswered requests keep -RIG_ETIMEOUT
+            rig_debug(RIG_DEBUG_WARN, "%s: %d of %d requests unanswered\n", __func__,
+                      count - oldest, count);
+            break;
+        }
+
+        frm_len = icom_frame_fix_preamble(frm_len, buf);
+
+        if (frm_len < ACKFRMLEN || buf[frm_len - 1] != FI)
+        {
+            rig_debug(RIG_DEBUG_WARN, "%s: dropping malformed frame\n", __func__);
+            continue;
+        }
+
+        for (i = 0; i < frm_len && buf[i] == PR; i++) { }
+
+        // our own requests, echoed on the link
+        if (buf[i] == priv->re_civ_addr && buf[i + 1] == ctrl_id)
+        {
+            continue;
+        }
+
+        if (icom_is_async_frame(rig, frm_len, buf)
+                || buf[i + 1] != priv->re_civ_addr || buf[i] != ctrl_id)
+        {
+            icom_frame_defer(rig, buf, frm_len);
+            continue;
+        }
+
+        if (buf[i + 2] == NAK || buf[i + 2] == ACK)
+        {
+            reqs[oldest].retval = buf[i + 2] == NAK ? -RIG_ERJCTED : RIG_OK;
+            oldest++;
+            continue;
+        }
+
+        // a reply to a later request means those before it were lost, they
+        // keep -RIG_ETIMEOUT
+        for (j = oldest; j < sent; j++)
+        {
+            if (buf[i + 2] == cmd
+                    && (subcmd == -1 || buf[i + 3] == subcmd)
+                    && frm_len - i - 1 >= head + reqs[j].payload_len
+                    && memcmp(buf + i + head, reqs[j].payload, reqs[j].payload_len) == 0)
+            {
+                break;
+            }
+        }
+
+        if (j == sent)
+        {
+            icom_frame_defer(rig, buf, frm_len);
+            continue;
+        }
+
+        if (j > oldest)
+        {
+            rig_debug(RIG_DEBUG_WARN, "%s: %d replies lost\n", __func__, j - oldest);
+        }
+
+        reqs[j].data_len = frm_len - i - 3;
+        memcpy(reqs[j].data, buf + i + 2, reqs[j].data_len);
+        reqs[j].retval = RIG_OK;
+        oldest = j + 1;
+    }
+
+    set_transaction_inactive(rig);
+    civ_bus_release(rig);
+
+    icom_frame_dispatch(rig);
+
+    RETURNFUNC(retval);
+}
+
 /* used in read_icom_frame as end of block */
 static const char icom_block_end[2] = { FI, COL};
 #define icom_block_end_length 2
@@ -29,6 +29,35 @@
 // Has to be big enough for 0xfe sequence to wake up rig
 #define MAXFRAMELEN 200
 
+#define ICOM_FRAME_RING_LEN 16
+
+/*
+ * Frames received during a transaction that are not its reply,
+ * e.g. transceive data, kept until the transaction is over
+ */
+struct icom_frame_ring
+{
+    int head;
+    int count;
+    int frame_len[ICOM_FRAME_RING_LEN];
+    unsigned char frames[ICOM_FRAME_RING_LEN][MAXFRAMELEN];
+};
+
+#define ICOM_PIPE_PAYLOAD_MAX 8
+
+/*
+ * One request of icom_transaction_pipe(): the payload sent after cmd and
+ * subcmd, and its reply data the way icom_transaction() returns it
+ */
+struct icom_pipe_req
+{
+    unsigned char payload[ICOM_PIPE_PAYLOAD_MAX];
+    int payload_len;
+    unsigned char data[MAXFRAMELEN];
+    int data_len;
+    int retval;     /* RIG_OK, -RIG_ERJCTED on NAK, -RIG_ETIMEOUT if unanswered */
+};
+
 /*
  * helper functions
  */
@@ -38,6 +67,7 @@ int make_cmd_frame(unsigned char frame[], unsigned char re_id, unsigned char ctr
 int icom_frame_fix_preamble(int frame_len, unsigned char *frame);
 
 int icom_transaction (RIG *rig, int cmd, int subcmd, const unsigned char *payload, int payload_len, unsigned char *data, int *data_len);
+int icom_transaction_pipe(RIG *rig, int cmd, int subcmd, struct icom_pipe_req *reqs, int count, int window);
 int read_icom_frame(hamlib_port_t *p, const unsigned char rxbuffer[], size_t rxbuffer_len);
 int read_icom_frame_direct(hamlib_port_t *p, const unsigned char rxbuffer[], size_t rxbuffer_len);
 
@@ -1133,6 +1133,7 @@ struct rig_caps ic7300_caps =
     .get_split_mode =  icom_get_split_mode,
     .set_split_vfo =  icom_set_split_vfo,
     .get_split_vfo =  icom_get_split_vfo,
+    .get_vfo_snapshot =  icom_get_vfo_snapshot,
     .set_powerstat = icom_set_powerstat,
     .get_powerstat = icom_get_powerstat,
     .power2mW = icom_power2mW,
@@ -1384,6 +1385,7 @@ struct rig_caps ic7300mk2_caps =
     .get_split_mode =  icom_get_split_mode,
     .set_split_vfo =  icom_set_split_vfo,
     .get_split_vfo =  icom_get_split_vfo,
+    .get_vfo_snapshot =  icom_get_vfo_snapshot,
     .set_powerstat = icom_set_powerstat,
     .get_powerstat = icom_get_powerstat,
     .power2mW = icom_power2mW,
@@ -1995,6 +1997,7 @@ struct rig_caps ic705_caps =
     .get_split_mode =  icom_get_split_mode,
     .set_split_vfo =  icom_set_split_vfo,
     .get_split_vfo =  icom_get_split_vfo,
+    .get_vfo_snapshot =  icom_get_vfo_snapshot,
     .set_powerstat = icom_set_powerstat,
 //    .get_powerstat = icom_get_powerstat, // powerstat is write only
     .power2mW = icom_power2mW,
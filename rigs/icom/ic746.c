@@ -150,6 +150,8 @@ static int ic746_set_parm(RIG *rig, setting_t parm, value_t val);
 static int ic746_get_parm(RIG *rig, setting_t parm, value_t *val);
 static int ic746pro_get_channel(RIG *rig, vfo_t vfo, channel_t *chan,
                                 int read_only);
+static int ic746pro_get_chan_all_cb(RIG *rig, vfo_t vfo, chan_cb_t chan_cb,
+                                    rig_ptr_t arg);
 static int ic746pro_set_channel(RIG *rig, vfo_t vfo, const channel_t *chan);
 static int ic746pro_set_ext_parm(RIG *rig, hamlib_token_t token, value_t val);
 static int ic746pro_get_ext_parm(RIG *rig, hamlib_token_t token, value_t *val);
@@ -420,7 +422,7 @@ struct rig_caps ic746pro_caps =
     RIG_MODEL(RIG_MODEL_IC746PRO),
     .model_name = "IC-746PRO",
     .mfg_name =  "Icom",
-    .version =  BACKEND_VER ".3",
+    .version =  BACKEND_VER ".4",
     .copyright =  "LGPL",
     .status =  RIG_STATUS_STABLE,
     .rig_type =  RIG_TYPE_TRANSCEIVER,
@@ -600,6 +602,7 @@ struct rig_caps ic746pro_caps =
     .get_ext_parm =  ic746pro_get_ext_parm,
     .get_channel = ic746pro_get_channel,
     .set_channel = ic746pro_set_channel,
+    .get_chan_all_cb = ic746pro_get_chan_all_cb,
     .hamlib_check_rig_caps = HAMLIB_CHECK_RIG_CAPS
 };
 
@@ -921,34 +924,56 @@ int ic746_get_parm(RIG *rig, setting_t parm, value_t *val)
 }
 
 /*
- * ic746pro_get_channel
- * Assumes rig!=NULL, STATE(rig)->priv!=NULL, chan!=NULL
- *
- * If memory is empty it will return RIG_OK,but every thing will be null. Where do we boundary check?
+ * Duplex offset of the band of freq. It is the band default, not part of
+ * the channel memory, and is read from the rig once per offs[] entry left
+ * at -1.
  */
-int ic746pro_get_channel(RIG *rig, vfo_t vfo, channel_t *chan, int read_only)
+static int ic746pro_get_rptr_offs(RIG *rig, freq_t freq, shortfreq_t offs[3],
+                                  shortfreq_t *rptr_offs)
 {
-    struct icom_priv_data *priv;
-    struct rig_state *rs;
-    unsigned char chanbuf[MAXFRAMELEN];
-    int chan_len, freq_len, retval, data_len;
+    unsigned char databuf[32];
+    int band, sc, n, data_len, retval;
 
-    rs = STATE(rig);
-    priv = (struct icom_priv_data *)rs->priv;
+    band = (int) freq / 1000000;  /* hf, 2m or 6 m */
 
-    to_bcd_be(chanbuf, chan->channel_num, 4);
-    chan_len = 2;
+    if (band < 50) { sc = S_MEM_HF_DUP_OFST; n = 0; }
+    else if (band < 108) { sc = S_MEM_6M_DUP_OFST; n = 1; }
+    else { sc = S_MEM_2M_DUP_OFST; n = 2; }
 
-    freq_len = priv->civ_731_mode ? 4 : 5;
+    if (offs[n] < 0)
+    {
+        retval = icom_transaction(rig, C_CTL_MEM, sc,
+                                  NULL, 0, databuf, &data_len);
 
-    retval = icom_transaction(rig, C_CTL_MEM, S_MEM_CNTNT,
-                              chanbuf, chan_len, chanbuf, &chan_len);
+        if (retval != RIG_OK)
+        {
+            return retval;
+        }
 
-    if (retval != RIG_OK)
-    {
-        return retval;
+        offs[n] = from_bcd(databuf + 3, 6) * 100;
     }
 
+    *rptr_offs = offs[n];
+
+    return RIG_OK;
+}
+
+/*
+ * ic746pro_decode_channel
+ * Fills chan from the reply to 0x1a 0x00, decode_arg being the
+ * shortfreq_t[3] of ic746pro_get_rptr_offs()
+ *
+ * If memory is empty it will return RIG_OK,but every thing will be null. Where do we boundary check?
+ */
+static int ic746pro_decode_channel(RIG *rig, channel_t *chan,
+                                   const unsigned char *chanbuf, int chan_len, rig_ptr_t decode_arg)
+{
+    const struct icom_priv_data *priv = (struct icom_priv_data *) STATE(rig)->priv;
+    shortfreq_t *offs = (shortfreq_t *) decode_arg;
+    int freq_len, retval;
+
+    freq_len = priv->civ_731_mode ? 4 : 5;
+
     chan->vfo = RIG_VFO_MEM;
     chan->ant = RIG_ANT_NONE;
     chan->freq = 0;
@@ -1005,12 +1030,9 @@ int ic746pro_get_channel(RIG *rig, vfo_t vfo, channel_t *chan, int read_only)
     /* do this only if not a blank channel */
     if (chan_len != 1)
     {
-        int band;
-        int sc;
-        unsigned char databuf[32];
-        mem_buf_t *membuf;
+        const mem_buf_t *membuf;
 
-        membuf = (mem_buf_t *)(chanbuf + 4);
+        membuf = (const mem_buf_t *)(chanbuf + 4);
 
         chan->split = (membuf->chan_flag & 0x10) ? RIG_SPLIT_ON : RIG_SPLIT_OFF;
         chan->flags = (membuf->chan_flag & 0x01) ? RIG_CHFLAG_SKIP : RIG_CHFLAG_NONE;
@@ -1036,21 +1058,13 @@ int ic746pro_get_channel(RIG *rig, vfo_t vfo, channel_t *chan, int read_only)
 
         /* offset is default for the band & is not stored in channel memory.
            The following retrieves the system default for the band */
-        band = (int) chan->freq / 1000000;  /* hf, 2m or 6 m */
-
-        if (band < 50) { sc = S_MEM_HF_DUP_OFST; }
-        else if (band < 108) { sc = S_MEM_6M_DUP_OFST; }
-        else { sc = S_MEM_2M_DUP_OFST; }
-
-        retval = icom_transaction(rig, C_CTL_MEM, sc,
-                                  NULL, 0, databuf, &data_len);
+        retval = ic746pro_get_rptr_offs(rig, chan->freq, offs, &chan->rptr_offs);
 
         if (retval != RIG_OK)
         {
             return retval;
         }
 
-        chan->rptr_offs = from_bcd(databuf + 3, 6) * 100;
         rig_debug(RIG_DEBUG_TRACE, "%s: chan->rptr_offs=%d\n", __func__,
                   (int)chan->rptr_offs);
 
@@ -1075,6 +1089,37 @@ int ic746pro_get_channel(RIG *rig, vfo_t vfo, channel_t *chan, int read_only)
                   chan->channel_desc);
     }
 
+    return RIG_OK;
+}
+
+/*
+ * ic746pro_get_channel
+ * Assumes rig!=NULL, STATE(rig)->priv!=NULL, chan!=NULL
+ */
+int ic746pro_get_channel(RIG *rig, vfo_t vfo, channel_t *chan, int read_only)
+{
+    unsigned char chanbuf[MAXFRAMELEN];
+    shortfreq_t offs[3] = { -1, -1, -1 };
+    int chan_len, retval;
+
+    to_bcd_be(chanbuf, chan->channel_num, 4);
+    chan_len = 2;
+
+    retval = icom_transaction(rig, C_CTL_MEM, S_MEM_CNTNT,
+                              chanbuf, chan_len, chanbuf, &chan_len);
+
+    if (retval != RIG_OK)
+    {
+        return retval;
+    }
+
+    retval = ic746pro_decode_channel(rig, chan, chanbuf, chan_len, offs);
+
+    if (retval != RIG_OK)
+    {
+        return retval;
+    }
+
     if (!read_only)
     {
         // Set rig to channel values
@@ -1088,6 +1133,19 @@ int ic746pro_get_channel(RIG *rig, vfo_t vfo, channel_t *chan, int read_only)
     return RIG_OK;
 }
 
+/*
+ * ic746pro_get_chan_all_cb
+ * Pipelined memory readout, the band offsets read once for all channels
+ */
+int ic746pro_get_chan_all_cb(RIG *rig, vfo_t vfo, chan_cb_t chan_cb,
+                             rig_ptr_t arg)
+{
+    shortfreq_t offs[3] = { -1, -1, -1 };
+
+    return icom_get_chan_all_cb_pipe(rig, vfo, chan_cb, arg,
+                                     ic746pro_decode_channel, offs);
+}
+
 /*
  * ic746pro_set_channel
  * Assumes rig!=NULL, STATE(rig)->priv!=NULL, chan!=NULL
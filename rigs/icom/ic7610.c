@@ -612,6 +612,7 @@ struct rig_caps ic7610_caps =
     .get_split_mode =  icom_get_split_mode,
     .set_split_vfo =  icom_set_split_vfo,
     .get_split_vfo =  icom_get_split_vfo,
+    .get_vfo_snapshot =  icom_get_vfo_snapshot,
     .set_powerstat = icom_set_powerstat,
     .get_powerstat = icom_get_powerstat,
     .send_morse = icom_send_morse,
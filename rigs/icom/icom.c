@@ -38,6 +38,7 @@
 #include "icom.h"
 #include "icom_defs.h"
 #include "frame.h"
+#include "civ_bus.h"
 #include "misc.h"
 #include "event.h"
 #include "cache.h"
@@ -490,6 +491,7 @@ struct icom_addr
 #define TOK_FILTER_USB TOKEN_BACKEND(6)
 #define TOK_FILTER_CW TOKEN_BACKEND(7)
 #define TOK_FILTER_FM TOKEN_BACKEND(8)
+#define TOK_CIV_BUS TOKEN_BACKEND(9)
 
 const struct confparams icom_cfg_params[] =
 {
@@ -528,6 +530,11 @@ const struct confparams icom_cfg_params[] =
         TOK_FILTER_FM, "filter_fm", "Filter to use FM", "Filter to use for FM/PKTFM when setting mode",
         "1", RIG_CONF_NUMERIC, {.n = {0, 3, 1}}
     },
+    {
+        TOK_CIV_BUS, "civ_bus", "Shared CI-V bus",
+        "Share rig_pathname with the other radios on the CI-V bus, each with its own civaddr",
+        "0", RIG_CONF_CHECKBUTTON
+    },
     {RIG_CONF_END, NULL,}
 };
 
@@ -791,6 +798,8 @@ int icom_cleanup(RIG *rig)
 
     priv = STATE(rig)->priv;
 
+    civ_bus_detach(rig);
+
     for (i = 0; rig->caps->spectrum_scopes[i].name != NULL; i++)
     {
         if (priv->spectrum_scope_cache[i].spectrum_data)
@@ -841,7 +850,15 @@ static int icom_get_usb_echo_off(RIG *rig)
         priv->serial_USB_echo_off = 0;
         // we should have a freq response so we'll read it and don't really care
         // flushing doesn't always work as it depends on timing
-        retval = read_icom_frame(RIGPORT(rig), buf, sizeof(buf));
+        if (priv->civ_bus)
+        {
+            retval = civ_bus_read(rig, buf, sizeof(buf));
+        }
+        else
+        {
+            retval = read_icom_frame(RIGPORT(rig), buf, sizeof(buf));
+        }
+
         rig_debug(RIG_DEBUG_VERBOSE, "%s: USB echo on detected, get freq retval=%d\n",
                   __func__, retval);
 
@@ -1160,6 +1177,17 @@ int icom_rig_open(RIG *rig)
 
     rp->retry = 0;
 
+    if (priv->civ_bus_enabled)
+    {
+        retval = civ_bus_attach(rig);
+
+        if (retval != RIG_OK)
+        {
+            rp->retry = retry_save;
+            RETURNFUNC(retval);
+        }
+    }
+
     priv->no_1a_03_cmd = ENUM_1A_03_UNK;
 
     rig_debug(RIG_DEBUG_VERBOSE, "%s: %s v%s\n", __func__, rig->caps->model_name,
@@ -1312,7 +1340,11 @@ int icom_rig_close(RIG *rig)
 
     ENTERFUNC;
 
-    if (priv->poweron == 0) { RETURNFUNC(RIG_OK); } // nothing to do
+    if (priv->poweron == 0)
+    {
+        civ_bus_detach(rig);
+        RETURNFUNC(RIG_OK);  // nothing to do
+    }
 
     if (priv->poweron == 1 && rs->auto_power_off)
     {
@@ -1329,11 +1361,14 @@ int icom_rig_close(RIG *rig)
 
             rig_debug(RIG_DEBUG_WARN, "%s: rig_set_powerstat failed: =%s\n", __func__,
                       rigerror(retval));
+            civ_bus_detach(rig);
             RETURNFUNC(retval);
         }
 
     }
 
+    civ_bus_detach(rig);
+
     RETURNFUNC(RIG_OK);
 }
 
@@ -5379,6 +5414,10 @@ int icom_set_conf(RIG *rig, hamlib_token_t token, const char *val)
 
         break;
 
+    case TOK_CIV_BUS:
+        priv->civ_bus_enabled = atoi(val) ? 1 : 0;
+        break;
+
     default:
         RETURNFUNC(-RIG_EINVAL);
     }
@@ -5412,6 +5451,9 @@ static int icom_get_conf2(RIG *rig, hamlib_token_t token, char *val, int val_len
     case TOK_NOXCHG: SNPRINTF(val, val_len, "%d", priv->no_xchg);
         break;
 
+    case TOK_CIV_BUS: SNPRINTF(val, val_len, "%d", priv->civ_bus_enabled);
+        break;
+
     default: RETURNFUNC(-RIG_EINVAL);
     }
 
@@ -6842,6 +6884,74 @@ int icom_set_split_vfo(RIG *rig, vfo_t rx_vfo, split_t split, vfo_t tx_vfo)
  * Does not appear to be supported by any mode?
  * \sa icom_mem_get_split_vfo()
  */
+/*
+ * icom_get_vfo_snapshot
+ * 0x25 and 0x26 read the selected and unselected VFO directly, so the
+ * snapshot costs one command per value and no VFO swap. Rigs not known
+ * to support them are left to the frontend.
+ */
+int icom_get_vfo_snapshot(RIG *rig, struct rig_vfo_snapshot *snapshot)
+{
+    struct rig_state *rs = STATE(rig);
+    const struct icom_priv_data *priv = (struct icom_priv_data *) rs->priv;
+    const struct icom_priv_caps *priv_caps = rig->caps->priv;
+    int retval;
+    int i;
+
+    ENTERFUNC;
+
+    if (!(rs->targetable_vfo & RIG_TARGETABLE_FREQ)
+            || !(rs->targetable_vfo & RIG_TARGETABLE_MODE)
+            || ((priv->x25cmdfails != 0 || priv->x26cmdfails != 0)
+                && !priv_caps->x25x26_always))
+    {
+        RETURNFUNC(-RIG_ENAVAIL);
+    }
+
+    for (i = 0; i < 2; i++)
+    {
+        vfo_t vfo = snapshot->vfos[i].vfo;
+
+        // the Sub receiver of Main/Sub + A/B rigs is not reachable with 0x25
+        if (VFO_HAS_MAIN_SUB_A_B_ONLY && (vfo == RIG_VFO_SUB || vfo == RIG_VFO_SUB_A
+                                          || vfo == RIG_VFO_SUB_B))
+        {
+            RETURNFUNC(-RIG_ENAVAIL);
+        }
+    }
+
+    for (i = 0; i < 2; i++)
+    {
+        struct rig_vfo_snapshot_entry *entry = &snapshot->vfos[i];
+
+        retval = icom_get_freq(rig, entry->vfo, &entry->freq);
+
+        if (retval != RIG_OK)
+        {
+            RETURNFUNC(retval);
+        }
+
+        retval = icom_get_mode(rig, entry->vfo, &entry->mode, &entry->width);
+
+        if (retval != RIG_OK)
+        {
+            RETURNFUNC(retval);
+        }
+    }
+
+    retval = icom_get_split_vfo(rig, RIG_VFO_CURR, &snapshot->split,
+                                &snapshot->tx_vfo);
+
+    if (retval != RIG_OK)
+    {
+        RETURNFUNC(retval);
+    }
+
+    retval = icom_get_ptt(rig, RIG_VFO_CURR, &snapshot->ptt);
+
+    RETURNFUNC(retval);
+}
+
 int icom_get_split_vfo(RIG *rig, vfo_t rx_vfo, split_t *split, vfo_t *tx_vfo)
 {
     unsigned char splitbuf[MAXFRAMELEN];
@@ -8187,8 +8297,17 @@ int icom_set_powerstat(RIG *rig, powerstat_t status)
         }
 
         memset(fe_buf, 0xfe, fe_max);
+
         // sending more than enough 0xfe's to wake up the rs232
-        write_block(rp, fe_buf, fe_max);
+        if (priv->civ_bus)
+        {
+            civ_bus_write(rig, fe_buf, fe_max);
+        }
+        else
+        {
+            write_block(rp, fe_buf, fe_max);
+        }
+
         // need to wait a bit for RigPI and others to queue the echo
         hl_usleep(400 * 1000);
 
@@ -8457,6 +8576,139 @@ int icom_set_mem(RIG *rig, vfo_t vfo, int ch)
     RETURNFUNC(RIG_OK);
 }
 
+/*
+ * Memory content requests outstanding at once when the link is full
+ * duplex, and channels read per pipelined transaction
+ */
+#define ICOM_PIPE_WINDOW 4
+#define ICOM_PIPE_BLOCK 16
+
+/*
+ * On a CI-V bus proper our requests would collide with the replies: only
+ * links without echo (USB, LAN) or with separate RXD and TXD get a window
+ */
+static int icom_pipe_window(RIG *rig)
+{
+    const struct icom_priv_data *priv = (struct icom_priv_data *) STATE(rig)->priv;
+    const struct icom_priv_caps *priv_caps = (struct icom_priv_caps *)
+            rig->caps->priv;
+    const hamlib_port_t *rp = RIGPORT(rig);
+
+    if (priv->civ_bus_enabled)
+    {
+        return 1;
+    }
+
+    if (priv_caps->serial_full_duplex || priv->serial_USB_echo_off
+            || rp->type.rig == RIG_PORT_NETWORK || rp->type.rig == RIG_PORT_UDP_NETWORK)
+    {
+        return ICOM_PIPE_WINDOW;
+    }
+
+    return 1;
+}
+
+/*
+ * icom_get_chan_all_cb_pipe
+ * get_chan_all_cb for backends that decode 0x1a 0x00: the channels of
+ * chan_list are read ICOM_PIPE_BLOCK at a time through
+ * icom_transaction_pipe(), decoded in channel order and handed to chan_cb
+ * the way get_chan_all_cb_generic() does. A channel whose reply got lost
+ * is read once more on its own with get_channel.
+ * Assumes rig!=NULL, STATE(rig)->priv!=NULL
+ */
+int icom_get_chan_all_cb_pipe(RIG *rig, vfo_t vfo, chan_cb_t chan_cb,
+                              rig_ptr_t arg, icom_mem_decode_t decode, rig_ptr_t decode_arg)
+{
+    chan_t *chan_list = STATE(rig)->chan_list;
+    struct icom_pipe_req *reqs;
+    int window = icom_pipe_window(rig);
+    int retval = RIG_OK;
+    int i;
+
+    ENTERFUNC;
+
+    reqs = calloc(ICOM_PIPE_BLOCK, sizeof(*reqs));
+
+    if (reqs == NULL)
+    {
+        RETURNFUNC(-RIG_ENOMEM);
+    }
+
+    for (i = 0; i < HAMLIB_CHANLSTSIZ && !RIG_IS_CHAN_END(chan_list[i])
+            && retval == RIG_OK; i++)
+    {
+        channel_t *chan = NULL;
+        int first, count, j;
+
+        // the application provides the struct the channel goes into
+        retval = chan_cb(rig, vfo, &chan, chan_list[i].startc, chan_list, arg);
+
+        if (retval == RIG_OK && chan == NULL)
+        {
+            retval = -RIG_ENOMEM;
+        }
+
+        for (first = chan_list[i].startc; retval == RIG_OK
+                && first <= chan_list[i].endc; first += count)
+        {
+            count = chan_list[i].endc - first + 1;
+
+            if (count > ICOM_PIPE_BLOCK) { count = ICOM_PIPE_BLOCK; }
+
+            for (j = 0; j < count; j++)
+            {
+                to_bcd_be(reqs[j].payload, first + j, 4);
+                reqs[j].payload_len = 2;
+            }
+
+            retval = icom_transaction_pipe(rig, C_CTL_MEM, S_MEM_CNTNT, reqs, count,
+                                           window);
+
+            for (j = 0; retval == RIG_OK && j < count; j++)
+            {
+                int ch = first + j;
+
+                chan->vfo = RIG_VFO_MEM;
+                chan->channel_num = ch;
+
+                if (reqs[j].retval == RIG_OK)
+                {
+                    retval = decode(rig, chan, reqs[j].data, reqs[j].data_len, decode_arg);
+                }
+                else if (reqs[j].retval == -RIG_ETIMEOUT)
+                {
+                    rig_debug(RIG_DEBUG_WARN, "%s: channel %d again on its own\n", __func__, ch);
+                    retval = rig->caps->get_channel(rig, vfo, chan, 1);
+                }
+                else
+                {
+                    retval = reqs[j].retval;
+                }
+
+                if (retval == -RIG_ENAVAIL)
+                {
+                    // empty channel
+                    retval = RIG_OK;
+                    continue;
+                }
+
+                if (retval != RIG_OK)
+                {
+                    break;
+                }
+
+                chan_cb(rig, vfo, &chan, ch < chan_list[i].endc ? ch + 1 : ch, chan_list,
+                        arg);
+            }
+        }
+    }
+
+    free(reqs);
+
+    RETURNFUNC(retval);
+}
+
 /*
  * icom_set_bank
  * Assumes rig!=NULL, STATE(rig)->priv!=NULL
@@ -31,6 +31,7 @@
 #include "cal.h"
 #include "tones.h"
 #include "idx_builtin.h"
+#include "frame.h"
 
 #ifdef HAVE_SYS_TIME_H
 #include <sys/time.h>
@@ -299,6 +300,9 @@ struct icom_priv_data
     int filter_usb;          /*!< Filter number to use for USB/LSB when setting mode */
     int filter_cw;           /*!< Filter number to use for CW/CWR when setting mode */
     int filter_fm;           /*!< Filter number to use for CW/CWR when setting mode */
+    int civ_bus_enabled;     /*!< Share the serial port with the other radios on the CI-V bus */
+    struct civ_bus_member *civ_bus; /*!< Our place on the shared CI-V bus, NULL when the port is ours */
+    struct icom_frame_ring async_frames; /*!< Frames to hand to icom_process_async_frame() after the transaction */
 };
 
 extern const struct ts_sc_list r8500_ts_sc_list[];
@@ -355,6 +359,7 @@ int icom_get_split_freq_mode(RIG *rig, vfo_t vfo, freq_t *tx_freq,
                              rmode_t *tx_mode, pbwidth_t *tx_width);
 int icom_set_split_vfo(RIG *rig, vfo_t rx_vfo, split_t split, vfo_t tx_vfo);
 int icom_get_split_vfo(RIG *rig, vfo_t rx_vfo, split_t *split, vfo_t *tx_vfo);
+int icom_get_vfo_snapshot(RIG *rig, struct rig_vfo_snapshot *snapshot);
 int icom_mem_get_split_vfo(RIG *rig, vfo_t vfo, split_t *split, vfo_t *tx_vfo);
 int icom_set_ts(RIG *rig, vfo_t vfo, shortfreq_t ts);
 int icom_get_ts(RIG *rig, vfo_t vfo, shortfreq_t *ts);
@@ -371,6 +376,16 @@ int icom_set_dcs_sql(RIG *rig, vfo_t vfo, tone_t code);
 int icom_get_dcs_sql(RIG *rig, vfo_t vfo, tone_t *code);
 int icom_set_bank(RIG *rig, vfo_t vfo, int bank);
 int icom_set_mem(RIG *rig, vfo_t vfo, int ch);
+
+/*
+ * Decodes the reply to 0x1a 0x00 (memory content), data as
+ * icom_transaction() returns it. Called outside the pipelined
+ * transaction, so it may talk to the rig.
+ */
+typedef int (*icom_mem_decode_t)(RIG *rig, channel_t *chan,
+                                 const unsigned char *data, int data_len, rig_ptr_t decode_arg);
+int icom_get_chan_all_cb_pipe(RIG *rig, vfo_t vfo, chan_cb_t chan_cb,
+                              rig_ptr_t arg, icom_mem_decode_t decode, rig_ptr_t decode_arg);
 int icom_vfo_op(RIG *rig, vfo_t vfo, vfo_op_t op);
 int icom_scan(RIG *rig, vfo_t vfo, scan_t scan, int ch);
 int icom_set_level(RIG *rig, vfo_t vfo, setting_t level, value_t val);
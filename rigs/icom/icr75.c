@@ -90,6 +90,8 @@
 static int icr75_set_channel(RIG *rig, vfo_t vfo, const channel_t *chan);
 static int icr75_get_channel(RIG *rig, vfo_t vfo, channel_t *chan,
                              int read_only);
+static int icr75_get_chan_all_cb(RIG *rig, vfo_t vfo, chan_cb_t chan_cb,
+                                 rig_ptr_t arg);
 static int icr75_set_parm(RIG *rig, setting_t parm, value_t val);
 static int icr75_get_parm(RIG *rig, setting_t parm, value_t *val);
 
@@ -108,7 +110,7 @@ struct rig_caps icr75_caps =
     RIG_MODEL(RIG_MODEL_ICR75),
     .model_name = "IC-R75",
     .mfg_name =  "Icom",
-    .version =  BACKEND_VER ".0",
+    .version =  BACKEND_VER ".1",
     .copyright =  "LGPL",
     .status =  RIG_STATUS_STABLE,
     .rig_type =  RIG_TYPE_RECEIVER,
@@ -249,6 +251,7 @@ struct rig_caps icr75_caps =
 
     .set_channel = icr75_set_channel,
     .get_channel = icr75_get_channel,
+    .get_chan_all_cb = icr75_get_chan_all_cb,
 
     .hamlib_check_rig_caps = HAMLIB_CHECK_RIG_CAPS
 };
@@ -324,33 +327,18 @@ int icr75_set_channel(RIG *rig, vfo_t vfo, const channel_t *chan)
 }
 
 /*
- * icr75_get_channel
- * Assumes rig!=NULL, STATE(rig)->priv!=NULL, chan!=NULL
+ * icr75_decode_channel
+ * Fills chan from the reply to 0x1a 0x00
  * TODO: still a WIP --SF
  */
-int icr75_get_channel(RIG *rig, vfo_t vfo, channel_t *chan, int read_only)
+static int icr75_decode_channel(RIG *rig, channel_t *chan,
+                                const unsigned char *chanbuf, int chan_len, rig_ptr_t decode_arg)
 {
-    struct icom_priv_data *priv;
-    struct rig_state *rs;
-    unsigned char chanbuf[24];
-    int chan_len, freq_len, retval;
-
-    rs = STATE(rig);
-    priv = (struct icom_priv_data *)rs->priv;
-
-    to_bcd_be(chanbuf, chan->channel_num, 4);
-    chan_len = 2;
+    const struct icom_priv_data *priv = (struct icom_priv_data *) STATE(rig)->priv;
+    int freq_len;
 
     freq_len = priv->civ_731_mode ? 4 : 5;
 
-    retval = icom_transaction(rig, C_CTL_MEM, S_MEM_CNTNT,
-                              chanbuf, chan_len, chanbuf, &chan_len);
-
-    if (retval != RIG_OK)
-    {
-        return retval;
-    }
-
     chan->vfo = RIG_VFO_MEM;
     chan->ant = RIG_ANT_NONE;
     chan->freq = 0;
@@ -390,7 +378,7 @@ int icr75_get_channel(RIG *rig, vfo_t vfo, channel_t *chan, int read_only)
      */
     if ((chan_len != freq_len + 18) && (chan_len != 5))
     {
-        rig_debug(RIG_DEBUG_ERR, "icr75_get_channel: wrong frame len=%d\n",
+        rig_debug(RIG_DEBUG_ERR, "%s: wrong frame len=%d\n", __func__,
                   chan_len);
         return -RIG_ERJCTED;
     }
@@ -422,7 +410,37 @@ int icr75_get_channel(RIG *rig, vfo_t vfo, channel_t *chan, int read_only)
         }
 
         chan->ant = from_bcd_be(chanbuf + chan_len++, 2);
-        strncpy(chan->channel_desc, (char *)(chanbuf + chan_len), 8);
+        strncpy(chan->channel_desc, (const char *)(chanbuf + chan_len), 8);
+    }
+
+    return RIG_OK;
+}
+
+/*
+ * icr75_get_channel
+ * Assumes rig!=NULL, STATE(rig)->priv!=NULL, chan!=NULL
+ */
+int icr75_get_channel(RIG *rig, vfo_t vfo, channel_t *chan, int read_only)
+{
+    unsigned char chanbuf[MAXFRAMELEN];
+    int chan_len, retval;
+
+    to_bcd_be(chanbuf, chan->channel_num, 4);
+    chan_len = 2;
+
+    retval = icom_transaction(rig, C_CTL_MEM, S_MEM_CNTNT,
+                              chanbuf, chan_len, chanbuf, &chan_len);
+
+    if (retval != RIG_OK)
+    {
+        return retval;
+    }
+
+    retval = icr75_decode_channel(rig, chan, chanbuf, chan_len, NULL);
+
+    if (retval != RIG_OK)
+    {
+        return retval;
     }
 
     if (!read_only)
@@ -438,6 +456,17 @@ int icr75_get_channel(RIG *rig, vfo_t vfo, channel_t *chan, int read_only)
     return RIG_OK;
 }
 
+/*
+ * icr75_get_chan_all_cb
+ * Pipelined memory readout
+ */
+int icr75_get_chan_all_cb(RIG *rig, vfo_t vfo, chan_cb_t chan_cb,
+                          rig_ptr_t arg)
+{
+    return icom_get_chan_all_cb_pipe(rig, vfo, chan_cb, arg,
+                                     icr75_decode_channel, NULL);
+}
+
 int icr75_set_parm(RIG *rig, setting_t parm, value_t val)
 {
     unsigned char prmbuf[MAXFRAMELEN];
@@ -321,6 +321,7 @@ struct rig_caps k3_caps =
     .get_split_mode =   k3_get_split_mode,
     .set_split_vfo =    kenwood_set_split_vfo,
     .get_split_vfo =    kenwood_get_split_vfo_if,
+    .get_vfo_snapshot = kenwood_get_vfo_snapshot,
     .set_rit =      k3_set_rit,
     .get_rit =      kenwood_get_rit,
     .set_xit =      k3_set_xit,
@@ -338,6 +339,10 @@ struct rig_caps k3_caps =
     .get_ext_level =    k3_get_ext_level,
     .vfo_op =       k3_vfo_op,
     .set_trn =      kenwood_set_trn,
+    .async_data_supported = 1,
+    .read_frame_direct = kenwood_read_frame_direct,
+    .is_async_frame = kenwood_is_async_frame,
+    .process_async_frame = kenwood_process_async_frame,
     .get_trn =      kenwood_get_trn,
     .set_powerstat =    kenwood_set_powerstat,
     .get_powerstat =    kenwood_get_powerstat,
@@ -483,6 +488,7 @@ struct rig_caps k3s_caps =
     .get_split_mode =   k3_get_split_mode,
     .set_split_vfo =    kenwood_set_split_vfo,
     .get_split_vfo =    kenwood_get_split_vfo_if,
+    .get_vfo_snapshot = kenwood_get_vfo_snapshot,
     .set_rit =      k3_set_rit,
     .get_rit =      kenwood_get_rit,
     .set_xit =      k3_set_xit,
@@ -500,6 +506,10 @@ struct rig_caps k3s_caps =
     .get_ext_level =    k3_get_ext_level,
     .vfo_op =       k3_vfo_op,
     .set_trn =      kenwood_set_trn,
+    .async_data_supported = 1,
+    .read_frame_direct = kenwood_read_frame_direct,
+    .is_async_frame = kenwood_is_async_frame,
+    .process_async_frame = kenwood_process_async_frame,
     .get_trn =      kenwood_get_trn,
     .set_powerstat =    kenwood_set_powerstat,
     .get_powerstat =    kenwood_get_powerstat,
@@ -674,6 +684,10 @@ struct rig_caps k4_caps =
     .get_ext_level =    k3_get_ext_level,
     .vfo_op =       k3_vfo_op,
     .set_trn =      kenwood_set_trn,
+    .async_data_supported = 1,
+    .read_frame_direct = kenwood_read_frame_direct,
+    .is_async_frame = kenwood_is_async_frame,
+    .process_async_frame = kenwood_process_async_frame,
     .get_trn =      kenwood_get_trn,
     .set_powerstat =    kenwood_set_powerstat,
     .get_powerstat =    kenwood_get_powerstat,
@@ -816,6 +830,7 @@ struct rig_caps kx3_caps =
     .get_split_mode =   k3_get_split_mode,
     .set_split_vfo =    kenwood_set_split_vfo,
     .get_split_vfo =    kenwood_get_split_vfo_if,
+    .get_vfo_snapshot = kenwood_get_vfo_snapshot,
     .set_rit =      k3_set_rit,
     .get_rit =      kenwood_get_rit,
     .set_xit =      k3_set_xit,
@@ -833,6 +848,10 @@ struct rig_caps kx3_caps =
     .get_ext_level =    k3_get_ext_level,
     .vfo_op =       k3_vfo_op,
     .set_trn =      kenwood_set_trn,
+    .async_data_supported = 1,
+    .read_frame_direct = kenwood_read_frame_direct,
+    .is_async_frame = kenwood_is_async_frame,
+    .process_async_frame = kenwood_process_async_frame,
     .get_trn =      kenwood_get_trn,
     .set_powerstat =    kenwood_set_powerstat,
     .get_powerstat =    kenwood_get_powerstat,
@@ -974,6 +993,7 @@ struct rig_caps kx2_caps =
     .get_split_mode =   k3_get_split_mode,
     .set_split_vfo =    kenwood_set_split_vfo,
     .get_split_vfo =    kenwood_get_split_vfo_if,
+    .get_vfo_snapshot = kenwood_get_vfo_snapshot,
     .set_rit =      k3_set_rit,
     .get_rit =      kenwood_get_rit,
     .set_xit =      k3_set_xit,
@@ -991,6 +1011,10 @@ struct rig_caps kx2_caps =
     .get_ext_level =    k3_get_ext_level,
     .vfo_op =       k3_vfo_op,
     .set_trn =      kenwood_set_trn,
+    .async_data_supported = 1,
+    .read_frame_direct = kenwood_read_frame_direct,
+    .is_async_frame = kenwood_is_async_frame,
+    .process_async_frame = kenwood_process_async_frame,
     .get_trn =      kenwood_get_trn,
     .set_powerstat =    kenwood_set_powerstat,
     .get_powerstat =    kenwood_get_powerstat,
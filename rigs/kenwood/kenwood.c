@@ -37,6 +37,8 @@
 #include "cal.h"
 #include "cache.h"
 #include "misc.h"
+#include "iofunc.h"
+#include "event.h"
 
 #include "kenwood.h"
 #include "ts990s.h"
@@ -257,6 +259,58 @@ static int remove_nonprint(char *s)
 }
 
 
+/*
+ * Keeps an IF answer for the IF cache of kenwood_transaction()
+ * The async data handler stores AI2 IF reports too, so the copy is made
+ * under the state lock the readers take
+ */
+static void kenwood_if_cache_store(RIG *rig, const char *buffer, size_t len)
+{
+    struct kenwood_priv_data *priv = STATE(rig)->priv;
+
+    len = min(min(len, strlen(buffer)), sizeof(priv->last_if_response) - 1);
+
+    pthread_mutex_lock(&STATE(rig)->state_mutex);
+    memcpy(priv->last_if_response, buffer, len);
+    priv->last_if_response[len] = '\0';
+    elapsed_ms(&priv->cache_start, HAMLIB_ELAPSED_SET);
+    pthread_mutex_unlock(&STATE(rig)->state_mutex);
+}
+
+
+/*
+ * Tells the async data handler which replies the transaction waits for,
+ * one per command in cmdstr, separated by the rig's command terminator
+ * Each prefix is completed before the terminator in front of it is
+ * overwritten, so the handler never sees half of one
+ */
+static void kenwood_set_pending_reply(RIG *rig, const char *cmdstr)
+{
+    struct kenwood_priv_data *priv = STATE(rig)->priv;
+    char cmdtrm = kenwood_caps(rig)->cmdtrm;
+    int n = 0;
+
+    priv->pending_reply[0] = '\0';
+
+    while (cmdstr && cmdstr[0] && n < KENWOOD_BATCH_MAX)
+    {
+        const char *next = strchr(cmdstr, cmdtrm);
+
+        priv->pending_reply[2 * n + 2] = '\0';
+        priv->pending_reply[2 * n + 1] = cmdstr[1];
+        priv->pending_reply[2 * n] = cmdstr[0];
+        n++;
+
+        if (next == NULL || cmdstr[1] == '\0')
+        {
+            break;
+        }
+
+        cmdstr = next + 1;
+    }
+}
+
+
 /**
  * kenwood_transaction
  * Assumes rig!=NULL STATE(rig)!=NULL rig->caps!=NULL
@@ -320,19 +374,30 @@ int kenwood_transaction(RIG *rig, const char *cmdstr, char *data,
     if (priv->is_emulation) { rp->post_write_delay = 0; }
 
     // if this is an IF cmdstr and not the first time through check cache
-    if (cmdstr && strcmp(cmdstr, "IF") == 0 && priv->cache_start.tv_sec != 0)
+    if (cmdstr && strcmp(cmdstr, "IF") == 0)
     {
-        int cache_age_ms;
+        int cache_age_ms = -1;
 
-        cache_age_ms = elapsed_ms(&priv->cache_start, HAMLIB_ELAPSED_GET);
+        pthread_mutex_lock(&rs->state_mutex);
 
-        if (cache_age_ms < 500) // 500ms cache time
+        if (priv->cache_start.tv_sec != 0)
         {
-            rig_debug(RIG_DEBUG_TRACE, "%s(%d): cache hit, age=%dms\n", __func__, __LINE__,
-                      cache_age_ms);
+            cache_age_ms = elapsed_ms(&priv->cache_start, HAMLIB_ELAPSED_GET);
+
+            // 500ms cache time
+            if (cache_age_ms < 500 && data)
+            {
+                strncpy(data, priv->last_if_response, datasize);
+            }
+        }
 
-            if (data) { strncpy(data, priv->last_if_response, datasize); }
+        pthread_mutex_unlock(&rs->state_mutex);
 
+        if (cache_age_ms >= 0 && cache_age_ms < 500)
+        {
+            rig_debug(RIG_DEBUG_TRACE, "%s(%d): cache hit, age=%dms\n", __func__, __LINE__,
+                      cache_age_ms);
+            rs->transaction_active = 0;
             RETURNFUNC2(RIG_OK);
         }
 
@@ -375,6 +440,14 @@ transaction_write:
             len++;
         }
 
+        if (rp->asyncio)
+        {
+            /* the async data handler passes this reply on and decodes
+               the AI reports arriving in between */
+            kenwood_set_pending_reply(rig, datasize ? cmdstr : priv->verify_cmd);
+            port_flush_sync_pipes(rp);
+        }
+
         /* flush anything in the read buffer before command is sent */
         rig_flush(rp);
 
@@ -421,7 +494,11 @@ transaction_write:
     }
 
     // Malachite SDR cannot send ID after FA
-    if (!datasize && priv->no_id) { RETURNFUNC2(RIG_OK); }
+    if (!datasize && priv->no_id)
+    {
+        retval = RIG_OK;
+        goto transaction_quit;
+    }
 
     if (!datasize && strncmp(cmdstr, "KY", 2) != 0)
     {
@@ -577,7 +654,8 @@ transaction_read:
             {
                 rig_debug(RIG_DEBUG_ERR, "%s: Command rejected by the rig (get): '%s'\n",
                           __func__, cmdstr);
-                RETURNFUNC2(-RIG_ERJCTED);
+                retval = -RIG_ERJCTED;
+                goto transaction_quit;
             }
 
             /* Command not understood by rig or rig busy */
@@ -713,11 +791,12 @@ transaction_read:
 
 transaction_quit:
 
+    kenwood_set_pending_reply(rig, NULL);
+
     // update the cache
     if (retval == RIG_OK && cmdstr && strcmp(cmdstr, "IF") == 0)
     {
-        elapsed_ms(&priv->cache_start, HAMLIB_ELAPSED_SET);
-        strncpy(priv->last_if_response, buffer, caps->if_len);
+        kenwood_if_cache_store(rig, buffer, caps->if_len);
     }
 
     rs->transaction_active = 0;
@@ -802,6 +881,206 @@ int kenwood_safe_transaction(RIG *rig, const char *cmd, char *buf,
     RETURNFUNC2(err);
 }
 
+/*
+ * Sends the batch in one write and sorts the replies, which the rig sends
+ * in order, into the entries
+ * A reply that skips entries marks them as failed, anything else that
+ * does not answer one of the remaining entries is an AI report and ignored
+ */
+static void kenwood_batch_exchange(RIG *rig, struct kenwood_batch_cmd *batch,
+                                  int count, const char *cmdbuf, int len)
+{
+    struct kenwood_priv_data *priv = STATE(rig)->priv;
+    const struct kenwood_priv_caps *caps = kenwood_caps(rig);
+    hamlib_port_t *rp = RIGPORT(rig);
+    char buffer[KENWOOD_MAX_BUF_LEN];
+    char cmdtrm_str[2] = { caps->cmdtrm, '\0' };
+    int answered = 0;
+    int retval;
+    int i = 0;
+
+    rig_debug(RIG_DEBUG_TRACE, "%s: cmdstr = %s\n", __func__, cmdbuf);
+
+    STATE(rig)->transaction_active = 1;
+
+    if (rp->asyncio)
+    {
+        kenwood_set_pending_reply(rig, cmdbuf);
+        port_flush_sync_pipes(rp);
+    }
+
+    rig_flush(rp);
+
+    retval = write_block(rp, (const unsigned char *) cmdbuf, len);
+
+    while (retval == RIG_OK && i < count)
+    {
+        int resp_len;
+        int j;
+
+        resp_len = read_string(rp, (unsigned char *) buffer, sizeof(buffer),
+                               cmdtrm_str, 1, 0, 1);
+
+        if (resp_len < 0)
+        {
+            break;
+        }
+
+        if (isprint(caps->cmdtrm))
+        {
+            resp_len = remove_nonprint(buffer);
+        }
+
+        if (resp_len < 1 || buffer[resp_len - 1] != caps->cmdtrm)
+        {
+            rig_debug(RIG_DEBUG_ERR, "%s: Response is not correctly terminated '%s'\n",
+                      __func__, buffer);
+            batch[i++].status = -RIG_EPROTO;
+            continue;
+        }
+
+        answered++;
+        buffer[--resp_len] = '\0';
+
+        if (resp_len == 1)
+        {
+            rig_debug(RIG_DEBUG_VERBOSE, "%s: '%s' answered with '%s'\n", __func__,
+                      batch[i].cmd, buffer);
+            batch[i++].status = buffer[0] == 'N' ? -RIG_ENAVAIL : -RIG_ERJCTED;
+            continue;
+        }
+
+        for (j = i; j < count; j++)
+        {
+            if (buffer[0] == batch[j].cmd[0] && buffer[1] == batch[j].cmd[1])
+            {
+                break;
+            }
+        }
+
+        if (j == count)
+        {
+            rig_debug(RIG_DEBUG_VERBOSE, "%s: ignoring unsolicited '%s'\n", __func__,
+                      buffer);
+            continue;
+        }
+
+        for (; i < j; i++)
+        {
+            rig_debug(RIG_DEBUG_ERR, "%s: no reply for '%s'\n", __func__, batch[i].cmd);
+            batch[i].status = -RIG_EPROTO;
+        }
+
+        if (batch[i].expected && resp_len != batch[i].expected)
+        {
+            rig_debug(RIG_DEBUG_ERR,
+                      "%s: wrong answer; len for cmd %s: expected = %d, got %d\n",
+                      __func__, batch[i].cmd, (int)batch[i].expected, resp_len);
+            batch[i++].status = -RIG_EPROTO;
+            continue;
+        }
+
+        strncpy(batch[i].data, buffer, batch[i].datasize - 1);
+        batch[i].data[batch[i].datasize - 1] = '\0';
+        batch[i].status = RIG_OK;
+
+        if (strcmp(batch[i].cmd, "IF") == 0)
+        {
+            kenwood_if_cache_store(rig, buffer, resp_len);
+        }
+
+        i++;
+    }
+
+    kenwood_set_pending_reply(rig, NULL);
+    STATE(rig)->transaction_active = 0;
+
+    if (retval == RIG_OK && answered == 0)
+    {
+        rig_debug(RIG_DEBUG_WARN, "%s: no reply to a batch, sending single commands\n",
+                  __func__);
+        priv->no_batch = 1;
+    }
+}
+
+/**
+ * kenwood_batch_transaction
+ * Reads several values in one round trip, e.g. "IF;FA;FB;"
+ *
+ * Parameters:
+ *  batch   Get commands with their reply buffers, as for
+ *          kenwood_safe_transaction(); expected 0 accepts any length
+ *  count   Number of entries, at most KENWOOD_BATCH_MAX
+ *
+ * Each entry gets its own status. Entries the batch could not answer, e.g.
+ * "?;" from a busy rig, are sent again one by one through
+ * kenwood_safe_transaction() and its retries. A rig that does not answer
+ * a batch at all is only sent single commands afterwards.
+ *
+ * returns RIG_OK if all entries succeeded, else the status of the first
+ * failed one
+ */
+int kenwood_batch_transaction(RIG *rig, struct kenwood_batch_cmd *batch,
+                              int count)
+{
+    struct kenwood_priv_data *priv = STATE(rig)->priv;
+    char cmdbuf[KENWOOD_MAX_BUF_LEN];
+    int retval = RIG_OK;
+    int len = 0;
+    int i;
+
+    ENTERFUNC;
+
+    if (count < 1 || count > KENWOOD_BATCH_MAX)
+    {
+        RETURNFUNC(-RIG_EINVAL);
+    }
+
+    for (i = 0; i < count; i++)
+    {
+        size_t cmdlen = batch[i].cmd ? strlen(batch[i].cmd) : 0;
+
+        if (cmdlen < 2 || len + cmdlen + 2 > sizeof(cmdbuf)
+                || !batch[i].data || batch[i].datasize < 2)
+        {
+            RETURNFUNC(-RIG_EINVAL);
+        }
+
+        memcpy(cmdbuf + len, batch[i].cmd, cmdlen);
+        len += cmdlen;
+        cmdbuf[len++] = kenwood_caps(rig)->cmdtrm;
+        batch[i].data[0] = '\0';
+        batch[i].status = -RIG_ETIMEOUT;
+    }
+
+    cmdbuf[len] = '\0';
+
+    if (!priv->no_batch && count > 1)
+    {
+        kenwood_batch_exchange(rig, batch, count, cmdbuf, len);
+    }
+
+    for (i = 0; i < count; i++)
+    {
+        if (batch[i].status != RIG_OK)
+        {
+            // expected 0 would make kenwood_safe_transaction() send a set command
+            batch[i].status = batch[i].expected ?
+                              kenwood_safe_transaction(rig, batch[i].cmd, batch[i].data,
+                                      batch[i].datasize, batch[i].expected) :
+                              kenwood_transaction(rig, batch[i].cmd, batch[i].data,
+                                      batch[i].datasize);
+        }
+
+        if (batch[i].status != RIG_OK && retval == RIG_OK)
+        {
+            retval = batch[i].status;
+        }
+    }
+
+    RETURNFUNC(retval);
+}
+
 rmode_t kenwood2rmode(unsigned char mode, const rmode_t mode_table[])
 {
     rig_debug(RIG_DEBUG_VERBOSE, "%s called\n", __func__);
@@ -1167,13 +1446,7 @@ int kenwood_open(RIG *rig)
                 kenwood_get_trn(rig, &priv->trn_state);  /* ignore errors */
             }
 
-            /* Currently we cannot cope with AI mode so turn it off in
-               case last client left it on */
-            if (priv->trn_state != RIG_TRN_OFF)
-            {
-                kenwood_set_trn(rig, RIG_TRN_OFF); /* ignore status in case
-                                                      it's not supported */
-            }
+            kenwood_set_ai_push(rig);
 
             if (!RIG_IS_THD74 && !RIG_IS_THD7A && !RIG_IS_TMD700)
             {
@@ -1230,6 +1503,17 @@ int kenwood_close(RIG *rig)
 
     ENTERFUNC;
 
+    if (priv->ai_push)
+    {
+        /* stop the reports kenwood_set_ai_push() asked for */
+        priv->ai_push = 0;
+
+        if (priv->trn_state != RIG_TRN_RIG)
+        {
+            kenwood_set_trn(rig, RIG_TRN_OFF);
+        }
+    }
+
     if (priv->poweron == 0) { RETURNFUNC(RIG_OK); } // nothing to do
 
     if (!no_restore_ai && priv->trn_state >= 0)
@@ -2180,6 +2464,125 @@ int kenwood_get_freq(RIG *rig, vfo_t vfo, freq_t *freq)
     RETURNFUNC(RIG_OK);
 }
 
+/* IF reports the base mode only, keep a cached data mode that matches it */
+static void kenwood_snapshot_mode(RIG *rig, struct rig_vfo_snapshot_entry *entry,
+                                  rmode_t mode)
+{
+    rmode_t cached = entry->mode;
+
+    if (cached == mode
+            || (cached == RIG_MODE_PKTUSB && mode == RIG_MODE_USB)
+            || (cached == RIG_MODE_PKTLSB && mode == RIG_MODE_LSB)
+            || (cached == RIG_MODE_PKTFM && mode == RIG_MODE_FM)
+            || (cached == RIG_MODE_PKTAM && mode == RIG_MODE_AM))
+    {
+        return;
+    }
+
+    entry->mode = mode;
+    entry->width = rig_passband_normal(rig, mode);
+}
+
+/*
+ * kenwood_get_vfo_snapshot
+ * IF gives freq, mode, split and PTT of the VFO it shows, FA or FB the
+ * frequency of the other one, whose mode stays the cached one
+ * All three are read in one round trip, IF only if its cache is stale
+ */
+int kenwood_get_vfo_snapshot(RIG *rig, struct rig_vfo_snapshot *snapshot)
+{
+    struct kenwood_priv_data *priv = STATE(rig)->priv;
+    struct kenwood_priv_caps *caps = kenwood_caps(rig);
+    char freqbuf[2][50];
+    struct kenwood_batch_cmd batch[3] =
+    {
+        { "IF", priv->info, sizeof(priv->info), caps->if_len, RIG_OK },
+        { "FA", freqbuf[0], sizeof(freqbuf[0]), 13, RIG_OK },
+        { "FB", freqbuf[1], sizeof(freqbuf[1]), 13, RIG_OK },
+    };
+    int if_cached;
+    int shown, rx;
+    int transmitting, split;
+    int retval;
+    int i;
+
+    ENTERFUNC;
+
+    // same 500ms IF cache as kenwood_transaction()
+    pthread_mutex_lock(&STATE(rig)->state_mutex);
+    if_cached = priv->cache_start.tv_sec != 0
+                && elapsed_ms(&priv->cache_start, HAMLIB_ELAPSED_GET) < 500;
+    pthread_mutex_unlock(&STATE(rig)->state_mutex);
+
+    retval = if_cached ? kenwood_batch_transaction(rig, batch + 1, 2)
+             : kenwood_batch_transaction(rig, batch, 3);
+
+    if (retval == RIG_OK && if_cached)
+    {
+        retval = kenwood_get_if(rig);
+    }
+
+    if (retval != RIG_OK)
+    {
+        RETURNFUNC(retval);
+    }
+
+    transmitting = '1' == priv->info[28];
+    split = '1' == priv->info[32];
+
+    switch (priv->info[30])
+    {
+    case '0': shown = 0; break;
+
+    case '1': shown = 1; break;
+
+    default: shown = -1; // memory
+    }
+
+    /* while transmitting split IF shows the TX VFO, Elecraft excepted */
+    rx = shown;
+
+    if (shown >= 0 && transmitting && split && !RIG_IS_K2 && !RIG_IS_K3)
+    {
+        rx = 1 - shown;
+    }
+
+    for (i = 0; i < 2; i++)
+    {
+        struct rig_vfo_snapshot_entry *entry = &snapshot->vfos[i];
+
+        if (i == shown)
+        {
+            memcpy(freqbuf[i], priv->info, 13);
+            freqbuf[i][13] = '\0';
+            sscanf(freqbuf[i] + 2, "%"SCNfreq, &entry->freq);
+            kenwood_snapshot_mode(rig, entry,
+                                  kenwood2rmode(priv->info[29] - '0', caps->mode_table));
+            continue;
+        }
+
+        sscanf(freqbuf[i] + 2, "%"SCNfreq, &entry->freq);
+        entry->cached = 1;
+    }
+
+    if (rx < 0)
+    {
+        snapshot->current_vfo = RIG_VFO_MEM;
+        snapshot->tx_vfo = RIG_VFO_MEM;
+    }
+    else
+    {
+        snapshot->current_vfo = snapshot->vfos[rx].vfo;
+        snapshot->tx_vfo = snapshot->vfos[split ? 1 - rx : rx].vfo;
+    }
+
+    snapshot->split = split ? RIG_SPLIT_ON : RIG_SPLIT_OFF;
+    snapshot->ptt = transmitting ? RIG_PTT_ON : RIG_PTT_OFF;
+    priv->split = snapshot->split;
+
+    RETURNFUNC(RIG_OK);
+}
+
 int kenwood_get_rit(RIG *rig, vfo_t vfo, shortfreq_t *rit)
 {
     int retval;
@@ -5295,6 +5698,12 @@ int kenwood_set_trn(RIG *rig, int trn)
         RETURNFUNC(-RIG_ENAVAIL);
 
     case RIG_MODEL_TS990S:
+    case RIG_MODEL_TS890S:
+    case RIG_MODEL_K3:
+    case RIG_MODEL_K3S:
+    case RIG_MODEL_KX3:
+    case RIG_MODEL_KX2:
+    case RIG_MODEL_K4:
         RETURNFUNC(kenwood_transaction(rig, (trn == RIG_TRN_RIG) ? "AI2" : "AI0", NULL,
                                        0));
 
@@ -5357,6 +5766,192 @@ int kenwood_get_trn(RIG *rig, int *trn)
     RETURNFUNC(RIG_OK);
 }
 
+/*
+ * kenwood_set_ai_push
+ * Called at the end of kenwood_open() and elecraft_open()
+ * With the "async" option the rig reports its changes by itself and the
+ * async data handler feeds them into the cache and the event callbacks,
+ * otherwise AI is turned off since the transactions cannot cope with it
+ */
+int kenwood_set_ai_push(RIG *rig)
+{
+    struct kenwood_priv_data *priv = STATE(rig)->priv;
+    int retval = RIG_OK;
+
+    ENTERFUNC;
+
+    priv->ai_push = 0;
+
+    if (STATE(rig)->async_data_enabled)
+    {
+        retval = kenwood_set_trn(rig, RIG_TRN_RIG);
+
+        if (retval == RIG_OK)
+        {
+            priv->ai_push = 1;
+            RETURNFUNC(RIG_OK);
+        }
+
+        rig_debug(RIG_DEBUG_WARN, "%s: cannot enable AI: %s\n", __func__,
+                  rigerror(retval));
+    }
+
+    /* turn AI off in case last client left it on */
+    if (priv->trn_state != RIG_TRN_OFF)
+    {
+        retval = kenwood_set_trn(rig, RIG_TRN_OFF); /* ignore status in case
+                                                      it's not supported */
+    }
+
+    RETURNFUNC(retval);
+}
+
+int kenwood_read_frame_direct(RIG *rig, size_t buffer_length,
+                              const unsigned char *buffer)
+{
+    char cmdtrm_str[2] = { kenwood_caps(rig)->cmdtrm, '\0' };
+
+    return read_string_direct(RIGPORT(rig), (unsigned char *) buffer,
+                              buffer_length, cmdtrm_str, 1, 0, 1);
+}
+
+/*
+ * kenwood_is_async_frame
+ * A frame is an AI report unless it answers the pending transaction
+ */
+int kenwood_is_async_frame(RIG *rig, size_t frame_length,
+                           const unsigned char *frame)
+{
+    const struct kenwood_priv_data *priv = STATE(rig)->priv;
+    static const char *const reports[] = { "FA", "FB", "MD", "IF", "TX", "RX", NULL };
+    int i;
+
+    if (!priv->ai_push || frame_length < 3)
+    {
+        return 0;
+    }
+
+    /* only the TS-990S reports its mode with OM, on Elecraft rigs OM
+       answers the option module query */
+    if (frame[0] == 'O' && frame[1] == 'M' && !RIG_IS_TS990S)
+    {
+        return 0;
+    }
+
+    for (i = 0; priv->pending_reply[i] != '\0'; i += 2)
+    {
+        if (frame[0] == priv->pending_reply[i] && frame[1] == priv->pending_reply[i + 1])
+        {
+            return 0;
+        }
+    }
+
+    if (frame[0] == 'O' && frame[1] == 'M')
+    {
+        return 1;
+    }
+
+    for (i = 0; reports[i] != NULL; i++)
+    {
+        if (frame[0] == reports[i][0] && frame[1] == reports[i][1])
+        {
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+static rmode_t kenwood_async_mode(RIG *rig, char c)
+{
+    int kmode = c <= '9' ? c - '0' : c - 'A' + 10;
+
+    return kenwood2rmode(kmode, kenwood_caps(rig)->mode_table);
+}
+
+/*
+ * kenwood_process_async_frame
+ * Decodes the AI reports about frequency, mode and PTT
+ */
+int kenwood_process_async_frame(RIG *rig, size_t frame_length,
+                                const unsigned char *frame)
+{
+    const struct kenwood_priv_caps *caps = kenwood_caps(rig);
+    char buf[KENWOOD_MAX_BUF_LEN];
+    freq_t freq;
+    vfo_t vfo;
+    int len;
+
+    len = min(frame_length, sizeof(buf) - 1);
+    memcpy(buf, frame, len);
+    buf[len] = '\0';
+    len = remove_nonprint(buf);
+
+    if (len > 0 && buf[len - 1] == caps->cmdtrm)
+    {
+        buf[--len] = '\0';
+    }
+
+    rig_debug(RIG_DEBUG_TRACE, "%s: AI report '%s'\n", __func__, buf);
+
+    if (strncmp(buf, "FA", 2) == 0 || strncmp(buf, "FB", 2) == 0)
+    {
+        if (sscanf(buf + 2, "%"SCNfreq, &freq) == 1)
+        {
+            rig_fire_freq_event(rig, buf[1] == 'A' ? RIG_VFO_A : RIG_VFO_B, freq);
+        }
+    }
+    else if (strncmp(buf, "MD$", 3) == 0 && len > 3)
+    {
+        /* the K3 and K4 report VFO B as MD$ */
+        rig_fire_mode_event(rig, RIG_VFO_B, kenwood_async_mode(rig, buf[3]),
+                            RIG_PASSBAND_NOCHANGE);
+    }
+    else if (strncmp(buf, "MD", 2) == 0 && len > 2)
+    {
+        rig_fire_mode_event(rig, RIG_VFO_CURR, kenwood_async_mode(rig, buf[2]),
+                            RIG_PASSBAND_NOCHANGE);
+    }
+    else if (strncmp(buf, "OM", 2) == 0 && len > 3 && RIG_IS_TS990S)
+    {
+        vfo = buf[2] == '1' ? RIG_VFO_SUB : RIG_VFO_MAIN;
+        rig_fire_mode_event(rig, vfo, kenwood_async_mode(rig, buf[3]),
+                            RIG_PASSBAND_NOCHANGE);
+    }
+    else if (strncmp(buf, "TX", 2) == 0 || strncmp(buf, "RX", 2) == 0)
+    {
+        rig_fire_ptt_event(rig, RIG_VFO_CURR,
+                           buf[0] == 'T' ? RIG_PTT_ON : RIG_PTT_OFF);
+    }
+    else if (strncmp(buf, "IF", 2) == 0 && len > 30)
+    {
+        /* a fresh IF answer spares the next IF transaction */
+        kenwood_if_cache_store(rig, buf, len);
+
+        switch (buf[30])
+        {
+        case '0': vfo = RIG_VFO_A; break;
+
+        case '1': vfo = RIG_VFO_B; break;
+
+        default: vfo = RIG_VFO_CURR;
+        }
+
+        rig_fire_mode_event(rig, vfo, kenwood_async_mode(rig, buf[29]),
+                            RIG_PASSBAND_NOCHANGE);
+        rig_fire_ptt_event(rig, vfo, buf[28] == '0' ? RIG_PTT_OFF : RIG_PTT_ON);
+
+        buf[13] = '\0';
+
+        if (sscanf(buf + 2, "%"SCNfreq, &freq) == 1)
+        {
+            rig_fire_freq_event(rig, vfo, freq);
+        }
+    }
+
+    return RIG_OK;
+}
+
 /*
  * kenwood_set_powerstat
  */
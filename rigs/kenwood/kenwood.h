@@ -37,6 +37,7 @@
 
 #define KENWOOD_MODE_TABLE_MAX  24
 #define KENWOOD_MAX_BUF_LEN   128 /* max answer len, arbitrary */
+#define KENWOOD_BATCH_MAX     8   /* max commands in one kenwood_batch_transaction() */
 
 
 /* Tokens for Parameters common to multiple rigs.
@@ -190,6 +191,19 @@ struct kenwood_priv_data
     const char *voice_mem_start, *voice_mem_stop; // Commands to do the thing to do
     rmode_t last_mode_pc; // last mode memory for PC command
     int power_now,power_min,power_max;
+    int ai_push; /* AI2 reports are decoded by the async data handler */
+    volatile char pending_reply[2 * KENWOOD_BATCH_MAX + 1]; /* reply prefixes the transaction waits for */
+    int no_batch; /* rig did not answer a batch, send one command at a time */
+};
+
+/* One get command of a kenwood_batch_transaction() */
+struct kenwood_batch_cmd
+{
+    const char *cmd;    /* command without terminator, e.g. "FA" */
+    char *data;         /* reply without terminator */
+    size_t datasize;
+    size_t expected;    /* reply length, 0 for any */
+    int status;         /* RIG_OK or the error of this command */
 };
 
 
@@ -205,6 +219,8 @@ extern tone_t kenwood51_ctcss_list[];
 int kenwood_transaction(RIG *rig, const char *cmdstr, char *data, size_t datasize);
 int kenwood_safe_transaction(RIG *rig, const char *cmd, char *buf,
                              size_t buf_size, size_t expected);
+int kenwood_batch_transaction(RIG *rig, struct kenwood_batch_cmd *batch,
+                              int count);
 
 rmode_t kenwood2rmode(unsigned char mode, const rmode_t mode_table[]);
 char rmode2kenwood(rmode_t mode, const rmode_t mode_table[]);
@@ -226,6 +242,7 @@ int kenwood_get_split_vfo_if(RIG *rig, vfo_t rxvfo, split_t *split,
 
 int kenwood_set_freq(RIG *rig, vfo_t vfo, freq_t freq);
 int kenwood_get_freq(RIG *rig, vfo_t vfo, freq_t *freq);
+int kenwood_get_vfo_snapshot(RIG *rig, struct rig_vfo_snapshot *snapshot);
 int kenwood_get_freq_if(RIG *rig, vfo_t vfo, freq_t *freq);
 int kenwood_set_rit(RIG *rig, vfo_t vfo, shortfreq_t rit);
 int kenwood_set_rit_new(RIG *rig, vfo_t vfo, shortfreq_t rit);  // Also use this for xit
@@ -275,6 +292,13 @@ int kenwood_get_clock(RIG *rig, int *year, int *month, int *day, int *hour, int
 int kenwood_set_clock(RIG *rig, int year, int month, int day, int hour, int min, int sec, double msec, int utc_offset);
 
 int kenwood_set_trn(RIG *rig, int trn);
+int kenwood_set_ai_push(RIG *rig);
+int kenwood_read_frame_direct(RIG *rig, size_t buffer_length,
+                              const unsigned char *buffer);
+int kenwood_is_async_frame(RIG *rig, size_t frame_length,
+                           const unsigned char *frame);
+int kenwood_process_async_frame(RIG *rig, size_t frame_length,
+                                const unsigned char *frame);
 int kenwood_get_trn(RIG *rig, int *trn);
 
 /* only use if returned string has length 6, e.g. 'SQ011;' */
@@ -1901,6 +1901,7 @@ struct rig_caps ts2000_caps =
     .get_vfo =  kenwood_get_vfo_if,
     .set_split_vfo = kenwood_set_split_vfo,
     .get_split_vfo = kenwood_get_split_vfo_if,
+    .get_vfo_snapshot = kenwood_get_vfo_snapshot,
     .set_ctcss_tone =  kenwood_set_ctcss_tone_tn,
     .get_ctcss_tone =  kenwood_get_ctcss_tone,
     .set_ctcss_sql =  kenwood_set_ctcss_sql,
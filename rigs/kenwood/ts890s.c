@@ -659,6 +659,10 @@ struct rig_caps ts890s_caps =
     .priv = (void *)& ts890s_priv_caps,
     .rig_init = kenwood_init,
     .rig_open = kenwood_open,
+    .async_data_supported = 1,
+    .read_frame_direct = kenwood_read_frame_direct,
+    .is_async_frame = kenwood_is_async_frame,
+    .process_async_frame = kenwood_process_async_frame,
     .rig_cleanup = kenwood_cleanup,
     .set_freq = kenwood_set_freq,
     .get_freq = kenwood_get_freq,
@@ -364,6 +364,7 @@ struct rig_caps ft991_caps =
     .get_ptt =            newcat_get_ptt,
     .set_split_vfo =      newcat_set_split_vfo,
     .get_split_vfo =      newcat_get_split_vfo,
+    .get_vfo_snapshot =   newcat_get_vfo_snapshot,
     .set_split_freq =     ft991_set_split_freq,
     .get_split_freq =     ft991_get_split_freq,
     .get_split_mode =     ft991_get_split_mode,
@@ -402,6 +403,10 @@ struct rig_caps ft991_caps =
     .get_ts =             newcat_get_ts,
     .set_trn =            newcat_set_trn,
     .get_trn =            newcat_get_trn,
+    .async_data_supported = 1,
+    .read_frame_direct =  newcat_read_frame_direct,
+    .is_async_frame =     newcat_is_async_frame,
+    .process_async_frame = newcat_process_async_frame,
     .set_channel =        newcat_set_channel,
     .get_channel =        newcat_get_channel,
     .set_ext_level =      newcat_set_ext_level,
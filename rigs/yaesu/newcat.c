@@ -28,6 +28,7 @@
  *
  */
 
+#include <stddef.h>
 #include <stdlib.h>
 #include <string.h>  /* String function definitions */
 #include <math.h>
@@ -39,6 +40,7 @@
 #include "misc.h"
 #include "cache.h"
 #include "cal.h"
+#include "event.h"
 #include "newcat.h"
 
 /* global variables */
@@ -429,25 +431,29 @@ const cal_table_float_t yaesu_default_id_meter_cal =
     }
 };
 
-// Easy reference to rig model -- it is set in newcat_valid_command
-static ncboolean is_ft450;
-static ncboolean is_ft710;
-static ncboolean is_ft891;
-static ncboolean is_ft897;
-static ncboolean is_ft897d;
-static ncboolean is_ft950;
-static ncboolean is_ft991;
-static ncboolean is_ft2000;
-static ncboolean is_ftdx9000;
-static ncboolean is_ftdx5000;
-static ncboolean is_ftdx1200;
-static ncboolean is_ftdx3000;
-static ncboolean is_ftdx3000dm;
-static ncboolean is_ftdx101d;
-static ncboolean is_ftdx101mp;
-static ncboolean is_ftdx10;
-static ncboolean is_ftx1;
-static ncboolean is_ftdx9000Old;
+/*
+ * Easy reference to rig model, per RIG so several newcat rigs can be open
+ * at once. The FTDX3000DM shares the FTDX3000 model and is told apart by
+ * its ID.
+ */
+#define RIG_IS_FT450  (rig->caps->rig_model == RIG_MODEL_FT450 || rig->caps->rig_model == RIG_MODEL_FT450D)
+#define RIG_IS_FT710  (rig->caps->rig_model == RIG_MODEL_FT710)
+#define RIG_IS_FT891  (rig->caps->rig_model == RIG_MODEL_FT891)
+#define RIG_IS_FT897  (rig->caps->rig_model == RIG_MODEL_FT897)
+#define RIG_IS_FT897D (rig->caps->rig_model == RIG_MODEL_FT897D)
+#define RIG_IS_FT950  (rig->caps->rig_model == RIG_MODEL_FT950)
+#define RIG_IS_FT991  (rig->caps->rig_model == RIG_MODEL_FT991)
+#define RIG_IS_FT2000 (rig->caps->rig_model == RIG_MODEL_FT2000)
+#define RIG_IS_FTDX9000 (rig->caps->rig_model == RIG_MODEL_FT9000)
+#define RIG_IS_FTDX9000OLD (rig->caps->rig_model == RIG_MODEL_FT9000OLD)
+#define RIG_IS_FTDX5000 (rig->caps->rig_model == RIG_MODEL_FTDX5000)
+#define RIG_IS_FTDX1200 (rig->caps->rig_model == RIG_MODEL_FTDX1200)
+#define RIG_IS_FTDX3000 (rig->caps->rig_model == RIG_MODEL_FTDX3000)
+#define RIG_IS_FTDX3000DM (((struct newcat_priv_data *)STATE(rig)->priv)->rig_id == NC_RIGID_FTDX3000DM)
+#define RIG_IS_FTDX101D (rig->caps->rig_model == RIG_MODEL_FTDX101D)
+#define RIG_IS_FTDX101MP (rig->caps->rig_model == RIG_MODEL_FTDX101MP)
+#define RIG_IS_FTDX10 (rig->caps->rig_model == RIG_MODEL_FTDX10)
+#define RIG_IS_FTX1   (rig->caps->rig_model == RIG_MODEL_FTX1)
 
 /*
  * Even though this table does make a handy reference, it could be deprecated as it is not really needed.
@@ -457,9 +463,9 @@ static ncboolean is_ftdx9000Old;
  * PR - Speech Proc ON/OFF, and BC - Auto Notch filter ON/OFF.
  * The FT-450 returns -RIG_ENVAIL for these unavailable CAT commands.
  *
- * NOTE: The following table must be in alphabetical order by the
- * command.  This is because it is searched using a binary search
- * to determine whether or not a command is valid for a given rig.
+ * The table is only read by newcat_resolve_commands() at rig_init time,
+ * which turns the rig's column into the per-rig bitmap used by
+ * newcat_valid_command().  It is kept in alphabetical order for reference.
  *
  * The list of supported commands is obtained from the rig's operator's
  * or CAT programming manual.
@@ -644,12 +650,15 @@ static int newcat_get_contour_level(RIG *rig, vfo_t vfo, int *level);
 static int newcat_set_contour_width(RIG *rig, vfo_t vfo, int width);
 static int newcat_get_contour_width(RIG *rig, vfo_t vfo, int *width);
 static ncboolean newcat_valid_command(RIG *rig, char const *const command);
+static void newcat_resolve_commands(RIG *rig);
+static int newcat_get_vfo_snapshot_prefetched(RIG *rig,
+        struct rig_vfo_snapshot *snapshot);
 
 /*
  * The BS command needs to know what band we're on so we can restore band info
  * So this converts freq to band index
  */
-static int newcat_band_index(freq_t freq)
+static int newcat_band_index(RIG *rig, freq_t freq)
 {
     int band = 11; // general
 
@@ -657,15 +666,15 @@ static int newcat_band_index(freq_t freq)
     // using < instead of <= for the moment
     // does anybody work LSB or RTTYR at the upper band edge?
     // what about band 13 -- what is it?
-    if (freq >= MHz(420) && freq < MHz(470) && !is_ftx1) { band = 16; }
-    else if (freq >= MHz(420) && freq < MHz(470) && is_ftx1) { band = 14; }
-    else if (freq >= MHz(144) && freq < MHz(148) && is_ftx1) { band = 13; }
+    if (freq >= MHz(420) && freq < MHz(470) && !RIG_IS_FTX1) { band = 16; }
+    else if (freq >= MHz(420) && freq < MHz(470) && RIG_IS_FTX1) { band = 14; }
+    else if (freq >= MHz(144) && freq < MHz(148) && RIG_IS_FTX1) { band = 13; }
     else if (freq >= MHz(144) && freq < MHz(148)) { band = 15; }
     // band 14 is RX only
     // override band 15 with 14 if needed
-    else if (freq >= MHz(118) && freq < MHz(164) && is_ftx1) { band = 12; }
+    else if (freq >= MHz(118) && freq < MHz(164) && RIG_IS_FTX1) { band = 12; }
     else if (freq >= MHz(118) && freq < MHz(164)) { band = 14; }
-    else if (freq >= MHz(70) && freq < MHz(70.5) && is_ftx1) { band = 11; }
+    else if (freq >= MHz(70) && freq < MHz(70.5) && RIG_IS_FTX1) { band = 11; }
     else if (freq >= MHz(70) && freq < MHz(70.5)) { band = 17; }
     else if (freq >= MHz(50) && freq < MHz(55)) { band = 10; }
     else if (freq >= MHz(28) && freq < MHz(29.7)) { band = 9; }
@@ -721,31 +730,7 @@ int newcat_init(RIG *rig)
     priv->current_mem = NC_MEM_CHANNEL_NONE;
     priv->fast_set_commands = FALSE;
 
-    /*
-     * Determine the type of rig from the model number.  Note it is
-     * possible for several model variants to exist; i.e., all the
-     * FT-9000 variants.
-     */
-
-    is_ft450 = newcat_is_rig(rig, RIG_MODEL_FT450);
-    is_ft450 |= newcat_is_rig(rig, RIG_MODEL_FT450D);
-    is_ft891 = newcat_is_rig(rig, RIG_MODEL_FT891);
-    is_ft897 = newcat_is_rig(rig, RIG_MODEL_FT897);
-    is_ft897d = newcat_is_rig(rig, RIG_MODEL_FT897D);
-    is_ft950 = newcat_is_rig(rig, RIG_MODEL_FT950);
-    is_ft991 = newcat_is_rig(rig, RIG_MODEL_FT991);
-    is_ft2000 = newcat_is_rig(rig, RIG_MODEL_FT2000);
-    is_ftdx9000 = newcat_is_rig(rig, RIG_MODEL_FT9000);
-    is_ftdx9000Old = newcat_is_rig(rig, RIG_MODEL_FT9000OLD);
-    is_ftdx5000 = newcat_is_rig(rig, RIG_MODEL_FTDX5000);
-    is_ftdx1200 = newcat_is_rig(rig, RIG_MODEL_FTDX1200);
-    is_ftdx3000 = newcat_is_rig(rig, RIG_MODEL_FTDX3000);
-    is_ftdx3000dm = FALSE; // Detected dynamically
-    is_ftdx101d = newcat_is_rig(rig, RIG_MODEL_FTDX101D);
-    is_ftdx101mp = newcat_is_rig(rig, RIG_MODEL_FTDX101MP);
-    is_ftdx10 = newcat_is_rig(rig, RIG_MODEL_FTDX10);
-    is_ft710 = newcat_is_rig(rig, RIG_MODEL_FT710);
-    is_ftx1 = newcat_is_rig(rig, RIG_MODEL_FTX1);
+    newcat_resolve_commands(rig);
 
     RETURNFUNC(RIG_OK);
 }
@@ -894,7 +879,7 @@ int newcat_open(RIG *rig)
 
 #if 0 // this apparently does not work
 
-    if (is_ftdx5000)
+    if (RIG_IS_FTDX5000)
     {
         // Remember EX103 status
         SNPRINTF(priv->cmd_str, sizeof(priv->cmd_str), "EX103;");
@@ -920,6 +905,14 @@ int newcat_open(RIG *rig)
 #endif
     priv->band_index = -1;
 
+    /* with the async option the data handler decodes the AI reports */
+    priv->ai_push = 0;
+
+    if (rig_s->async_data_enabled)
+    {
+        priv->ai_push = newcat_set_trn(rig, RIG_TRN_RIG) == RIG_OK;
+    }
+
     RETURNFUNC(RIG_OK);
 }
 
@@ -937,6 +930,19 @@ int newcat_close(RIG *rig)
 
     ENTERFUNC;
 
+    if (priv->ai_push)
+    {
+        /* stop the reports newcat_open() asked for unless the AI state
+           is restored below */
+        priv->ai_push = 0;
+
+        if ((no_restore_ai || priv->trn_state < 0) && rig_s->comm_state
+                && rig_s->powerstat != RIG_POWER_OFF)
+        {
+            newcat_set_trn(rig, RIG_TRN_OFF);
+        }
+    }
+
     if (!no_restore_ai && priv->trn_state >= 0 && rig_s->comm_state
             && rig_s->powerstat != RIG_POWER_OFF)
     {
@@ -954,7 +960,7 @@ int newcat_close(RIG *rig)
 
 #if 0 // this apparently does not work -- we can't query EX103
 
-    if (is_ftdx5000)
+    if (RIG_IS_FTDX5000)
     {
         // Restore EX103 status
         SNPRINTF(priv->cmd_str, sizeof(priv->cmd_str), "EX103%c;",
@@ -1085,9 +1091,9 @@ int newcat_60m_exception(RIG *rig, freq_t freq, rmode_t mode)
     }
 
     // some rigs need to skip freq/mode settings as 60M only operates in memory mode
-    if (is_ft991 || is_ft897 || is_ft897d || is_ftdx5000 || is_ftdx10) { return 1; }
+    if (RIG_IS_FT991 || RIG_IS_FT897 || RIG_IS_FT897D || RIG_IS_FTDX5000 || RIG_IS_FTDX10) { return 1; }
 
-    if (!is_ftdx10 && !is_ft710 && !is_ftdx101d && !is_ftdx101mp && !is_ftx1) { return 0; }
+    if (!RIG_IS_FTDX10 && !RIG_IS_FT710 && !RIG_IS_FTDX101D && !RIG_IS_FTDX101MP && !RIG_IS_FTX1) { return 0; }
 
     rig_debug(RIG_DEBUG_VERBOSE, "%s: 60M exception ignoring freq/mode commands\n",
               __func__);
@@ -1228,9 +1234,9 @@ int newcat_set_freq(RIG *rig, vfo_t vfo, freq_t freq)
     //special_60m = newcat_is_rig(rig, RIG_MODEL_FTDX5000);
     //special_60m |= newcat_is_rig(rig, RIG_MODEL_FT450);
     rig_debug(RIG_DEBUG_TRACE,
-              "%s: special_60m=%d, 60m freq=%d, is_ftdx3000=%d,is_ftdx3000dm=%d\n",
+              "%s: special_60m=%d, 60m freq=%d, RIG_IS_FTDX3000=%d,RIG_IS_FTDX3000DM=%d\n",
               __func__, special_60m, freq >= 5300000
-              && freq <= 5410000, is_ftdx3000, is_ftdx3000dm);
+              && freq <= 5410000, RIG_IS_FTDX3000, RIG_IS_FTDX3000DM);
 
     if (special_60m && (freq >= 5300000 && freq <= 5410000))
     {
@@ -1239,7 +1245,7 @@ int newcat_set_freq(RIG *rig, vfo_t vfo, freq_t freq)
         RETURNFUNC(RIG_OK); /* make it look like we changed */
     }
 
-    if ((is_ftdx101d || is_ftdx101mp) && (freq >= 70000000 && freq <= 70499999))
+    if ((RIG_IS_FTDX101D || RIG_IS_FTDX101MP) && (freq >= 70000000 && freq <= 70499999))
     {
         // ensure the tuner is off for 70cm -- can cause damage to the rig
         newcat_set_func(rig, RIG_VFO_A, RIG_FUNC_TUNER, 0);
@@ -1267,7 +1273,7 @@ int newcat_set_freq(RIG *rig, vfo_t vfo, freq_t freq)
 
     // some rigs like FTDX101D cannot change non-TX vfo freq
     // but they can change the TX vfo
-    if ((is_ftdx101d || is_ftdx101mp) && cachep->ptt == RIG_PTT_ON)
+    if ((RIG_IS_FTDX101D || RIG_IS_FTDX101MP) && cachep->ptt == RIG_PTT_ON)
     {
         rig_debug(RIG_DEBUG_TRACE, "%s: ftdx101 check vfo OK, vfo=%s, tx_vfo=%s\n",
                   __func__, rig_strvfo(vfo), rig_strvfo(rig_s->tx_vfo));
@@ -1281,7 +1287,7 @@ int newcat_set_freq(RIG *rig, vfo_t vfo, freq_t freq)
         if (vfo != rig_s->tx_vfo) { RETURNFUNC(-RIG_ENTARGET); }
     }
 
-    if (is_ftdx3000 || is_ftdx3000dm || is_ftdx5000 || is_ftdx1200)
+    if (RIG_IS_FTDX3000 || RIG_IS_FTDX3000DM || RIG_IS_FTDX5000 || RIG_IS_FTDX1200)
     {
         // we have a few rigs that can't set freq while PTT_ON
         // so we'll try a few times to see if we just need to wait a bit
@@ -1368,7 +1374,7 @@ int newcat_set_freq(RIG *rig, vfo_t vfo, freq_t freq)
         rig_debug(RIG_DEBUG_TRACE, "%s(%d)%s: checking VFOA for band change \n",
                   __FILE__, __LINE__, __func__);
 
-        changing = newcat_band_index(freq) != newcat_band_index(freqA);
+        changing = newcat_band_index(rig, freq) != newcat_band_index(rig, freqA);
         rig_debug(RIG_DEBUG_TRACE, "%s: VFO_A band changing=%d\n", __func__, changing);
     }
     else
@@ -1378,7 +1384,7 @@ int newcat_set_freq(RIG *rig, vfo_t vfo, freq_t freq)
         rig_debug(RIG_DEBUG_TRACE, "%s(%d)%s: checking VFOB for band change \n",
                   __FILE__, __LINE__, __func__);
 
-        changing = newcat_band_index(freq) != newcat_band_index(freqB);
+        changing = newcat_band_index(rig, freq) != newcat_band_index(rig, freqB);
         rig_debug(RIG_DEBUG_TRACE, "%s: VFO_B band changing=%d\n", __func__, changing);
     }
 
@@ -1387,13 +1393,13 @@ int newcat_set_freq(RIG *rig, vfo_t vfo, freq_t freq)
             // remove the split check here -- hopefully works OK
             //&& !cachep->split
             // seems some rigs are problematic
-            // && !(is_ftdx3000 || is_ftdx3000dm)
+            // && !(RIG_IS_FTDX3000 || RIG_IS_FTDX3000DM)
             // some rigs can't do BS command on 60M
-            // && !(is_ftdx3000 || is_ftdx3000dm && newcat_band_index(freq) == 2)
-            && !(is_ft2000 && newcat_band_index(freq) == 2)
-            && !(is_ftdx1200 && newcat_band_index(freq) == 2)
-            && !is_ft891 // 891 does not remember bandwidth so don't do this
-            && !is_ft991 // 991 does not behave well with bandstack changes
+            // && !(RIG_IS_FTDX3000 || RIG_IS_FTDX3000DM && newcat_band_index(rig, freq) == 2)
+            && !(RIG_IS_FT2000 && newcat_band_index(rig, freq) == 2)
+            && !(RIG_IS_FTDX1200 && newcat_band_index(rig, freq) == 2)
+            && !RIG_IS_FT891 // 891 does not remember bandwidth so don't do this
+            && !RIG_IS_FT991 // 991 does not behave well with bandstack changes
             && rig->caps->get_vfo != NULL
             && rig->caps->set_vfo != NULL) // gotta' have get_vfo too
     {
@@ -1409,15 +1415,15 @@ int newcat_set_freq(RIG *rig, vfo_t vfo, freq_t freq)
             }
 
             // we need to change vfos, BS, and change back
-            if (is_ft991 == FALSE && is_ft891 == FALSE && newcat_valid_command(rig, "VS"))
+            if (RIG_IS_FT991 == FALSE && RIG_IS_FT891 == FALSE && newcat_valid_command(rig, "VS"))
             {
                 SNPRINTF(priv->cmd_str, sizeof(priv->cmd_str), "VS%d;BS%02d%c",
-                         vfo1, newcat_band_index(freq), cat_term);
+                         vfo1, newcat_band_index(rig, freq), cat_term);
             }
             else
             {
                 SNPRINTF(priv->cmd_str, sizeof(priv->cmd_str), "BS%02d%c",
-                         newcat_band_index(freq), cat_term);
+                         newcat_band_index(rig, freq), cat_term);
             }
 
 
@@ -1443,7 +1449,7 @@ int newcat_set_freq(RIG *rig, vfo_t vfo, freq_t freq)
         else
         {
             SNPRINTF(priv->cmd_str, sizeof(priv->cmd_str), "BS%02d%c",
-                     newcat_band_index(freq), cat_term);
+                     newcat_band_index(rig, freq), cat_term);
 
             if (RIG_OK != (err = newcat_set_cmd(rig)))
             {
@@ -1485,11 +1491,11 @@ int newcat_set_freq(RIG *rig, vfo_t vfo, freq_t freq)
             // If the BS works on both VFOs then VFOB will have the band select answer
             // so now change needed
             // If the BS is by VFO then we'll need to do BS for the other VFO too
-            if (newcat_band_index(freqtmp) != newcat_band_index(freq))
+            if (newcat_band_index(rig, freqtmp) != newcat_band_index(rig, freq))
             {
 
                 SNPRINTF(priv->cmd_str, sizeof(priv->cmd_str), "BS%02d%c",
-                         newcat_band_index(freq), cat_term);
+                         newcat_band_index(rig, freq), cat_term);
 
                 if (RIG_OK != (err = newcat_set_cmd(rig)))
                 {
@@ -1569,29 +1575,29 @@ int newcat_set_freq(RIG *rig, vfo_t vfo, freq_t freq)
         // just drop through
     }
 
-    rig_debug(RIG_DEBUG_VERBOSE, "%s: is_ft991=%d, CACHE(rig)->split=%d, vfo=%s\n",
-              __func__, is_ft991, cachep->split, rig_strvfo(vfo));
+    rig_debug(RIG_DEBUG_VERBOSE, "%s: RIG_IS_FT991=%d, CACHE(rig)->split=%d, vfo=%s\n",
+              __func__, RIG_IS_FT991, cachep->split, rig_strvfo(vfo));
 
-    if (priv->band_index < 0) { priv->band_index = newcat_band_index(freq); }
+    if (priv->band_index < 0) { priv->band_index = newcat_band_index(rig, freq); }
 
     // only use bandstack method when actually changing bands
     // there are multiple bandstacks so we just use the 1st one
-    if (is_ft991 && vfo == RIG_VFO_A && priv->band_index != newcat_band_index(freq))
+    if (RIG_IS_FT991 && vfo == RIG_VFO_A && priv->band_index != newcat_band_index(rig, freq))
     {
         if (cachep->split)
         {
             // FT991/991A bandstack does not work in split mode
             // so for a VFOA change we stop split, change bands, change freq, enable split
             SNPRINTF(priv->cmd_str, sizeof(priv->cmd_str), "FT2;BS%02d;FA%09.0f;FT3;",
-                     newcat_band_index(freq), freq);
+                     newcat_band_index(rig, freq), freq);
         }
         else  // in non-split us BS to get bandstack info
         {
             SNPRINTF(priv->cmd_str, sizeof(priv->cmd_str), "BS%02d;FA%09.0f;",
-                     newcat_band_index(freq), freq);
+                     newcat_band_index(rig, freq), freq);
         }
 
-        priv->band_index = newcat_band_index(freq);
+        priv->band_index = newcat_band_index(rig, freq);
     }
 
     else if (RIG_MODEL_FT450 == caps->rig_model)
@@ -1624,7 +1630,7 @@ int newcat_set_freq(RIG *rig, vfo_t vfo, freq_t freq)
     }
 
     rig_debug(RIG_DEBUG_TRACE, "%s: band changing? old=%d, new=%d\n", __func__,
-              newcat_band_index(freq), newcat_band_index(rig_s->current_freq));
+              newcat_band_index(rig, freq), newcat_band_index(rig, rig_s->current_freq));
 
     if (RIG_MODEL_FT450 == caps->rig_model && priv->ret_data[2] != target_vfo)
     {
@@ -2177,7 +2183,7 @@ int newcat_set_ptt(RIG *rig, vfo_t vfo, ptt_t ptt)
 
         /* Build the command string */
         // the FTDX5000 uses menu 103 for front/rear audio in USB mode
-        if (is_ftdx5000)
+        if (RIG_IS_FTDX5000)
         {
             // Ensure FT5000 is back to MIC input
             SNPRINTF(priv->cmd_str, sizeof(priv->cmd_str), "EX1030;");
@@ -2194,7 +2200,7 @@ int newcat_set_ptt(RIG *rig, vfo_t vfo, ptt_t ptt)
 
         /* Build the command string */
         // the FTDX5000 uses menu 103 for front/rear audio in USB mode
-        if (is_ftdx5000)
+        if (RIG_IS_FTDX5000)
         {
             // Ensure FT5000 is back to MIC input
             SNPRINTF(priv->cmd_str, sizeof(priv->cmd_str), "EX1031;");
@@ -2226,7 +2232,7 @@ int newcat_set_ptt(RIG *rig, vfo_t vfo, ptt_t ptt)
         if (STATE(rig)->current_mode != RIG_MODE_CW
                 && STATE(rig)->current_mode != RIG_MODE_CWR
                 && STATE(rig)->current_mode != RIG_MODE_CWN
-                && (is_ftdx3000 || is_ftdx3000dm)
+                && (RIG_IS_FTDX3000 || RIG_IS_FTDX3000DM)
            )
         {
             // DX3000 with separate rx/tx antennas was failing frequency change
@@ -2745,19 +2751,19 @@ int newcat_set_split_vfo(RIG *rig, vfo_t vfo, split_t split, vfo_t tx_vfo)
         //RETURNFUNC(RIG_OK); // fake the return code to make things happy
     }
 
-    if (is_ft991)
+    if (RIG_IS_FT991)
     {
         // FT-991(A) doesn't have a concept of an active VFO, so VFO B needs to be the split VFO
         vfo = RIG_VFO_A;
         tx_vfo = RIG_SPLIT_ON == split ? RIG_VFO_B : RIG_VFO_A;
     }
-    else if (is_ftdx101d || is_ftdx101mp || is_ftx1)
+    else if (RIG_IS_FTDX101D || RIG_IS_FTDX101MP || RIG_IS_FTX1)
     {
         // FTDX101(D/MP) always use Sub VFO for transmit when in split mode
         vfo = RIG_VFO_MAIN;
         tx_vfo = RIG_SPLIT_ON == split ? RIG_VFO_SUB : RIG_VFO_MAIN;
     }
-    else if (is_ftdx10)
+    else if (RIG_IS_FTDX10)
     {
         // FTDX10 always uses VFO B for transmit when in split mode
         vfo = RIG_VFO_A;
@@ -2892,6 +2898,142 @@ int newcat_get_split_vfo(RIG *rig, vfo_t vfo, split_t *split, vfo_t *tx_vfo)
     RETURNFUNC(RIG_OK);
 }
 
+/*
+ * newcat_get_vfo_snapshot
+ * IF answers for VFO A and OI for VFO B, so neither needs a VFO swap
+ * The commands for the VFOs, split and PTT are read in one batch first
+ */
+int newcat_get_vfo_snapshot(RIG *rig, struct rig_vfo_snapshot *snapshot)
+{
+    struct newcat_priv_data *priv = (struct newcat_priv_data *)STATE(rig)->priv;
+    struct newcat_batch_cmd batch[5];
+    int count = 0;
+    int err;
+
+    ENTERFUNC;
+
+    memset(batch, 0, sizeof(batch));
+
+    if (!newcat_valid_command(rig, "IF") || !newcat_valid_command(rig, "OI"))
+    {
+        RETURNFUNC(-RIG_ENAVAIL);
+    }
+
+    if (STATE(rig)->powerstat == 0)
+    {
+        rig_debug(RIG_DEBUG_WARN, "%s: Cannot get from rig when power is off\n",
+                  __func__);
+        snapshot->vfos[0].cached = 1;
+        snapshot->vfos[1].cached = 1;
+        RETURNFUNC(RIG_OK); // to prevent repeats
+    }
+
+    // what newcat_get_split_vfo() and newcat_get_ptt() will ask for
+    SNPRINTF(batch[count++].cmd_str, sizeof(batch[0].cmd_str), "IF%c", cat_term);
+    SNPRINTF(batch[count++].cmd_str, sizeof(batch[0].cmd_str), "OI%c", cat_term);
+
+    if (newcat_valid_command(rig, "ST") && !RIG_IS_FT450
+            && !priv->split_st_command_missing)
+    {
+        SNPRINTF(batch[count++].cmd_str, sizeof(batch[0].cmd_str), "ST%c", cat_term);
+    }
+
+    if (newcat_valid_command(rig, "FT"))
+    {
+        SNPRINTF(batch[count++].cmd_str, sizeof(batch[0].cmd_str), "FT%c", cat_term);
+    }
+
+    if (newcat_valid_command(rig, "TX"))
+    {
+        SNPRINTF(batch[count++].cmd_str, sizeof(batch[0].cmd_str), "TX%c", cat_term);
+    }
+
+    // failed entries are asked for again by newcat_get_cmd()
+    newcat_get_cmd_batch(rig, batch, count);
+    priv->prefetch = batch;
+    priv->prefetch_count = count;
+
+    err = newcat_get_vfo_snapshot_prefetched(rig, snapshot);
+
+    priv->prefetch = NULL;
+    priv->prefetch_count = 0;
+
+    RETURNFUNC(err);
+}
+
+/* Reads the snapshot with newcat_get_cmd() answered from priv->prefetch */
+static int newcat_get_vfo_snapshot_prefetched(RIG *rig,
+        struct rig_vfo_snapshot *snapshot)
+{
+    struct newcat_priv_data *priv = (struct newcat_priv_data *)STATE(rig)->priv;
+    int err;
+    int i;
+
+    ENTERFUNC;
+
+    for (i = 0; i < 2; i++)
+    {
+        struct rig_vfo_snapshot_entry *entry = &snapshot->vfos[i];
+        int width_frequency;
+        char freqbuf[10];
+        rmode_t mode;
+
+        SNPRINTF(priv->cmd_str, sizeof(priv->cmd_str), "%s%c", i == 0 ? "IF" : "OI",
+                 cat_term);
+
+        if (RIG_OK != (err = newcat_get_cmd(rig)))
+        {
+            RETURNFUNC(err);
+        }
+
+        // same layouts as in newcat_get_vfo_mode()
+        switch (strlen(priv->ret_data))
+        {
+        case 27:
+        case 30: width_frequency = 8; break;
+
+        case 41:
+        case 28: width_frequency = 9; break;
+
+        default:
+            rig_debug(RIG_DEBUG_ERR,
+                      "%s: incorrect length of %2.2s response, expected 27 or 28, got %d\n",
+                      __func__, priv->cmd_str, (int)strlen(priv->ret_data));
+            RETURNFUNC(-RIG_EPROTO);
+        }
+
+        memcpy(freqbuf, priv->ret_data + 5, width_frequency);
+        freqbuf[width_frequency] = '\0';
+        entry->freq = atof(freqbuf);
+
+        // P6 mode follows P2 freq, P3 clarifier offset, P4 and P5 clarifier switches
+        mode = newcat_rmode(priv->ret_data[5 + width_frequency + 7]);
+
+        if (mode != entry->mode)
+        {
+            entry->mode = mode;
+            entry->width = rig_passband_normal(rig, mode);
+        }
+    }
+
+    err = newcat_get_split_vfo(rig, RIG_VFO_CURR, &snapshot->split,
+                               &snapshot->tx_vfo);
+
+    if (err != RIG_OK && err != -RIG_ENAVAIL)
+    {
+        RETURNFUNC(err);
+    }
+
+    err = newcat_get_ptt(rig, RIG_VFO_CURR, &snapshot->ptt);
+
+    if (err != RIG_OK && err != -RIG_ENAVAIL)
+    {
+        RETURNFUNC(err);
+    }
+
+    RETURNFUNC(RIG_OK);
+}
+
 int newcat_set_rit(RIG *rig, vfo_t vfo, shortfreq_t rit)
 {
     struct newcat_priv_data *priv = (struct newcat_priv_data *)STATE(rig)->priv;
@@ -3321,7 +3463,7 @@ int newcat_set_ctcss_tone(RIG *rig, vfo_t vfo, tone_t tone)
     }
     else
     {
-        if (is_ft891 || is_ft991 || is_ftdx101d || is_ftdx101mp || is_ftdx10)
+        if (RIG_IS_FT891 || RIG_IS_FT991 || RIG_IS_FTDX101D || RIG_IS_FTDX101MP || RIG_IS_FTDX10)
         {
             SNPRINTF(priv->cmd_str, sizeof(priv->cmd_str), "CN%c0%03d%cCT%c2%c",
                      main_sub_vfo, i, cat_term, main_sub_vfo, cat_term);
@@ -3366,7 +3508,7 @@ int newcat_get_ctcss_tone(RIG *rig, vfo_t vfo, tone_t *tone)
         main_sub_vfo = (RIG_VFO_B == vfo || RIG_VFO_SUB == vfo) ? '1' : '0';
     }
 
-    if (is_ft891 || is_ft991 || is_ftdx101d || is_ftdx101mp || is_ftdx10)
+    if (RIG_IS_FT891 || RIG_IS_FT991 || RIG_IS_FTDX101D || RIG_IS_FTDX101MP || RIG_IS_FTDX10)
     {
         SNPRINTF(priv->cmd_str, sizeof(priv->cmd_str), "%s%c0%c", cmd, main_sub_vfo,
                  cat_term);
@@ -3682,7 +3824,7 @@ int newcat_set_powerstat(RIG *rig, powerstat_t status)
 
         //oser_close(rp);
         // we can add more rigs to this exception to speed them up
-        if (!is_ft991)
+        if (!RIG_IS_FT991)
         {
             rig_close(rig);
             hl_usleep(3000000);
@@ -4109,7 +4251,7 @@ int newcat_set_level(RIG *rig, vfo_t vfo, setting_t level, value_t val)
             RETURNFUNC(-RIG_ENAVAIL);
         }
 
-        if (is_ftdx3000dm)      /* No separate rig->caps for this rig :-( */
+        if (RIG_IS_FTDX3000DM)      /* No separate rig->caps for this rig :-( */
         {
             fpf = (int)((val.f * 50.0f) + 0.5f);
         }
@@ -4129,7 +4271,7 @@ int newcat_set_level(RIG *rig, vfo_t vfo, setting_t level, value_t val)
 
         fpf = (int)((val.f / level_info->step.f) + 0.5f);
 
-        if (is_ftdx10) { main_sub_vfo = '0'; }
+        if (RIG_IS_FTDX10) { main_sub_vfo = '0'; }
 
         SNPRINTF(priv->cmd_str, sizeof(priv->cmd_str), "AG%c%03d%c", main_sub_vfo, fpf,
                  cat_term);
@@ -4167,7 +4309,7 @@ int newcat_set_level(RIG *rig, vfo_t vfo, setting_t level, value_t val)
             RETURNFUNC(-RIG_EINVAL);
         }
 
-        if (rig->caps->targetable_vfo & RIG_TARGETABLE_LEVEL && !is_ftdx10 && !is_ft710)
+        if (rig->caps->targetable_vfo & RIG_TARGETABLE_LEVEL && !RIG_IS_FTDX10 && !RIG_IS_FT710)
         {
             priv->cmd_str[2] = main_sub_vfo;
         }
@@ -4184,8 +4326,8 @@ int newcat_set_level(RIG *rig, vfo_t vfo, setting_t level, value_t val)
             RETURNFUNC(-RIG_ENAVAIL);
         }
 
-        if (is_ft991 || is_ftdx3000 || is_ftdx3000dm || is_ftdx5000 || is_ftdx101d
-                || is_ftdx101mp)
+        if (RIG_IS_FT991 || RIG_IS_FTDX3000 || RIG_IS_FTDX3000DM || RIG_IS_FTDX5000 || RIG_IS_FTDX101D
+                || RIG_IS_FTDX101MP)
         {
             newcat_get_mode(rig, vfo, &mode, &width);
         }
@@ -4204,17 +4346,17 @@ int newcat_set_level(RIG *rig, vfo_t vfo, setting_t level, value_t val)
             }
         }
 
-        if (is_ftdx101d || is_ftdx101mp)
+        if (RIG_IS_FTDX101D || RIG_IS_FTDX101MP)
         {
             SNPRINTF(priv->cmd_str, sizeof(priv->cmd_str), "IS%c0%+.4d%c", main_sub_vfo,
                      val.i, cat_term);
         }
-        else if (is_ftdx10 || is_ft710)
+        else if (RIG_IS_FTDX10 || RIG_IS_FT710)
         {
             SNPRINTF(priv->cmd_str, sizeof(priv->cmd_str), "IS00%+.4d%c",
                      val.i, cat_term);
         }
-        else if (is_ft891)
+        else if (RIG_IS_FT891)
         {
             SNPRINTF(priv->cmd_str, sizeof(priv->cmd_str), "IS0%d%+.4d%c",
                      val.i == 0 ? 0 : 1,
@@ -4226,15 +4368,15 @@ int newcat_set_level(RIG *rig, vfo_t vfo, setting_t level, value_t val)
                      val.i, cat_term);
         }
 
-        if (rig->caps->targetable_vfo & RIG_TARGETABLE_LEVEL && !is_ft2000
-                && !is_ftdx10 && !is_ft710)
+        if (rig->caps->targetable_vfo & RIG_TARGETABLE_LEVEL && !RIG_IS_FT2000
+                && !RIG_IS_FTDX10 && !RIG_IS_FT710)
         {
             priv->cmd_str[2] = main_sub_vfo;
         }
 
         // Some Yaesu rigs reject this command in AM/FM modes
-        if (is_ft991 || is_ftdx3000 || is_ftdx3000dm || is_ftdx5000 || is_ftdx101d
-                || is_ftdx101mp)
+        if (RIG_IS_FT991 || RIG_IS_FTDX3000 || RIG_IS_FTDX3000DM || RIG_IS_FTDX5000 || RIG_IS_FTDX101D
+                || RIG_IS_FTDX101MP)
         {
             if (mode & RIG_MODE_AM || mode & RIG_MODE_FM || mode & RIG_MODE_AMN
                     || mode & RIG_MODE_FMN)
@@ -4295,9 +4437,9 @@ int newcat_set_level(RIG *rig, vfo_t vfo, setting_t level, value_t val)
         }
 
 
-        if (is_ft991 || is_ft710 || is_ftdx3000 || is_ftdx3000dm || is_ftdx5000
-                || is_ftdx101d
-                || is_ftdx101mp)
+        if (RIG_IS_FT991 || RIG_IS_FT710 || RIG_IS_FTDX3000 || RIG_IS_FTDX3000DM || RIG_IS_FTDX5000
+                || RIG_IS_FTDX101D
+                || RIG_IS_FTDX101MP)
         {
             newcat_get_mode(rig, vfo, &mode, &width);
         }
@@ -4307,9 +4449,9 @@ int newcat_set_level(RIG *rig, vfo_t vfo, setting_t level, value_t val)
         SNPRINTF(priv->cmd_str, sizeof(priv->cmd_str), "MG%03d%c", fpf, cat_term);
 
         // Some Yaesu rigs reject this command in RTTY modes
-        if (is_ft991 || is_ft710 || is_ftdx3000 || is_ftdx3000dm || is_ftdx5000
-                || is_ftdx101d
-                || is_ftdx101mp)
+        if (RIG_IS_FT991 || RIG_IS_FT710 || RIG_IS_FTDX3000 || RIG_IS_FTDX3000DM || RIG_IS_FTDX5000
+                || RIG_IS_FTDX101D
+                || RIG_IS_FTDX101MP)
         {
             if (mode & RIG_MODE_RTTY || mode & RIG_MODE_RTTYR)
             {
@@ -4326,8 +4468,8 @@ int newcat_set_level(RIG *rig, vfo_t vfo, setting_t level, value_t val)
             RETURNFUNC(-RIG_ENAVAIL);
         }
 
-        if (is_ftdx101d
-                || is_ftdx101mp) // new format for the command with VFO selection
+        if (RIG_IS_FTDX101D
+                || RIG_IS_FTDX101MP) // new format for the command with VFO selection
         {
             format = "MS0%d;";
 
@@ -4336,7 +4478,7 @@ int newcat_set_level(RIG *rig, vfo_t vfo, setting_t level, value_t val)
                 format = "MS1%d;";
             }
         }
-        else if (is_ftdx10)
+        else if (RIG_IS_FTDX10)
         {
             format = "MS%d0;";
         }
@@ -4393,8 +4535,8 @@ int newcat_set_level(RIG *rig, vfo_t vfo, setting_t level, value_t val)
         {
             SNPRINTF(priv->cmd_str, sizeof(priv->cmd_str), "PA00%c", cat_term);
 
-            if (rig->caps->targetable_vfo & RIG_TARGETABLE_LEVEL && !is_ft2000
-                    && !is_ftdx10 && !is_ft710)
+            if (rig->caps->targetable_vfo & RIG_TARGETABLE_LEVEL && !RIG_IS_FT2000
+                    && !RIG_IS_FTDX10 && !RIG_IS_FT710)
             {
                 priv->cmd_str[2] = main_sub_vfo;
             }
@@ -4418,8 +4560,8 @@ int newcat_set_level(RIG *rig, vfo_t vfo, setting_t level, value_t val)
             RETURNFUNC(-RIG_EINVAL);
         }
 
-        if (rig->caps->targetable_vfo & RIG_TARGETABLE_LEVEL  && !is_ft2000
-                && !is_ftdx10 && !is_ft710)
+        if (rig->caps->targetable_vfo & RIG_TARGETABLE_LEVEL  && !RIG_IS_FT2000
+                && !RIG_IS_FTDX10 && !RIG_IS_FT710)
         {
             priv->cmd_str[2] = main_sub_vfo;
         }
@@ -4436,8 +4578,8 @@ int newcat_set_level(RIG *rig, vfo_t vfo, setting_t level, value_t val)
         {
             SNPRINTF(priv->cmd_str, sizeof(priv->cmd_str), "RA00%c", cat_term);
 
-            if (rig->caps->targetable_vfo & RIG_TARGETABLE_LEVEL && !is_ft2000
-                    && !is_ftdx10 && !is_ft710)
+            if (rig->caps->targetable_vfo & RIG_TARGETABLE_LEVEL && !RIG_IS_FT2000
+                    && !RIG_IS_FTDX10 && !RIG_IS_FT710)
             {
                 priv->cmd_str[2] = main_sub_vfo;
             }
@@ -4461,8 +4603,8 @@ int newcat_set_level(RIG *rig, vfo_t vfo, setting_t level, value_t val)
             RETURNFUNC(-RIG_EINVAL);
         }
 
-        if (rig->caps->targetable_vfo & RIG_TARGETABLE_LEVEL && !is_ft2000
-                && !is_ftdx10 && !is_ft710)
+        if (rig->caps->targetable_vfo & RIG_TARGETABLE_LEVEL && !RIG_IS_FT2000
+                && !RIG_IS_FTDX10 && !RIG_IS_FT710)
         {
             priv->cmd_str[2] = main_sub_vfo;
         }
@@ -4477,7 +4619,7 @@ int newcat_set_level(RIG *rig, vfo_t vfo, setting_t level, value_t val)
 
         fpf = (int)((val.f / level_info->step.f) + 0.5f);
 
-        if (is_ftdx10) { main_sub_vfo = '0'; }
+        if (RIG_IS_FTDX10) { main_sub_vfo = '0'; }
 
         SNPRINTF(priv->cmd_str, sizeof(priv->cmd_str), "RG%c%03d%c", main_sub_vfo, fpf,
                  cat_term);
@@ -4507,7 +4649,7 @@ int newcat_set_level(RIG *rig, vfo_t vfo, setting_t level, value_t val)
         }
         else
         {
-            if (is_ft991)
+            if (RIG_IS_FT991)
             {
                 if (fpf > 15) { fpf = 15; }
 
@@ -4520,8 +4662,8 @@ int newcat_set_level(RIG *rig, vfo_t vfo, setting_t level, value_t val)
 
             SNPRINTF(priv->cmd_str, sizeof(priv->cmd_str), "RL0%02d%c", fpf, cat_term);
 
-            if (rig->caps->targetable_vfo & RIG_TARGETABLE_LEVEL && !is_ft2000
-                    && !is_ftdx10 && !is_ft710)
+            if (rig->caps->targetable_vfo & RIG_TARGETABLE_LEVEL && !RIG_IS_FT2000
+                    && !RIG_IS_FTDX10 && !RIG_IS_FT710)
             {
                 priv->cmd_str[2] = main_sub_vfo;
             }
@@ -4560,7 +4702,7 @@ int newcat_set_level(RIG *rig, vfo_t vfo, setting_t level, value_t val)
 
         millis = dot10ths_to_millis(val.i, keyspd.i);
 
-        if (is_ftdx101d || is_ftdx101mp || is_ftdx10 || is_ft710)
+        if (RIG_IS_FTDX101D || RIG_IS_FTDX101MP || RIG_IS_FTDX10 || RIG_IS_FT710)
         {
             if (millis <= 30) { SNPRINTF(priv->cmd_str, sizeof(priv->cmd_str), "SD00;"); }
             else if (millis <= 50) { SNPRINTF(priv->cmd_str, sizeof(priv->cmd_str), "SD01;"); }
@@ -4576,7 +4718,7 @@ int newcat_set_level(RIG *rig, vfo_t vfo, setting_t level, value_t val)
                          6 + ((millis - 300) / 100));
             }
         }
-        else if (is_ftdx5000)
+        else if (RIG_IS_FTDX5000)
         {
             if (millis < 20)
             {
@@ -4590,8 +4732,8 @@ int newcat_set_level(RIG *rig, vfo_t vfo, setting_t level, value_t val)
 
             SNPRINTF(priv->cmd_str, sizeof(priv->cmd_str), "SD%04d%c", millis, cat_term);
         }
-        else if (is_ft950 || is_ft450 || is_ft891 || is_ft991 || is_ftdx1200
-                 || is_ftdx3000 || is_ftdx3000dm)
+        else if (RIG_IS_FT950 || RIG_IS_FT450 || RIG_IS_FT891 || RIG_IS_FT991 || RIG_IS_FTDX1200
+                 || RIG_IS_FTDX3000 || RIG_IS_FTDX3000DM)
         {
             if (millis < 30)
             {
@@ -4605,7 +4747,7 @@ int newcat_set_level(RIG *rig, vfo_t vfo, setting_t level, value_t val)
 
             SNPRINTF(priv->cmd_str, sizeof(priv->cmd_str), "SD%04d%c", millis, cat_term);
         }
-        else if (is_ft2000 || is_ftdx9000)
+        else if (RIG_IS_FT2000 || RIG_IS_FTDX9000)
         {
             if (millis < 0)
             {
@@ -4647,7 +4789,7 @@ int newcat_set_level(RIG *rig, vfo_t vfo, setting_t level, value_t val)
         SNPRINTF(priv->cmd_str, sizeof(priv->cmd_str), "SQ%c%03d%c", main_sub_vfo, fpf,
                  cat_term);
 
-        if (rig->caps->targetable_vfo & RIG_TARGETABLE_LEVEL && !is_ftdx10 && !is_ft710)
+        if (rig->caps->targetable_vfo & RIG_TARGETABLE_LEVEL && !RIG_IS_FTDX10 && !RIG_IS_FT710)
         {
             priv->cmd_str[2] = main_sub_vfo;
         }
@@ -4664,7 +4806,7 @@ int newcat_set_level(RIG *rig, vfo_t vfo, setting_t level, value_t val)
         val.i = val.i * 100;
         rig_debug(RIG_DEBUG_TRACE, "%s: vali=%d\n", __func__, val.i);
 
-        if (is_ft950 || is_ft450 || is_ftdx1200)
+        if (RIG_IS_FT950 || RIG_IS_FT450 || RIG_IS_FTDX1200)
         {
             if (val.i < 100)         /* min is 30ms but spec is 100ms Unit Intervals */
             {
@@ -4678,8 +4820,8 @@ int newcat_set_level(RIG *rig, vfo_t vfo, setting_t level, value_t val)
 
             SNPRINTF(priv->cmd_str, sizeof(priv->cmd_str), "VD%04d%c", val.i, cat_term);
         }
-        else if (is_ftdx101d || is_ftdx101mp || is_ftdx10
-                 || is_ft710) // new lookup table argument
+        else if (RIG_IS_FTDX101D || RIG_IS_FTDX101MP || RIG_IS_FTDX10
+                 || RIG_IS_FT710) // new lookup table argument
         {
             rig_debug(RIG_DEBUG_TRACE, "%s: ft101 #1 val.i=%d\n", __func__, val.i);
 
@@ -4747,7 +4889,7 @@ int newcat_set_level(RIG *rig, vfo_t vfo, setting_t level, value_t val)
 
         val.i = val.i / 10;
 
-        if (is_ftdx9000)
+        if (RIG_IS_FTDX9000)
         {
             if (val.i < 0)
             {
@@ -4762,7 +4904,7 @@ int newcat_set_level(RIG *rig, vfo_t vfo, setting_t level, value_t val)
             }
         }
 
-        if (is_ft891 || is_ft991 || is_ftdx101d || is_ftdx101mp || is_ftdx10)
+        if (RIG_IS_FT891 || RIG_IS_FT991 || RIG_IS_FTDX101D || RIG_IS_FTDX101MP || RIG_IS_FTDX10)
         {
             if (val.i > 320)
             {
@@ -4770,7 +4912,7 @@ int newcat_set_level(RIG *rig, vfo_t vfo, setting_t level, value_t val)
             }
         }
 
-        if (is_ft950 || is_ftdx9000)
+        if (RIG_IS_FT950 || RIG_IS_FTDX9000)
         {
             if (val.i > 300)
             {
@@ -4787,12 +4929,12 @@ int newcat_set_level(RIG *rig, vfo_t vfo, setting_t level, value_t val)
 
         SNPRINTF(priv->cmd_str, sizeof(priv->cmd_str), "BP01%03d%c", val.i, cat_term);
 
-        if (is_ftdx9000)
+        if (RIG_IS_FTDX9000)
         {
             SNPRINTF(priv->cmd_str, sizeof(priv->cmd_str), "BP%03d%c", val.i, cat_term);
         }
-        else if (rig->caps->targetable_vfo & RIG_TARGETABLE_LEVEL && !is_ft2000
-                 && !is_ftdx10 && !is_ft710)
+        else if (rig->caps->targetable_vfo & RIG_TARGETABLE_LEVEL && !RIG_IS_FT2000
+                 && !RIG_IS_FTDX10 && !RIG_IS_FT710)
         {
             priv->cmd_str[2] = main_sub_vfo;
         }
@@ -4807,7 +4949,7 @@ int newcat_set_level(RIG *rig, vfo_t vfo, setting_t level, value_t val)
 
         fpf = (int)((val.f / level_info->step.f) + 0.5f);
 
-        if (is_ftdx9000)
+        if (RIG_IS_FTDX9000)
         {
             SNPRINTF(priv->cmd_str, sizeof(priv->cmd_str), "ML%03d%c", fpf, cat_term);
         }
@@ -4855,8 +4997,8 @@ int newcat_set_level(RIG *rig, vfo_t vfo, setting_t level, value_t val)
 
         SNPRINTF(priv->cmd_str, sizeof(priv->cmd_str), "NL00%02d%c", fpf, cat_term);
 
-        if (rig->caps->targetable_vfo & RIG_TARGETABLE_LEVEL && !is_ftdx10 && !is_ft710
-                && !is_ftdx101mp)
+        if (rig->caps->targetable_vfo & RIG_TARGETABLE_LEVEL && !RIG_IS_FTDX10 && !RIG_IS_FT710
+                && !RIG_IS_FTDX101MP)
         {
             priv->cmd_str[2] = main_sub_vfo;
         }
@@ -4864,7 +5006,7 @@ int newcat_set_level(RIG *rig, vfo_t vfo, setting_t level, value_t val)
         break;
 
     case RIG_LEVEL_USB_AF:
-        if (is_ftdx101d || is_ftdx101mp)
+        if (RIG_IS_FTDX101D || RIG_IS_FTDX101MP)
         {
             rmode_t curmode = STATE(rig)->current_vfo == RIG_VFO_A ?
                               cachep->modeMainA : cachep->modeMainB;
@@ -4968,8 +5110,8 @@ int newcat_get_level(RIG *rig, vfo_t vfo, setting_t level, value_t *val)
 
         SNPRINTF(priv->cmd_str, sizeof(priv->cmd_str), "PA0%c", cat_term);
 
-        if (rig->caps->targetable_vfo & RIG_TARGETABLE_LEVEL && !is_ft2000
-                && !is_ftdx10 && !is_ft710)
+        if (rig->caps->targetable_vfo & RIG_TARGETABLE_LEVEL && !RIG_IS_FT2000
+                && !RIG_IS_FTDX10 && !RIG_IS_FT710)
         {
             priv->cmd_str[2] = main_sub_vfo;
         }
@@ -4982,12 +5124,12 @@ int newcat_get_level(RIG *rig, vfo_t vfo, setting_t level, value_t *val)
             RETURNFUNC(-RIG_ENAVAIL);
         }
 
-        if (is_ftdx10) { main_sub_vfo = '0'; }
+        if (RIG_IS_FTDX10) { main_sub_vfo = '0'; }
 
         SNPRINTF(priv->cmd_str, sizeof(priv->cmd_str), "AG%c%c", main_sub_vfo,
                  cat_term);
 
-        if (rig->caps->targetable_vfo & RIG_TARGETABLE_LEVEL && !is_ftdx10 && !is_ft710)
+        if (rig->caps->targetable_vfo & RIG_TARGETABLE_LEVEL && !RIG_IS_FTDX10 && !RIG_IS_FT710)
         {
             priv->cmd_str[2] = main_sub_vfo;
         }
@@ -5003,7 +5145,7 @@ int newcat_get_level(RIG *rig, vfo_t vfo, setting_t level, value_t *val)
         SNPRINTF(priv->cmd_str, sizeof(priv->cmd_str), "GT%c%c", main_sub_vfo,
                  cat_term);
 
-        if (rig->caps->targetable_vfo & RIG_TARGETABLE_LEVEL && !is_ftdx10 && !is_ft710)
+        if (rig->caps->targetable_vfo & RIG_TARGETABLE_LEVEL && !RIG_IS_FTDX10 && !RIG_IS_FT710)
         {
             priv->cmd_str[2] = main_sub_vfo;
         }
@@ -5020,8 +5162,8 @@ int newcat_get_level(RIG *rig, vfo_t vfo, setting_t level, value_t *val)
             RETURNFUNC(-RIG_ENAVAIL);
         }
 
-        if (is_ft991 || is_ftdx3000 || is_ftdx3000dm || is_ftdx5000 || is_ftdx101d
-                || is_ftdx101mp)
+        if (RIG_IS_FT991 || RIG_IS_FTDX3000 || RIG_IS_FTDX3000DM || RIG_IS_FTDX5000 || RIG_IS_FTDX101D
+                || RIG_IS_FTDX101MP)
         {
             newcat_get_mode(rig, vfo, &mode, &width);
         }
@@ -5029,15 +5171,15 @@ int newcat_get_level(RIG *rig, vfo_t vfo, setting_t level, value_t *val)
         SNPRINTF(priv->cmd_str, sizeof(priv->cmd_str), "IS%c%c", main_sub_vfo,
                  cat_term);
 
-        if (rig->caps->targetable_vfo & RIG_TARGETABLE_LEVEL && !is_ft2000
-                && !is_ftdx10 && !is_ft710)
+        if (rig->caps->targetable_vfo & RIG_TARGETABLE_LEVEL && !RIG_IS_FT2000
+                && !RIG_IS_FTDX10 && !RIG_IS_FT710)
         {
             priv->cmd_str[2] = main_sub_vfo;
         }
 
         // Some Yaesu rigs reject this command in AM/FM modes
-        if (is_ft991 || is_ftdx3000 || is_ftdx3000dm || is_ftdx5000 || is_ftdx101d
-                || is_ftdx101mp)
+        if (RIG_IS_FT991 || RIG_IS_FTDX3000 || RIG_IS_FTDX3000DM || RIG_IS_FTDX5000 || RIG_IS_FTDX101D
+                || RIG_IS_FTDX101MP)
         {
             if (mode & RIG_MODE_AM || mode & RIG_MODE_FM || mode & RIG_MODE_AMN
                     || mode & RIG_MODE_FMN)
@@ -5088,9 +5230,9 @@ int newcat_get_level(RIG *rig, vfo_t vfo, setting_t level, value_t *val)
             RETURNFUNC(RIG_OK);
         }
 
-        if (is_ft991 || is_ft710 || is_ftdx3000 || is_ftdx3000dm || is_ftdx5000
-                || is_ftdx101d
-                || is_ftdx101mp)
+        if (RIG_IS_FT991 || RIG_IS_FT710 || RIG_IS_FTDX3000 || RIG_IS_FTDX3000DM || RIG_IS_FTDX5000
+                || RIG_IS_FTDX101D
+                || RIG_IS_FTDX101MP)
         {
             newcat_get_mode(rig, vfo, &mode, &width);
         }
@@ -5098,9 +5240,9 @@ int newcat_get_level(RIG *rig, vfo_t vfo, setting_t level, value_t *val)
         SNPRINTF(priv->cmd_str, sizeof(priv->cmd_str), "MG%c", cat_term);
 
         // Some Yaesu rigs reject this command in RTTY modes
-        if (is_ft991 || is_ft710 || is_ftdx3000 || is_ftdx3000dm || is_ftdx5000
-                || is_ftdx101d
-                || is_ftdx101mp)
+        if (RIG_IS_FT991 || RIG_IS_FT710 || RIG_IS_FTDX3000 || RIG_IS_FTDX3000DM || RIG_IS_FTDX5000
+                || RIG_IS_FTDX101D
+                || RIG_IS_FTDX101MP)
         {
             if (mode & RIG_MODE_RTTY || mode & RIG_MODE_RTTYR)
             {
@@ -5128,8 +5270,8 @@ int newcat_get_level(RIG *rig, vfo_t vfo, setting_t level, value_t *val)
 
         SNPRINTF(priv->cmd_str, sizeof(priv->cmd_str), "RA0%c", cat_term);
 
-        if (rig->caps->targetable_vfo & RIG_TARGETABLE_LEVEL && !is_ft2000
-                && !is_ftdx10 && !is_ft710)
+        if (rig->caps->targetable_vfo & RIG_TARGETABLE_LEVEL && !RIG_IS_FT2000
+                && !RIG_IS_FTDX10 && !RIG_IS_FT710)
         {
             priv->cmd_str[2] = main_sub_vfo;
         }
@@ -5163,8 +5305,8 @@ int newcat_get_level(RIG *rig, vfo_t vfo, setting_t level, value_t *val)
 
         SNPRINTF(priv->cmd_str, sizeof(priv->cmd_str), "RL0%c", cat_term);
 
-        if (rig->caps->targetable_vfo & RIG_TARGETABLE_LEVEL && !is_ft2000
-                && !is_ftdx10 && !is_ft710)
+        if (rig->caps->targetable_vfo & RIG_TARGETABLE_LEVEL && !RIG_IS_FT2000
+                && !RIG_IS_FTDX10 && !RIG_IS_FT710)
         {
             priv->cmd_str[2] = main_sub_vfo;
         }
@@ -5189,7 +5331,7 @@ int newcat_get_level(RIG *rig, vfo_t vfo, setting_t level, value_t *val)
         SNPRINTF(priv->cmd_str, sizeof(priv->cmd_str), "SQ%c%c", main_sub_vfo,
                  cat_term);
 
-        if (rig->caps->targetable_vfo & RIG_TARGETABLE_LEVEL && !is_ftdx10 && !is_ft710)
+        if (rig->caps->targetable_vfo & RIG_TARGETABLE_LEVEL && !RIG_IS_FTDX10 && !RIG_IS_FT710)
         {
             priv->cmd_str[2] = main_sub_vfo;
         }
@@ -5224,8 +5366,8 @@ int newcat_get_level(RIG *rig, vfo_t vfo, setting_t level, value_t *val)
 
         SNPRINTF(priv->cmd_str, sizeof(priv->cmd_str), "NL0%c", cat_term);
 
-        if (rig->caps->targetable_vfo & RIG_TARGETABLE_LEVEL && !is_ftdx10 && !is_ft710
-                && !is_ftdx101mp)
+        if (rig->caps->targetable_vfo & RIG_TARGETABLE_LEVEL && !RIG_IS_FTDX10 && !RIG_IS_FT710
+                && !RIG_IS_FTDX101MP)
         {
             priv->cmd_str[2] = main_sub_vfo;
         }
@@ -5242,7 +5384,7 @@ int newcat_get_level(RIG *rig, vfo_t vfo, setting_t level, value_t *val)
             RETURNFUNC(-RIG_ENAVAIL);
         }
 
-        if (is_ftdx10) { main_sub_vfo = '0'; }
+        if (RIG_IS_FTDX10) { main_sub_vfo = '0'; }
 
         SNPRINTF(priv->cmd_str, sizeof(priv->cmd_str), "SM%c%c", main_sub_vfo,
                  cat_term);
@@ -5254,11 +5396,11 @@ int newcat_get_level(RIG *rig, vfo_t vfo, setting_t level, value_t *val)
             RETURNFUNC(-RIG_ENAVAIL);
         }
 
-        if (is_ftdx9000)
+        if (RIG_IS_FTDX9000)
         {
             SNPRINTF(priv->cmd_str, sizeof(priv->cmd_str), "RM09%c", cat_term);
         }
-        else if (is_ftdx3000 || is_ftdx3000dm || is_ftdx5000)
+        else if (RIG_IS_FTDX3000 || RIG_IS_FTDX3000DM || RIG_IS_FTDX5000)
         {
             // The 3000 has to use the meter read for SWR when the tuner is on
             // We'll assume the 5000 is the same way for now
@@ -5290,7 +5432,7 @@ int newcat_get_level(RIG *rig, vfo_t vfo, setting_t level, value_t *val)
             RETURNFUNC(-RIG_ENAVAIL);
         }
 
-        if (is_ftdx9000)
+        if (RIG_IS_FTDX9000)
         {
             SNPRINTF(priv->cmd_str, sizeof(priv->cmd_str), "RM07%c", cat_term);
         }
@@ -5308,7 +5450,7 @@ int newcat_get_level(RIG *rig, vfo_t vfo, setting_t level, value_t *val)
             RETURNFUNC(-RIG_ENAVAIL);
         }
 
-        if (is_ftdx9000)
+        if (RIG_IS_FTDX9000)
         {
             SNPRINTF(priv->cmd_str, sizeof(priv->cmd_str), "RM08%c", cat_term);
         }
@@ -5325,7 +5467,7 @@ int newcat_get_level(RIG *rig, vfo_t vfo, setting_t level, value_t *val)
             RETURNFUNC(-RIG_ENAVAIL);
         }
 
-        if (is_ftdx9000)
+        if (RIG_IS_FTDX9000)
         {
             SNPRINTF(priv->cmd_str, sizeof(priv->cmd_str), "RM06%c", cat_term);
         }
@@ -5342,7 +5484,7 @@ int newcat_get_level(RIG *rig, vfo_t vfo, setting_t level, value_t *val)
             RETURNFUNC(-RIG_ENAVAIL);
         }
 
-        if (is_ftdx9000)
+        if (RIG_IS_FTDX9000)
         {
             SNPRINTF(priv->cmd_str, sizeof(priv->cmd_str), "RM11%c", cat_term);
         }
@@ -5359,7 +5501,7 @@ int newcat_get_level(RIG *rig, vfo_t vfo, setting_t level, value_t *val)
             RETURNFUNC(-RIG_ENAVAIL);
         }
 
-        if (is_ftdx9000)
+        if (RIG_IS_FTDX9000)
         {
             SNPRINTF(priv->cmd_str, sizeof(priv->cmd_str), "RM10%c", cat_term);
         }
@@ -5391,12 +5533,12 @@ int newcat_get_level(RIG *rig, vfo_t vfo, setting_t level, value_t *val)
 
         SNPRINTF(priv->cmd_str, sizeof(priv->cmd_str), "BP01%c", cat_term);
 
-        if (is_ftdx9000)
+        if (RIG_IS_FTDX9000)
         {
             SNPRINTF(priv->cmd_str, sizeof(priv->cmd_str), "BP%c", cat_term);
         }
-        else if (rig->caps->targetable_vfo & RIG_TARGETABLE_LEVEL && !is_ft2000
-                 && !is_ftdx10 && !is_ft710)
+        else if (rig->caps->targetable_vfo & RIG_TARGETABLE_LEVEL && !RIG_IS_FT2000
+                 && !RIG_IS_FTDX10 && !RIG_IS_FT710)
         {
             priv->cmd_str[2] = main_sub_vfo;
         }
@@ -5409,7 +5551,7 @@ int newcat_get_level(RIG *rig, vfo_t vfo, setting_t level, value_t *val)
             RETURNFUNC(-RIG_ENAVAIL);
         }
 
-        if (is_ftdx9000)
+        if (RIG_IS_FTDX9000)
         {
             SNPRINTF(priv->cmd_str, sizeof(priv->cmd_str), "ML%c", cat_term);
         }
@@ -5426,7 +5568,7 @@ int newcat_get_level(RIG *rig, vfo_t vfo, setting_t level, value_t *val)
             RETURNFUNC(-RIG_ENAVAIL);
         }
 
-        if (is_ftdx9000)
+        if (RIG_IS_FTDX9000)
         {
             SNPRINTF(priv->cmd_str, sizeof(priv->cmd_str), "RM14%c", cat_term);
         }
@@ -5438,7 +5580,7 @@ int newcat_get_level(RIG *rig, vfo_t vfo, setting_t level, value_t *val)
         break;
 
     case RIG_LEVEL_USB_AF_INPUT:
-        if (is_ftdx101d || is_ftdx101mp)
+        if (RIG_IS_FTDX101D || RIG_IS_FTDX101MP)
         {
             rmode_t curmode = STATE(rig)->current_vfo == RIG_VFO_A ?
                               cachep->modeMainA : cachep->modeMainB;
@@ -5480,7 +5622,7 @@ int newcat_get_level(RIG *rig, vfo_t vfo, setting_t level, value_t *val)
         break;
 
     case RIG_LEVEL_USB_AF:
-        if (is_ftdx101d || is_ftdx101mp)
+        if (RIG_IS_FTDX101D || RIG_IS_FTDX101MP)
         {
             rmode_t curmode = STATE(rig)->current_vfo == RIG_VFO_A ?
                               cachep->modeMainA : cachep->modeMainB;
@@ -5707,7 +5849,7 @@ int newcat_get_level(RIG *rig, vfo_t vfo, setting_t level, value_t *val)
         int millis;
         value_t keyspd;
 
-        if (is_ftdx101d || is_ftdx101mp || is_ftdx10 || is_ft710)
+        if (RIG_IS_FTDX101D || RIG_IS_FTDX101MP || RIG_IS_FTDX10 || RIG_IS_FT710)
         {
             switch (raw_value)
             {
@@ -5754,9 +5896,9 @@ int newcat_get_level(RIG *rig, vfo_t vfo, setting_t level, value_t *val)
             break;
         }
 
-        if (is_ftdx1200 || is_ftdx3000 || is_ftdx3000dm || is_ftdx5000 || is_ft891
-                || is_ft991
-                || is_ftdx101d || is_ftdx101mp || is_ftdx10)
+        if (RIG_IS_FTDX1200 || RIG_IS_FTDX3000 || RIG_IS_FTDX3000DM || RIG_IS_FTDX5000 || RIG_IS_FT891
+                || RIG_IS_FT991
+                || RIG_IS_FTDX101D || RIG_IS_FTDX101MP || RIG_IS_FTDX10)
         {
             val->i = round(rig_raw2val(atoi(retlvl), &yaesu_default_str_cal));
         }
@@ -5816,7 +5958,7 @@ int newcat_get_level(RIG *rig, vfo_t vfo, setting_t level, value_t *val)
     case RIG_LEVEL_VOXDELAY:
         val->i = atoi(retlvl);
 
-        if (is_ftdx101d || is_ftdx101mp || is_ftdx10 || is_ft710)
+        if (RIG_IS_FTDX101D || RIG_IS_FTDX101MP || RIG_IS_FTDX10 || RIG_IS_FT710)
         {
             switch (val->i)
             {
@@ -6024,8 +6166,8 @@ int newcat_set_func(RIG *rig, vfo_t vfo, setting_t func, int status)
             RETURNFUNC(-RIG_ENAVAIL);
         }
 
-        if (is_ft991 || is_ftdx3000 || is_ftdx3000dm || is_ftdx5000 || is_ftdx101d
-                || is_ftdx101mp)
+        if (RIG_IS_FT991 || RIG_IS_FTDX3000 || RIG_IS_FTDX3000DM || RIG_IS_FTDX5000 || RIG_IS_FTDX101D
+                || RIG_IS_FTDX101MP)
         {
             err = newcat_get_mode(rig, vfo, &mode, &width);
 
@@ -6038,14 +6180,14 @@ int newcat_set_func(RIG *rig, vfo_t vfo, setting_t func, int status)
         SNPRINTF(priv->cmd_str, sizeof(priv->cmd_str), "BC0%d%c", status ? 1 : 0,
                  cat_term);
 
-        if (rig->caps->targetable_vfo & RIG_TARGETABLE_FUNC && !is_ft2000 && !is_ftdx10)
+        if (rig->caps->targetable_vfo & RIG_TARGETABLE_FUNC && !RIG_IS_FT2000 && !RIG_IS_FTDX10)
         {
             priv->cmd_str[2] = main_sub_vfo;
         }
 
         // Some Yaesu rigs reject this command in FM mode
-        if (is_ft991 || is_ftdx3000 || is_ftdx3000dm || is_ftdx5000 || is_ftdx101d
-                || is_ftdx101mp)
+        if (RIG_IS_FT991 || RIG_IS_FTDX3000 || RIG_IS_FTDX3000DM || RIG_IS_FTDX5000 || RIG_IS_FTDX101D
+                || RIG_IS_FTDX101MP)
         {
             if (mode & RIG_MODE_FM || mode & RIG_MODE_FMN)
             {
@@ -6066,8 +6208,8 @@ int newcat_set_func(RIG *rig, vfo_t vfo, setting_t func, int status)
             RETURNFUNC(-RIG_ENAVAIL);
         }
 
-        if (is_ft991 || is_ftdx3000 || is_ftdx3000dm || is_ftdx5000 || is_ftdx101d
-                || is_ftdx101mp)
+        if (RIG_IS_FT991 || RIG_IS_FTDX3000 || RIG_IS_FTDX3000DM || RIG_IS_FTDX5000 || RIG_IS_FTDX101D
+                || RIG_IS_FTDX101MP)
         {
             err = newcat_get_mode(rig, vfo, &mode, &width);
 
@@ -6080,14 +6222,14 @@ int newcat_set_func(RIG *rig, vfo_t vfo, setting_t func, int status)
         SNPRINTF(priv->cmd_str, sizeof(priv->cmd_str), "BP00%03d%c", status ? 1 : 0,
                  cat_term);
 
-        if (rig->caps->targetable_vfo & RIG_TARGETABLE_FUNC && !is_ft2000 && !is_ftdx10)
+        if (rig->caps->targetable_vfo & RIG_TARGETABLE_FUNC && !RIG_IS_FT2000 && !RIG_IS_FTDX10)
         {
             priv->cmd_str[2] = main_sub_vfo;
         }
 
         // Some Yaesu rigs reject this command in FM mode
-        if (is_ft991 || is_ftdx3000 || is_ftdx3000dm || is_ftdx5000 || is_ftdx101d
-                || is_ftdx101mp)
+        if (RIG_IS_FT991 || RIG_IS_FTDX3000 || RIG_IS_FTDX3000DM || RIG_IS_FTDX5000 || RIG_IS_FTDX101D
+                || RIG_IS_FTDX101MP)
         {
             if (mode & RIG_MODE_FM || mode & RIG_MODE_FMN)
             {
@@ -6162,8 +6304,8 @@ int newcat_set_func(RIG *rig, vfo_t vfo, setting_t func, int status)
             RETURNFUNC(-RIG_ENAVAIL);
         }
 
-        if (is_ftdx1200 || is_ftdx3000 || is_ftdx3000dm || is_ftdx5000 || is_ftdx101d
-                || is_ftdx101mp)
+        if (RIG_IS_FTDX1200 || RIG_IS_FTDX3000 || RIG_IS_FTDX3000DM || RIG_IS_FTDX5000 || RIG_IS_FTDX101D
+                || RIG_IS_FTDX101MP)
         {
             // These rigs can lock Main/Sub VFO dials individually
             SNPRINTF(priv->cmd_str, sizeof(priv->cmd_str), "LK%d%c", status ? 7 : 4,
@@ -6229,8 +6371,8 @@ int newcat_set_func(RIG *rig, vfo_t vfo, setting_t func, int status)
             RETURNFUNC(-RIG_ENAVAIL);
         }
 
-        if (is_ft991 || is_ftdx3000 || is_ftdx3000dm || is_ftdx5000 || is_ftdx101d
-                || is_ftdx101mp)
+        if (RIG_IS_FT991 || RIG_IS_FTDX3000 || RIG_IS_FTDX3000DM || RIG_IS_FTDX5000 || RIG_IS_FTDX101D
+                || RIG_IS_FTDX101MP)
         {
             err = newcat_get_mode(rig, vfo, &mode, &width);
 
@@ -6249,8 +6391,8 @@ int newcat_set_func(RIG *rig, vfo_t vfo, setting_t func, int status)
         }
 
         // Some Yaesu rigs reject this command in FM mode
-        if (is_ft991 || is_ftdx3000 || is_ftdx3000dm || is_ftdx5000 || is_ftdx101d
-                || is_ftdx101mp)
+        if (RIG_IS_FT991 || RIG_IS_FTDX3000 || RIG_IS_FTDX3000DM || RIG_IS_FTDX5000 || RIG_IS_FTDX101D
+                || RIG_IS_FTDX101MP)
         {
             if (mode & RIG_MODE_FM || mode & RIG_MODE_FMN)
             {
@@ -6271,9 +6413,9 @@ int newcat_set_func(RIG *rig, vfo_t vfo, setting_t func, int status)
             RETURNFUNC(-RIG_ENAVAIL);
         }
 
-        if (is_ft991 || is_ft710 || is_ftdx3000 || is_ftdx3000dm || is_ftdx5000
-                || is_ftdx101d
-                || is_ftdx101mp)
+        if (RIG_IS_FT991 || RIG_IS_FT710 || RIG_IS_FTDX3000 || RIG_IS_FTDX3000DM || RIG_IS_FTDX5000
+                || RIG_IS_FTDX101D
+                || RIG_IS_FTDX101MP)
         {
             err = newcat_get_mode(rig, vfo, &mode, &width);
 
@@ -6283,10 +6425,10 @@ int newcat_set_func(RIG *rig, vfo_t vfo, setting_t func, int status)
             }
         }
 
-        if (is_ft891 || is_ft991 || is_ft710 || is_ftdx1200 || is_ftdx3000
-                || is_ftdx3000dm
-                || is_ftdx101d
-                || is_ftdx101mp)
+        if (RIG_IS_FT891 || RIG_IS_FT991 || RIG_IS_FT710 || RIG_IS_FTDX1200 || RIG_IS_FTDX3000
+                || RIG_IS_FTDX3000DM
+                || RIG_IS_FTDX101D
+                || RIG_IS_FTDX101MP)
         {
             // There seems to be an error in the manuals for some of these rigs stating that values should be 1 = OFF and 2 = ON, but they are 0 = OFF and 1 = ON instead
             SNPRINTF(priv->cmd_str, sizeof(priv->cmd_str), "PR0%d%c", status ? 1 : 0,
@@ -6299,9 +6441,9 @@ int newcat_set_func(RIG *rig, vfo_t vfo, setting_t func, int status)
         }
 
         // Some Yaesu rigs reject this command in AM/FM/RTTY modes
-        if (is_ft991 || is_ft710 || is_ftdx3000 || is_ftdx3000dm || is_ftdx5000
-                || is_ftdx101d
-                || is_ftdx101mp)
+        if (RIG_IS_FT991 || RIG_IS_FT710 || RIG_IS_FTDX3000 || RIG_IS_FTDX3000DM || RIG_IS_FTDX5000
+                || RIG_IS_FTDX101D
+                || RIG_IS_FTDX101MP)
         {
             if (mode & RIG_MODE_AM || mode & RIG_MODE_FM || mode & RIG_MODE_AMN
                     || mode & RIG_MODE_FMN ||
@@ -6337,7 +6479,7 @@ int newcat_set_func(RIG *rig, vfo_t vfo, setting_t func, int status)
         break;
 
     case RIG_FUNC_RIT:
-        if (is_ft710)
+        if (RIG_IS_FT710)
         {
             RETURNFUNC(newcat_set_clarifier(rig, vfo, status, -1));
         }
@@ -6355,7 +6497,7 @@ int newcat_set_func(RIG *rig, vfo_t vfo, setting_t func, int status)
         break;
 
     case RIG_FUNC_XIT:
-        if (is_ft710)
+        if (RIG_IS_FT710)
         {
             RETURNFUNC(newcat_set_clarifier(rig, vfo, -1, status));
         }
@@ -6378,22 +6520,22 @@ int newcat_set_func(RIG *rig, vfo_t vfo, setting_t func, int status)
             RETURNFUNC(-RIG_ENAVAIL);
         }
 
-        if (is_ftdx101d || is_ftdx101mp)
+        if (RIG_IS_FTDX101D || RIG_IS_FTDX101MP)
         {
             SNPRINTF(priv->cmd_str, sizeof(priv->cmd_str), "CO%c2%04d%c", main_sub_vfo,
                      status ? 1 : 0, cat_term);
         }
-        else if (is_ftdx10 || is_ft710 || is_ft991 || is_ft891)
+        else if (RIG_IS_FTDX10 || RIG_IS_FT710 || RIG_IS_FT991 || RIG_IS_FT891)
         {
             SNPRINTF(priv->cmd_str, sizeof(priv->cmd_str), "CO02%04d%c", status ? 1 : 0,
                      cat_term);
         }
-        else if (is_ftdx5000)
+        else if (RIG_IS_FTDX5000)
         {
             SNPRINTF(priv->cmd_str, sizeof(priv->cmd_str), "CO%c0%02d%c", main_sub_vfo,
                      status ? 2 : 0, cat_term);
         }
-        else if (is_ftdx3000 || is_ftdx3000dm || is_ftdx1200 || is_ft2000)
+        else if (RIG_IS_FTDX3000 || RIG_IS_FTDX3000DM || RIG_IS_FTDX1200 || RIG_IS_FT2000)
         {
             SNPRINTF(priv->cmd_str, sizeof(priv->cmd_str), "CO00%02d%c", status ? 2 : 0,
                      cat_term);
@@ -6458,8 +6600,8 @@ int newcat_get_func(RIG *rig, vfo_t vfo, setting_t func, int *status)
             RETURNFUNC(-RIG_ENAVAIL);
         }
 
-        if (is_ft991 || is_ftdx3000 || is_ftdx3000dm || is_ftdx5000 || is_ftdx101d
-                || is_ftdx101mp)
+        if (RIG_IS_FT991 || RIG_IS_FTDX3000 || RIG_IS_FTDX3000DM || RIG_IS_FTDX5000 || RIG_IS_FTDX101D
+                || RIG_IS_FTDX101MP)
         {
             err = newcat_get_mode(rig, vfo, &mode, &width);
 
@@ -6477,8 +6619,8 @@ int newcat_get_func(RIG *rig, vfo_t vfo, setting_t func, int *status)
         }
 
         // Some Yaesu rigs reject this command in FM mode
-        if (is_ft991 || is_ftdx3000 || is_ftdx3000dm || is_ftdx5000 || is_ftdx101d
-                || is_ftdx101mp)
+        if (RIG_IS_FT991 || RIG_IS_FTDX3000 || RIG_IS_FTDX3000DM || RIG_IS_FTDX5000 || RIG_IS_FTDX101D
+                || RIG_IS_FTDX101MP)
         {
             if (mode & RIG_MODE_FM || mode & RIG_MODE_FMN)
             {
@@ -6613,10 +6755,10 @@ int newcat_get_func(RIG *rig, vfo_t vfo, setting_t func, int *status)
             RETURNFUNC(-RIG_ENAVAIL);
         }
 
-        if (is_ftdx1200 || is_ftdx3000 || is_ftdx3000dm || is_ft891 || is_ft991
-                || is_ft710
-                || is_ftdx101d
-                || is_ftdx101mp)
+        if (RIG_IS_FTDX1200 || RIG_IS_FTDX3000 || RIG_IS_FTDX3000DM || RIG_IS_FT891 || RIG_IS_FT991
+                || RIG_IS_FT710
+                || RIG_IS_FTDX101D
+                || RIG_IS_FTDX101MP)
         {
             SNPRINTF(priv->cmd_str, sizeof(priv->cmd_str), "PR0%c", cat_term);
         }
@@ -6646,7 +6788,7 @@ int newcat_get_func(RIG *rig, vfo_t vfo, setting_t func, int *status)
         break;
 
     case RIG_FUNC_RIT:
-        if (is_ft710)
+        if (RIG_IS_FT710)
         {
             RETURNFUNC(newcat_get_clarifier(rig, vfo, status, NULL));
         }
@@ -6663,7 +6805,7 @@ int newcat_get_func(RIG *rig, vfo_t vfo, setting_t func, int *status)
         break;
 
     case RIG_FUNC_XIT:
-        if (is_ft710)
+        if (RIG_IS_FT710)
         {
             RETURNFUNC(newcat_get_clarifier(rig, vfo, NULL, status));
         }
@@ -6685,21 +6827,21 @@ int newcat_get_func(RIG *rig, vfo_t vfo, setting_t func, int *status)
             RETURNFUNC(-RIG_ENAVAIL);
         }
 
-        if (is_ftdx101d || is_ftdx101mp)
+        if (RIG_IS_FTDX101D || RIG_IS_FTDX101MP)
         {
             SNPRINTF(priv->cmd_str, sizeof(priv->cmd_str), "CO%c2%c", main_sub_vfo,
                      cat_term);
         }
-        else if (is_ftdx10 || is_ft710 || is_ft991 || is_ft891)
+        else if (RIG_IS_FTDX10 || RIG_IS_FT710 || RIG_IS_FT991 || RIG_IS_FT891)
         {
             SNPRINTF(priv->cmd_str, sizeof(priv->cmd_str), "CO02%c", cat_term);
         }
-        else if (is_ftdx5000)
+        else if (RIG_IS_FTDX5000)
         {
             SNPRINTF(priv->cmd_str, sizeof(priv->cmd_str), "CO%c0%c", main_sub_vfo,
                      cat_term);
         }
-        else if (is_ftdx3000 || is_ftdx3000dm || is_ftdx1200 || is_ft2000)
+        else if (RIG_IS_FTDX3000 || RIG_IS_FTDX3000DM || RIG_IS_FTDX1200 || RIG_IS_FT2000)
         {
             SNPRINTF(priv->cmd_str, sizeof(priv->cmd_str), "CO00%c", cat_term);
         }
@@ -6760,8 +6902,8 @@ int newcat_get_func(RIG *rig, vfo_t vfo, setting_t func, int *status)
         break;
 
     case RIG_FUNC_LOCK:
-        if (is_ftdx1200 || is_ftdx3000 || is_ftdx3000dm || is_ftdx5000 || is_ftdx101d
-                || is_ftdx101mp)
+        if (RIG_IS_FTDX1200 || RIG_IS_FTDX3000 || RIG_IS_FTDX3000DM || RIG_IS_FTDX5000 || RIG_IS_FTDX101D
+                || RIG_IS_FTDX101MP)
         {
             // These rigs can lock Main/Sub VFO dials individually
             *status = (retfunc[0] == '0' || retfunc[0] == '4') ? 0 : 1;
@@ -6813,16 +6955,16 @@ int newcat_get_func(RIG *rig, vfo_t vfo, setting_t func, int *status)
         break;
 
     case RIG_FUNC_APF:
-        if (is_ftdx101d || is_ftdx101mp || is_ftdx10 || is_ft991 || is_ft891
-                || is_ft710)
+        if (RIG_IS_FTDX101D || RIG_IS_FTDX101MP || RIG_IS_FTDX10 || RIG_IS_FT991 || RIG_IS_FT891
+                || RIG_IS_FT710)
         {
             *status = (retfunc[last_char_index] == '1') ? 1 : 0;
         }
-        else if (is_ftdx5000)
+        else if (RIG_IS_FTDX5000)
         {
             *status = (retfunc[last_char_index] == '2') ? 1 : 0;
         }
-        else if (is_ftdx3000 || is_ftdx3000dm || is_ftdx1200 || is_ft2000)
+        else if (RIG_IS_FTDX3000 || RIG_IS_FTDX3000DM || RIG_IS_FTDX1200 || RIG_IS_FT2000)
         {
             *status = (retfunc[last_char_index] == '2') ? 1 : 0;
         }
@@ -7494,7 +7636,7 @@ int newcat_vfo_op(RIG *rig, vfo_t vfo, vfo_op_t op)
     switch (op)
     {
     case RIG_OP_TUNE:
-        if (is_ft710)
+        if (RIG_IS_FT710)
         {
             SNPRINTF(priv->cmd_str, sizeof(priv->cmd_str), "AC003%c", cat_term);
         }
@@ -7667,6 +7809,129 @@ int newcat_get_trn(RIG *rig, int *trn)
 }
 
 
+int newcat_read_frame_direct(RIG *rig, size_t buffer_length,
+                             const unsigned char *buffer)
+{
+    return read_string_direct(RIGPORT(rig), (unsigned char *) buffer,
+                              buffer_length, &cat_term, sizeof(cat_term), 0, 1);
+}
+
+
+/*
+ * A frame is an AI report unless it is the reply to a pending command,
+ * which is passed on once
+ */
+int newcat_is_async_frame(RIG *rig, size_t frame_length,
+                          const unsigned char *frame)
+{
+    struct newcat_priv_data *priv = (struct newcat_priv_data *)STATE(rig)->priv;
+    static const char *const reports[] = { "FA", "FB", "MD", "TX", "IF", "OI", NULL };
+    int i;
+
+    if (!priv->ai_push || frame_length < 3)
+    {
+        return 0;
+    }
+
+    for (i = 0; priv->pending_reply[i] != '\0'; i += 2)
+    {
+        if (frame[0] == priv->pending_reply[i] && frame[1] == priv->pending_reply[i + 1])
+        {
+            priv->pending_reply[i] = '-';
+            return 0;
+        }
+    }
+
+    for (i = 0; reports[i] != NULL; i++)
+    {
+        if (frame[0] == reports[i][0] && frame[1] == reports[i][1])
+        {
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+
+/*
+ * Decodes the AI reports about frequency, mode and PTT
+ * FA/IF are about the main VFO, FB/OI about the sub VFO
+ */
+int newcat_process_async_frame(RIG *rig, size_t frame_length,
+                               const unsigned char *frame)
+{
+    struct newcat_priv_data *priv = (struct newcat_priv_data *)STATE(rig)->priv;
+    char buf[NEWCAT_DATA_LEN];
+    char freqbuf[16];
+    int width_frequency;
+    vfo_t vfo;
+    int len;
+
+    len = frame_length < sizeof(buf) ? frame_length : sizeof(buf) - 1;
+    memcpy(buf, frame, len);
+    buf[len] = '\0';
+
+    if (len > 0 && buf[len - 1] == cat_term)
+    {
+        buf[--len] = '\0';
+    }
+
+    rig_debug(RIG_DEBUG_TRACE, "%s: AI report '%s'\n", __func__, buf);
+
+    if (strncmp(buf, "FA", 2) == 0 || strncmp(buf, "FB", 2) == 0)
+    {
+        rig_fire_freq_event(rig, buf[1] == 'A' ? RIG_VFO_A : RIG_VFO_B,
+                            atof(buf + 2));
+    }
+    else if (strncmp(buf, "MD", 2) == 0 && len > 3)
+    {
+        vfo = buf[2] == '1' ? RIG_VFO_B : RIG_VFO_A;
+        rig_fire_mode_event(rig, vfo, newcat_rmode(buf[3]), RIG_PASSBAND_NOCHANGE);
+    }
+    else if (strncmp(buf, "TX", 2) == 0 && len > 2)
+    {
+        rig_fire_ptt_event(rig, RIG_VFO_CURR,
+                           buf[2] == '0' ? RIG_PTT_OFF : RIG_PTT_ON);
+    }
+    else if (strncmp(buf, "IF", 2) == 0 || strncmp(buf, "OI", 2) == 0)
+    {
+        // same layouts as in newcat_get_vfo_mode(), without the terminator
+        switch (len + 1)
+        {
+        case 27:
+        case 30: width_frequency = 8; break;
+
+        case 41:
+        case 28: width_frequency = 9; break;
+
+        default:
+            rig_debug(RIG_DEBUG_WARN, "%s: unexpected length %d of '%s'\n", __func__,
+                      len, buf);
+            return RIG_OK;
+        }
+
+        vfo = buf[0] == 'I' ? RIG_VFO_A : RIG_VFO_B;
+
+        if (vfo == RIG_VFO_A)
+        {
+            /* a fresh IF answer spares the next IF; */
+            SNPRINTF(priv->last_if_response, sizeof(priv->last_if_response), "%s%c",
+                     buf, cat_term);
+            elapsed_ms(&priv->cache_start, 1);
+        }
+
+        memcpy(freqbuf, buf + 5, width_frequency);
+        freqbuf[width_frequency] = '\0';
+        rig_fire_freq_event(rig, vfo, atof(freqbuf));
+        rig_fire_mode_event(rig, vfo, newcat_rmode(buf[5 + width_frequency + 7]),
+                            RIG_PASSBAND_NOCHANGE);
+    }
+
+    return RIG_OK;
+}
+
+
 int newcat_decode_event(RIG *rig)
 {
     ENTERFUNC;
@@ -7881,7 +8146,7 @@ int newcat_get_channel(RIG *rig, vfo_t vfo, channel_t *chan, int read_only)
     rig_debug(RIG_DEBUG_TRACE, "sizeof(priv->cmd_str) = %d\n",
               (int)sizeof(priv->cmd_str));
 
-    if (is_ftdx101d || is_ftdx101mp || is_ft991 || is_ft710)
+    if (RIG_IS_FTDX101D || RIG_IS_FTDX101MP || RIG_IS_FT991 || RIG_IS_FT710)
     {
         SNPRINTF(priv->cmd_str, sizeof(priv->cmd_str), "MT%03d%c", chan->channel_num,
                  cat_term);
@@ -8058,6 +8323,55 @@ const char *newcat_get_info(RIG *rig)
 }
 
 
+/*
+ * newcat_resolve_commands
+ *
+ * Build the command bitmap of the rig from the valid_commands table, so
+ * newcat_valid_command() does not have to search the table each time.
+ * Rigs without a column get an empty bitmap, i.e. all commands invalid.
+ */
+
+static void newcat_resolve_commands(RIG *rig)
+{
+    struct newcat_priv_data *priv = (struct newcat_priv_data *)STATE(rig)->priv;
+    size_t offset;
+    int i;
+
+    memset(priv->valid_cmds, 0, sizeof(priv->valid_cmds));
+
+    if (RIG_IS_FT450) { offset = offsetof(yaesu_newcat_commands_t, ft450); }
+    else if (RIG_IS_FT891) { offset = offsetof(yaesu_newcat_commands_t, ft891); }
+    else if (RIG_IS_FT950) { offset = offsetof(yaesu_newcat_commands_t, ft950); }
+    else if (RIG_IS_FT991) { offset = offsetof(yaesu_newcat_commands_t, ft991); }
+    else if (RIG_IS_FT2000) { offset = offsetof(yaesu_newcat_commands_t, ft2000); }
+    else if (RIG_IS_FTDX5000) { offset = offsetof(yaesu_newcat_commands_t, ft5000); }
+    else if (RIG_IS_FTDX9000) { offset = offsetof(yaesu_newcat_commands_t, ft9000); }
+    else if (RIG_IS_FTDX1200) { offset = offsetof(yaesu_newcat_commands_t, ft1200); }
+    else if (RIG_IS_FTDX3000) { offset = offsetof(yaesu_newcat_commands_t, ft3000); }
+    else if (RIG_IS_FTDX101D) { offset = offsetof(yaesu_newcat_commands_t, ft101d); }
+    else if (RIG_IS_FTDX101MP) { offset = offsetof(yaesu_newcat_commands_t, ft101mp); }
+    else if (RIG_IS_FTDX10) { offset = offsetof(yaesu_newcat_commands_t, ftdx10); }
+    else if (RIG_IS_FT710) { offset = offsetof(yaesu_newcat_commands_t, ft710); }
+    else if (RIG_IS_FTX1) { offset = offsetof(yaesu_newcat_commands_t, ftx1); }
+    else
+    {
+        rig_debug(RIG_DEBUG_ERR, "%s: '%s' is unknown\n", __func__,
+                  rig->caps->model_name);
+        return;
+    }
+
+    for (i = 0; i < valid_commands_count; i++)
+    {
+        const char *command = valid_commands[i].command;
+
+        if (*(const ncboolean *)((const char *)&valid_commands[i] + offset))
+        {
+            priv->valid_cmds[command[0] - 'A'] |= 1u << (command[1] - 'A');
+        }
+    }
+}
+
+
 /*
  * newcat_valid_command
  *
@@ -8069,129 +8383,34 @@ const char *newcat_get_info(RIG *rig)
 
 ncboolean newcat_valid_command(RIG *rig, char const *const command)
 {
-    struct rig_caps *caps;
-    int search_high;
-    int search_low;
+    struct newcat_priv_data *priv;
 
     rig_debug(RIG_DEBUG_TRACE, "%s %s\n", __func__, command);
 
-    caps = rig->caps;
-
-    if (!caps)
+    if (!rig->caps || !STATE(rig)->priv)
     {
         rig_debug(RIG_DEBUG_ERR, "%s: Rig capabilities not valid\n", __func__);
         RETURNFUNC2(FALSE);
     }
 
-    if (!is_ft450 && !is_ft950 && !is_ft891 && !is_ft991 && !is_ft2000
-            && !is_ftdx5000 && !is_ftdx9000 && !is_ftdx1200 && !is_ftdx3000 && !is_ftdx101d
-            && !is_ftdx101mp && !is_ftdx10 && !is_ft710 && !is_ftx1)
+    priv = (struct newcat_priv_data *)STATE(rig)->priv;
+
+    if (command[0] < 'A' || command[0] > 'Z' || command[1] < 'A'
+            || command[1] > 'Z' || command[2] != '\0')
     {
-        rig_debug(RIG_DEBUG_ERR, "%s: '%s' is unknown\n", __func__, caps->model_name);
+        rig_debug(RIG_DEBUG_TRACE, "%s: '%s' command '%s' not valid\n",
+                  __func__, rig->caps->model_name, command);
         RETURNFUNC2(FALSE);
     }
 
-    /*
-     * Make sure the command is known, and then check to make sure
-     * is it valid for the rig.
-     */
-
-    search_low = 0;
-    search_high = valid_commands_count;
-
-    while (search_low <= search_high)
+    if (!(priv->valid_cmds[command[0] - 'A'] & (1u << (command[1] - 'A'))))
     {
-        int search_test;
-        int search_index;
-
-        search_index = (search_low + search_high) / 2;
-        search_test = strcmp(valid_commands[search_index].command, command);
-
-        if (search_test > 0)
-        {
-            search_high = search_index - 1;
-        }
-        else if (search_test < 0)
-        {
-            search_low = search_index + 1;
-        }
-        else
-        {
-            /*
-             * The command is valid.  Now make sure it is supported by the rig.
-             */
-            if (is_ft450 && valid_commands[search_index].ft450)
-            {
-                RETURNFUNC2(TRUE);
-            }
-            else if (is_ft891 && valid_commands[search_index].ft891)
-            {
-                RETURNFUNC2(TRUE);
-            }
-            else if (is_ft950 && valid_commands[search_index].ft950)
-            {
-                RETURNFUNC2(TRUE);
-            }
-            else if (is_ft991 && valid_commands[search_index].ft991)
-            {
-                RETURNFUNC2(TRUE);
-            }
-            else if (is_ft2000 && valid_commands[search_index].ft2000)
-            {
-                RETURNFUNC2(TRUE);
-            }
-            else if (is_ftdx5000 && valid_commands[search_index].ft5000)
-            {
-                RETURNFUNC2(TRUE);
-            }
-            else if (is_ftdx9000 && valid_commands[search_index].ft9000)
-            {
-                RETURNFUNC2(TRUE);
-            }
-            else if (is_ftdx1200 && valid_commands[search_index].ft1200)
-            {
-                RETURNFUNC2(TRUE);
-            }
-            else if (is_ftdx3000 && valid_commands[search_index].ft3000)
-            {
-                RETURNFUNC2(TRUE);
-            }
-            else if (is_ftdx3000dm && valid_commands[search_index].ft3000)
-            {
-                RETURNFUNC2(TRUE);
-            }
-            else if (is_ftdx101d && valid_commands[search_index].ft101d)
-            {
-                RETURNFUNC2(TRUE);
-            }
-            else if (is_ftdx101mp && valid_commands[search_index].ft101mp)
-            {
-                RETURNFUNC2(TRUE);
-            }
-            else if (is_ftdx10 && valid_commands[search_index].ftdx10)
-            {
-                RETURNFUNC2(TRUE);
-            }
-            else if (is_ft710 && valid_commands[search_index].ft710)
-            {
-                RETURNFUNC2(TRUE);
-            }
-            else if (is_ftx1 && valid_commands[search_index].ftx1)
-            {
-                RETURNFUNC2(TRUE);
-            }
-            else
-            {
-                rig_debug(RIG_DEBUG_TRACE, "%s: '%s' command '%s' not supported\n",
-                          __func__, caps->model_name, command);
-                RETURNFUNC2(FALSE);
-            }
-        }
+        rig_debug(RIG_DEBUG_TRACE, "%s: '%s' command '%s' not supported\n",
+                  __func__, rig->caps->model_name, command);
+        RETURNFUNC2(FALSE);
     }
 
-    rig_debug(RIG_DEBUG_TRACE, "%s: '%s' command '%s' not valid\n",
-              __func__, caps->model_name, command);
-    RETURNFUNC2(FALSE);
+    RETURNFUNC2(TRUE);
 }
 
 
@@ -8259,9 +8478,9 @@ int newcat_set_tx_vfo(RIG *rig, vfo_t tx_vfo)
     }
 
     // NOTE: FT-450 only has toggle command so not sure how to definitively set the TX VFO (VS; doesn't seem to help either)
-    if (is_ft950 || is_ft2000 || is_ftdx3000 || is_ftdx3000dm || is_ftdx5000
-            || is_ftdx1200 || is_ft991 ||
-            is_ftdx10 || is_ftdx101d || is_ftdx101mp)
+    if (RIG_IS_FT950 || RIG_IS_FT2000 || RIG_IS_FTDX3000 || RIG_IS_FTDX3000DM || RIG_IS_FTDX5000
+            || RIG_IS_FTDX1200 || RIG_IS_FT991 ||
+            RIG_IS_FTDX10 || RIG_IS_FTDX101D || RIG_IS_FTDX101MP)
     {
         // These rigs use numbers 2 and 3 to denote A/B or Main/Sub VFOs - 0 and 1 are for toggling TX function
         p1 = p1 + 2;
@@ -8370,7 +8589,7 @@ static int newcat_set_split(RIG *rig, split_t split, vfo_t *rx_vfo,
 
     ENTERFUNC;
 
-    if (!newcat_valid_command(rig, "ST") || is_ft450
+    if (!newcat_valid_command(rig, "ST") || RIG_IS_FT450
             || priv->split_st_command_missing)
     {
         RETURNFUNC(-RIG_ENAVAIL);
@@ -8420,12 +8639,12 @@ static int newcat_set_split(RIG *rig, split_t split, vfo_t *rx_vfo,
     case RIG_SPLIT_ON:
 
         // These rigs have fixed RX and TX VFOs when using the ST split command
-        if (is_ftdx101d || is_ftdx101mp)
+        if (RIG_IS_FTDX101D || RIG_IS_FTDX101MP)
         {
             *rx_vfo = RIG_VFO_MAIN;
             *tx_vfo = RIG_VFO_SUB;
         }
-        else if (is_ftdx10)
+        else if (RIG_IS_FTDX10)
         {
             *rx_vfo = RIG_VFO_A;
             *tx_vfo = RIG_VFO_B;
@@ -8461,7 +8680,7 @@ static int newcat_get_split(RIG *rig, split_t *split, vfo_t *tx_vfo)
 
     ENTERFUNC;
 
-    if (!newcat_valid_command(rig, "ST") || is_ft450
+    if (!newcat_valid_command(rig, "ST") || RIG_IS_FT450
             || priv->split_st_command_missing)
     {
         RETURNFUNC(-RIG_ENAVAIL);
@@ -8497,11 +8716,11 @@ static int newcat_get_split(RIG *rig, split_t *split, vfo_t *tx_vfo)
         *split = RIG_SPLIT_ON;
 
         // These rigs have fixed RX and TX VFOs when using the ST split command
-        if (is_ftdx101d || is_ftdx101mp || is_ftx1)
+        if (RIG_IS_FTDX101D || RIG_IS_FTDX101MP || RIG_IS_FTX1)
         {
             *tx_vfo = RIG_VFO_SUB;
         }
-        else if (is_ftdx10)
+        else if (RIG_IS_FTDX10)
         {
             *tx_vfo = RIG_VFO_B;
         }
@@ -8746,7 +8965,7 @@ int newcat_set_rx_bandwidth(RIG *rig, vfo_t vfo, rmode_t mode, pbwidth_t width)
 
     // NOTE: RIG_PASSBAND_NORMAL (0) should select the default filter width (SH00)
 
-    if (is_ft950)
+    if (RIG_IS_FT950)
     {
         switch (mode)
         {
@@ -8848,8 +9067,8 @@ int newcat_set_rx_bandwidth(RIG *rig, vfo_t vfo, rmode_t mode, pbwidth_t width)
         case RIG_MODE_FMN:
             RETURNFUNC(RIG_OK);
         }
-    } // end is_ft950 */
-    else if (is_ft891)
+    } // end RIG_IS_FT950 */
+    else if (RIG_IS_FT891)
     {
         switch (mode)
         {
@@ -8943,8 +9162,8 @@ int newcat_set_rx_bandwidth(RIG *rig, vfo_t vfo, rmode_t mode, pbwidth_t width)
         default:
             RETURNFUNC(-RIG_EINVAL);
         } // end switch(mode)
-    } // end is_ft891
-    else if (is_ft991)
+    } // end RIG_IS_FT891
+    else if (RIG_IS_FT991)
     {
         switch (mode)
         {
@@ -9081,8 +9300,8 @@ int newcat_set_rx_bandwidth(RIG *rig, vfo_t vfo, rmode_t mode, pbwidth_t width)
         default:
             RETURNFUNC(-RIG_EINVAL);
         } // end switch(mode)
-    } // end is_ft991
-    else if (is_ftdx1200 || is_ftdx3000)
+    } // end RIG_IS_FT991
+    else if (RIG_IS_FTDX1200 || RIG_IS_FTDX3000)
     {
         // FTDX 1200 and FTDX 3000 have the same set of filter choices
         switch (mode)
@@ -9195,8 +9414,8 @@ int newcat_set_rx_bandwidth(RIG *rig, vfo_t vfo, rmode_t mode, pbwidth_t width)
 
             RETURNFUNC(err);
         }
-    } // end is_ftdx1200 and is_ftdx3000
-    else if (is_ftdx5000)
+    } // end RIG_IS_FTDX1200 and RIG_IS_FTDX3000
+    else if (RIG_IS_FTDX5000)
     {
         switch (mode)
         {
@@ -9307,8 +9526,8 @@ int newcat_set_rx_bandwidth(RIG *rig, vfo_t vfo, rmode_t mode, pbwidth_t width)
 
             RETURNFUNC(err);
         }
-    } // end is_ftdx5000
-    else if (is_ftdx101d || is_ftdx101mp || is_ftdx10 || is_ft710)
+    } // end RIG_IS_FTDX5000
+    else if (RIG_IS_FTDX101D || RIG_IS_FTDX101MP || RIG_IS_FTDX10 || RIG_IS_FT710)
     {
         switch (mode)
         {
@@ -9410,7 +9629,7 @@ int newcat_set_rx_bandwidth(RIG *rig, vfo_t vfo, rmode_t mode, pbwidth_t width)
             RETURNFUNC(RIG_OK);
         }
     } // end is_ftdx101
-    else if (is_ft2000)
+    else if (RIG_IS_FT2000)
     {
         // We need details on the widths here, manuals lack information.
         switch (mode)
@@ -9553,18 +9772,18 @@ int newcat_set_rx_bandwidth(RIG *rig, vfo_t vfo, rmode_t mode, pbwidth_t width)
 
     } /* end else */
 
-    if (is_ftdx101d || is_ftdx101mp || is_ft891)
+    if (RIG_IS_FTDX101D || RIG_IS_FTDX101MP || RIG_IS_FT891)
     {
         // some rigs now require the bandwidth be turned "on"
-        int on = is_ft891;
+        int on = RIG_IS_FT891;
         SNPRINTF(priv->cmd_str, sizeof(priv->cmd_str), "SH%c%d%02d;", main_sub_vfo, on,
                  w);
     }
-    else if (is_ft2000 || is_ftdx3000)
+    else if (RIG_IS_FT2000 || RIG_IS_FTDX3000)
     {
         SNPRINTF(priv->cmd_str, sizeof(priv->cmd_str), "SH0%02d;", w);
     }
-    else if (is_ftdx10)
+    else if (RIG_IS_FTDX10)
     {
         SNPRINTF(priv->cmd_str, sizeof(priv->cmd_str), "SH00%02d;", w);
     }
@@ -9772,7 +9991,7 @@ int newcat_get_rx_bandwidth(RIG *rig, vfo_t vfo, rmode_t mode, pbwidth_t *width)
         RETURNFUNC(err);
     }
 
-    if (is_ft950 || is_ftdx5000 || is_ftdx3000)
+    if (RIG_IS_FT950 || RIG_IS_FTDX5000 || RIG_IS_FTDX3000)
     {
         // Some Yaesu rigs cannot query SH in modes such as AM/FM
         switch (mode)
@@ -9795,7 +10014,7 @@ int newcat_get_rx_bandwidth(RIG *rig, vfo_t vfo, rmode_t mode, pbwidth_t *width)
 
     if (sh_command_valid)
     {
-        if (is_ft2000 || is_ftdx10 || is_ftdx3000)
+        if (RIG_IS_FT2000 || RIG_IS_FTDX10 || RIG_IS_FTDX3000)
         {
             SNPRINTF(priv->cmd_str, sizeof(priv->cmd_str), "%s0%c", cmd, cat_term);
         }
@@ -9865,7 +10084,7 @@ int newcat_get_rx_bandwidth(RIG *rig, vfo_t vfo, rmode_t mode, pbwidth_t *width)
         w = 0;
     }
 
-    if (is_ft950)
+    if (RIG_IS_FT950)
     {
         if ((narrow = get_narrow(rig, RIG_VFO_MAIN)) < 0)
         {
@@ -9985,8 +10204,8 @@ int newcat_get_rx_bandwidth(RIG *rig, vfo_t vfo, rmode_t mode, pbwidth_t *width)
             RETURNFUNC(-RIG_EINVAL);
         }   /* end switch(mode) */
 
-    } /* end if is_ft950 */
-    else if (is_ft891)
+    } /* end if RIG_IS_FT950 */
+    else if (RIG_IS_FT891)
     {
         if ((narrow = get_narrow(rig, vfo)) < 0)
         {
@@ -10131,8 +10350,8 @@ int newcat_get_rx_bandwidth(RIG *rig, vfo_t vfo, rmode_t mode, pbwidth_t *width)
             RETURNFUNC(-RIG_EINVAL);
         }   /* end switch(mode) */
 
-    } /* end if is_ft891 */
-    else if (is_ft991)
+    } /* end if RIG_IS_FT891 */
+    else if (RIG_IS_FT991)
     {
         // some modes are fixed and can't be queried with "NA0"
         if (mode != RIG_MODE_C4FM && mode != RIG_MODE_PKTFM && mode != RIG_MODE_PKTFMN
@@ -10276,8 +10495,8 @@ int newcat_get_rx_bandwidth(RIG *rig, vfo_t vfo, rmode_t mode, pbwidth_t *width)
             RETURNFUNC(-RIG_EINVAL);
         }   /* end switch(mode) */
 
-    } /* end if is_ft991 */
-    else if (is_ftdx1200 || is_ftdx3000)
+    } /* end if RIG_IS_FT991 */
+    else if (RIG_IS_FTDX1200 || RIG_IS_FTDX3000)
     {
         if ((narrow = get_narrow(rig, RIG_VFO_MAIN)) < 0)
         {
@@ -10419,8 +10638,8 @@ int newcat_get_rx_bandwidth(RIG *rig, vfo_t vfo, rmode_t mode, pbwidth_t *width)
             RETURNFUNC(-RIG_EINVAL);
         }   /* end switch(mode) */
 
-    } /* end if is_ftdx1200 or is_ftdx3000 */
-    else if (is_ftdx5000)
+    } /* end if RIG_IS_FTDX1200 or RIG_IS_FTDX3000 */
+    else if (RIG_IS_FTDX5000)
     {
         if ((narrow = get_narrow(rig, RIG_VFO_MAIN)) < 0)
         {
@@ -10563,8 +10782,8 @@ int newcat_get_rx_bandwidth(RIG *rig, vfo_t vfo, rmode_t mode, pbwidth_t *width)
             RETURNFUNC(-RIG_EINVAL);
         }   /* end switch(mode) */
 
-    } /* end if is_ftdx5000 */
-    else if (is_ftdx101d || is_ftdx101mp || is_ftdx10)
+    } /* end if RIG_IS_FTDX5000 */
+    else if (RIG_IS_FTDX101D || RIG_IS_FTDX101MP || RIG_IS_FTDX10)
     {
         rig_debug(RIG_DEBUG_TRACE, "%s: is_ftdx101 w=%d, mode=%s\n", __func__, w,
                   rig_strrmode(mode));
@@ -10722,7 +10941,7 @@ int newcat_get_rx_bandwidth(RIG *rig, vfo_t vfo, rmode_t mode, pbwidth_t *width)
 
         rig_debug(RIG_DEBUG_TRACE, "%s: end if FTDX101D\n", __func__);
     } /* end if is_ftdx101 */
-    else if (is_ft2000)
+    else if (RIG_IS_FT2000)
     {
         if ((narrow = get_narrow(rig, RIG_VFO_MAIN)) < 0)
         {
@@ -10827,7 +11046,7 @@ int newcat_get_rx_bandwidth(RIG *rig, vfo_t vfo, rmode_t mode, pbwidth_t *width)
         default:
             RETURNFUNC(-RIG_EINVAL);
         } /* end switch (mode) */
-    } /* end if is_ft2000 */
+    } /* end if RIG_IS_FT2000 */
     else
     {
         /* FT450, FT9000 */
@@ -10966,7 +11185,6 @@ int newcat_get_rigid(RIG *rig)
             s += 2;     /* ID0310, jump past ID */
             priv->rig_id = atoi(s);
 
-            is_ftdx3000dm = priv->rig_id == NC_RIGID_FTDX3000DM;
         }
 
         rig_debug(RIG_DEBUG_TRACE, "rig_id = %d, idstr = %s\n", priv->rig_id,
@@ -11089,6 +11307,46 @@ int newcat_vfomem_toggle(RIG *rig)
     RETURNFUNC(newcat_set_cmd(rig));
 }
 
+/*
+ * Discards unsolicited data before a command is sent
+ * In AI mode the async data handler decodes the reports instead and
+ * passes on to read_string() the first frame starting like each of the
+ * ;-separated commands in reply
+ */
+static void newcat_expect_reply(RIG *rig, const char *reply)
+{
+    hamlib_port_t *rp = RIGPORT(rig);
+    struct newcat_priv_data *priv = (struct newcat_priv_data *)STATE(rig)->priv;
+    int n = 0;
+
+    if (!rp->asyncio)
+    {
+        rig_flush(rp);
+        return;
+    }
+
+    port_flush_sync_pipes(rp);
+    priv->pending_reply[0] = '\0';
+
+    // each prefix is complete before the terminator in front of it goes
+    while (reply[0] && n < NEWCAT_BATCH_MAX)
+    {
+        const char *next = strchr(reply, cat_term);
+
+        priv->pending_reply[2 * n + 2] = '\0';
+        priv->pending_reply[2 * n + 1] = reply[1];
+        priv->pending_reply[2 * n] = reply[0];
+        n++;
+
+        if (next == NULL || reply[1] == '\0')
+        {
+            break;
+        }
+
+        reply = next + 1;
+    }
+}
+
 /*
  * Writes a null  terminated command string from  priv->cmd_str to the
  * CAT  port and  returns a  response from  the rig  in priv->ret_data
@@ -11120,6 +11378,21 @@ int newcat_get_cmd(RIG *rig)
         RETURNFUNC(RIG_OK); // to prevent repeats
     }
 
+    // replies a batch has read already, see newcat_get_vfo_snapshot()
+    for (retry_count = 0; retry_count < priv->prefetch_count; retry_count++)
+    {
+        const struct newcat_batch_cmd *entry = &priv->prefetch[retry_count];
+
+        if (entry->status == RIG_OK && strcmp(entry->cmd_str, priv->cmd_str) == 0)
+        {
+            rig_debug(RIG_DEBUG_TRACE, "%s: prefetched %s\n", __func__, entry->ret_data);
+            strcpy(priv->ret_data, entry->ret_data);
+            RETURNFUNC(RIG_OK);
+        }
+    }
+
+    retry_count = 0;
+
     // try to cache rapid repeats of the IF command
     // this is for WSJT-X/JTDX sequence of v/f/m/t
     // should allow rapid repeat of any call using the IF; cmd
@@ -11200,7 +11473,7 @@ int newcat_get_cmd(RIG *rig)
 
     while (rc != RIG_OK && retry_count++ <= rp->retry)
     {
-        rig_flush(rp);  /* discard any unsolicited data */
+        newcat_expect_reply(rig, priv->cmd_str);
 
         if (rc != -RIG_BUSBUSY)
         {
@@ -11346,6 +11619,218 @@ int newcat_get_cmd(RIG *rig)
     RETURNFUNC(rc);
 }
 
+/*
+ * Sends the commands of the batch still to be read in one write and sorts
+ * the replies, which the rig sends in order, into the entries
+ * A reply that skips entries marks them as failed, anything else that
+ * does not answer one of the remaining entries is ignored
+ */
+static void newcat_batch_exchange(RIG *rig, struct newcat_batch_cmd *batch,
+                                 int count)
+{
+    hamlib_port_t *rp = RIGPORT(rig);
+    struct newcat_priv_data *priv = (struct newcat_priv_data *)STATE(rig)->priv;
+    char cmd_str[NEWCAT_BATCH_MAX * 16];
+    char buffer[NEWCAT_DATA_LEN];
+    int send[NEWCAT_BATCH_MAX];
+    int sent = 0;
+    int answered = 0;
+    int rc;
+    int i;
+
+    cmd_str[0] = '\0';
+
+    for (i = 0; i < count; i++)
+    {
+        if (batch[i].status != RIG_OK)
+        {
+            strcat(cmd_str, batch[i].cmd_str);
+            send[sent++] = i;
+        }
+    }
+
+    if (sent == 0)
+    {
+        return;
+    }
+
+    newcat_expect_reply(rig, cmd_str);
+
+    rig_debug(RIG_DEBUG_TRACE, "cmd_str = %s\n", cmd_str);
+
+    rc = write_block(rp, (unsigned char *) cmd_str, strlen(cmd_str));
+
+    i = 0;
+
+    while (rc == RIG_OK && i < sent)
+    {
+        struct newcat_batch_cmd *entry;
+        int len;
+        int j;
+
+        len = read_string(rp, (unsigned char *) buffer, sizeof(buffer),
+                          &cat_term, sizeof(cat_term), 0, 1);
+
+        if (len <= 0)
+        {
+            break;
+        }
+
+        len = strlen(buffer);
+
+        if (len < 1 || buffer[len - 1] != cat_term)
+        {
+            rig_debug(RIG_DEBUG_ERR, "%s: Command is not correctly terminated '%s'\n",
+                      __func__, buffer);
+            batch[send[i++]].status = -RIG_EPROTO;
+            continue;
+        }
+
+        answered++;
+
+        if (len == 2)
+        {
+            rig_debug(RIG_DEBUG_VERBOSE, "%s: '%s' answered with '%s'\n", __func__,
+                      batch[send[i]].cmd_str, buffer);
+            batch[send[i++]].status = buffer[0] == 'N' ? -RIG_ENAVAIL : -RIG_ERJCTED;
+            continue;
+        }
+
+        for (j = i; j < sent; j++)
+        {
+            if (buffer[0] == batch[send[j]].cmd_str[0]
+                    && buffer[1] == batch[send[j]].cmd_str[1])
+            {
+                break;
+            }
+        }
+
+        if (j == sent)
+        {
+            rig_debug(RIG_DEBUG_VERBOSE, "%s: ignoring unsolicited '%s'\n", __func__,
+                      buffer);
+            continue;
+        }
+
+        for (; i < j; i++)
+        {
+            rig_debug(RIG_DEBUG_ERR, "%s: no reply for '%s'\n", __func__,
+                      batch[send[i]].cmd_str);
+            batch[send[i]].status = -RIG_EPROTO;
+        }
+
+        entry = &batch[send[i++]];
+        strcpy(entry->ret_data, buffer);
+        entry->status = RIG_OK;
+
+        if (strcmp(entry->cmd_str, "IF;") == 0)
+        {
+            elapsed_ms(&priv->cache_start, 1);
+            strcpy(priv->last_if_response, buffer);
+        }
+    }
+
+    for (; i < sent; i++)
+    {
+        batch[send[i]].status = rc != RIG_OK ? rc : -RIG_ETIMEOUT;
+    }
+
+    if (rc == RIG_OK && sent > 1 && answered == 0)
+    {
+        rig_debug(RIG_DEBUG_WARN, "%s: no reply to a batch, sending single commands\n",
+                  __func__);
+        priv->no_batch = 1;
+    }
+}
+
+/*
+ * Reads several values in one round trip, e.g. "FA;FB;MD0;TX;"
+ *
+ * Each entry gets its own status and its reply in ret_data, like
+ * newcat_get_cmd() for a single command. "IF;" is taken from the IF
+ * cache while that is valid. Failed entries are not retried; callers
+ * fall back to newcat_get_cmd() for them, e.g. by setting priv->prefetch
+ * to the batch. A rig that does not answer a batch at all is only sent
+ * single commands afterwards.
+ *
+ * Returns RIG_OK if all entries succeeded, else the status of the first
+ * failed one
+ */
+int newcat_get_cmd_batch(RIG *rig, struct newcat_batch_cmd *batch, int count)
+{
+    struct newcat_priv_data *priv = (struct newcat_priv_data *)STATE(rig)->priv;
+    int rc = RIG_OK;
+    int i;
+
+    ENTERFUNC;
+
+    if (count < 1 || count > NEWCAT_BATCH_MAX)
+    {
+        RETURNFUNC(-RIG_EINVAL);
+    }
+
+    for (i = 0; i < count; i++)
+    {
+        size_t cmd_len = strlen(batch[i].cmd_str);
+
+        if (cmd_len < 3 || cmd_len >= sizeof(batch[i].cmd_str)
+                || batch[i].cmd_str[cmd_len - 1] != cat_term
+                || memchr(batch[i].cmd_str, cat_term, cmd_len - 1) != NULL)
+        {
+            RETURNFUNC(-RIG_EINVAL);
+        }
+
+        batch[i].ret_data[0] = '\0';
+        batch[i].status = -RIG_ETIMEOUT;
+
+        if (strcmp(batch[i].cmd_str, "IF;") == 0 && priv->cache_start.tv_sec != 0
+                && elapsed_ms(&priv->cache_start, 0) < 500)
+        {
+            strcpy(batch[i].ret_data, priv->last_if_response);
+            batch[i].status = RIG_OK;
+        }
+    }
+
+    if (STATE(rig)->powerstat == 0)
+    {
+        rig_debug(RIG_DEBUG_WARN, "%s: Cannot get from rig when power is off\n",
+                  __func__);
+
+        for (i = 0; i < count; i++)
+        {
+            batch[i].status = RIG_OK; // like newcat_get_cmd(), to prevent repeats
+        }
+
+        RETURNFUNC(RIG_OK);
+    }
+
+    if (priv->no_batch)
+    {
+        for (i = 0; i < count; i++)
+        {
+            if (batch[i].status == RIG_OK)
+            {
+                continue;
+            }
+
+            strcpy(priv->cmd_str, batch[i].cmd_str);
+            batch[i].status = newcat_get_cmd(rig);
+            strcpy(batch[i].ret_data, priv->ret_data);
+        }
+    }
+    else
+    {
+        newcat_batch_exchange(rig, batch, count);
+    }
+
+    for (i = 0; i < count && rc == RIG_OK; i++)
+    {
+        rc = batch[i].status;
+    }
+
+    RETURNFUNC(rc);
+}
+
 /*
  * This tries to set and read to validate the set command actually worked
  * returns RIG_OK if set, -RIG_EIMPL if not implemented yet, or -RIG_EPROTO if unsuccessful
@@ -11421,7 +11906,7 @@ int newcat_set_cmd_validate(RIG *rig)
         strcpy(valcmd, "VS;");
 
         // Some models treat the 2nd VS as a mute request
-        if (is_ftdx3000 || is_ftdx9000)
+        if (RIG_IS_FTDX3000 || RIG_IS_FTDX9000)
         {
             strcpy(valcmd, "");
         }
@@ -11508,7 +11993,7 @@ int newcat_set_cmd_validate(RIG *rig)
         hamlib_port_t *rp = RIGPORT(rig);
         char cmd[256]; // big enough
 repeat:
-        rig_flush(rp);  /* discard any unsolicited data */
+        newcat_expect_reply(rig, valcmd);
         SNPRINTF(cmd, sizeof(cmd), "%s", priv->cmd_str);
         rc = write_block(rp, (unsigned char *) cmd, strlen(cmd));
 
@@ -11609,7 +12094,7 @@ int newcat_set_cmd(RIG *rig)
 
     while (rc != RIG_OK && retry_count++ <= rp->retry)
     {
-        rig_flush(rp);  /* discard any unsolicited data */
+        newcat_expect_reply(rig, verify_cmd);
         /* send the command */
         rig_debug(RIG_DEBUG_TRACE, "cmd_str = %s\n", priv->cmd_str);
 
@@ -12090,17 +12575,17 @@ static int newcat_set_apf_frequency(RIG *rig, vfo_t vfo, int freq)
     }
 
     // Range seems to be -250..250 Hz in 10 Hz steps
-    if (is_ftdx101d || is_ftdx101mp)
+    if (RIG_IS_FTDX101D || RIG_IS_FTDX101MP)
     {
         SNPRINTF(priv->cmd_str, sizeof(priv->cmd_str), "CO%c3%04d%c", main_sub_vfo,
                  (freq + 250) / 10, cat_term);
     }
-    else if (is_ftdx10 || is_ft991 || is_ft891 || is_ft710)
+    else if (RIG_IS_FTDX10 || RIG_IS_FT991 || RIG_IS_FT891 || RIG_IS_FT710)
     {
         SNPRINTF(priv->cmd_str, sizeof(priv->cmd_str), "CO03%04d%c", (freq + 250) / 10,
                  cat_term);
     }
-    else if (is_ftdx3000 || is_ftdx1200)
+    else if (RIG_IS_FTDX3000 || RIG_IS_FTDX1200)
     {
         SNPRINTF(priv->cmd_str, sizeof(priv->cmd_str), "CO02%02d%c", (freq + 250) / 10,
                  cat_term);
@@ -12126,16 +12611,16 @@ static int newcat_get_apf_frequency(RIG *rig, vfo_t vfo, int *freq)
         RETURNFUNC2(-RIG_ENAVAIL);
     }
 
-    if (is_ftdx101d || is_ftdx101mp)
+    if (RIG_IS_FTDX101D || RIG_IS_FTDX101MP)
     {
         SNPRINTF(priv->cmd_str, sizeof(priv->cmd_str), "CO%c3%c", main_sub_vfo,
                  cat_term);
     }
-    else if (is_ftdx10 || is_ft991 || is_ft891 || is_ft710)
+    else if (RIG_IS_FTDX10 || RIG_IS_FT991 || RIG_IS_FT891 || RIG_IS_FT710)
     {
         SNPRINTF(priv->cmd_str, sizeof(priv->cmd_str), "CO03%c", cat_term);
     }
-    else if (is_ftdx3000 || is_ftdx1200)
+    else if (RIG_IS_FTDX3000 || RIG_IS_FTDX1200)
     {
         SNPRINTF(priv->cmd_str, sizeof(priv->cmd_str), "CO02%c", cat_term);
     }
@@ -12174,29 +12659,29 @@ static int newcat_set_apf_width(RIG *rig, vfo_t vfo, int choice)
         RETURNFUNC2(-RIG_ENAVAIL);
     }
 
-    if (is_ftdx101d || is_ftdx101mp || is_ftdx10)
+    if (RIG_IS_FTDX101D || RIG_IS_FTDX101MP || RIG_IS_FTDX10)
     {
         SNPRINTF(priv->cmd_str, sizeof(priv->cmd_str), "EX030201%d%c", choice,
                  cat_term);
     }
-    else if (is_ft710)
+    else if (RIG_IS_FT710)
     {
         SNPRINTF(priv->cmd_str, sizeof(priv->cmd_str), "EX030204%d%c", choice,
                  cat_term);
     }
-    else if (is_ft991)
+    else if (RIG_IS_FT991)
     {
         SNPRINTF(priv->cmd_str, sizeof(priv->cmd_str), "EX111%d%c", choice, cat_term);
     }
-    else if (is_ft891)
+    else if (RIG_IS_FT891)
     {
         SNPRINTF(priv->cmd_str, sizeof(priv->cmd_str), "EX1201%d%c", choice, cat_term);
     }
-    else if (is_ftdx5000)
+    else if (RIG_IS_FTDX5000)
     {
         SNPRINTF(priv->cmd_str, sizeof(priv->cmd_str), "EX112%d%c", choice, cat_term);
     }
-    else if (is_ftdx3000 || is_ftdx1200)
+    else if (RIG_IS_FTDX3000 || RIG_IS_FTDX1200)
     {
         SNPRINTF(priv->cmd_str, sizeof(priv->cmd_str), "EX107%d%c", choice, cat_term);
     }
@@ -12220,27 +12705,27 @@ static int newcat_get_apf_width(RIG *rig, vfo_t vfo, int *choice)
         RETURNFUNC2(-RIG_ENAVAIL);
     }
 
-    if (is_ftdx101d || is_ftdx101mp || is_ftdx10)
+    if (RIG_IS_FTDX101D || RIG_IS_FTDX101MP || RIG_IS_FTDX10)
     {
         SNPRINTF(priv->cmd_str, sizeof(priv->cmd_str), "EX030201%c", cat_term);
     }
-    else if (is_ft710)
+    else if (RIG_IS_FT710)
     {
         SNPRINTF(priv->cmd_str, sizeof(priv->cmd_str), "EX030204%c", cat_term);
     }
-    else if (is_ft991)
+    else if (RIG_IS_FT991)
     {
         SNPRINTF(priv->cmd_str, sizeof(priv->cmd_str), "EX111%c", cat_term);
     }
-    else if (is_ft891)
+    else if (RIG_IS_FT891)
     {
         SNPRINTF(priv->cmd_str, sizeof(priv->cmd_str), "EX1201%c", cat_term);
     }
-    else if (is_ftdx5000)
+    else if (RIG_IS_FTDX5000)
     {
         SNPRINTF(priv->cmd_str, sizeof(priv->cmd_str), "EX112%c", cat_term);
     }
-    else if (is_ftdx3000 || is_ftdx1200)
+    else if (RIG_IS_FTDX3000 || RIG_IS_FTDX1200)
     {
         SNPRINTF(priv->cmd_str, sizeof(priv->cmd_str), "EX107%c", cat_term);
     }
@@ -12277,22 +12762,22 @@ static int newcat_set_contour(RIG *rig, vfo_t vfo, int status)
         RETURNFUNC2(-RIG_ENAVAIL);
     }
 
-    if (is_ftdx101d || is_ftdx101mp)
+    if (RIG_IS_FTDX101D || RIG_IS_FTDX101MP)
     {
         SNPRINTF(priv->cmd_str, sizeof(priv->cmd_str), "CO%c0%04d%c", main_sub_vfo,
                  status ? 1 : 0, cat_term);
     }
-    else if (is_ftdx10 || is_ft991 || is_ft891 || is_ft710)
+    else if (RIG_IS_FTDX10 || RIG_IS_FT991 || RIG_IS_FT891 || RIG_IS_FT710)
     {
         SNPRINTF(priv->cmd_str, sizeof(priv->cmd_str), "CO00%04d%c", status ? 1 : 0,
                  cat_term);
     }
-    else if (is_ftdx5000)
+    else if (RIG_IS_FTDX5000)
     {
         SNPRINTF(priv->cmd_str, sizeof(priv->cmd_str), "CO%c0%02d%c", main_sub_vfo,
                  status ? 1 : 0, cat_term);
     }
-    else if (is_ftdx3000 || is_ftdx1200 || is_ft2000)
+    else if (RIG_IS_FTDX3000 || RIG_IS_FTDX1200 || RIG_IS_FT2000)
     {
         SNPRINTF(priv->cmd_str, sizeof(priv->cmd_str), "CO00%02d%c", status ? 1 : 0,
                  cat_term);
@@ -12319,21 +12804,21 @@ static int newcat_get_contour(RIG *rig, vfo_t vfo, int *status)
         RETURNFUNC2(-RIG_ENAVAIL);
     }
 
-    if (is_ftdx101d || is_ftdx101mp)
+    if (RIG_IS_FTDX101D || RIG_IS_FTDX101MP)
     {
         SNPRINTF(priv->cmd_str, sizeof(priv->cmd_str), "CO%c0%c", main_sub_vfo,
                  cat_term);
     }
-    else if (is_ftdx10 || is_ft991 || is_ft891 || is_ft710)
+    else if (RIG_IS_FTDX10 || RIG_IS_FT991 || RIG_IS_FT891 || RIG_IS_FT710)
     {
         SNPRINTF(priv->cmd_str, sizeof(priv->cmd_str), "CO00%c", cat_term);
     }
-    else if (is_ftdx5000)
+    else if (RIG_IS_FTDX5000)
     {
         SNPRINTF(priv->cmd_str, sizeof(priv->cmd_str), "CO%c0%c", main_sub_vfo,
                  cat_term);
     }
-    else if (is_ftdx3000 || is_ftdx1200 || is_ft2000)
+    else if (RIG_IS_FTDX3000 || RIG_IS_FTDX1200 || RIG_IS_FT2000)
     {
         SNPRINTF(priv->cmd_str, sizeof(priv->cmd_str), "CO00%c", cat_term);
     }
@@ -12372,24 +12857,24 @@ static int newcat_set_contour_frequency(RIG *rig, vfo_t vfo, int freq)
         RETURNFUNC2(-RIG_ENAVAIL);
     }
 
-    if (is_ftdx101d || is_ftdx101mp)
+    if (RIG_IS_FTDX101D || RIG_IS_FTDX101MP)
     {
         // Range is 10..3200 Hz
         SNPRINTF(priv->cmd_str, sizeof(priv->cmd_str), "CO%c1%04d%c", main_sub_vfo,
                  freq, cat_term);
     }
-    else if (is_ftdx10 || is_ft991 || is_ft891 || is_ft710)
+    else if (RIG_IS_FTDX10 || RIG_IS_FT991 || RIG_IS_FT891 || RIG_IS_FT710)
     {
         // Range is 10..3200 Hz
         SNPRINTF(priv->cmd_str, sizeof(priv->cmd_str), "CO01%04d%c", freq, cat_term);
     }
-    else if (is_ftdx5000)
+    else if (RIG_IS_FTDX5000)
     {
         // Range is 100..4000 Hz in 100 Hz steps
         SNPRINTF(priv->cmd_str, sizeof(priv->cmd_str), "CO%c1%01d%c", main_sub_vfo,
                  freq / 100, cat_term);
     }
-    else if (is_ftdx3000 || is_ftdx1200 || is_ft2000)
+    else if (RIG_IS_FTDX3000 || RIG_IS_FTDX1200 || RIG_IS_FT2000)
     {
         // Range is 100..4000 Hz in 100 Hz steps
         SNPRINTF(priv->cmd_str, sizeof(priv->cmd_str), "CO01%02d%c", freq / 100,
@@ -12416,21 +12901,21 @@ static int newcat_get_contour_frequency(RIG *rig, vfo_t vfo, int *freq)
         RETURNFUNC2(-RIG_ENAVAIL);
     }
 
-    if (is_ftdx101d || is_ftdx101mp)
+    if (RIG_IS_FTDX101D || RIG_IS_FTDX101MP)
     {
         SNPRINTF(priv->cmd_str, sizeof(priv->cmd_str), "CO%c1%c", main_sub_vfo,
                  cat_term);
     }
-    else if (is_ftdx10 || is_ft991 || is_ft891 || is_ft710)
+    else if (RIG_IS_FTDX10 || RIG_IS_FT991 || RIG_IS_FT891 || RIG_IS_FT710)
     {
         SNPRINTF(priv->cmd_str, sizeof(priv->cmd_str), "CO01%c", cat_term);
     }
-    else if (is_ftdx5000)
+    else if (RIG_IS_FTDX5000)
     {
         SNPRINTF(priv->cmd_str, sizeof(priv->cmd_str), "CO%c1%c", main_sub_vfo,
                  cat_term);
     }
-    else if (is_ftdx3000 || is_ftdx1200 || is_ft2000)
+    else if (RIG_IS_FTDX3000 || RIG_IS_FTDX1200 || RIG_IS_FT2000)
     {
         SNPRINTF(priv->cmd_str, sizeof(priv->cmd_str), "CO01%c", cat_term);
     }
@@ -12454,11 +12939,11 @@ static int newcat_get_contour_frequency(RIG *rig, vfo_t vfo, int *freq)
 
     int raw_value = atoi(ret_data);
 
-    if (is_ftdx101d || is_ftdx101mp || is_ftdx10 || is_ft991 || is_ft891)
+    if (RIG_IS_FTDX101D || RIG_IS_FTDX101MP || RIG_IS_FTDX10 || RIG_IS_FT991 || RIG_IS_FT891)
     {
         *freq = raw_value;
     }
-    else if (is_ftdx5000 || is_ftdx3000 || is_ftdx1200 || is_ft2000)
+    else if (RIG_IS_FTDX5000 || RIG_IS_FTDX3000 || RIG_IS_FTDX1200 || RIG_IS_FT2000)
     {
         *freq = raw_value * 100;
     }
@@ -12479,30 +12964,30 @@ static int newcat_set_contour_level(RIG *rig, vfo_t vfo, int level)
         RETURNFUNC2(-RIG_ENAVAIL);
     }
 
-    if (is_ftdx101d || is_ftdx101mp || is_ftdx10)
+    if (RIG_IS_FTDX101D || RIG_IS_FTDX101MP || RIG_IS_FTDX10)
     {
         SNPRINTF(priv->cmd_str, sizeof(priv->cmd_str), "EX030202%+03d%c", level,
                  cat_term);
     }
-    else if (is_ft710)
+    else if (RIG_IS_FT710)
     {
         SNPRINTF(priv->cmd_str, sizeof(priv->cmd_str), "EX030205%+03d%c", level,
                  cat_term);
     }
-    else if (is_ft991)
+    else if (RIG_IS_FT991)
     {
         SNPRINTF(priv->cmd_str, sizeof(priv->cmd_str), "EX112%+03d%c", level, cat_term);
     }
-    else if (is_ft891)
+    else if (RIG_IS_FT891)
     {
         SNPRINTF(priv->cmd_str, sizeof(priv->cmd_str), "EX1202%+03d%c", level,
                  cat_term);
     }
-    else if (is_ftdx5000)
+    else if (RIG_IS_FTDX5000)
     {
         SNPRINTF(priv->cmd_str, sizeof(priv->cmd_str), "EX113%+03d%c", level, cat_term);
     }
-    else if (is_ftdx3000 || is_ftdx1200)
+    else if (RIG_IS_FTDX3000 || RIG_IS_FTDX1200)
     {
         SNPRINTF(priv->cmd_str, sizeof(priv->cmd_str), "EX108%+03d%c", level, cat_term);
     }
@@ -12526,27 +13011,27 @@ static int newcat_get_contour_level(RIG *rig, vfo_t vfo, int *level)
         RETURNFUNC2(-RIG_ENAVAIL);
     }
 
-    if (is_ftdx101d || is_ftdx101mp || is_ftdx10)
+    if (RIG_IS_FTDX101D || RIG_IS_FTDX101MP || RIG_IS_FTDX10)
     {
         SNPRINTF(priv->cmd_str, sizeof(priv->cmd_str), "EX030202%c", cat_term);
     }
-    else if (is_ft710)
+    else if (RIG_IS_FT710)
     {
         SNPRINTF(priv->cmd_str, sizeof(priv->cmd_str), "EX030205%c", cat_term);
     }
-    else if (is_ft991)
+    else if (RIG_IS_FT991)
     {
         SNPRINTF(priv->cmd_str, sizeof(priv->cmd_str), "EX112%c", cat_term);
     }
-    else if (is_ft891)
+    else if (RIG_IS_FT891)
     {
         SNPRINTF(priv->cmd_str, sizeof(priv->cmd_str), "EX1202%c", cat_term);
     }
-    else if (is_ftdx5000)
+    else if (RIG_IS_FTDX5000)
     {
         SNPRINTF(priv->cmd_str, sizeof(priv->cmd_str), "EX113%c", cat_term);
     }
-    else if (is_ftdx3000 || is_ftdx1200)
+    else if (RIG_IS_FTDX3000 || RIG_IS_FTDX1200)
     {
         SNPRINTF(priv->cmd_str, sizeof(priv->cmd_str), "EX108%c", cat_term);
     }
@@ -12582,29 +13067,29 @@ static int newcat_set_contour_width(RIG *rig, vfo_t vfo, int width)
         RETURNFUNC2(-RIG_ENAVAIL);
     }
 
-    if (is_ftdx101d || is_ftdx101mp || is_ftdx10)
+    if (RIG_IS_FTDX101D || RIG_IS_FTDX101MP || RIG_IS_FTDX10)
     {
         SNPRINTF(priv->cmd_str, sizeof(priv->cmd_str), "EX030203%02d%c", width,
                  cat_term);
     }
-    else if (is_ft710)
+    else if (RIG_IS_FT710)
     {
         SNPRINTF(priv->cmd_str, sizeof(priv->cmd_str), "EX030206%02d%c", width,
                  cat_term);
     }
-    else if (is_ft991)
+    else if (RIG_IS_FT991)
     {
         SNPRINTF(priv->cmd_str, sizeof(priv->cmd_str), "EX113%02d%c", width, cat_term);
     }
-    else if (is_ft891)
+    else if (RIG_IS_FT891)
     {
         SNPRINTF(priv->cmd_str, sizeof(priv->cmd_str), "EX1203%02d%c", width, cat_term);
     }
-    else if (is_ftdx5000)
+    else if (RIG_IS_FTDX5000)
     {
         SNPRINTF(priv->cmd_str, sizeof(priv->cmd_str), "EX114%02d%c", width, cat_term);
     }
-    else if (is_ftdx3000 || is_ftdx1200)
+    else if (RIG_IS_FTDX3000 || RIG_IS_FTDX1200)
     {
         SNPRINTF(priv->cmd_str, sizeof(priv->cmd_str), "EX109%02d%c", width, cat_term);
     }
@@ -12628,27 +13113,27 @@ static int newcat_get_contour_width(RIG *rig, vfo_t vfo, int *width)
         RETURNFUNC2(-RIG_ENAVAIL);
     }
 
-    if (is_ftdx101d || is_ftdx101mp || is_ftdx10)
+    if (RIG_IS_FTDX101D || RIG_IS_FTDX101MP || RIG_IS_FTDX10)
     {
         SNPRINTF(priv->cmd_str, sizeof(priv->cmd_str), "EX030203%c", cat_term);
     }
-    else if (is_ft710)
+    else if (RIG_IS_FT710)
     {
         SNPRINTF(priv->cmd_str, sizeof(priv->cmd_str), "EX030206%c", cat_term);
     }
-    else if (is_ft991)
+    else if (RIG_IS_FT991)
     {
         SNPRINTF(priv->cmd_str, sizeof(priv->cmd_str), "EX113%c", cat_term);
     }
-    else if (is_ft891)
+    else if (RIG_IS_FT891)
     {
         SNPRINTF(priv->cmd_str, sizeof(priv->cmd_str), "EX1203%c", cat_term);
     }
-    else if (is_ftdx5000)
+    else if (RIG_IS_FTDX5000)
     {
         SNPRINTF(priv->cmd_str, sizeof(priv->cmd_str), "EX114%c", cat_term);
     }
-    else if (is_ftdx3000 || is_ftdx1200)
+    else if (RIG_IS_FTDX3000 || RIG_IS_FTDX1200)
     {
         SNPRINTF(priv->cmd_str, sizeof(priv->cmd_str), "EX109%c", cat_term);
     }
@@ -109,6 +109,16 @@ struct newcat_priv_caps
     struct newcat_roofing_filter roofing_filters[NEWCAT_ROOFING_FILTER_COUNT];
 };
 
+#define NEWCAT_BATCH_MAX                8
+
+/* One get command of a newcat_get_cmd_batch() */
+struct newcat_batch_cmd
+{
+    char cmd_str[16];               /* command with terminator, e.g. "FA;" */
+    char ret_data[NEWCAT_DATA_LEN]; /* reply with terminator */
+    int status;                     /* RIG_OK or the error of this command */
+};
+
 /*
  * Private state for newcat rigs
  */
@@ -142,6 +152,12 @@ struct newcat_priv_data
     int ftx1_clar_cached;        /* 1 if RX/TX CLAR states have been cached */
     char ftx1_rx_clar_on;        /* Cached RX CLAR enable: '0' or '1' */
     char ftx1_tx_clar_on;        /* Cached TX CLAR enable: '0' or '1' */
+    int ai_push;    /* AI1 reports are decoded by the async data handler */
+    volatile char pending_reply[2 * NEWCAT_BATCH_MAX + 1]; /* reply prefixes the commands wait for */
+    int no_batch;   /* rig did not answer a batch, send one command at a time */
+    struct newcat_batch_cmd *prefetch; /* replies newcat_get_cmd() takes instead of asking */
+    int prefetch_count;
+    uint32_t valid_cmds[26];  /* bit n of [c - 'A'] set if command c + ('A' + n) is valid */
 };
 
 /*
@@ -177,6 +193,7 @@ struct newcat_priv_data
  */
 
 int newcat_get_cmd(RIG *rig);
+int newcat_get_cmd_batch(RIG *rig, struct newcat_batch_cmd *batch, int count);
 int newcat_set_cmd(RIG *rig);
 
 int newcat_init(RIG *rig);
@@ -225,6 +242,7 @@ int newcat_power2mW(RIG * rig, unsigned int *mwpower, float power, freq_t freq,
 int newcat_mW2power(RIG * rig, float *power, unsigned int mwpower, freq_t freq, rmode_t mode);
 int newcat_set_split_vfo(RIG * rig, vfo_t vfo, split_t split, vfo_t tx_vfo);
 int newcat_get_split_vfo(RIG * rig, vfo_t vfo, split_t * split, vfo_t *tx_vfo);
+int newcat_get_vfo_snapshot(RIG *rig, struct rig_vfo_snapshot *snapshot);
 int newcat_set_rptr_shift(RIG * rig, vfo_t vfo, rptr_shift_t rptr_shift);
 int newcat_get_rptr_shift(RIG * rig, vfo_t vfo, rptr_shift_t * rptr_shift);
 int newcat_set_rptr_offs(RIG *rig, vfo_t vfo, shortfreq_t offs);
@@ -239,6 +257,12 @@ int newcat_set_ts(RIG * rig, vfo_t vfo, shortfreq_t ts);
 int newcat_get_ts(RIG * rig, vfo_t vfo, shortfreq_t * ts);
 int newcat_set_trn(RIG * rig, int trn);
 int newcat_get_trn(RIG * rig, int *trn);
+int newcat_read_frame_direct(RIG *rig, size_t buffer_length,
+                             const unsigned char *buffer);
+int newcat_is_async_frame(RIG *rig, size_t frame_length,
+                          const unsigned char *frame);
+int newcat_process_async_frame(RIG *rig, size_t frame_length,
+                               const unsigned char *frame);
 int newcat_set_channel(RIG * rig, vfo_t vfo, const channel_t * chan);
 int newcat_get_channel(RIG * rig, vfo_t vfo, channel_t * chan, int read_only);
 rmode_t newcat_rmode(char mode);
@@ -86,6 +86,13 @@ int main(int argc, char *argv[])
 
             if (n <= 0) { perror("IF"); }
         }
+        else if (strcmp(buf, "OI;") == 0)
+        {
+            SNPRINTF(buf, sizeof(buf), "OI000%09.0f+000000200000;", freqB);
+            n = write(fd, buf, strlen(buf));
+
+            if (n <= 0) { perror("OI"); }
+        }
         else if (strcmp(buf, "FA;") == 0)
         {
             SNPRINTF(buf, sizeof(buf), "FA%09.0f;", freqA);
@@ -134,6 +141,13 @@ int main(int argc, char *argv[])
         {
             hl_usleep(50 * 1000);
         }
+        else if (strcmp(buf, "TX;") == 0)
+        {
+            pbuf = "TX0;";
+            n = write(fd, pbuf, strlen(pbuf));
+
+            if (n <= 0) { perror("TX"); }
+        }
         else if (strcmp(buf, "FT;") == 0)
         {
             hl_usleep(50 * 1000);
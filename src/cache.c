@@ -33,7 +33,13 @@
  * @{
  */
 
-int rig_set_cache_mode(RIG *rig, vfo_t vfo, rmode_t mode, pbwidth_t width)
+/* The cache functions hold the state lock only while they copy the
+ * fields, and log before taking it or after releasing it, see rig_lock()
+ * for the lock hierarchy
+ * The setters set *changed when the stored value differs from the cached one
+ */
+static int cache_set_mode(RIG *rig, vfo_t vfo, rmode_t mode, pbwidth_t width,
+                          int *changed)
 {
     struct rig_cache *cachep = CACHE(rig);
     struct rig_state *rs = STATE(rig);
@@ -65,6 +71,8 @@ int rig_set_cache_mode(RIG *rig, vfo_t vfo, rmode_t mode, pbwidth_t width)
 
     if (vfo == RIG_VFO_OTHER) { vfo = vfo_fixup(rig, vfo, cachep->split); }
 
+    pthread_mutex_lock(&rs->state_mutex);
+
     if (vfo == rs->current_vfo)
     {
         cachep->modeCurr = mode;
@@ -98,6 +106,8 @@ int rig_set_cache_mode(RIG *rig, vfo_t vfo, rmode_t mode, pbwidth_t width)
     case RIG_VFO_VFO:
     case RIG_VFO_MAIN:
     case RIG_VFO_MAIN_A:
+        *changed = cachep->modeMainA != mode
+                   || (width > 0 && cachep->widthMainA != width);
         cachep->modeMainA = mode;
 
         if (width > 0) { cachep->widthMainA = width; }
@@ -109,6 +119,8 @@ int rig_set_cache_mode(RIG *rig, vfo_t vfo, rmode_t mode, pbwidth_t width)
     case RIG_VFO_B:
     case RIG_VFO_SUB:
     case RIG_VFO_MAIN_B:
+        *changed = cachep->modeMainB != mode
+                   || (width > 0 && cachep->widthMainB != width);
         cachep->modeMainB = mode;
 
         if (width > 0) { cachep->widthMainB = width; }
@@ -119,6 +131,8 @@ int rig_set_cache_mode(RIG *rig, vfo_t vfo, rmode_t mode, pbwidth_t width)
 
     case RIG_VFO_C:
     case RIG_VFO_MAIN_C:
+        *changed = cachep->modeMainC != mode
+                   || (width > 0 && cachep->widthMainC != width);
         cachep->modeMainC = mode;
 
         if (width > 0) { cachep->widthMainC = width; }
@@ -128,36 +142,59 @@ int rig_set_cache_mode(RIG *rig, vfo_t vfo, rmode_t mode, pbwidth_t width)
         break;
 
     case RIG_VFO_SUB_A:
+        *changed = cachep->modeSubA != mode;
         cachep->modeSubA = mode;
         elapsed_ms(&cachep->time_modeSubA, HAMLIB_ELAPSED_SET);
         break;
 
     case RIG_VFO_SUB_B:
+        *changed = cachep->modeSubB != mode;
         cachep->modeSubB = mode;
         elapsed_ms(&cachep->time_modeSubB, HAMLIB_ELAPSED_SET);
         break;
 
     case RIG_VFO_SUB_C:
+        *changed = cachep->modeSubC != mode;
         cachep->modeSubC = mode;
         elapsed_ms(&cachep->time_modeSubC, HAMLIB_ELAPSED_SET);
         break;
 
     case RIG_VFO_MEM:
+        *changed = cachep->modeMem != mode;
         cachep->modeMem = mode;
         elapsed_ms(&cachep->time_modeMem, HAMLIB_ELAPSED_SET);
         break;
 
     default:
+        pthread_mutex_unlock(&rs->state_mutex);
         rig_debug(RIG_DEBUG_WARN, "%s(%d): unknown vfo=%s\n", __func__, __LINE__,
                   rig_strvfo(vfo));
         RETURNFUNC(-RIG_EINTERNAL);
     }
 
+    pthread_mutex_unlock(&rs->state_mutex);
+
     rig_cache_show(rig, __func__, __LINE__);
     RETURNFUNC(RIG_OK);
 }
 
-int rig_set_cache_freq(RIG *rig, vfo_t vfo, freq_t freq)
+int rig_set_cache_mode(RIG *rig, vfo_t vfo, rmode_t mode, pbwidth_t width)
+{
+    int retval;
+    int changed = 0;
+
+    retval = cache_set_mode(rig, vfo, mode, width, &changed);
+
+    // rereading an unchanged value must not wake the publisher
+    if (retval == RIG_OK && changed)
+    {
+        rig_cache_notify(rig);
+    }
+
+    return retval;
+}
+
+static int cache_set_freq(RIG *rig, vfo_t vfo, freq_t freq, int *changed)
 {
     int flag = HAMLIB_ELAPSED_SET;
     struct rig_cache *cachep = CACHE(rig);
@@ -193,6 +230,15 @@ int rig_set_cache_freq(RIG *rig, vfo_t vfo, freq_t freq)
                   rig_strvfo(vfo), freq);
     }
 
+    if (vfo == RIG_VFO_OTHER)
+    {
+        rig_debug(RIG_DEBUG_VERBOSE, "%s(%d): ignoring VFO_OTHER\n", __func__,
+                  __LINE__);
+        return (RIG_OK);
+    }
+
+    pthread_mutex_lock(&rs->state_mutex);
+
     if (vfo == rs->current_vfo)
     {
         cachep->freqCurr = freq;
@@ -230,6 +276,7 @@ int rig_set_cache_freq(RIG *rig, vfo_t vfo, freq_t freq)
     case RIG_VFO_VFO:
     case RIG_VFO_MAIN:
     case RIG_VFO_MAIN_A:
+        *changed = cachep->freqMainA != freq;
         cachep->freqMainA = freq;
         elapsed_ms(&cachep->time_freqMainA, flag);
         break;
@@ -237,47 +284,51 @@ int rig_set_cache_freq(RIG *rig, vfo_t vfo, freq_t freq)
     case RIG_VFO_B:
     case RIG_VFO_MAIN_B:
     case RIG_VFO_SUB:
+        *changed = cachep->freqMainB != freq;
         cachep->freqMainB = freq;
         elapsed_ms(&cachep->time_freqMainB, flag);
         break;
 
     case RIG_VFO_C:
     case RIG_VFO_MAIN_C:
+        *changed = cachep->freqMainC != freq;
         cachep->freqMainC = freq;
         elapsed_ms(&cachep->time_freqMainC, flag);
         break;
 
     case RIG_VFO_SUB_A:
+        *changed = cachep->freqSubA != freq;
         cachep->freqSubA = freq;
         elapsed_ms(&cachep->time_freqSubA, flag);
         break;
 
     case RIG_VFO_SUB_B:
+        *changed = cachep->freqSubB != freq;
         cachep->freqSubB = freq;
         elapsed_ms(&cachep->time_freqSubB, flag);
         break;
 
     case RIG_VFO_SUB_C:
+        *changed = cachep->freqSubC != freq;
         cachep->freqSubC = freq;
         elapsed_ms(&cachep->time_freqSubC, flag);
         break;
 
     case RIG_VFO_MEM:
+        *changed = cachep->freqMem != freq;
         cachep->freqMem = freq;
         elapsed_ms(&cachep->time_freqMem, flag);
         break;
 
-    case RIG_VFO_OTHER:
-        rig_debug(RIG_DEBUG_VERBOSE, "%s(%d): ignoring VFO_OTHER\n", __func__,
-                  __LINE__);
-        break;
-
     default:
+        pthread_mutex_unlock(&rs->state_mutex);
         rig_debug(RIG_DEBUG_WARN, "%s(%d): unknown vfo?, vfo=%s\n", __func__, __LINE__,
                   rig_strvfo(vfo));
         return (-RIG_EINVAL);
     }
 
+    pthread_mutex_unlock(&rs->state_mutex);
+
     if (rig_need_debug(RIG_DEBUG_CACHE))
     {
         rig_cache_show(rig, __func__, __LINE__);
@@ -287,29 +338,25 @@ int rig_set_cache_freq(RIG *rig, vfo_t vfo, freq_t freq)
     return (RIG_OK);
 }
 
-/**
- * \brief get cached values for a VFO
- * \param rig           The rig handle
- * \param vfo           The VFO to get information from
- * \param freq          The frequency is stored here
- * \param cache_ms_freq The age of the last frequency update in ms
- * \param mode          The mode is stored here
- * \param cache_ms_mode The age of the last mode update in ms
- * \param width         The width is stored here
- * \param cache_ms_width The age of the last width update in ms
- *
- * Use this to query the cache and then determine to actually fetch data from
- * the rig.
- *
- * \note All pointers must be given. No pointer can be left at NULL
- *
- * \return RIG_OK if the operation has been successful, otherwise
- * a negative value if an error occurred (in which case, cause is
- * set appropriately).
- *
- */
-int rig_get_cache(RIG *rig, vfo_t vfo, freq_t *freq, int *cache_ms_freq,
-                  rmode_t *mode, int *cache_ms_mode, pbwidth_t *width, int *cache_ms_width)
+int rig_set_cache_freq(RIG *rig, vfo_t vfo, freq_t freq)
+{
+    int retval;
+    int changed = 0;
+
+    retval = cache_set_freq(rig, vfo, freq, &changed);
+
+    // rereading an unchanged value must not wake the publisher
+    if (retval == RIG_OK && changed)
+    {
+        rig_cache_notify(rig);
+    }
+
+    return retval;
+}
+
+static int cache_get(RIG *rig, vfo_t vfo, freq_t *freq, int *cache_ms_freq,
+                     rmode_t *mode, int *cache_ms_mode, pbwidth_t *width,
+                     int *cache_ms_width)
 {
     struct rig_cache *cachep;
     struct rig_state *rs;
@@ -403,6 +450,8 @@ int rig_get_cache(RIG *rig, vfo_t vfo, freq_t *freq, int *cache_ms_freq,
     // If we're in satmode we map SUB to SUB_A
     if (vfo == RIG_VFO_SUB && cachep->satmode) { vfo = RIG_VFO_SUB_A; };
 
+    pthread_mutex_lock(&rs->state_mutex);
+
     switch (vfo)
     {
     case RIG_VFO_CURR:
@@ -518,11 +567,14 @@ int rig_get_cache(RIG *rig, vfo_t vfo, freq_t *freq, int *cache_ms_freq,
         break;
 
     default:
+        pthread_mutex_unlock(&rs->state_mutex);
         rig_debug(RIG_DEBUG_WARN, "%s(%d): unknown vfo?, vfo=%s\n", __func__, __LINE__,
                   rig_strvfo(vfo));
         RETURNFUNC2(-RIG_EINVAL);
     }
 
+    pthread_mutex_unlock(&rs->state_mutex);
+
     rig_debug(RIG_DEBUG_CACHE, "%s(%d): vfo=%s, freq=%.0f, mode=%s, width=%d\n",
               __func__, __LINE__, rig_strvfo(vfo),
               (double)*freq, rig_strrmode(*mode), (int)*width);
@@ -535,6 +587,43 @@ int rig_get_cache(RIG *rig, vfo_t vfo, freq_t *freq, int *cache_ms_freq,
     return RIG_OK;
 }
 
+/**
+ * \brief get cached values for a VFO
+ * \param rig           The rig handle
+ * \param vfo           The VFO to get information from
+ * \param freq          The frequency is stored here
+ * \param cache_ms_freq The age of the last frequency update in ms
+ * \param mode          The mode is stored here
+ * \param cache_ms_mode The age of the last mode update in ms
+ * \param width         The width is stored here
+ * \param cache_ms_width The age of the last width update in ms
+ *
+ * Use this to query the cache and then determine to actually fetch data from
+ * the rig.
+ *
+ * \note All pointers must be given. No pointer can be left at NULL
+ *
+ * \return RIG_OK if the operation has been successful, otherwise
+ * a negative value if an error occurred (in which case, cause is
+ * set appropriately).
+ *
+ */
+int rig_get_cache(RIG *rig, vfo_t vfo, freq_t *freq, int *cache_ms_freq,
+                  rmode_t *mode, int *cache_ms_mode, pbwidth_t *width, int *cache_ms_width)
+{
+    int retval;
+
+    if (CHECK_RIG_ARG(rig))
+    {
+        return -RIG_EINVAL;
+    }
+
+    retval = cache_get(rig, vfo, freq, cache_ms_freq, mode, cache_ms_mode, width,
+                       cache_ms_width);
+
+    return retval;
+}
+
 /**
  * \brief get cached values for a VFO
  * \param rig           The rig handle
@@ -569,6 +658,58 @@ int rig_get_cache_freq(RIG *rig, vfo_t vfo, freq_t *freq, int *cache_ms_freq_p)
     return retval;
 }
 
+/* Wake up the threads waiting in rig_cache_wait_change(), i.e. the rig poll
+ * routine publishing the state to network clients
+ * Called after the cached freq/mode/PTT/split has been changed
+ */
+void rig_cache_notify(RIG *rig)
+{
+    struct rig_cache *cachep = CACHE(rig);
+
+    pthread_mutex_lock(&cachep->notify_mutex);
+    cachep->generation++;
+    pthread_cond_broadcast(&cachep->notify_cond);
+    pthread_mutex_unlock(&cachep->notify_mutex);
+}
+
+/* Wait up to timeout_ms for a cache update newer than *generation
+ * Returns 1 and updates *generation if the cache was updated, 0 on timeout
+ */
+int rig_cache_wait_change(RIG *rig, unsigned int *generation, int timeout_ms)
+{
+    struct rig_cache *cachep = CACHE(rig);
+    struct timespec deadline;
+    int changed;
+
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_sec += timeout_ms / 1000;
+    deadline.tv_nsec += (long)(timeout_ms % 1000) * 1000000L;
+
+    if (deadline.tv_nsec >= 1000000000L)
+    {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000L;
+    }
+
+    pthread_mutex_lock(&cachep->notify_mutex);
+
+    while (cachep->generation == *generation)
+    {
+        if (pthread_cond_timedwait(&cachep->notify_cond, &cachep->notify_mutex,
+                                   &deadline) != 0)
+        {
+            break;
+        }
+    }
+
+    changed = cachep->generation != *generation;
+    *generation = cachep->generation;
+
+    pthread_mutex_unlock(&cachep->notify_mutex);
+
+    return changed;
+}
+
 /* Get cache timeout period
  * Returns value in msec, -1 if error
  */
@@ -24,6 +24,8 @@
 #ifndef _CACHE_H
 #define _CACHE_H
 
+#include <pthread.h>
+
 #include "hamlib/rig.h"
 
 __BEGIN_DECLS
@@ -114,6 +116,9 @@ struct rig_cache {
     struct timespec time_ptt;
     struct timespec time_split;
     int satmode; // if rig is in satellite mode
+    unsigned int generation; // bumped by rig_cache_notify() on every update
+    pthread_mutex_t notify_mutex;
+    pthread_cond_t notify_cond;
 };
 
 /* Access macros */
@@ -126,6 +131,8 @@ struct rig_cache {
 int rig_set_cache_mode(RIG *rig, vfo_t vfo, rmode_t mode, pbwidth_t width);
 int rig_set_cache_freq(RIG *rig, vfo_t vfo, freq_t freq);
 void rig_cache_show(RIG *rig, const char *func, int line);
+void rig_cache_notify(RIG *rig);
+int rig_cache_wait_change(RIG *rig, unsigned int *generation, int timeout_ms);
 
 __END_DECLS
 
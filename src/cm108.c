@@ -264,8 +264,6 @@ int cm108_close(hamlib_port_t *port)
  */
 int cm108_ptt_set(hamlib_port_t *p, ptt_t pttx)
 {
-    rig_debug(RIG_DEBUG_VERBOSE, "%s called\n", __func__);
-
     // For a CM108 USB audio device PTT is wired up to one of the GPIO
     // pins.  Usually this is GPIO3 (bit 2 of the GPIO register) because it
     // is on the corner of the chip package (pin 13) so it's easily accessible.
@@ -298,12 +296,6 @@ int cm108_ptt_set(hamlib_port_t *p, ptt_t pttx)
         // byte 2: xxxx dcba     GPIO3-0 data-direction register (1=output)
         // byte 3: xxxx xxxx     SPDIF
 
-        rig_debug(RIG_DEBUG_VERBOSE,
-                  "%s: bit number %d to state %d\n",
-                  __func__,
-                  p->parm.cm108.ptt_bitnum,
-                  (pttx == RIG_PTT_ON) ? 1 : 0);
-
         if (p->fd == -1)
         {
             return -RIG_EINVAL;
@@ -312,6 +304,13 @@ int cm108_ptt_set(hamlib_port_t *p, ptt_t pttx)
         // Send the HID packet
         bytes = write(p->fd, out_rep, sizeof(out_rep));
 
+        // not before the write, it would delay the PTT edge
+        rig_debug(RIG_DEBUG_VERBOSE,
+                  "%s: bit number %d to state %d\n",
+                  __func__,
+                  p->parm.cm108.ptt_bitnum,
+                  (pttx == RIG_PTT_ON) ? 1 : 0);
+
         if (bytes < 0)
         {
             return -RIG_EIO;
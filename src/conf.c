@@ -222,6 +222,16 @@ static const struct confparams frontend_cfg_params[] =
         "Multicast data UDP port for sending commands to rig",
         "4532", RIG_CONF_NUMERIC, { .n = { 0, 1000000, 1 } }
     },
+    {
+        TOK_MULTICAST_CMD_EXEC, "multicast_cmd_exec", "Execute multicast commands",
+        "True lets any host on the multicast group set freq, mode, PTT, split and VFO, otherwise commands are answered with an access denied error",
+        "0", RIG_CONF_CHECKBUTTON, { }
+    },
+    {
+        TOK_MULTICAST_MIN_INTERVAL, "multicast_min_interval", "Multicast data minimum interval in ms",
+        "Minimum time between two published rig state changes, changes in between go out together, value of 0 publishes every change",
+        "50", RIG_CONF_NUMERIC, { .n = { 0, 60000, 1 } }
+    },
     {
         TOK_FREQ_SKIP, "freq_skip", "Skip setting freq on non-active VFO",
         "True enables skipping setting the TX_VFO when RX_VFO is receiving and skips RX_VFO when TX_VFO is transmitting",
@@ -232,6 +242,16 @@ static const struct confparams frontend_cfg_params[] =
         "Knows about WSJTX and GPREDICT as of 20240702",
         "0", RIG_CONF_CHECKBUTTON, { }
     },
+    {
+        TOK_TRUSTED_SET, "trusted_set", "Trust successful set_freq",
+        "True puts the requested frequency in the cache after a successful set_freq instead of reading it back from the rig",
+        "0", RIG_CONF_CHECKBUTTON, { }
+    },
+    {
+        TOK_TRUSTED_SET_VERIFY, "trusted_set_verify", "Trusted set_freq verification delay in ms",
+        "Delay after the last trusted set_freq before the frequency is read back in the background, value of 0 disables verification",
+        "0", RIG_CONF_NUMERIC, { .n = { 0, 60000, 1 } }
+    },
 
     { RIG_CONF_END, NULL, }
 };
@@ -817,6 +837,24 @@ static int frontend_set_conf(RIG *rig, hamlib_token_t token, const char *val)
         rs->multicast_cmd_port = val_i;
         break;
 
+    case TOK_MULTICAST_CMD_EXEC:
+        if (1 != sscanf(val, "%ld", &val_i))
+        {
+            return -RIG_EINVAL;
+        }
+
+        rs->multicast_cmd_exec = val_i != 0;
+        break;
+
+    case TOK_MULTICAST_MIN_INTERVAL:
+        if (1 != sscanf(val, "%ld", &val_i) || val_i < 0)
+        {
+            return -RIG_EINVAL;
+        }
+
+        rs->multicast_min_interval_ms = val_i;
+        break;
+
     case TOK_FREQ_SKIP:
         if (1 != sscanf(val, "%ld", &val_i))
         {
@@ -826,6 +864,24 @@ static int frontend_set_conf(RIG *rig, hamlib_token_t token, const char *val)
         rs->freq_skip = val_i != 0;
         break;
 
+    case TOK_TRUSTED_SET:
+        if (1 != sscanf(val, "%ld", &val_i))
+        {
+            return -RIG_EINVAL;
+        }
+
+        rs->trusted_set = val_i != 0;
+        break;
+
+    case TOK_TRUSTED_SET_VERIFY:
+        if (1 != sscanf(val, "%ld", &val_i) || val_i < 0)
+        {
+            return -RIG_EINVAL;
+        }
+
+        rs->trusted_set_verify_ms = val_i;
+        break;
+
     case TOK_CLIENT:
         rig_debug(RIG_DEBUG_VERBOSE, "%s: Client claims to be %s\n", __func__, val);
 
@@ -1262,10 +1318,26 @@ static int frontend_get_conf2(RIG *rig, hamlib_token_t token, char *val,
         SNPRINTF(val, val_len, "%d", rs->multicast_cmd_port);
         break;
 
+    case TOK_MULTICAST_CMD_EXEC:
+        SNPRINTF(val, val_len, "%d", rs->multicast_cmd_exec);
+        break;
+
+    case TOK_MULTICAST_MIN_INTERVAL:
+        SNPRINTF(val, val_len, "%d", rs->multicast_min_interval_ms);
+        break;
+
     case TOK_FREQ_SKIP:
         SNPRINTF(val, val_len, "%d", rs->freq_skip);
         break;
 
+    case TOK_TRUSTED_SET:
+        SNPRINTF(val, val_len, "%d", rs->trusted_set);
+        break;
+
+    case TOK_TRUSTED_SET_VERIFY:
+        SNPRINTF(val, val_len, "%d", rs->trusted_set_verify_ms);
+        break;
+
     default:
         return -RIG_EINVAL;
     }
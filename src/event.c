@@ -47,6 +47,7 @@
 #include "misc.h"
 #include "cache.h"
 #include "network.h"
+#include "spectrum.h"
 
 #define CHECK_RIG_ARG(r) (!(r) || !(r)->caps || !STATE(r)->comm_state)
 
@@ -87,14 +88,18 @@ static void *rig_poll_routine(void *arg)
 
     // Attempt to detect changes with the interval below (in milliseconds)
     int change_detection_interval = 50;
-    int interval_count = 0;
+    unsigned int generation = 0;
+    struct timespec last_publish;
 
     update_occurred = 0;
 
     network_publish_rig_poll_data(rig);
+    elapsed_ms(&last_publish, HAMLIB_ELAPSED_SET);
 
     while (rs->poll_routine_thread_run)
     {
+        int since;
+
         if (rs->current_vfo != vfo)
         {
             vfo = rs->current_vfo;
@@ -121,7 +126,7 @@ static void *rig_poll_routine(void *arg)
 
         if (cachep->freqMainC != freq_main_c)
         {
-            freq_main_b = cachep->freqMainC;
+            freq_main_c = cachep->freqMainC;
             update_occurred = 1;
         }
 
@@ -227,22 +232,31 @@ static void *rig_poll_routine(void *arg)
             update_occurred = 1;
         }
 
-        if (update_occurred)
+        since = (int) elapsed_ms(&last_publish, HAMLIB_ELAPSED_GET);
+
+        // Changes go out at most every multicast_min_interval_ms, the state is
+        // published every poll_interval even if nothing has changed
+        if ((update_occurred && since >= rs->multicast_min_interval_ms)
+                || since >= rs->poll_interval)
         {
             network_publish_rig_poll_data(rig);
+            elapsed_ms(&last_publish, HAMLIB_ELAPSED_SET);
             update_occurred = 0;
-            interval_count = 0;
+            since = 0;
         }
 
-        hl_usleep(change_detection_interval * 1000);
-        interval_count++;
-
-        // Publish updates every poll_interval if no changes have been detected
-        if (interval_count >= (rs->poll_interval / change_detection_interval))
+        if (update_occurred)
         {
-            interval_count = 0;
-            network_publish_rig_poll_data(rig);
+            // let more changes accumulate into the same publication
+            hl_usleep((rs->multicast_min_interval_ms - since) * 1000);
+            continue;
         }
+
+        // Woken early by rig_cache_notify() so freq/mode/PTT/split changes
+        // go out at once, VFO changes are still seen by the timeout
+        rig_cache_wait_change(rig, &generation,
+                              rs->poll_interval - since < change_detection_interval
+                              ? rs->poll_interval - since : change_detection_interval);
     }
 
     network_publish_rig_poll_data(rig);
@@ -701,6 +715,7 @@ int rig_fire_ptt_event(RIG *rig, vfo_t vfo, ptt_t ptt)
 
     cachep->ptt = ptt;
     elapsed_ms(&cachep->time_ptt, HAMLIB_ELAPSED_SET);
+    rig_cache_notify(rig);
 
     network_publish_rig_transceive_data(rig);
 
@@ -753,55 +768,58 @@ int rig_fire_pltune_event(RIG *rig, vfo_t vfo, freq_t *freq, rmode_t *mode,
 static int print_spectrum_line(char *str, size_t length,
                                struct rig_spectrum_line *line)
 {
+    float levels[HAMLIB_MAX_SPECTRUM_DATA];
     int data_level_max = line->data_level_max / 2;
-    int aggregate_count = line->spectrum_data_length / 120;
-    int aggregate_value = 0;
+    int data_length = line->spectrum_data_length;
+    int count = data_length < 120 ? data_length : 120;
     int i, c;
     int charlen = strlen("█");
 
     str[0] = '\0';
 
-    for (i = 0, c = 0; i < line->spectrum_data_length; i++)
+    if (data_length <= 0 || data_length > HAMLIB_MAX_SPECTRUM_DATA
+            || data_level_max <= 0)
     {
-        int current = line->spectrum_data[i];
-        aggregate_value = current > aggregate_value ? current : aggregate_value;
-
-        if (i > 0 && i % aggregate_count == 0)
-        {
-            if (c + charlen >= length)
-            {
-                break;
-            }
-
-            int level = aggregate_value * 10 / data_level_max;
-
-            if (level >= 8)
-            {
-                strcpy(str + c, "█");
-                c += charlen;
-            }
-            else if (level >= 6)
-            {
-                strcpy(str + c, "▓");
-                c += charlen;
-            }
-            else if (level >= 4)
-            {
-                strcpy(str + c, "▒");
-                c += charlen;
-            }
-            else if (level >= 2)
-            {
-                strcpy(str + c, "░");
-                c += charlen;
-            }
-            else if (level >= 0)
-            {
-                strcpy(str + c, " ");
-                c += 1;
-            }
-
-            aggregate_value = 0;
+        return 0;
+    }
+
+    spectrum_u8_to_float(levels, line->spectrum_data, data_length, 1.0f, 0.0f);
+    spectrum_decimate(levels, count, levels, data_length,
+                      RIG_SPECTRUM_DECIMATION_MAX);
+
+    for (i = 0, c = 0; i < count; i++)
+    {
+        if (c + charlen >= length)
+        {
+            break;
+        }
+
+        int level = (int) levels[i] * 10 / data_level_max;
+
+        if (level >= 8)
+        {
+            strcpy(str + c, "█");
+            c += charlen;
+        }
+        else if (level >= 6)
+        {
+            strcpy(str + c, "▓");
+            c += charlen;
+        }
+        else if (level >= 4)
+        {
+            strcpy(str + c, "▒");
+            c += charlen;
+        }
+        else if (level >= 2)
+        {
+            strcpy(str + c, "░");
+            c += charlen;
+        }
+        else if (level >= 0)
+        {
+            strcpy(str + c, " ");
+            c += 1;
         }
     }
 
@@ -811,6 +829,9 @@ static int print_spectrum_line(char *str, size_t length,
 
 int rig_fire_spectrum_event(RIG *rig, struct rig_spectrum_line *line)
 {
+    struct rig_spectrum_signals signals;
+    int have_signals;
+
     ENTERFUNC;
 
     if (rig_need_debug(RIG_DEBUG_TRACE))
@@ -821,13 +842,17 @@ int rig_fire_spectrum_event(RIG *rig, struct rig_spectrum_line *line)
                   spectrum_debug);
     }
 
-    network_publish_rig_spectrum_data(rig, line);
+    have_signals = spectrum_detector_fire(rig, line, &signals) == 1;
 
     if (rig->callbacks.spectrum_event)
     {
         rig->callbacks.spectrum_event(rig, line, rig->callbacks.spectrum_arg);
     }
 
+    // also feeds the multicast publisher, see network_multicast_publisher_start(),
+    // the signals travel with the line so subscribers never see a newer detection
+    spectrum_proc_fire(rig, line, have_signals ? &signals : NULL);
+
     RETURNFUNC(RIG_OK);
 }
 
@@ -0,0 +1,495 @@
+/*
+ *  Hamlib Interface - write-behind coalescing of frequency changes
+ *  Copyright (c) 2000-2025 The Hamlib Group
+ *
+ *
+ *   This library is free software; you can redistribute it and/or
+ *   modify it under the terms of the GNU Lesser General Public
+ *   License as published by the Free Software Foundation; either
+ *   version 2.1 of the License, or (at your option) any later version.
+ *
+ *   This library is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *   Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public
+ *   License along with this library; if not, write to the Free Software
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+/* SPDX-License-Identifier: LGPL-2.1-or-later */
+
+/**
+ * \addtogroup rig
+ * @{
+ */
+
+/**
+ * \file freq_coalesce.c
+ * \brief Write-behind coalescing of frequency changes
+ *
+ * A tuning knob or a doppler tracker can ask for more frequency changes
+ * than a slow CAT link carries. In coalescing mode rig_set_freq() only
+ * stores the frequency in a slot per VFO and returns; a sender thread
+ * writes the latest value of each slot to the rig as fast as the link
+ * completes the writes. Intermediate values are skipped.
+ */
+
+#include "hamlib/config.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#include <pthread.h>
+
+#include "hamlib/rig.h"
+#include "hamlib/rig_state.h"
+#include "freq_coalesce.h"
+#include "cache.h"
+#include "misc.h"
+
+#define FREQ_COALESCE_SLOTS 8
+
+typedef struct freq_coalesce_slot_s
+{
+    vfo_t vfo;              /* RIG_VFO_NONE if the slot is free */
+    freq_t freq;            /* latest requested frequency */
+    int pending;            /* freq has not been handed to the sender yet */
+    unsigned int submitted; /* number of requests */
+    unsigned int written;   /* number of requests covered by completed writes */
+    int status;             /* result of the last write */
+} freq_coalesce_slot;
+
+typedef struct freq_coalesce_priv_data_s
+{
+    RIG *rig;
+    pthread_t thread_id;
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;            /* signals the sender */
+    pthread_cond_t written_cond;    /* signals rig_wait_set_freq() */
+    pthread_cond_t idle_cond;       /* users dropped to 0, with state_mutex */
+    int users;                      /* callers using priv, under state_mutex */
+    int run;
+    int min_interval_ms;
+    int next;                       /* round robin between the VFOs */
+    freq_coalesce_slot slots[FREQ_COALESCE_SLOTS];
+} freq_coalesce_priv_data;
+
+/* Get the sender data if coalescing is enabled
+ * The data stays valid until freq_coalesce_put(), freq_coalesce_stop() waits
+ * for it. Only state_mutex guards the pointer, no other lock is taken here.
+ */
+static freq_coalesce_priv_data *freq_coalesce_get(RIG *rig)
+{
+    struct rig_state *rs = STATE(rig);
+    freq_coalesce_priv_data *priv;
+
+    pthread_mutex_lock(&rs->state_mutex);
+    priv = (freq_coalesce_priv_data *) rs->freq_coalesce_priv_data;
+
+    if (priv != NULL)
+    {
+        priv->users++;
+    }
+
+    pthread_mutex_unlock(&rs->state_mutex);
+
+    return priv;
+}
+
+static void freq_coalesce_put(RIG *rig, freq_coalesce_priv_data *priv)
+{
+    struct rig_state *rs = STATE(rig);
+
+    pthread_mutex_lock(&rs->state_mutex);
+
+    if (--priv->users == 0)
+    {
+        pthread_cond_broadcast(&priv->idle_cond);
+    }
+
+    pthread_mutex_unlock(&rs->state_mutex);
+}
+
+/* The VFO rig_set_freq() will write, so that VFOA and currVFO on VFOA
+ * share a slot
+ */
+static vfo_t freq_coalesce_vfo(RIG *rig, vfo_t vfo)
+{
+    vfo = vfo_fixup(rig, vfo, CACHE(rig)->split);
+
+    if (vfo == RIG_VFO_CURR)
+    {
+        vfo = STATE(rig)->current_vfo;
+    }
+
+    return vfo;
+}
+
+static freq_coalesce_slot *freq_coalesce_next_pending(
+    freq_coalesce_priv_data *priv)
+{
+    int i;
+
+    for (i = 0; i < FREQ_COALESCE_SLOTS; i++)
+    {
+        int n = (priv->next + i) % FREQ_COALESCE_SLOTS;
+
+        if (priv->slots[n].pending)
+        {
+            priv->next = (n + 1) % FREQ_COALESCE_SLOTS;
+            return &priv->slots[n];
+        }
+    }
+
+    return NULL;
+}
+
+static void *freq_coalesce_sender(void *arg)
+{
+    freq_coalesce_priv_data *priv = (freq_coalesce_priv_data *) arg;
+    RIG *rig = priv->rig;
+
+    pthread_mutex_lock(&priv->mutex);
+
+    for (;;)
+    {
+        freq_coalesce_slot *slot = freq_coalesce_next_pending(priv);
+        unsigned int submitted;
+        vfo_t vfo;
+        freq_t freq;
+        int status;
+
+        if (slot == NULL)
+        {
+            // pending writes are flushed before stopping
+            if (!priv->run)
+            {
+                break;
+            }
+
+            pthread_cond_wait(&priv->cond, &priv->mutex);
+            continue;
+        }
+
+        vfo = slot->vfo;
+        freq = slot->freq;
+        submitted = slot->submitted;
+        slot->pending = 0;
+
+        pthread_mutex_unlock(&priv->mutex);
+
+        status = rig_set_freq(rig, vfo, freq);
+
+        if (status != RIG_OK)
+        {
+            rig_debug(RIG_DEBUG_WARN, "%s: set_freq %s %.0f failed: %s\n", __func__,
+                      rig_strvfo(vfo), freq, rigerror(status));
+        }
+
+        pthread_mutex_lock(&priv->mutex);
+
+        slot->written = submitted;
+        slot->status = status;
+        pthread_cond_broadcast(&priv->written_cond);
+
+        if (slot->pending)
+        {
+            // the write above updated the cache with an older value
+            freq = slot->freq;
+            pthread_mutex_unlock(&priv->mutex);
+            rig_set_cache_freq(rig, vfo, freq);
+            pthread_mutex_lock(&priv->mutex);
+        }
+
+        if (priv->min_interval_ms > 0)
+        {
+            pthread_mutex_unlock(&priv->mutex);
+            hl_usleep(priv->min_interval_ms * 1000);
+            pthread_mutex_lock(&priv->mutex);
+        }
+    }
+
+    pthread_mutex_unlock(&priv->mutex);
+
+    return NULL;
+}
+
+/* Queue a frequency change, called by rig_set_freq()
+ * Returns 1 if the change was queued, 0 if the caller has to write it now
+ */
+int freq_coalesce_submit(RIG *rig, vfo_t vfo, freq_t freq)
+{
+    freq_coalesce_priv_data *priv = freq_coalesce_get(rig);
+    freq_coalesce_slot *slot = NULL;
+    int i;
+
+    if (priv == NULL)
+    {
+        return 0;
+    }
+
+    if (pthread_equal(pthread_self(), priv->thread_id))
+    {
+        freq_coalesce_put(rig, priv);
+        return 0;
+    }
+
+    vfo = freq_coalesce_vfo(rig, vfo);
+
+    pthread_mutex_lock(&priv->mutex);
+
+    for (i = 0; i < FREQ_COALESCE_SLOTS; i++)
+    {
+        if (priv->slots[i].vfo == vfo)
+        {
+            slot = &priv->slots[i];
+            break;
+        }
+
+        if (slot == NULL && priv->slots[i].vfo == RIG_VFO_NONE)
+        {
+            slot = &priv->slots[i];
+        }
+    }
+
+    if (slot == NULL)
+    {
+        pthread_mutex_unlock(&priv->mutex);
+        freq_coalesce_put(rig, priv);
+        return 0;
+    }
+
+    slot->vfo = vfo;
+    slot->freq = freq;
+    slot->pending = 1;
+    slot->submitted++;
+    pthread_cond_signal(&priv->cond);
+
+    pthread_mutex_unlock(&priv->mutex);
+    freq_coalesce_put(rig, priv);
+
+    // readers see the requested frequency until the write completes
+    rig_set_cache_freq(rig, vfo, freq);
+
+    return 1;
+}
+
+/* Flush the pending writes and stop the sender, called by rig_close() */
+void freq_coalesce_stop(RIG *rig)
+{
+    struct rig_state *rs = STATE(rig);
+    freq_coalesce_priv_data *priv;
+
+    // new callers write directly from now on
+    pthread_mutex_lock(&rs->state_mutex);
+    priv = (freq_coalesce_priv_data *) rs->freq_coalesce_priv_data;
+    rs->freq_coalesce_priv_data = NULL;
+    pthread_mutex_unlock(&rs->state_mutex);
+
+    if (priv == NULL)
+    {
+        return;
+    }
+
+    pthread_mutex_lock(&priv->mutex);
+    priv->run = 0;
+    pthread_cond_signal(&priv->cond);
+    pthread_mutex_unlock(&priv->mutex);
+
+    pthread_join(priv->thread_id, NULL);
+
+    // callers already holding priv, e.g. in rig_wait_set_freq()
+    pthread_mutex_lock(&rs->state_mutex);
+
+    while (priv->users > 0)
+    {
+        pthread_cond_wait(&priv->idle_cond, &rs->state_mutex);
+    }
+
+    pthread_mutex_unlock(&rs->state_mutex);
+
+    pthread_cond_destroy(&priv->idle_cond);
+    pthread_cond_destroy(&priv->written_cond);
+    pthread_cond_destroy(&priv->cond);
+    pthread_mutex_destroy(&priv->mutex);
+    free(priv);
+}
+
+/**
+ * \brief Enable or disable write-behind coalescing of frequency changes
+ * \param rig             The rig handle
+ * \param min_interval_ms Pause between two writes, 0 to write as fast as the
+ * link allows, or a negative value to disable coalescing
+ *
+ * In coalescing mode rig_set_freq() returns immediately. The frequency is
+ * written to the rig by a background thread, and a request still waiting
+ * when a newer one for the same VFO arrives is replaced by it. The cache,
+ * and thus rig_get_freq() within the cache timeout, returns the requested
+ * frequency while the write is pending. Use rig_wait_set_freq() to learn
+ * when and how the write completed.
+ *
+ * Disabling flushes the pending writes. rig_close() disables coalescing.
+ * Must not be called while another thread is in rig_set_freq().
+ *
+ * \return RIG_OK if the operation has been successful, otherwise
+ * a negative value if an error occurred.
+ *
+ * \sa rig_set_freq(), rig_wait_set_freq()
+ */
+int HAMLIB_API rig_set_freq_coalescing(RIG *rig, int min_interval_ms)
+{
+    struct rig_state *rs;
+    freq_coalesce_priv_data *priv;
+    int err;
+
+    if (!rig || !rig->caps)
+    {
+        return -RIG_EINVAL;
+    }
+
+    ENTERFUNC;
+
+    rs = STATE(rig);
+
+    if (min_interval_ms < 0)
+    {
+        freq_coalesce_stop(rig);
+        RETURNFUNC(RIG_OK);
+    }
+
+    priv = freq_coalesce_get(rig);
+
+    if (priv != NULL)
+    {
+        pthread_mutex_lock(&priv->mutex);
+        priv->min_interval_ms = min_interval_ms;
+        pthread_mutex_unlock(&priv->mutex);
+        freq_coalesce_put(rig, priv);
+        RETURNFUNC(RIG_OK);
+    }
+
+    if (!rs->comm_state)
+    {
+        RETURNFUNC(-RIG_EINVAL);
+    }
+
+    priv = calloc(1, sizeof(freq_coalesce_priv_data));
+
+    if (priv == NULL)
+    {
+        RETURNFUNC(-RIG_ENOMEM);
+    }
+
+    priv->rig = rig;
+    priv->run = 1;
+    priv->min_interval_ms = min_interval_ms;
+    pthread_mutex_init(&priv->mutex, NULL);
+    pthread_cond_init(&priv->cond, NULL);
+    pthread_cond_init(&priv->written_cond, NULL);
+    pthread_cond_init(&priv->idle_cond, NULL);
+
+    err = pthread_create(&priv->thread_id, NULL, freq_coalesce_sender, priv);
+
+    if (err)
+    {
+        rig_debug(RIG_DEBUG_ERR, "%s: pthread_create error: %s\n", __func__,
+                  strerror(err));
+        pthread_cond_destroy(&priv->idle_cond);
+        pthread_cond_destroy(&priv->written_cond);
+        pthread_cond_destroy(&priv->cond);
+        pthread_mutex_destroy(&priv->mutex);
+        free(priv);
+        RETURNFUNC(-RIG_EINTERNAL);
+    }
+
+    pthread_mutex_lock(&rs->state_mutex);
+    rs->freq_coalesce_priv_data = priv;
+    pthread_mutex_unlock(&rs->state_mutex);
+
+    RETURNFUNC(RIG_OK);
+}
+
+/**
+ * \brief Wait for the coalesced frequency changes of a VFO to be written
+ * \param rig        The rig handle
+ * \param vfo        The VFO as passed to rig_set_freq()
+ * \param timeout_ms How long to wait, 0 to only check
+ *
+ * \return the result of the last write to the VFO once all the requests
+ * made before the call are written, -RIG_ETIMEOUT if a write is still
+ * pending after timeout_ms. RIG_OK if coalescing is not enabled.
+ *
+ * \sa rig_set_freq_coalescing()
+ */
+int HAMLIB_API rig_wait_set_freq(RIG *rig, vfo_t vfo, int timeout_ms)
+{
+    freq_coalesce_priv_data *priv;
+    freq_coalesce_slot *slot = NULL;
+    struct timespec deadline;
+    unsigned int submitted;
+    int status = RIG_OK;
+    int i;
+
+    if (!rig || !rig->caps)
+    {
+        return -RIG_EINVAL;
+    }
+
+    priv = freq_coalesce_get(rig);
+
+    if (priv == NULL)
+    {
+        return RIG_OK;
+    }
+
+    vfo = freq_coalesce_vfo(rig, vfo);
+
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_sec += timeout_ms / 1000;
+    deadline.tv_nsec += (long)(timeout_ms % 1000) * 1000000L;
+
+    if (deadline.tv_nsec >= 1000000000L)
+    {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000L;
+    }
+
+    pthread_mutex_lock(&priv->mutex);
+
+    for (i = 0; i < FREQ_COALESCE_SLOTS; i++)
+    {
+        if (priv->slots[i].vfo == vfo)
+        {
+            slot = &priv->slots[i];
+            break;
+        }
+    }
+
+    if (slot != NULL)
+    {
+        submitted = slot->submitted;
+
+        // unsigned difference copes with the counters wrapping around
+        while ((int)(submitted - slot->written) > 0)
+        {
+            if (pthread_cond_timedwait(&priv->written_cond, &priv->mutex,
+                                       &deadline) == ETIMEDOUT)
+            {
+                break;
+            }
+        }
+
+        status = (int)(submitted - slot->written) > 0 ? -RIG_ETIMEOUT :
+                 slot->status;
+    }
+
+    pthread_mutex_unlock(&priv->mutex);
+    freq_coalesce_put(rig, priv);
+
+    return status;
+}
+
+/** @} */
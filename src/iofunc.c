@@ -1243,7 +1243,8 @@ static int read_block_generic(hamlib_port_t *p, unsigned char *rxbuffer,
          */
         rd_count = (int) port_read_generic(p, rxbuffer + total_count, count, direct);
 
-        if (rd_count < 0)
+        // readable but nothing read means the other end closed, e.g. a socket
+        if (rd_count <= 0)
         {
             rig_debug(RIG_DEBUG_ERR, "%s(): read failed, direct=%d - %s\n", __func__,
                       direct, strerror(errno));
@@ -1430,6 +1431,8 @@ static int read_string_generic(hamlib_port_t *p,
 #endif
 #endif
 shortcut:
+            // a stale EAGAIN would add the sleep below to every character
+            errno = 0;
             rd_count = port_read_generic(p, &rxbuffer[total_count],
                                          expected_len == 1 ? 1 : minlen, direct);
 //            rig_debug(RIG_DEBUG_VERBOSE, "%s: read %d bytes tot=%d\n", __func__, (int)rd_count, total_count);
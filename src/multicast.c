@@ -59,303 +59,115 @@ static struct sockaddr_in dest_addr = {0};
 #endif
 
 
-int multicast_stop(RIG *rig)
-{
-    struct rig_state *rs = STATE(rig);
+#define MULTICAST_JSON_SIZE 8192
+#define MULTICAST_HEARTBEAT_MS 500      // send the status at least this often
 
-    if (rs->multicast) { rs->multicast->runflag = 0; }
-
-    pthread_join(rs->multicast->threadid, NULL);
-    return RIG_OK;
-}
+// The cached status a packet is sent for
+struct multicast_status
+{
+    vfo_t vfo;
+    freq_t freqA;
+    freq_t freqB;
+    rmode_t modeA;
+    rmode_t modeB;
+    pbwidth_t widthA;
+    pbwidth_t widthB;
+    ptt_t ptt;
+    split_t split;
+};
 
-#if 0
-static int multicast_status_changed(RIG *rig)
+int multicast_stop(RIG *rig)
 {
-    int retval;
-    struct rig_cache *cachep = CACHE(rig);
     struct rig_state *rs = STATE(rig);
-#if 0
-    freq_t freq, freqsave = cachep->freqMainA;
-
-    if ((retval = rig_get_freq(rig, RIG_VFO_A, &freq)) != RIG_OK)
-    {
-        rig_debug(RIG_DEBUG_ERR, "%s: rig_get_freq:%s\n", __func__, rigerror(retval));
-    }
-
-    if (freq != freqsave) { return 1; }
 
-#endif
-
-    rmode_t modeA, modeAsave = cachep->modeMainA;
-    rmode_t modeB, modeBsave = cachep->modeMainB;
-    pbwidth_t widthA, widthAsave = cachep->widthMainA;
-    pbwidth_t widthB, widthBsave = cachep->widthMainB;
+    if (rs->multicast == NULL) { return RIG_OK; }
 
-#if  0
+    rs->multicast->runflag = 0;
 
-    if (rs->multicast->seqnumber % 2 == 0
-            && (retval = rig_get_mode(rig, RIG_VFO_A, &modeA, &widthA)) != RIG_OK)
-    {
-        rig_debug(RIG_DEBUG_ERR, "%s: rig_get_modeA:%s\n", __func__, rigerror(retval));
-    }
+    // wake up the broadcaster waiting for a cache change
+    rig_cache_notify(rig);
 
-#endif
-
-    if (modeA != modeAsave) { return 1; }
-
-    if (widthA != widthAsave) { return 1; }
-
-#if 0
-
-    if (rs->multicast->seqnumber % 2 == 0
-            && (rig->caps->targetable_vfo & RIG_TARGETABLE_MODE)
-            && (retval = rig_get_mode(rig, RIG_VFO_B, &modeB, &widthB)) != RIG_OK)
-    {
-        rig_debug(RIG_DEBUG_ERR, "%s: rig_get_modeB:%s\n", __func__, rigerror(retval));
-    }
-
-#endif
-
-    if (modeB != modeBsave) { return 1; }
-
-    if (widthB != widthBsave) { return 1; }
-
-    ptt_t ptt, pttsave = cachep->ptt;
-
-#if 0
-
-    if (rs->multicast->seqnumber % 2 == 0
-            && (retval = rig_get_ptt(rig, RIG_VFO_CURR, &ptt)) != RIG_OK)
-        if (ptt != pttsave) { return 1; }
-
-    split_t split, splitsave = cachep->split;
-    vfo_t txvfo;
-
-    if (rs->multicast->seqnumber % 2 == 0
-            && (retval = rig_get_split_vfo(rig, RIG_VFO_CURR, &split, &txvfo)) != RIG_OK)
-        if (split != splitsave) { return 1; }
-
-#endif
-
-    return 0;
-}
-#endif
-
-void json_add_string(char *msg, const char *key, const char *value,
-                     int addComma)
-{
-    strcat(msg, "\"");
-    strcat(msg, key);
-    strcat(msg, "\": ");
-    strcat(msg, "\"");
-    strcat(msg, value);
-    strcat(msg, "\"");
-
-    if (addComma) { strcat(msg, ",\n"); }
-}
-
-void json_add_int(char *msg, const char *key, const int number, int addComma)
-{
-
-    strcat(msg, "\"");
-    strcat(msg, key);
-    strcat(msg, "\": ");
-    char tmp[64];
-    sprintf(tmp, "%d", number);
-    strcat(msg, tmp);
-
-    if (addComma)
-    {
-        strcat(msg, ",\n");
-    }
+    pthread_join(rs->multicast->threadid, NULL);
+    return RIG_OK;
 }
 
-// cppcheck-suppress unusedFunction
-void json_add_double(char *msg, const char *key, const double value)
+static void multicast_status_get(RIG *rig, struct multicast_status *status)
 {
-    if (strlen(msg) != 0)
-    {
-        strcat(msg, ",\n");
-    }
+    struct rig_cache *cachep = CACHE(rig);
 
-    strcat(msg, "\"");
-    strcat(msg, key);
-    strcat(msg, "\": ");
-    char tmp[64];
-    sprintf(tmp, "%f", value);
-    strcat(msg, tmp);
+    status->vfo = STATE(rig)->current_vfo;
+    status->freqA = cachep->freqMainA;
+    status->freqB = cachep->freqMainB;
+    status->modeA = cachep->modeMainA;
+    status->modeB = cachep->modeMainB;
+    status->widthA = cachep->widthMainA;
+    status->widthB = cachep->widthMainB;
+    status->ptt = cachep->ptt;
+    status->split = cachep->split;
 }
 
-// cppcheck-suppress unusedFunction
-void json_add_boolean(char *msg, const char *key, const int value, int addComma)
+static int json_add_vfo(char *msg, int size, const char *name, freq_t freq,
+                        rmode_t mode, pbwidth_t width)
 {
-
-    strcat(msg, "\"");
-    strcat(msg, key);
-    strcat(msg, "\": ");
-    char tmp[64];
-    sprintf(tmp, "%s", value == 0 ? "false" : "true");
-    strcat(msg, tmp);
-
-    if (addComma)
-    {
-        strcat(msg, ",\n");
-    }
+    const char *smode = rig_strrmode(mode);
+
+    return snprintf(msg, size,
+                    "{\n"
+                    "\"Name\": \"%s\",\n"
+                    "\"Freq\": %.0f,\n"
+                    "\"Mode\": \"%s\",\n"
+                    "\"Width\": %d\n"
+                    "}",
+                    name, freq, smode[0] ? smode : "None", (int) width);
 }
 
-void json_add_time(char *msg, int addComma)
+/*
+ * Build the status packet in msg, returns its length
+ * id and mode_list do not change while the rig is open and are formatted
+ * once by the caller
+ */
+static int multicast_build_json(RIG *rig, const struct multicast_status *status,
+                                const char *id, const char *mode_list,
+                                char *msg, int size)
 {
     char mydate[256];
-    date_strget(mydate, sizeof(mydate), 0);
-
-
-    strcat(msg, "\"Time\": \"");
-    strcat(msg, mydate);
-    strcat(msg, "\"");
-
-    if (addComma)
-    {
-        strcat(msg, ",\n");
-    }
-}
-
-void json_add_vfoA(RIG *rig, char *msg)
-{
-    struct rig_cache *cachep = CACHE(rig);
-    struct rig_state *rs = STATE(rig);
-
-    strcat(msg, "{\n");
-    json_add_string(msg, "Name", "VFOA", 1);
-    json_add_int(msg, "Freq", cachep->freqMainA, 1);
-
-    if (strlen(rig_strrmode(cachep->modeMainA)) > 0)
-    {
-        json_add_string(msg, "Mode", rig_strrmode(cachep->modeMainA), 1);
-    }
-    else
-    {
-        json_add_string(msg, "Mode", "None", 1);
-    }
+    int len;
 
-    json_add_int(msg, "Width", cachep->widthMainA, 0);
+    date_strget(mydate, sizeof(mydate), 0);
 
-#if 0 // not working quite yet
-    // what about full duplex? rx_vfo would be in rx all the time?
-    rig_debug(RIG_DEBUG_ERR, "%s: rx_vfo=%s, tx_vfo=%s, split=%d\n", __func__,
-              rig_strvfo(rs->rx_vfo), rig_strvfo(rs->tx_vfo),
-              cachep->split);
-    printf("%s: rx_vfo=%s, tx_vfo=%s, split=%d\n", __func__,
-           rig_strvfo(rs->rx_vfo), rig_strvfo(rs->tx_vfo),
-           cachep->split);
+    len = snprintf(msg, size,
+                   "{\n"
+                   "\"ID\": \"%s\",\n"
+                   "\"Time\": \"%s\",\n"
+                   "\"Sequence\": %d,\n"
+                   "\"VFOCurr\": \"%s\",\n"
+                   "\"PTT\": %d,\n"
+                   "\"Split\": %d,\n"
+                   "\"ModeList\": \"%s\",\n"
+                   "\"VFOs\": [\n",
+                   id, mydate, STATE(rig)->multicast->seqnumber++,
+                   rig_strvfo(status->vfo), (int) status->ptt, (int) status->split,
+                   mode_list);
 
-    if (cachep->split)
-    {
-        if (rs->tx_vfo && (RIG_VFO_B | RIG_VFO_MAIN_B))
-        {
-            json_add_boolean(msg, "RX", !cachep->ptt, 1);
-            json_add_boolean(msg, "TX", 0, 0);
-        }
-        else // we must be in reverse split
-        {
-            json_add_boolean(msg, "RX", 0, 1);
-            json_add_boolean(msg, "TX", cachep->ptt, 0);
-        }
-    }
-    else if (rs->current_vfo && (RIG_VFO_A | RIG_VFO_MAIN_A))
-    {
-        json_add_boolean(msg, "RX", !cachep->ptt, 1);
-        json_add_boolean(msg, "TX", cachep->ptt, 0);
-    }
-    else // VFOB must be active so never RX or TX
-    {
-        json_add_boolean(msg, "RX", 0, 1);
-        json_add_boolean(msg, "TX", 0, 0);
-    }
+    if (len >= size) { return size - 1; }
 
-#endif
-    strcat(msg, "\n}");
-}
+    len += json_add_vfo(msg + len, size - len, "VFOA", status->freqA,
+                        status->modeA, status->widthA);
 
-void json_add_vfoB(RIG *rig, char *msg)
-{
-    struct rig_cache *cachep = CACHE(rig);
-    struct rig_state *rs = STATE(rig);
+    if (len >= size) { return size - 1; }
 
-    strcat(msg, ",\n{\n");
-    json_add_string(msg, "Name", "VFOB", 1);
-    json_add_int(msg, "Freq", cachep->freqMainB, 1);
+    len += snprintf(msg + len, size - len, ",\n");
 
-    if (strlen(rig_strrmode(cachep->modeMainB)) > 0)
-    {
-        json_add_string(msg, "Mode", rig_strrmode(cachep->modeMainB), 1);
-    }
-    else
-    {
-        json_add_string(msg, "Mode", "None", 1);
-    }
-
-    json_add_int(msg, "Width", cachep->widthMainB, 0);
+    if (len >= size) { return size - 1; }
 
-#if 0 // not working yet
+    len += json_add_vfo(msg + len, size - len, "VFOB", status->freqB,
+                        status->modeB, status->widthB);
 
-    if (rs->rx_vfo != rs->tx_vfo && cachep->split)
-    {
-        if (rs->tx_vfo && (RIG_VFO_B | RIG_VFO_MAIN_B))
-        {
-            json_add_boolean(msg, "RX", 0, 1);
-            json_add_boolean(msg, "TX", cachep->ptt, 0);
-        }
-        else // we must be in reverse split
-        {
-            json_add_boolean(msg, "RX", cachep->ptt, 1);
-            json_add_boolean(msg, "TX", 0, 0);
-        }
-    }
-    else if (rs->current_vfo && (RIG_VFO_A | RIG_VFO_MAIN_A))
-    {
-        json_add_boolean(msg, "RX", !cachep->ptt, 1);
-        json_add_boolean(msg, "TX", cachep->ptt, 0);
-    }
-    else // VFOB must be active so always RX or TX
-    {
-        json_add_boolean(msg, "RX", 1, 1);
-        json_add_boolean(msg, "TX", 1, 0);
-    }
+    if (len >= size) { return size - 1; }
 
-#endif
+    len += snprintf(msg + len, size - len, "\n]\n}\n");
 
-    strcat(msg, "\n}\n]\n");
-}
-
-static int multicast_send_json(RIG *rig)
-{
-    char msg[8192]; // could be pretty big
-    char buf[4096];
-    struct rig_cache *cachep = CACHE(rig);
-    struct rig_state *rs = STATE(rig);
-
-//    sprintf(msg,"%s:f=%.1f", date_strget(msg, (int)sizeof(msg), 0), f);
-    msg[0] = 0;
-    snprintf(buf, sizeof(buf), "%s:%s", rig->caps->model_name,
-             RIGPORT(rig)->pathname);
-    strcat(msg, "{\n");
-    json_add_string(msg, "ID", buf, 1);
-    json_add_time(msg, 1);
-    json_add_int(msg, "Sequence", rs->multicast->seqnumber++, 1);
-    json_add_string(msg, "VFOCurr", rig_strvfo(rs->current_vfo), 1);
-    json_add_int(msg, "PTT", cachep->ptt, 1);
-    json_add_int(msg, "Split", cachep->split, 1);
-    rig_sprintf_mode(buf, sizeof(buf), rs->mode_list);
-    json_add_string(msg, "ModeList", buf, 1);
-    strcat(msg, "\"VFOs\": [\n");
-    json_add_vfoA(rig, msg);
-    json_add_vfoB(rig, msg);
-    strcat(msg, "}\n");
-
-    // send the thing
-    multicast_send(rig, msg, strlen(msg));
-    return 0;
+    return len < size ? len : size - 1;
 }
 
 // cppcheck-suppress unusedFunction
@@ -393,97 +205,84 @@ void *multicast_thread_rx(void *vrig)
     return NULL;
 }
 
-#define LOOPCOUNT 50
+/*
+ * Broadcast the rig status whenever the cache changes
+ *
+ * The thread sleeps until rig_cache_notify() reports an update, then sends
+ * one packet for all changes seen within the multicast_min_interval conf
+ * value. A heartbeat packet goes out when nothing changed for
+ * MULTICAST_HEARTBEAT_MS.
+ */
 // cppcheck-suppress unusedFunction
 void *multicast_thread(void *vrig)
 {
-    //int retval;
     RIG *rig = (RIG *)vrig;
-    //rig_debug(RIG_DEBUG_TRACE, "%s: started\n", __func__);
+    struct rig_state *rs = STATE(rig);
+    struct multicast_status status, sent;
+    struct timespec last_sent = {0};
+    unsigned int generation = 0;
+    char id[512];
+    char mode_list[1024];
+    char *msg;
 
-    // do the 1st packet all the time
-    //multicast_status_changed(rig);
-    //multicast_send_json(rig);
-    int loopcount = LOOPCOUNT;
+    msg = malloc(MULTICAST_JSON_SIZE);
 
-    freq_t freqA, freqAsave = 0;
-    freq_t freqB, freqBsave = 0;
-    mode_t modeA, modeAsave = 0;
-    mode_t modeB, modeBsave = 0;
-    ptt_t ptt, pttsave = 0;
-    struct rig_cache *cachep = CACHE(rig);
-    struct rig_state *rs = STATE(rig);
+    if (msg == NULL)
+    {
+        rig_debug(RIG_DEBUG_ERR, "%s: malloc failed\n", __func__);
+        return NULL;
+    }
+
+    snprintf(id, sizeof(id), "%s:%s", rig->caps->model_name,
+             RIGPORT(rig)->pathname);
+    rig_sprintf_mode(mode_list, sizeof(mode_list), rs->mode_list);
+
+    memset(&sent, 0, sizeof(sent));
+    memset(&status, 0, sizeof(status));
 
     rs->multicast->runflag = 1;
 
     while (rs->multicast->runflag)
     {
-        while (STATE(rig)->powerstat == RIG_POWER_OFF)
+        int since;
+
+        if (rs->powerstat == RIG_POWER_OFF)
         {
             rig_debug(RIG_DEBUG_VERBOSE, "%s: waiting for RIG_POWER_ON\n", __func__);
             hl_usleep(500 * 1000);
+            continue;
         }
 
-#if 0
-
-        if ((retval = rig_get_freq(rig, RIG_VFO_A, &freqA)) != RIG_OK)
-        {
-            rig_debug(RIG_DEBUG_ERR, "%s: rig_get_freqA:%s\n", __func__, rigerror(retval));
-        }
-
-        if ((rig->caps->targetable_vfo & RIG_TARGETABLE_FREQ)
-                && (retval = rig_get_freq(rig, RIG_VFO_B, &freqB)) != RIG_OK)
-        {
-            rig_debug(RIG_DEBUG_ERR, "%s: rig_get_freqB:%s\n", __func__, rigerror(retval));
-        }
-        else
-        {
-            freqB = cachep->freqMainB;
-        }
-
-#else
-        freqA = cachep->freqMainA;
-        freqB = cachep->freqMainB;
-        modeA = cachep->modeMainA;
-        modeB = cachep->modeMainB;
-        ptt = cachep->ptt;
-#endif
+        since = (int) elapsed_ms(&last_sent, HAMLIB_ELAPSED_GET);
+        multicast_status_get(rig, &status);
 
-        if (freqA != freqAsave
-                || freqB != freqBsave
-                || modeA != modeAsave
-                || modeB != modeBsave
-                || ptt != pttsave
-                || loopcount-- <= 0)
+        if (memcmp(&status, &sent, sizeof(status)) != 0
+                || since >= MULTICAST_HEARTBEAT_MS)
         {
-#if 0
+            int len;
 
-            if (loopcount <= 0)
+            if (since < rs->multicast_min_interval_ms)
             {
-                rig_debug(RIG_DEBUG_CACHE, "%s: sending multicast packet timeout\n", __func__);
+                // let more changes accumulate into the same packet
+                hl_usleep((rs->multicast_min_interval_ms - since) * 1000);
+                continue;
             }
-            else { rig_debug(RIG_DEBUG_ERR, "%s: sending multicast packet due to change\n", __func__); }
 
-#endif
+            len = multicast_build_json(rig, &status, id, mode_list, msg,
+                                       MULTICAST_JSON_SIZE);
+            multicast_send(rig, msg, len);
 
-//            multicast_status_changed(rig);
-            multicast_send_json(rig);
-            freqAsave = freqA;
-            freqBsave = freqB;
-            modeAsave = modeA;
-            modeBsave = modeB;
-            pttsave = ptt;
-            loopcount = LOOPCOUNT;
-        }
-        else
-        {
-            //rig_debug(RIG_DEBUG_VERBOSE, "%s: loop\n", __func__);
-            hl_usleep(10 * 1000);
+            sent = status;
+            elapsed_ms(&last_sent, HAMLIB_ELAPSED_SET);
+            since = 0;
         }
 
-
+        rig_cache_wait_change(rig, &generation,
+                              MULTICAST_HEARTBEAT_MS - since);
     }
 
+    free(msg);
+
 #ifdef _WIN32
     WSACleanup();
 #endif
@@ -586,11 +385,6 @@ int multicast_init(RIG *rig, char *addr, int port)
 
 #endif
 
-    // Construct the multicast group address
-    // struct ip_mreq mreq = {0};
-    rs->multicast->mreq.imr_multiaddr.s_addr = inet_addr(addr);
-    rs->multicast->mreq.imr_interface.s_addr = htonl(INADDR_ANY);
-
     // Set the multicast TTL (time-to-live) to limit the scope of the packets
     char ttl = 1;
 
@@ -605,8 +399,12 @@ int multicast_init(RIG *rig, char *addr, int port)
 
 // look like we need to implement the client in a separate thread?
     // Join the multicast group
+    struct ip_mreq mreq = {0};
+    mreq.imr_multiaddr.s_addr = inet_addr(addr);
+    mreq.imr_interface.s_addr = htonl(INADDR_ANY);
+
     if (setsockopt(rs->multicast->sock, IPPROTO_IP, IP_ADD_MEMBERSHIP,
-                   (char *)&rs->multicast->mreq, sizeof(rs->multicast->mreq)) < 0)
+                   (char *)&mreq, sizeof(mreq)) < 0)
     {
         rig_debug(RIG_DEBUG_ERR, "%s: setsockopt: %s\n", __func__, strerror(errno));
         //return -RIG_EIO;
@@ -638,14 +436,7 @@ void multicast_close(RIG *rig)
 {
     struct rig_state *rs = STATE(rig);
 
-    // Leave the multicast group
-    if (setsockopt(rs->multicast->sock, IPPROTO_IP,
-                   IP_DROP_MEMBERSHIP, (char *)&rs->multicast->mreq,
-                   sizeof(rs->multicast->mreq)) < 0)
-    {
-        rig_debug(RIG_DEBUG_ERR, "%s: setsockopt: %s\n", __func__, strerror(errno));
-        return;
-    }
+    // The sender never joins the group, nothing to leave
 
     // Close the socket
     if (close(rs->multicast->sock))
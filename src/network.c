@@ -80,6 +80,7 @@
 #include "misc.h"
 #include "asyncpipe.h"
 #include "snapshot_data.h"
+#include "network_cmd.h"
 
 #ifdef HAVE_WINDOWS_H
 // cppcheck-suppress missingInclude
@@ -132,6 +133,7 @@ typedef struct multicast_publisher_priv_data_s
 {
     pthread_t thread_id;
     multicast_publisher_args args;
+    int spectrum_subscription;
 } multicast_publisher_priv_data;
 
 typedef struct multicast_receiver_args_s
@@ -876,7 +878,8 @@ int network_publish_rig_transceive_data(RIG *rig)
     return result;
 }
 
-int network_publish_rig_spectrum_data(RIG *rig, struct rig_spectrum_line *line)
+int network_publish_rig_spectrum_data(RIG *rig, struct rig_spectrum_line *line,
+                                      const struct rig_spectrum_signals *signals)
 {
     int result;
     struct rig_state *rs = STATE(rig);
@@ -886,7 +889,8 @@ int network_publish_rig_spectrum_data(RIG *rig, struct rig_spectrum_line *line)
     {
         .type = MULTICAST_PUBLISHER_DATA_PACKET_TYPE_SPECTRUM,
         .padding = 0,
-        .data_length = sizeof(struct rig_spectrum_line) + line->spectrum_data_length,
+        .data_length = sizeof(struct rig_spectrum_line) + line->spectrum_data_length
+        + (signals ? sizeof(struct rig_spectrum_signals) : 0),
     };
 
     if (rs->multicast_publisher_priv_data == NULL)
@@ -922,6 +926,14 @@ int network_publish_rig_spectrum_data(RIG *rig, struct rig_spectrum_line *line)
     result = multicast_publisher_write_data(
                  mcast_publisher_args, line->spectrum_data_length, line->spectrum_data);
 
+    // the detector results of this line follow its data, if there are any
+    if (result == RIG_OK && signals)
+    {
+        result = multicast_publisher_write_data(
+                     mcast_publisher_args, sizeof(struct rig_spectrum_signals),
+                     (unsigned char *) signals);
+    }
+
     multicast_publisher_write_unlock(rig);
 
     if (result != RIG_OK)
@@ -932,12 +944,30 @@ int network_publish_rig_spectrum_data(RIG *rig, struct rig_spectrum_line *line)
     RETURNFUNC2(RIG_OK);
 }
 
+/* Spectrum subscription callback, runs on its own thread so that a full
+ * data pipe never stalls the async data handler */
+static int multicast_publisher_spectrum_cb(RIG *rig,
+        const struct rig_spectrum_proc_output *output, rig_ptr_t arg)
+{
+    struct rig_spectrum_line line = output->line;
+
+    if (output->dropped > 0)
+    {
+        rig_debug(RIG_DEBUG_TRACE, "%s: %u spectrum lines skipped\n", __func__,
+                  output->dropped);
+    }
+
+    return network_publish_rig_spectrum_data(rig, &line, output->signals);
+}
+
 static int multicast_publisher_read_packet(multicast_publisher_args
         const *mcast_publisher_args,
         uint8_t *type, struct rig_spectrum_line *spectrum_line,
-        unsigned char *spectrum_data)
+        unsigned char *spectrum_data, struct rig_spectrum_signals *signals,
+        int *have_signals)
 {
     int result;
+    size_t signals_length;
     multicast_publisher_data_packet packet;
 
     result = multicast_publisher_read_data(mcast_publisher_args, sizeof(packet),
@@ -964,8 +994,13 @@ static int multicast_publisher_read_packet(multicast_publisher_args
             return (result);
         }
 
-        if (packet.data_length - sizeof(struct rig_spectrum_line) !=
-                spectrum_line->spectrum_data_length)
+        signals_length = packet.data_length - sizeof(struct rig_spectrum_line)
+                         - spectrum_line->spectrum_data_length;
+
+        if (packet.data_length < sizeof(struct rig_spectrum_line)
+                + spectrum_line->spectrum_data_length
+                || (signals_length != 0
+                    && signals_length != sizeof(struct rig_spectrum_signals)))
         {
             rig_debug(RIG_DEBUG_ERR,
                       "%s: multicast publisher data error, expected %d bytes of spectrum data, got %d bytes\n",
@@ -984,6 +1019,19 @@ static int multicast_publisher_read_packet(multicast_publisher_args
             return (result);
         }
 
+        *have_signals = signals_length != 0;
+
+        if (*have_signals)
+        {
+            result = multicast_publisher_read_data(mcast_publisher_args,
+                                                   sizeof(struct rig_spectrum_signals), (unsigned char *) signals);
+
+            if (result < 0)
+            {
+                return (result);
+            }
+        }
+
         break;
 
     default:
@@ -1011,6 +1059,8 @@ static void *multicast_publisher(void *arg)
     RIG *rig = args->rig;
     struct rig_state *rs = STATE(rig);
     struct rig_spectrum_line spectrum_line;
+    struct rig_spectrum_signals signals;
+    int have_signals = 0;
     uint8_t packet_type = MULTICAST_PUBLISHER_DATA_PACKET_TYPE_SPECTRUM;
     multicast_publisher_priv_data *mcast_publisher_priv =
         (multicast_publisher_priv_data *)
@@ -1048,7 +1098,7 @@ static void *multicast_publisher(void *arg)
         int result;
 
         result = multicast_publisher_read_packet(args, &packet_type, &spectrum_line,
-                 spectrum_data);
+                 spectrum_data, &signals, &have_signals);
 
         if (result != RIG_OK)
         {
@@ -1063,9 +1113,16 @@ static void *multicast_publisher(void *arg)
             continue;
         }
 
-        result = snapshot_serialize(sizeof(snapshot_buffer), snapshot_buffer, rig,
-                                    packet_type == MULTICAST_PUBLISHER_DATA_PACKET_TYPE_SPECTRUM ? &spectrum_line :
-                                    NULL);
+        if (packet_type == MULTICAST_PUBLISHER_DATA_PACKET_TYPE_SPECTRUM)
+        {
+            result = snapshot_serialize(sizeof(snapshot_buffer), snapshot_buffer, rig,
+                                        &spectrum_line, have_signals ? &signals : NULL);
+        }
+        else
+        {
+            result = snapshot_serialize(sizeof(snapshot_buffer), snapshot_buffer, rig,
+                                        NULL, NULL);
+        }
 
         if (result != RIG_OK)
         {
@@ -1343,9 +1400,85 @@ int is_wireless()
 #endif
 #endif
 
+#if defined(__linux__) && defined(MSG_WAITFORONE)
+#define MULTICAST_RECEIVER_RECVMMSG 1
+#endif
+
+#define MULTICAST_RECEIVER_DATAGRAM_SIZE 4096
+
+typedef struct multicast_receiver_batch_s
+{
+    char data[NETWORK_CMD_BATCH_MAX][MULTICAST_RECEIVER_DATAGRAM_SIZE];
+    int length[NETWORK_CMD_BATCH_MAX];
+    network_cmd cmds[NETWORK_CMD_BATCH_MAX];
+#ifdef MULTICAST_RECEIVER_RECVMMSG
+    struct mmsghdr msgs[NETWORK_CMD_BATCH_MAX];
+    struct iovec iovecs[NETWORK_CMD_BATCH_MAX];
+#endif
+} multicast_receiver_batch;
+
+/*
+ * Drain up to NETWORK_CMD_BATCH_MAX datagrams from the non-blocking socket
+ * Returns the number of datagrams read, or -1 on error
+ */
+static int multicast_receiver_read_batch(int socket_fd,
+        multicast_receiver_batch *batch)
+{
+    int count = 0;
+
+#ifdef MULTICAST_RECEIVER_RECVMMSG
+    int i;
+
+    for (i = 0; i < NETWORK_CMD_BATCH_MAX; i++)
+    {
+        batch->iovecs[i].iov_base = batch->data[i];
+        batch->iovecs[i].iov_len = MULTICAST_RECEIVER_DATAGRAM_SIZE;
+        memset(&batch->msgs[i], 0, sizeof(batch->msgs[i]));
+        batch->msgs[i].msg_hdr.msg_iov = &batch->iovecs[i];
+        batch->msgs[i].msg_hdr.msg_iovlen = 1;
+    }
+
+    count = recvmmsg(socket_fd, batch->msgs, NETWORK_CMD_BATCH_MAX, MSG_DONTWAIT,
+                     NULL);
+
+    if (count < 0)
+    {
+        return (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) ? 0 : -1;
+    }
+
+    for (i = 0; i < count; i++)
+    {
+        batch->length[i] = (int) batch->msgs[i].msg_len;
+    }
+
+#else
+
+    while (count < NETWORK_CMD_BATCH_MAX)
+    {
+        ssize_t result = recvfrom(socket_fd, batch->data[count],
+                                  MULTICAST_RECEIVER_DATAGRAM_SIZE, 0, NULL, NULL);
+
+        if (result < 0)
+        {
+            if (errno == 0 || errno == EAGAIN || errno == EWOULDBLOCK)
+            {
+                break;
+            }
+
+            return count > 0 ? count : -1;
+        }
+
+        batch->length[count++] = (int) result;
+    }
+
+#endif
+
+    return count;
+}
+
 static void *multicast_receiver(void *arg)
 {
-    char data[4096];
+    multicast_receiver_batch *batch;
     char ip4[INET6_ADDRSTRLEN] = "";
 
     struct multicast_receiver_args_s *args = (struct multicast_receiver_args_s *)
@@ -1474,16 +1607,24 @@ static void *multicast_receiver(void *arg)
         rig_debug(RIG_DEBUG_VERBOSE, "%s: errno==0 so trying to continue\n", __func__);
     }
 
+    batch = calloc(1, sizeof(multicast_receiver_batch));
+
+    if (batch == NULL)
+    {
+        rig_debug(RIG_DEBUG_ERR, "%s: calloc failed\n", __func__);
+        return NULL;
+    }
+
     rs->multicast_receiver_run = 1;
 
     while (rs->multicast_receiver_run)
     {
-        struct sockaddr_in client_addr;
-        socklen_t client_len = sizeof(client_addr);
         fd_set rfds, efds;
         struct timeval timeout;
         int select_result;
         ssize_t result;
+        int count, commands, superseded;
+        int i;
 
         timeout.tv_sec = 0;
         timeout.tv_usec = MULTICAST_DATA_PIPE_TIMEOUT_USEC;
@@ -1525,34 +1666,50 @@ static void *multicast_receiver(void *arg)
             break;
         }
 
-        result = recvfrom(socket_fd, data, sizeof(data), 0,
-                          (struct sockaddr *) &client_addr, &client_len);
+        count = multicast_receiver_read_batch(socket_fd, batch);
 
-        if (result <= 0)
+        if (count < 0)
         {
-            if (result < 0)
-            {
-                if (errno == 0 || errno == EAGAIN || errno == EWOULDBLOCK)
-                {
-                    continue;
-                }
+            rig_debug(RIG_DEBUG_ERR, "%s: error receiving from UDP socket %s:%d: %s\n",
+                      __func__,
+                      args->multicast_addr, args->multicast_port, strerror(errno));
+            break;
+        }
+
+        commands = 0;
+
+        for (i = 0; i < count; i++)
+        {
+            rig_debug(RIG_DEBUG_TRACE, "%s: received %d bytes of data: %.*s\n", __func__,
+                      batch->length[i], batch->length[i], batch->data[i]);
 
-                rig_debug(RIG_DEBUG_ERR, "%s: error receiving from UDP socket %s:%d: %s\n",
-                          __func__,
-                          args->multicast_addr, args->multicast_port, strerror(errno));
+            // snapshots from publishers on the same group are not commands
+            if (network_cmd_parse(batch->data[i], batch->length[i],
+                                  &batch->cmds[commands]) == RIG_OK)
+            {
+                commands++;
             }
+        }
 
-            break;
+        if (commands == 0)
+        {
+            continue;
         }
 
-        // TODO: handle commands from multicast clients
-        rig_debug(RIG_DEBUG_VERBOSE, "%s: received %ld bytes of data: %.*s\n", __func__,
-                  (long) result, (int) result, data);
+        superseded = network_cmd_collapse(batch->cmds, commands);
+
+        rig_debug(RIG_DEBUG_VERBOSE,
+                  "%s: executing %d of %d commands from %d datagrams\n", __func__,
+                  commands - superseded, commands, count);
+
+        network_cmd_execute(rig, batch->cmds, commands);
 
-        // TODO: if a new snapshot needs to be sent, call network_publish_rig_poll_data() and the publisher routine will send out a snapshot
-        // TODO: new logic in publisher needs to be written for other types of responses
+        // one snapshot acknowledges the whole batch
+        network_publish_rig_poll_data(rig);
     }
 
+    free(batch);
+
     rs->multicast_receiver_run = 0;
     mcast_receiver_priv->thread_id = 0;
 
@@ -1689,6 +1846,7 @@ int network_multicast_publisher_start(RIG *rig, const char *multicast_addr,
     mcast_publisher_priv->args.multicast_addr = multicast_addr;
     mcast_publisher_priv->args.multicast_port = multicast_port;
     mcast_publisher_priv->args.rig = rig;
+    mcast_publisher_priv->spectrum_subscription = -1;
 
     mutex_status = pthread_mutex_init(&mcast_publisher_priv->args.write_lock, NULL);
 
@@ -1720,6 +1878,22 @@ int network_multicast_publisher_start(RIG *rig, const char *multicast_addr,
         RETURNFUNC(-RIG_EINTERNAL);
     }
 
+    if (items & RIG_MULTICAST_SPECTRUM)
+    {
+        // Lines arriving while the previous one is still being sent replace it
+        status = rig_spectrum_subscribe(rig, NULL, multicast_publisher_spectrum_cb,
+                                        NULL);
+
+        if (status < 0)
+        {
+            rig_debug(RIG_DEBUG_ERR,
+                      "%s: multicast publisher spectrum subscription failed, result=%d\n",
+                      __func__, status);
+        }
+
+        mcast_publisher_priv->spectrum_subscription = status;
+    }
+
     RETURNFUNC(RIG_OK);
 }
 
@@ -1747,6 +1921,12 @@ int network_multicast_publisher_stop(RIG *rig)
         RETURNFUNC(RIG_OK);
     }
 
+    if (mcast_publisher_priv->spectrum_subscription >= 0)
+    {
+        rig_spectrum_proc_remove(rig, mcast_publisher_priv->spectrum_subscription);
+        mcast_publisher_priv->spectrum_subscription = -1;
+    }
+
     if (mcast_publisher_priv->thread_id != 0)
     {
         int err = pthread_join(mcast_publisher_priv->thread_id, NULL);
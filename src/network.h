@@ -34,7 +34,8 @@ void network_flush(hamlib_port_t *rp);
 int network_flush2(hamlib_port_t *rp, unsigned char *stopset, char *buf, int buf_len);
 int network_publish_rig_poll_data(RIG *rig);
 int network_publish_rig_transceive_data(RIG *rig);
-int network_publish_rig_spectrum_data(RIG *rig, struct rig_spectrum_line *line);
+int network_publish_rig_spectrum_data(RIG *rig, struct rig_spectrum_line *line,
+                                      const struct rig_spectrum_signals *signals);
 int network_publish_rig_status_change(RIG *rig, int32_t status);
 HAMLIB_EXPORT(int) network_multicast_publisher_start(RIG *rig, const char *multicast_addr, int multicast_port, enum multicast_item_e items);
 HAMLIB_EXPORT(int) network_multicast_publisher_stop(RIG *rig);
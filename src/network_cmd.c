@@ -0,0 +1,362 @@
+/*
+ *  Hamlib Interface - multicast command execution
+ *  Copyright (c) 2000-2025 The Hamlib Group
+ *
+ *
+ *   This library is free software; you can redistribute it and/or
+ *   modify it under the terms of the GNU Lesser General Public
+ *   License as published by the Free Software Foundation; either
+ *   version 2.1 of the License, or (at your option) any later version.
+ *
+ *   This library is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *   Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public
+ *   License along with this library; if not, write to the Free Software
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+/* SPDX-License-Identifier: LGPL-2.1-or-later */
+
+/**
+ * \file network_cmd.c
+ * \brief Multicast command execution
+ *
+ * The multicast receiver hands over all datagrams received in one wakeup
+ * as a batch. Commands made redundant by a later command of the same batch
+ * are dropped, the others are executed in order, and the results are kept
+ * until the next snapshot publishes them as acknowledgement.
+ */
+
+#include "hamlib/config.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <pthread.h>
+
+#include "hamlib/rig.h"
+#include "hamlib/rig_state.h"
+#include "network_cmd.h"
+#include "misc.h"
+
+#include "cJSON.h"
+
+typedef struct network_cmd_priv_data_s
+{
+    pthread_mutex_t mutex;
+    int ack_count;
+    network_cmd acks[NETWORK_CMD_BATCH_MAX];
+} network_cmd_priv_data;
+
+static network_cmd_priv_data *network_cmd_priv(RIG *rig, int create)
+{
+    struct rig_state *rs = STATE(rig);
+    static pthread_mutex_t create_mutex = PTHREAD_MUTEX_INITIALIZER;
+    network_cmd_priv_data *priv;
+
+    pthread_mutex_lock(&create_mutex);
+
+    priv = (network_cmd_priv_data *) rs->network_cmd_priv_data;
+
+    if (priv == NULL && create)
+    {
+        priv = calloc(1, sizeof(network_cmd_priv_data));
+
+        if (priv)
+        {
+            pthread_mutex_init(&priv->mutex, NULL);
+            rs->network_cmd_priv_data = priv;
+        }
+    }
+
+    pthread_mutex_unlock(&create_mutex);
+
+    return priv;
+}
+
+static int network_cmd_parse_text(network_cmd *cmd)
+{
+    char text[NETWORK_CMD_LEN];
+    char *argv[5];
+    char *saveptr = NULL;
+    char *token;
+    int argc = 0;
+
+    strncpy(text, cmd->command, sizeof(text) - 1);
+    text[sizeof(text) - 1] = '\0';
+
+    for (token = strtok_r(text, " \t", &saveptr); token && argc < 5;
+            token = strtok_r(NULL, " \t", &saveptr))
+    {
+        argv[argc++] = token;
+    }
+
+    if (argc < 2)
+    {
+        return -RIG_EINVAL;
+    }
+
+    cmd->vfo = rig_parse_vfo(argv[1]);
+
+    if (cmd->vfo == RIG_VFO_NONE)
+    {
+        return -RIG_EINVAL;
+    }
+
+    if (strcmp(argv[0], "set_freq") == 0 && argc == 3)
+    {
+        cmd->op = NETWORK_CMD_SET_FREQ;
+        cmd->freq = strtod(argv[2], NULL);
+        return cmd->freq > 0 ? RIG_OK : -RIG_EINVAL;
+    }
+
+    if (strcmp(argv[0], "set_mode") == 0 && (argc == 3 || argc == 4))
+    {
+        cmd->op = NETWORK_CMD_SET_MODE;
+        cmd->mode = rig_parse_mode(argv[2]);
+        cmd->width = argc == 4 ? atol(argv[3]) : RIG_PASSBAND_NOCHANGE;
+        return cmd->mode != RIG_MODE_NONE ? RIG_OK : -RIG_EINVAL;
+    }
+
+    if (strcmp(argv[0], "set_ptt") == 0 && argc == 3)
+    {
+        cmd->op = NETWORK_CMD_SET_PTT;
+        cmd->value = atoi(argv[2]);
+        return RIG_OK;
+    }
+
+    if (strcmp(argv[0], "set_split_vfo") == 0 && argc == 4)
+    {
+        cmd->op = NETWORK_CMD_SET_SPLIT_VFO;
+        cmd->value = atoi(argv[2]);
+        cmd->tx_vfo = rig_parse_vfo(argv[3]);
+        return RIG_OK;
+    }
+
+    if (strcmp(argv[0], "set_vfo") == 0 && argc == 2)
+    {
+        cmd->op = NETWORK_CMD_SET_VFO;
+        return RIG_OK;
+    }
+
+    return -RIG_EINVAL;
+}
+
+/* Parse a received datagram
+ * Returns -RIG_EINVAL for anything that is not a command, including the
+ * snapshots sent by publishers sharing the multicast group
+ */
+int network_cmd_parse(const char *data, int length, network_cmd *cmd)
+{
+    cJSON *root_node;
+    cJSON *node;
+    int result = -RIG_EINVAL;
+
+    memset(cmd, 0, sizeof(*cmd));
+
+    root_node = cJSON_ParseWithLength(data, length);
+
+    if (root_node == NULL)
+    {
+        return -RIG_EINVAL;
+    }
+
+    node = cJSON_GetObjectItemCaseSensitive(root_node, "command");
+
+    if (cJSON_IsString(node))
+    {
+        strncpy(cmd->command, node->valuestring, sizeof(cmd->command) - 1);
+
+        node = cJSON_GetObjectItemCaseSensitive(root_node, "id");
+
+        if (cJSON_IsString(node))
+        {
+            strncpy(cmd->id, node->valuestring, sizeof(cmd->id) - 1);
+        }
+
+        result = network_cmd_parse_text(cmd);
+
+        if (result != RIG_OK)
+        {
+            rig_debug(RIG_DEBUG_WARN, "%s: invalid command from '%s': %s\n", __func__,
+                      cmd->id, cmd->command);
+        }
+    }
+
+    cJSON_Delete(root_node);
+
+    return result;
+}
+
+/* Settings a later command of the same kind fully replaces */
+static int network_cmd_collapsible(const network_cmd *cmd)
+{
+    return cmd->op == NETWORK_CMD_SET_FREQ || cmd->op == NETWORK_CMD_SET_MODE;
+}
+
+/* Mark the commands a later command of the batch makes redundant
+ * Only the last set_freq or set_mode for each VFO is kept, e.g. the final
+ * set_freq of a tuning burst. set_ptt, set_split_vfo and set_vfo are state
+ * edges: they are never dropped and end the run, so a frequency set before
+ * keying up is still applied before the PTT.
+ * Returns the number of superseded commands
+ */
+int network_cmd_collapse(network_cmd *cmds, int count)
+{
+    int superseded = 0;
+    int i, j;
+
+    for (i = 0; i < count; i++)
+    {
+        if (!network_cmd_collapsible(&cmds[i]))
+        {
+            continue;
+        }
+
+        for (j = i + 1; j < count; j++)
+        {
+            if (!network_cmd_collapsible(&cmds[j]))
+            {
+                break;
+            }
+
+            if (cmds[j].op == cmds[i].op && cmds[j].vfo == cmds[i].vfo)
+            {
+                cmds[i].superseded = 1;
+                superseded++;
+                break;
+            }
+        }
+    }
+
+    return superseded;
+}
+
+/* Execute a collapsed batch and keep the results for the next snapshot
+ * Unless multicast_cmd_exec is set, every command is refused with
+ * -RIG_EACCESS: anyone on the group could otherwise key the transmitter.
+ */
+int network_cmd_execute(RIG *rig, network_cmd *cmds, int count)
+{
+    network_cmd_priv_data *priv;
+    int i;
+
+    for (i = 0; i < count; i++)
+    {
+        network_cmd *cmd = &cmds[i];
+
+        if (!STATE(rig)->multicast_cmd_exec)
+        {
+            rig_debug(RIG_DEBUG_WARN,
+                      "%s: '%s' from '%s' refused, multicast_cmd_exec is off\n", __func__,
+                      cmd->command, cmd->id);
+            cmd->superseded = 0;
+            cmd->status = -RIG_EACCESS;
+            continue;
+        }
+
+        if (cmd->superseded)
+        {
+            cmd->status = RIG_OK;
+            continue;
+        }
+
+        rig_debug(RIG_DEBUG_VERBOSE, "%s: executing '%s' from '%s'\n", __func__,
+                  cmd->command, cmd->id);
+
+        switch (cmd->op)
+        {
+        case NETWORK_CMD_SET_FREQ:
+            cmd->status = rig_set_freq(rig, cmd->vfo, cmd->freq);
+            break;
+
+        case NETWORK_CMD_SET_MODE:
+            cmd->status = rig_set_mode(rig, cmd->vfo, cmd->mode, cmd->width);
+            break;
+
+        case NETWORK_CMD_SET_PTT:
+            cmd->status = rig_set_ptt(rig, cmd->vfo, (ptt_t) cmd->value);
+            break;
+
+        case NETWORK_CMD_SET_SPLIT_VFO:
+            cmd->status = rig_set_split_vfo(rig, cmd->vfo, (split_t) cmd->value,
+                                            cmd->tx_vfo);
+            break;
+
+        case NETWORK_CMD_SET_VFO:
+            cmd->status = rig_set_vfo(rig, cmd->vfo);
+            break;
+
+        default:
+            cmd->status = -RIG_EINTERNAL;
+        }
+    }
+
+    priv = network_cmd_priv(rig, 1);
+
+    if (priv == NULL)
+    {
+        return -RIG_ENOMEM;
+    }
+
+    pthread_mutex_lock(&priv->mutex);
+
+    // acks not published yet make room for the newest ones
+    for (i = 0; i < count; i++)
+    {
+        if (priv->ack_count == NETWORK_CMD_BATCH_MAX)
+        {
+            memmove(&priv->acks[0], &priv->acks[1],
+                    (NETWORK_CMD_BATCH_MAX - 1) * sizeof(network_cmd));
+            priv->ack_count--;
+        }
+
+        priv->acks[priv->ack_count++] = cmds[i];
+    }
+
+    pthread_mutex_unlock(&priv->mutex);
+
+    return RIG_OK;
+}
+
+/* Hand the results not published yet to the snapshot serializer */
+int network_cmd_take_acks(RIG *rig, network_cmd *acks, int max)
+{
+    network_cmd_priv_data *priv = network_cmd_priv(rig, 0);
+    int count;
+
+    if (priv == NULL)
+    {
+        return 0;
+    }
+
+    pthread_mutex_lock(&priv->mutex);
+
+    count = priv->ack_count < max ? priv->ack_count : max;
+    memcpy(acks, priv->acks, count * sizeof(network_cmd));
+    priv->ack_count = 0;
+
+    pthread_mutex_unlock(&priv->mutex);
+
+    return count;
+}
+
+/* Called by rig_cleanup() */
+void network_cmd_cleanup(RIG *rig)
+{
+    struct rig_state *rs = STATE(rig);
+    network_cmd_priv_data *priv = (network_cmd_priv_data *)
+                                  rs->network_cmd_priv_data;
+
+    if (priv == NULL)
+    {
+        return;
+    }
+
+    pthread_mutex_destroy(&priv->mutex);
+    free(priv);
+    rs->network_cmd_priv_data = NULL;
+}
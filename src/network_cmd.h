@@ -0,0 +1,71 @@
+/*
+ *  Hamlib Interface - multicast command execution
+ *  Copyright (c) 2000-2025 The Hamlib Group
+ *
+ *
+ *   This library is free software; you can redistribute it and/or
+ *   modify it under the terms of the GNU Lesser General Public
+ *   License as published by the Free Software Foundation; either
+ *   version 2.1 of the License, or (at your option) any later version.
+ *
+ *   This library is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *   Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public
+ *   License along with this library; if not, write to the Free Software
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+/* SPDX-License-Identifier: LGPL-2.1-or-later */
+
+#ifndef _NETWORK_CMD_H
+#define _NETWORK_CMD_H 1
+
+#include "hamlib/rig.h"
+
+__BEGIN_DECLS
+
+/* Commands received by the multicast receiver, see README.multicast
+ *
+ * A command datagram is a JSON object:
+ *   { "id": "MyApp 123", "command": "set_freq VFOA 14074000" }
+ */
+#define NETWORK_CMD_ID_LEN 64
+#define NETWORK_CMD_LEN 128
+#define NETWORK_CMD_BATCH_MAX 32    /* datagrams handled per receiver wakeup */
+
+typedef enum network_cmd_op_e
+{
+    NETWORK_CMD_SET_FREQ = 0,       /* set_freq VFO FREQ */
+    NETWORK_CMD_SET_MODE,           /* set_mode VFO MODE WIDTH */
+    NETWORK_CMD_SET_PTT,            /* set_ptt VFO PTT */
+    NETWORK_CMD_SET_SPLIT_VFO,      /* set_split_vfo VFO SPLIT TXVFO */
+    NETWORK_CMD_SET_VFO,            /* set_vfo VFO */
+} network_cmd_op;
+
+typedef struct network_cmd_s
+{
+    char id[NETWORK_CMD_ID_LEN];    /* sender identification, echoed in the ack */
+    char command[NETWORK_CMD_LEN];  /* command text, echoed in the ack */
+    network_cmd_op op;
+    vfo_t vfo;
+    freq_t freq;
+    rmode_t mode;
+    pbwidth_t width;
+    int value;                      /* PTT or split */
+    vfo_t tx_vfo;
+    int status;                     /* result of the execution */
+    int superseded;                 /* replaced by a later command of the same batch */
+} network_cmd;
+
+int network_cmd_parse(const char *data, int length, network_cmd *cmd);
+int network_cmd_collapse(network_cmd *cmds, int count);
+int network_cmd_execute(RIG *rig, network_cmd *cmds, int count);
+int network_cmd_take_acks(RIG *rig, network_cmd *acks, int max);
+void network_cmd_cleanup(RIG *rig);
+
+__END_DECLS
+
+#endif /* _NETWORK_CMD_H */
@@ -622,8 +622,6 @@ int HAMLIB_API par_unlock(hamlib_port_t *port)
  */
 int par_ptt_set(hamlib_port_t *p, ptt_t pttx)
 {
-    rig_debug(RIG_DEBUG_VERBOSE, "%s called\n", __func__);
-
     switch (p->type.ptt)
     {
     case RIG_PTT_PARALLEL:
@@ -636,6 +634,7 @@ int par_ptt_set(hamlib_port_t *p, ptt_t pttx)
 
         if (status != RIG_OK)
         {
+            par_unlock(p);
             return status;
         }
 
@@ -656,6 +655,9 @@ int par_ptt_set(hamlib_port_t *p, ptt_t pttx)
 
         status = par_write_control(p, ctl);
         par_unlock(p);
+
+        // after the write so keying is not delayed
+        rig_debug(RIG_DEBUG_VERBOSE, "%s: PTT=%d\n", __func__, pttx);
         return status;
     }
 
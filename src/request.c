@@ -0,0 +1,805 @@
+/*
+ *  Hamlib Interface - rig operation requests
+ *  Copyright (c) 2000-2025 The Hamlib Group
+ *
+ *
+ *   This library is free software; you can redistribute it and/or
+ *   modify it under the terms of the GNU Lesser General Public
+ *   License as published by the Free Software Foundation; either
+ *   version 2.1 of the License, or (at your option) any later version.
+ *
+ *   This library is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *   Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public
+ *   License along with this library; if not, write to the Free Software
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+/* SPDX-License-Identifier: LGPL-2.1-or-later */
+
+/**
+ * \addtogroup rig
+ * @{
+ */
+
+/**
+ * \file request.c
+ * \brief Rig operation requests and VFO batches
+ *
+ * A struct rig_request describes one get or set operation so it can be
+ * queued and run later. rig_vfo_batch() runs a set of them grouped by
+ * target VFO, which on rigs that cannot target a VFO costs one VFO swap per
+ * group instead of two per request.
+ *
+ * rig_submit() queues a request for a worker thread of the rig and returns
+ * at once. The completion is reported by a callback, or through a pipe an
+ * event loop polls next to the pipes of other rigs.
+ */
+
+#include "hamlib/config.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+
+#ifdef HAVE_FCNTL_H
+#include <fcntl.h>
+#endif
+
+#include <pthread.h>
+
+#include "hamlib/rig.h"
+#include "hamlib/rig_state.h"
+#include "request.h"
+#include "cache.h"
+#include "misc.h"
+
+/* Run a request against vfo instead of req->vfo */
+int rig_request_execute(RIG *rig, struct rig_request *req, vfo_t vfo)
+{
+    switch (req->type)
+    {
+    case RIG_REQ_GET_FREQ:
+        req->retcode = rig_get_freq(rig, vfo, &req->freq);
+        break;
+
+    case RIG_REQ_SET_FREQ:
+        req->retcode = rig_set_freq(rig, vfo, req->freq);
+        break;
+
+    case RIG_REQ_GET_MODE:
+        req->retcode = rig_get_mode(rig, vfo, &req->mode, &req->width);
+        break;
+
+    case RIG_REQ_SET_MODE:
+        req->retcode = rig_set_mode(rig, vfo, req->mode, req->width);
+        break;
+
+    case RIG_REQ_GET_LEVEL:
+        req->retcode = rig_get_level(rig, vfo, req->setting, &req->val);
+        break;
+
+    case RIG_REQ_SET_LEVEL:
+        req->retcode = rig_set_level(rig, vfo, req->setting, req->val);
+        break;
+
+    case RIG_REQ_GET_FUNC:
+        req->retcode = rig_get_func(rig, vfo, req->setting, &req->status);
+        break;
+
+    case RIG_REQ_SET_FUNC:
+        req->retcode = rig_set_func(rig, vfo, req->setting, req->status);
+        break;
+
+    case RIG_REQ_GET_PTT:
+        req->retcode = rig_get_ptt(rig, vfo, &req->ptt);
+        break;
+
+    case RIG_REQ_SET_PTT:
+        req->retcode = rig_set_ptt(rig, vfo, req->ptt);
+        break;
+
+    default:
+        req->retcode = -RIG_EINVAL;
+    }
+
+    return req->retcode;
+}
+
+/* True if the rig runs the request on any VFO without selecting it */
+int rig_request_targetable(RIG *rig, const struct rig_request *req)
+{
+    int targetable;
+
+    switch (req->type)
+    {
+    case RIG_REQ_GET_FREQ:
+    case RIG_REQ_SET_FREQ:
+        targetable = RIG_TARGETABLE_FREQ;
+        break;
+
+    case RIG_REQ_GET_MODE:
+    case RIG_REQ_SET_MODE:
+        targetable = RIG_TARGETABLE_MODE;
+        break;
+
+    case RIG_REQ_GET_LEVEL:
+    case RIG_REQ_SET_LEVEL:
+        targetable = RIG_TARGETABLE_LEVEL;
+        break;
+
+    case RIG_REQ_GET_FUNC:
+    case RIG_REQ_SET_FUNC:
+        targetable = RIG_TARGETABLE_FUNC;
+        break;
+
+    case RIG_REQ_GET_PTT:
+    case RIG_REQ_SET_PTT:
+        targetable = RIG_TARGETABLE_PTT;
+        break;
+
+    default:
+        return 0;
+    }
+
+    return (rig->caps->targetable_vfo & targetable) != 0;
+}
+
+/* The VFO a request has to be run on, with the aliases resolved */
+static vfo_t rig_vfo_batch_group(RIG *rig, const struct rig_request *req,
+                                 vfo_t curr_vfo)
+{
+    switch (req->vfo)
+    {
+    case RIG_VFO_CURR:
+    case RIG_VFO_VFO:
+        return curr_vfo;
+
+    case RIG_VFO_TX:
+        return CACHE(rig)->split ? STATE(rig)->tx_vfo : curr_vfo;
+
+    default:
+        return req->vfo;
+    }
+}
+
+/* Select a VFO and keep the state and cache in step the way rig_set_vfo()
+ * does, without its frequency readback which would cost a round trip per swap */
+static int rig_vfo_batch_select(RIG *rig, vfo_t vfo)
+{
+    struct rig_state *rs = STATE(rig);
+    struct rig_cache *cachep = CACHE(rig);
+    vfo_t vfo_save = rs->current_vfo;
+    int retcode;
+
+    rs->current_vfo = vfo;
+
+    retcode = rig->caps->set_vfo(rig, vfo);
+
+    if (retcode != RIG_OK)
+    {
+        rs->current_vfo = vfo_save;
+        return retcode;
+    }
+
+    // vfo may change in the rig backend
+    cachep->vfo = rs->current_vfo;
+    elapsed_ms(&cachep->time_vfo, HAMLIB_ELAPSED_SET);
+
+    return RIG_OK;
+}
+
+/**
+ * \brief run several requests with as few VFO swaps as possible
+ * \param rig          The rig handle
+ * \param requests     The requests, results are stored in place
+ * \param count        Number of requests
+ * \param swaps_saved  The location where to store the number of VFO swaps
+ * saved compared to running the requests one by one, may be NULL
+ *
+ *  On a rig that cannot target a VFO for an operation, rig_get_level() and
+ *  friends select the VFO, run the operation and select the previous VFO
+ *  again, two swaps per call. rig_vfo_batch() groups the requests by target
+ *  VFO instead: the current VFO first, then each other VFO in order of first
+ *  appearance, selected once for the whole group. The current VFO is
+ *  restored once at the end. Requests the rig can target run without a
+ *  swap in their group.
+ *
+ *  Requests for the same VFO run in the given order, requests for different
+ *  VFOs may not. No other thread uses the rig during the batch.
+ *
+ * \return RIG_OK if the batch has been run, the \a retcode field of each
+ * request holds its result. A negative value if an error occurred.
+ *
+ * \sa struct rig_request
+ */
+int HAMLIB_API rig_vfo_batch(RIG *rig, struct rig_request *requests,
+                             int count, int *swaps_saved)
+{
+    const struct rig_caps *caps;
+    struct rig_state *rs;
+    vfo_t curr_vfo;
+    int naive = 0, swaps = 0;
+    int retcode;
+    int i, j;
+
+    if (!rig || !rig->caps || !STATE(rig)->comm_state || !requests || count < 0)
+    {
+        return -RIG_EINVAL;
+    }
+
+    ENTERFUNC;
+
+    caps = rig->caps;
+    rs = STATE(rig);
+
+    rig_lock(rig, 1);
+
+    curr_vfo = rs->current_vfo;
+
+    if ((curr_vfo == RIG_VFO_CURR || curr_vfo == RIG_VFO_NONE) && caps->get_vfo)
+    {
+        rig_get_vfo(rig, &curr_vfo);
+    }
+
+    // group -1 is the current VFO
+    for (i = -1; i < count; i++)
+    {
+        vfo_t group = i < 0 ? curr_vfo : rig_vfo_batch_group(rig, &requests[i],
+                      curr_vfo);
+
+        if (i >= 0)
+        {
+            if (group == curr_vfo) { continue; }
+
+            for (j = 0; j < i; j++)
+            {
+                if (rig_vfo_batch_group(rig, &requests[j], curr_vfo) == group) { break; }
+            }
+
+            if (j < i) { continue; }
+        }
+
+        for (j = 0; j < count; j++)
+        {
+            struct rig_request *req = &requests[j];
+
+            if (rig_vfo_batch_group(rig, req, curr_vfo) != group) { continue; }
+
+            if (rig_request_targetable(rig, req))
+            {
+                rig_request_execute(rig, req, group);
+                continue;
+            }
+
+            if (group != curr_vfo)
+            {
+                naive += 2;
+            }
+
+            if (group != rs->current_vfo)
+            {
+                if (caps->set_vfo == NULL)
+                {
+                    req->retcode = -RIG_ENTARGET;
+                    continue;
+                }
+
+                retcode = rig_vfo_batch_select(rig, group);
+
+                if (retcode != RIG_OK)
+                {
+                    req->retcode = retcode;
+                    continue;
+                }
+
+                swaps++;
+            }
+
+            rig_request_execute(rig, req, group);
+        }
+    }
+
+    if (rs->current_vfo != curr_vfo && curr_vfo != RIG_VFO_CURR
+            && curr_vfo != RIG_VFO_NONE)
+    {
+        retcode = rig_vfo_batch_select(rig, curr_vfo);
+
+        if (retcode != RIG_OK)
+        {
+            rig_debug(RIG_DEBUG_ERR, "%s: restoring %s failed: %s\n", __func__,
+                      rig_strvfo(curr_vfo), rigerror(retcode));
+        }
+
+        swaps++;
+    }
+
+    rig_lock(rig, 0);
+
+    rig_debug(RIG_DEBUG_VERBOSE, "%s: %d requests, %d VFO swaps, %d saved\n",
+              __func__, count, swaps, naive - swaps);
+
+    if (swaps_saved)
+    {
+        *swaps_saved = naive - swaps;
+    }
+
+    RETURNFUNC(RIG_OK);
+}
+
+#define RIG_SUBMIT_QUEUE_MAX 64
+
+typedef struct rig_submit_entry_s
+{
+    struct rig_request req;
+    rig_request_cb_t cb;
+    rig_ptr_t arg;
+    struct timespec deadline;   /* tv_sec 0 if none */
+    int cancelled;
+} rig_submit_entry;
+
+typedef struct rig_submit_priv_data_s
+{
+    RIG *rig;
+    pthread_t thread_id;
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    int run;
+    int last_id;
+    int head;                   /* pending requests */
+    int count;
+    rig_submit_entry queue[RIG_SUBMIT_QUEUE_MAX];
+    int done_head;              /* completed requests without callback */
+    int done_count;
+    struct rig_request done[RIG_SUBMIT_QUEUE_MAX];
+    int fd_read;                /* one byte per completed request in done */
+    int fd_write;
+} rig_submit_priv_data;
+
+static int rig_submit_deadline_passed(const struct timespec *deadline)
+{
+    struct timespec now;
+
+    if (deadline->tv_sec == 0)
+    {
+        return 0;
+    }
+
+    clock_gettime(CLOCK_REALTIME, &now);
+
+    return now.tv_sec > deadline->tv_sec || (now.tv_sec == deadline->tv_sec
+            && now.tv_nsec >= deadline->tv_nsec);
+}
+
+/* Called with the mutex held */
+static void rig_submit_complete(rig_submit_priv_data *priv,
+                                rig_submit_entry *entry)
+{
+    if (entry->cb)
+    {
+        pthread_mutex_unlock(&priv->mutex);
+        entry->cb(priv->rig, &entry->req, entry->arg);
+        pthread_mutex_lock(&priv->mutex);
+        return;
+    }
+
+    // rig_submit() keeps room for it
+    priv->done[(priv->done_head + priv->done_count) % RIG_SUBMIT_QUEUE_MAX] =
+        entry->req;
+    priv->done_count++;
+
+#if !defined(WIN32)
+
+    if (priv->fd_write >= 0 && write(priv->fd_write, "", 1) != 1)
+    {
+        rig_debug(RIG_DEBUG_ERR, "%s: write error: %s\n", __func__,
+                  strerror(errno));
+    }
+
+#endif
+}
+
+static void *rig_submit_worker(void *arg)
+{
+    rig_submit_priv_data *priv = (rig_submit_priv_data *) arg;
+    RIG *rig = priv->rig;
+
+    pthread_mutex_lock(&priv->mutex);
+
+    for (;;)
+    {
+        rig_submit_entry entry;
+
+        if (priv->count == 0)
+        {
+            if (!priv->run)
+            {
+                break;
+            }
+
+            pthread_cond_wait(&priv->cond, &priv->mutex);
+            continue;
+        }
+
+        // copied out so rig_submit() can reuse the slot while it runs
+        entry = priv->queue[priv->head];
+        priv->head = (priv->head + 1) % RIG_SUBMIT_QUEUE_MAX;
+        priv->count--;
+
+        if (entry.cancelled || !priv->run)
+        {
+            entry.req.retcode = -RIG_ECANCELED;
+        }
+        else if (rig_submit_deadline_passed(&entry.deadline))
+        {
+            entry.req.retcode = -RIG_ETIMEOUT;
+        }
+        else
+        {
+            pthread_mutex_unlock(&priv->mutex);
+
+            rig_lock(rig, 1);
+            rig_request_execute(rig, &entry.req, entry.req.vfo);
+            rig_lock(rig, 0);
+
+            pthread_mutex_lock(&priv->mutex);
+        }
+
+        rig_debug(RIG_DEBUG_TRACE, "%s: request %d done: %s\n", __func__,
+                  entry.req.id, rigerror(entry.req.retcode));
+
+        rig_submit_complete(priv, &entry);
+    }
+
+    pthread_mutex_unlock(&priv->mutex);
+
+    return NULL;
+}
+
+static void rig_submit_free(rig_submit_priv_data *priv)
+{
+#if !defined(WIN32)
+
+    if (priv->fd_read >= 0) { close(priv->fd_read); }
+
+    if (priv->fd_write >= 0) { close(priv->fd_write); }
+
+#endif
+
+    pthread_cond_destroy(&priv->cond);
+    pthread_mutex_destroy(&priv->mutex);
+    free(priv);
+}
+
+static rig_submit_priv_data *rig_submit_priv(RIG *rig)
+{
+    struct rig_state *rs = STATE(rig);
+    static pthread_mutex_t create_mutex = PTHREAD_MUTEX_INITIALIZER;
+    rig_submit_priv_data *priv;
+    int err;
+
+    pthread_mutex_lock(&create_mutex);
+
+    priv = (rig_submit_priv_data *) rs->submit_priv_data;
+
+    if (priv != NULL)
+    {
+        pthread_mutex_unlock(&create_mutex);
+        return priv;
+    }
+
+    priv = calloc(1, sizeof(rig_submit_priv_data));
+
+    if (priv == NULL)
+    {
+        pthread_mutex_unlock(&create_mutex);
+        return NULL;
+    }
+
+    priv->rig = rig;
+    priv->run = 1;
+    priv->fd_read = -1;
+    priv->fd_write = -1;
+    pthread_mutex_init(&priv->mutex, NULL);
+    pthread_cond_init(&priv->cond, NULL);
+
+#if !defined(WIN32)
+    {
+        int fds[2];
+
+        if (pipe(fds) == 0)
+        {
+            fcntl(fds[0], F_SETFL, fcntl(fds[0], F_GETFL) | O_NONBLOCK);
+            fcntl(fds[1], F_SETFL, fcntl(fds[1], F_GETFL) | O_NONBLOCK);
+            priv->fd_read = fds[0];
+            priv->fd_write = fds[1];
+        }
+        else
+        {
+            rig_debug(RIG_DEBUG_ERR, "%s: pipe error: %s\n", __func__, strerror(errno));
+        }
+    }
+#endif
+
+    err = pthread_create(&priv->thread_id, NULL, rig_submit_worker, priv);
+
+    if (err)
+    {
+        rig_debug(RIG_DEBUG_ERR, "%s: pthread_create error: %s\n", __func__,
+                  strerror(err));
+        rig_submit_free(priv);
+        pthread_mutex_unlock(&create_mutex);
+        return NULL;
+    }
+
+    rs->submit_priv_data = priv;
+
+    pthread_mutex_unlock(&create_mutex);
+
+    return priv;
+}
+
+/* Complete the pending requests with -RIG_ECANCELED and stop the worker */
+void rig_submit_stop(RIG *rig)
+{
+    struct rig_state *rs = STATE(rig);
+    rig_submit_priv_data *priv = (rig_submit_priv_data *) rs->submit_priv_data;
+
+    if (priv == NULL)
+    {
+        return;
+    }
+
+    pthread_mutex_lock(&priv->mutex);
+    priv->run = 0;
+    pthread_cond_signal(&priv->cond);
+    pthread_mutex_unlock(&priv->mutex);
+
+    pthread_join(priv->thread_id, NULL);
+
+    rs->submit_priv_data = NULL;
+
+    rig_submit_free(priv);
+}
+
+/**
+ * \brief queue a request for asynchronous execution
+ * \param rig        The rig handle
+ * \param request    The request, copied before the call returns
+ * \param timeout_ms Deadline for the request to start, 0 for none
+ * \param cb         Completion callback, or NULL to report the completion
+ * through rig_request_fd() and rig_request_reap()
+ * \param arg        Passed to \a cb
+ *
+ *  The request is run by a worker thread of the rig, started by the first
+ *  call, in submission order and interleaved with the calls of other
+ *  threads. A request not started when its deadline passes, or cancelled
+ *  by rig_cancel(), completes with -RIG_ETIMEOUT or -RIG_ECANCELED without
+ *  being run. rig_close() cancels the pending requests.
+ *
+ *  The callback runs on the worker thread and must not wait for other
+ *  requests of the same rig.
+ *
+ * \return the request identifier, a positive number also found in the
+ * \a id field of the completed request. -RIG_ELIMIT if too many requests
+ * are pending, or another negative value if an error occurred.
+ *
+ * \sa rig_cancel(), rig_request_fd(), rig_vfo_batch()
+ */
+int HAMLIB_API rig_submit(RIG *rig, const struct rig_request *request,
+                          int timeout_ms, rig_request_cb_t cb, rig_ptr_t arg)
+{
+    rig_submit_priv_data *priv;
+    rig_submit_entry *entry;
+    int id;
+
+    if (!rig || !rig->caps || !STATE(rig)->comm_state || !request
+            || timeout_ms < 0)
+    {
+        return -RIG_EINVAL;
+    }
+
+    priv = rig_submit_priv(rig);
+
+    if (priv == NULL)
+    {
+        return -RIG_EINTERNAL;
+    }
+
+    pthread_mutex_lock(&priv->mutex);
+
+    // completions waiting to be reaped hold a place too
+    if (priv->count + priv->done_count >= RIG_SUBMIT_QUEUE_MAX)
+    {
+        pthread_mutex_unlock(&priv->mutex);
+        rig_debug(RIG_DEBUG_WARN, "%s: %d requests pending\n", __func__,
+                  RIG_SUBMIT_QUEUE_MAX);
+        return -RIG_ELIMIT;
+    }
+
+    entry = &priv->queue[(priv->head + priv->count) % RIG_SUBMIT_QUEUE_MAX];
+    memset(entry, 0, sizeof(*entry));
+    entry->req = *request;
+    entry->req.retcode = RIG_OK;
+    entry->cb = cb;
+    entry->arg = arg;
+
+    if (timeout_ms > 0)
+    {
+        clock_gettime(CLOCK_REALTIME, &entry->deadline);
+        entry->deadline.tv_sec += timeout_ms / 1000;
+        entry->deadline.tv_nsec += (long)(timeout_ms % 1000) * 1000000L;
+
+        if (entry->deadline.tv_nsec >= 1000000000L)
+        {
+            entry->deadline.tv_sec++;
+            entry->deadline.tv_nsec -= 1000000000L;
+        }
+    }
+
+    priv->last_id = priv->last_id == 0x7fffffff ? 1 : priv->last_id + 1;
+    entry->req.id = priv->last_id;
+    // the worker may complete and reuse the entry once unlocked
+    id = entry->req.id;
+    priv->count++;
+    pthread_cond_signal(&priv->cond);
+
+    pthread_mutex_unlock(&priv->mutex);
+
+    return id;
+}
+
+/**
+ * \brief cancel a request queued by rig_submit()
+ * \param rig  The rig handle
+ * \param id   The identifier returned by rig_submit()
+ *
+ *  A request still pending completes with -RIG_ECANCELED without being
+ *  run. A request already running is not interrupted.
+ *
+ * \return RIG_OK if the request will complete as cancelled, -RIG_EINVAL if
+ * it is not pending anymore.
+ *
+ * \sa rig_submit()
+ */
+int HAMLIB_API rig_cancel(RIG *rig, int id)
+{
+    rig_submit_priv_data *priv;
+    int retcode = -RIG_EINVAL;
+    int i;
+
+    if (!rig || !rig->caps)
+    {
+        return -RIG_EINVAL;
+    }
+
+    priv = (rig_submit_priv_data *) STATE(rig)->submit_priv_data;
+
+    if (priv == NULL)
+    {
+        return -RIG_EINVAL;
+    }
+
+    pthread_mutex_lock(&priv->mutex);
+
+    for (i = 0; i < priv->count; i++)
+    {
+        rig_submit_entry *entry = &priv->queue[(priv->head + i) %
+                                               RIG_SUBMIT_QUEUE_MAX];
+
+        if (entry->req.id == id && !entry->cancelled)
+        {
+            entry->cancelled = 1;
+            retcode = RIG_OK;
+            break;
+        }
+    }
+
+    pthread_mutex_unlock(&priv->mutex);
+
+    return retcode;
+}
+
+/**
+ * \brief file descriptor signalling completed requests
+ * \param rig  The rig handle
+ *
+ *  The descriptor becomes readable when a request submitted without
+ *  callback completes, so one thread can poll() or select() the
+ *  descriptors of many rigs and call rig_request_reap() on the ready ones.
+ *  Only read it through rig_request_reap(). It is closed by rig_close().
+ *
+ * \return the file descriptor, or a negative value if an error occurred.
+ * -RIG_ENAVAIL on Windows.
+ *
+ * \sa rig_submit(), rig_request_reap()
+ */
+int HAMLIB_API rig_request_fd(RIG *rig)
+{
+    if (!rig || !rig->caps || !STATE(rig)->comm_state)
+    {
+        return -RIG_EINVAL;
+    }
+
+#if defined(WIN32)
+    return -RIG_ENAVAIL;
+#else
+    rig_submit_priv_data *priv = rig_submit_priv(rig);
+
+    if (priv == NULL)
+    {
+        return -RIG_EINTERNAL;
+    }
+
+    return priv->fd_read >= 0 ? priv->fd_read : -RIG_EIO;
+#endif
+}
+
+/**
+ * \brief collect the requests completed without callback
+ * \param rig  The rig handle
+ * \param done The location where to store the completed requests
+ * \param max  Room in \a done
+ *
+ * Does not wait.
+ *
+ * \return the number of requests stored in \a done, or a negative value if
+ * an error occurred.
+ *
+ * \sa rig_submit(), rig_request_fd()
+ */
+int HAMLIB_API rig_request_reap(RIG *rig, struct rig_request *done, int max)
+{
+    rig_submit_priv_data *priv;
+    int count = 0;
+
+    if (!rig || !rig->caps || !done || max < 0)
+    {
+        return -RIG_EINVAL;
+    }
+
+    priv = (rig_submit_priv_data *) STATE(rig)->submit_priv_data;
+
+    if (priv == NULL)
+    {
+        return 0;
+    }
+
+    pthread_mutex_lock(&priv->mutex);
+
+    while (count < max && priv->done_count > 0)
+    {
+        done[count++] = priv->done[priv->done_head];
+        priv->done_head = (priv->done_head + 1) % RIG_SUBMIT_QUEUE_MAX;
+        priv->done_count--;
+    }
+
+#if !defined(WIN32)
+
+    if (count > 0 && priv->fd_read >= 0)
+    {
+        char buf[RIG_SUBMIT_QUEUE_MAX];
+
+        // one byte was written per completion
+        if (read(priv->fd_read, buf, count) != count)
+        {
+            rig_debug(RIG_DEBUG_ERR, "%s: read error: %s\n", __func__, strerror(errno));
+        }
+    }
+
+#endif
+
+    pthread_mutex_unlock(&priv->mutex);
+
+    return count;
+}
+
+/** @} */
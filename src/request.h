@@ -0,0 +1,39 @@
+/*
+ *  Hamlib Interface - rig operation requests
+ *  Copyright (c) 2000-2025 The Hamlib Group
+ *
+ *
+ *   This library is free software; you can redistribute it and/or
+ *   modify it under the terms of the GNU Lesser General Public
+ *   License as published by the Free Software Foundation; either
+ *   version 2.1 of the License, or (at your option) any later version.
+ *
+ *   This library is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *   Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public
+ *   License along with this library; if not, write to the Free Software
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+/* SPDX-License-Identifier: LGPL-2.1-or-later */
+
+#ifndef _REQUEST_H
+#define _REQUEST_H 1
+
+#include "hamlib/rig.h"
+
+__BEGIN_DECLS
+
+/* Hamlib internal use, see rig_vfo_batch() */
+int rig_request_execute(RIG *rig, struct rig_request *req, vfo_t vfo);
+int rig_request_targetable(RIG *rig, const struct rig_request *req);
+
+/* Called by rig_close(), see rig_submit() */
+void rig_submit_stop(RIG *rig);
+
+__END_DECLS
+
+#endif /* _REQUEST_H */
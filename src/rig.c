@@ -73,6 +73,11 @@
 #include "sprintflst.h"
 #include "hamlibdatetime.h"
 #include "cache.h"
+#include "spectrum.h"
+#include "network_cmd.h"
+#include "freq_coalesce.h"
+#include "trusted_set.h"
+#include "request.h"
 
 /**
  * \brief Hamlib short license name
@@ -270,7 +275,8 @@ static const char *const rigerror_table[] =
     "Security error password not provided or crypto failure",
     "Rig is not powered on",
     "Limit exceeded",
-    "Access denied"
+    "Access denied",
+    "Operation cancelled"
 };
 //! @endcond
 
@@ -589,6 +595,8 @@ static void vaporize(RIG *rig)
 {
     if (CACHE(rig))
     {
+        pthread_cond_destroy(&CACHE(rig)->notify_cond);
+        pthread_mutex_destroy(&CACHE(rig)->notify_mutex);
         free(CACHE(rig));
         CACHE(rig) = NULL;
     }
@@ -749,6 +757,8 @@ RIG *HAMLIB_API rig_init(rig_model_t rig_model)
         return NULL;
     }
     cachep = CACHE(rig);
+    pthread_mutex_init(&cachep->notify_mutex, NULL);
+    pthread_cond_init(&cachep->notify_cond, NULL);
 
     rs->rig_model = caps->rig_model;
     rs->priv = NULL;
@@ -860,6 +870,7 @@ RIG *HAMLIB_API rig_init(rig_model_t rig_model)
 #endif
     rs->multicast_data_port = 4532;
     rs->multicast_cmd_port = 4532;
+    rs->multicast_min_interval_ms = 50;
     rs->lo_freq = 0;
     cachep->timeout_ms = 500;  // 500ms cache timeout by default
     cachep->ptt = 0;
@@ -1030,6 +1041,9 @@ RIG *HAMLIB_API rig_init(rig_model_t rig_model)
 #endif
     pthread_mutex_init(&rs->api_mutex, &api_attr);
     pthread_mutexattr_destroy(&api_attr);
+    pthread_mutex_init(&rs->ptt_mutex, NULL);
+    pthread_mutex_init(&rs->dcd_mutex, NULL);
+    pthread_mutex_init(&rs->state_mutex, NULL);
 
     /*
      * Give the backend a chance to setup his private data
@@ -1291,6 +1305,10 @@ int HAMLIB_API rig_open(RIG *rig)
         RETURNFUNC2(status);
     }
 
+    // port_open() created the sync pipes, but nothing fills them until the
+    // async data handler runs, so the backend's rig_open() reads directly
+    rp->asyncio = 0;
+
     switch (pttp->type.ptt)
     {
     case RIG_PTT_NONE:
@@ -1693,7 +1711,18 @@ int HAMLIB_API rig_open(RIG *rig)
 
     int timesave = rs->timeout;
     rs->timeout = 0;
-    rig_flush_force(rp, 1);
+
+    // With async I/O the data handler already reads the device, e.g. the
+    // state a TCI server pushes once open, flushing it could cut a frame in half
+    if (rp->asyncio)
+    {
+        port_flush_sync_pipes(rp);
+    }
+    else
+    {
+        rig_flush_force(rp, 1);
+    }
+
     rs->timeout = timesave;
 
     enum multicast_item_e items = RIG_MULTICAST_POLL | RIG_MULTICAST_TRANSCEIVE
@@ -1778,6 +1807,11 @@ int HAMLIB_API rig_close(RIG *rig)
 
     remove_opened_rig(rig);
 
+    // write the pending frequency changes while the port is still open
+    freq_coalesce_stop(rig);
+    trusted_set_stop(rig);
+    rig_submit_stop(rig);
+
     rs->comm_status = RIG_COMM_STATUS_DISCONNECTED;
 
     if (!skip_init)
@@ -1801,6 +1835,8 @@ int HAMLIB_API rig_close(RIG *rig)
      * FIXME: what happens if PTT and rig ports are the same?
      *          (eg. ptt_type = RIG_PTT_SERIAL)
      */
+    pthread_mutex_lock(&rs->ptt_mutex);
+
     switch (pttp->type.ptt)
     {
     case RIG_PTT_NONE:
@@ -1861,6 +1897,10 @@ int HAMLIB_API rig_close(RIG *rig)
                   pttp->type.ptt);
     }
 
+    pthread_mutex_unlock(&rs->ptt_mutex);
+
+    pthread_mutex_lock(&rs->dcd_mutex);
+
     switch (dcdp->type.dcd)
     {
     case RIG_DCD_NONE:
@@ -1893,6 +1933,8 @@ int HAMLIB_API rig_close(RIG *rig)
                   dcdp->type.dcd);
     }
 
+    pthread_mutex_unlock(&rs->dcd_mutex);
+
     dcdp->fd = pttp->fd = -1;
 
     port_close(rp, rp->type.rig);
@@ -1944,7 +1986,14 @@ int HAMLIB_API rig_cleanup(RIG *rig)
         rig->caps->rig_cleanup(rig);
     }
 
+    spectrum_proc_cleanup_all(rig);
+    spectrum_detector_cleanup_all(rig);
+    network_cmd_cleanup(rig);
+
     //pthread_mutex_destroy(&STATE(rig)->api_mutex);
+    pthread_mutex_destroy(&STATE(rig)->ptt_mutex);
+    pthread_mutex_destroy(&STATE(rig)->dcd_mutex);
+    pthread_mutex_destroy(&STATE(rig)->state_mutex);
 
     /* Release all buffers, and the rig_struct itself */
     vaporize(rig);
@@ -2154,6 +2203,7 @@ int rig_set_freq(RIG *rig, vfo_t vfo, freq_t freq)
     struct rig_cache *cachep;
     struct rig_state *rs;
     int retcode;
+    freq_t freq_orig = freq;
     freq_t freq_new = freq;
     vfo_t vfo_save;
     static int last_band = -1;
@@ -2166,6 +2216,19 @@ int rig_set_freq(RIG *rig, vfo_t vfo, freq_t freq)
         return -RIG_EINVAL;
     }
 
+    caps = rig->caps;
+
+    if (caps->set_freq == NULL)
+    {
+        return -RIG_ENAVAIL;
+    }
+
+    // in coalescing mode the sender thread does the rest
+    if (freq_coalesce_submit(rig, vfo, freq))
+    {
+        return RIG_OK;
+    }
+
     cachep = CACHE(rig);
     rs = STATE(rig);
 
@@ -2243,8 +2306,6 @@ int rig_set_freq(RIG *rig, vfo_t vfo, freq_t freq)
         rs->twiddle_state = TWIDDLE_OFF;
     }
 
-    caps = rig->caps;
-
     if (rs->lo_freq != 0.0)
     {
         freq -= rs->lo_freq;
@@ -2256,13 +2317,6 @@ int rig_set_freq(RIG *rig, vfo_t vfo, freq_t freq)
         freq += (freq_t)((double)rs->vfo_comp * freq);
     }
 
-    if (caps->set_freq == NULL)
-    {
-        ELAPSED2;
-        LOCK(0);
-        RETURNFUNC(-RIG_ENAVAIL);
-    }
-
     vfo_save = rs->current_vfo;
     vfo = vfo_fixup(rig, vfo, cachep->split);
 
@@ -2322,8 +2376,8 @@ int rig_set_freq(RIG *rig, vfo_t vfo, freq_t freq)
 
             if (retcode != RIG_OK) { LOCK(0); RETURNFUNC(retcode); }
 
-            // Unidirectional rigs do not reset cache
-            if (rig->caps->rig_model != RIG_MODEL_FT736R)
+            // Unidirectional rigs and trusted sets do not reset cache
+            if (rig->caps->rig_model != RIG_MODEL_FT736R && !rs->trusted_set)
             {
                 rig_set_cache_freq(rig, vfo, (freq_t)0);
             }
@@ -2406,7 +2460,13 @@ int rig_set_freq(RIG *rig, vfo_t vfo, freq_t freq)
         retcode = caps->set_freq(rig, vfo, freq);
     }
 
-    if (retcode == RIG_OK && caps->get_freq != NULL)
+    if (retcode == RIG_OK && rs->trusted_set)
+    {
+        // the cache gets the requested freq below, the rig is asked later if at all,
+        // rig_get_freq() reports the caller's freq, not the one sent to the rig
+        trusted_set_verify(rig, vfo, freq_orig);
+    }
+    else if (retcode == RIG_OK && caps->get_freq != NULL)
     {
 
         // verify our freq to ensure HZ mods are seen
@@ -2791,13 +2851,211 @@ int HAMLIB_API rig_get_freq(RIG *rig, vfo_t vfo, freq_t *freq)
     RETURNFUNC(retcode);
 }
 
+/* Fill a snapshot with the usual get calls
+ * Only what the rig reports without swapping VFOs is read, the rest is
+ * taken from the cache
+ */
+static int rig_get_vfo_snapshot_generic(RIG *rig,
+                                        struct rig_vfo_snapshot *snapshot)
+{
+    const struct rig_caps *caps = rig->caps;
+    struct rig_state *rs = STATE(rig);
+    int retcode;
+    int i;
+
+    if (caps->get_vfo && !(rs->current_vfo & (snapshot->vfos[0].vfo
+                           | snapshot->vfos[1].vfo)))
+    {
+        retcode = rig_get_vfo(rig, &snapshot->current_vfo);
+
+        if (retcode != RIG_OK && retcode != -RIG_ENAVAIL && retcode != -RIG_ENIMPL)
+        {
+            return retcode;
+        }
+    }
+
+    for (i = 0; i < 2; i++)
+    {
+        struct rig_vfo_snapshot_entry *entry = &snapshot->vfos[i];
+        // with the current VFO unknown the first one is assumed
+        int current = entry->vfo == snapshot->current_vfo
+                      || (i == 0 && snapshot->vfos[1].vfo != snapshot->current_vfo);
+        vfo_t vfo = current ? RIG_VFO_CURR : entry->vfo;
+        int cache_ms_freq, cache_ms_mode, cache_ms_width;
+
+        rig_get_cache(rig, entry->vfo, &entry->freq, &cache_ms_freq, &entry->mode,
+                      &cache_ms_mode, &entry->width, &cache_ms_width);
+
+        if (current || (caps->targetable_vfo & RIG_TARGETABLE_FREQ))
+        {
+            HAMLIB_TRACE;
+            retcode = rig_get_freq(rig, vfo, &entry->freq);
+
+            if (retcode != RIG_OK) { return retcode; }
+        }
+        else
+        {
+            entry->cached = 1;
+        }
+
+        if (current || (caps->targetable_vfo & RIG_TARGETABLE_MODE))
+        {
+            HAMLIB_TRACE;
+            retcode = rig_get_mode(rig, vfo, &entry->mode, &entry->width);
+
+            if (retcode != RIG_OK) { return retcode; }
+        }
+        else
+        {
+            entry->cached = 1;
+        }
+    }
+
+    retcode = rig_get_split_vfo(rig, RIG_VFO_CURR, &snapshot->split,
+                                &snapshot->tx_vfo);
+
+    if (retcode != RIG_OK && retcode != -RIG_ENAVAIL && retcode != -RIG_ENIMPL)
+    {
+        return retcode;
+    }
+
+    retcode = rig_get_ptt(rig, RIG_VFO_CURR, &snapshot->ptt);
+
+    if (retcode != RIG_OK && retcode != -RIG_ENAVAIL && retcode != -RIG_ENIMPL)
+    {
+        return retcode;
+    }
+
+    return RIG_OK;
+}
+
+/**
+ * \brief get frequency, mode, split and PTT of both VFOs in one call
+ * \param rig       The rig handle
+ * \param snapshot  The location where to store the VFO states
+ *
+ *  Retrieves the state of VFOA/Main and VFOB/Sub, the split state and TX VFO,
+ *  and PTT. Backends implementing the get_vfo_snapshot hook read all of it
+ *  with as few commands as the rig allows, otherwise the usual get
+ *  functions are used. In either case the VFOs are never swapped: a value
+ *  the rig cannot report for a VFO that is not selected comes from the
+ *  cache, and the \a cached field of its entry is set.
+ *
+ *  The cache is updated with the values read, and answers the call on its
+ *  own while all of them are fresh.
+ *
+ * \return RIG_OK if the operation has been successful, otherwise
+ * a negative value if an error occurred (in which case, cause is
+ * set appropriately).
+ *
+ * \sa rig_get_freqs(), rig_get_vfo_info()
+ */
+int HAMLIB_API rig_get_vfo_snapshot(RIG *rig, struct rig_vfo_snapshot *snapshot)
+{
+    const struct rig_caps *caps;
+    struct rig_state *rs;
+    struct rig_cache *cachep;
+    int retcode = -RIG_ENIMPL;
+    int fresh = 1;
+    int i;
+
+    if (CHECK_RIG_ARG(rig) || !snapshot)
+    {
+        rig_debug(RIG_DEBUG_ERR, "%s: rig or rig->caps is null\n", __func__);
+        return -RIG_EINVAL;
+    }
+
+    ELAPSED1;
+    ENTERFUNC;
+
+    caps = rig->caps;
+    rs = STATE(rig);
+    cachep = CACHE(rig);
+
+    memset(snapshot, 0, sizeof(*snapshot));
+    snapshot->vfos[0].vfo = vfo_fixup(rig, RIG_VFO_A, cachep->split);
+    snapshot->vfos[1].vfo = vfo_fixup(rig, RIG_VFO_B, cachep->split);
+    snapshot->current_vfo = rs->current_vfo;
+    snapshot->split = cachep->split;
+    snapshot->tx_vfo = cachep->split_vfo;
+    snapshot->ptt = cachep->ptt;
+
+    for (i = 0; i < 2; i++)
+    {
+        struct rig_vfo_snapshot_entry *entry = &snapshot->vfos[i];
+        int cache_ms_freq, cache_ms_mode, cache_ms_width;
+
+        rig_get_cache(rig, entry->vfo, &entry->freq, &cache_ms_freq, &entry->mode,
+                      &cache_ms_mode, &entry->width, &cache_ms_width);
+
+        if (entry->freq == 0 || cache_ms_freq >= cachep->timeout_ms
+                || cache_ms_mode >= cachep->timeout_ms)
+        {
+            fresh = 0;
+        }
+    }
+
+    if (fresh
+            && elapsed_ms(&cachep->time_split, HAMLIB_ELAPSED_GET) < cachep->timeout_ms
+            && elapsed_ms(&cachep->time_ptt, HAMLIB_ELAPSED_GET) < cachep->timeout_ms)
+    {
+        rig_debug(RIG_DEBUG_TRACE, "%s: cache hit\n", __func__);
+        ELAPSED2;
+        RETURNFUNC(RIG_OK);
+    }
+
+    LOCK(1);
+
+    if (caps->get_vfo_snapshot)
+    {
+        HAMLIB_TRACE;
+        retcode = caps->get_vfo_snapshot(rig, snapshot);
+
+        if (retcode == RIG_OK)
+        {
+            for (i = 0; i < 2; i++)
+            {
+                struct rig_vfo_snapshot_entry *entry = &snapshot->vfos[i];
+
+                if (!entry->cached)
+                {
+                    rig_set_cache_freq(rig, entry->vfo, entry->freq);
+                    rig_set_cache_mode(rig, entry->vfo, entry->mode, entry->width);
+                }
+            }
+
+            rs->current_vfo = snapshot->current_vfo;
+            cachep->split = snapshot->split;
+            cachep->split_vfo = snapshot->tx_vfo;
+            elapsed_ms(&cachep->time_split, HAMLIB_ELAPSED_SET);
+            cachep->ptt = snapshot->ptt;
+            elapsed_ms(&cachep->time_ptt, HAMLIB_ELAPSED_SET);
+        }
+    }
+
+    if (retcode == -RIG_ENIMPL || retcode == -RIG_ENAVAIL)
+    {
+        for (i = 0; i < 2; i++)
+        {
+            snapshot->vfos[i].cached = 0;
+        }
+
+        retcode = rig_get_vfo_snapshot_generic(rig, snapshot);
+    }
+
+    ELAPSED2;
+    LOCK(0);
+    RETURNFUNC(retcode);
+}
+
 /**
  * \brief get the frequency of VFOA and VFOB
  * \param rig   The rig handle
  * \param freqA  The location where to store the VFOA/Main frequency
  * \param freqB  The location where to store the VFOB/Sub frequency
  *
- *  Retrieves the frequency of  VFOA/Main and VFOB/Sub
+ *  Retrieves the frequency of  VFOA/Main and VFOB/Sub without swapping
+ *  VFOs, see rig_get_vfo_snapshot().
  *  The value stored at \a freq location equals RIG_FREQ_NONE when the current
  *  frequency of the VFO is not defined (e.g. blank memory).
  *
@@ -2805,14 +3063,27 @@ int HAMLIB_API rig_get_freq(RIG *rig, vfo_t vfo, freq_t *freq)
  * a negative value if an error occurred (in which case, cause is
  * set appropriately).
  *
- * \sa rig_set_freq()
+ * \sa rig_set_freq(), rig_get_vfo_snapshot()
  */
-// cppcheck-suppress unusedFunction
-int HAMLIB_API rig_get_freqs(RIG *rig, freq_t *freqA, freq_t freqB)
+int HAMLIB_API rig_get_freqs(RIG *rig, freq_t *freqA, freq_t *freqB)
 {
-    // we will attempt to avoid vfo swapping in this routine
+    struct rig_vfo_snapshot snapshot;
+    int retcode;
 
-    return (-RIG_ENIMPL);
+    if (!freqA || !freqB)
+    {
+        return -RIG_EINVAL;
+    }
+
+    retcode = rig_get_vfo_snapshot(rig, &snapshot);
+
+    if (retcode == RIG_OK)
+    {
+        *freqA = snapshot.vfos[0].freq;
+        *freqB = snapshot.vfos[1].freq;
+    }
+
+    return retcode;
 }
 
 
@@ -3604,6 +3875,131 @@ int HAMLIB_API rig_get_vfo(RIG *rig, vfo_t *vfo)
 }
 
 
+/* True if PTT is a hardware line on a port of its own, see rig_set_ptt_line() */
+static int rig_ptt_line_separate(RIG *rig)
+{
+    const hamlib_port_t *pttp = PTTPORT(rig);
+
+    switch (pttp->type.ptt)
+    {
+    case RIG_PTT_SERIAL_DTR:
+    case RIG_PTT_SERIAL_RTS:
+        return strcmp(pttp->pathname, RIGPORT(rig)->pathname) != 0;
+
+    case RIG_PTT_PARALLEL:
+    case RIG_PTT_CM108:
+    case RIG_PTT_GPIO:
+    case RIG_PTT_GPION:
+        return 1;
+
+    default:
+        return 0;
+    }
+}
+
+/* Seize a serial PTT port freed by ptt_share, called with ptt_mutex held */
+static int rig_ptt_line_open(hamlib_port_t *pttp)
+{
+    pttp->fd = ser_open(pttp);
+
+    if (pttp->fd < 0)
+    {
+        rig_debug(RIG_DEBUG_ERR, "%s: cannot open PTT device \"%s\"\n", __func__,
+                  pttp->pathname);
+        return -RIG_EIO;
+    }
+
+    /* Needed on Linux because the serial port driver sets RTS/DTR
+       high on open - set the non-PTT line low since we offer no control
+       of it and low is better than high */
+    return pttp->type.ptt == RIG_PTT_SERIAL_DTR ? ser_set_rts(pttp, 0) :
+           ser_set_dtr(pttp, 0);
+}
+
+/* PTT fast path: a line on a port of its own does not wait for the CAT
+ * transaction in progress. It is switched under ptt_mutex instead of the
+ * API lock, with nothing logged or allocated before the edge once the port
+ * is open.
+ */
+static int rig_set_ptt_line(RIG *rig, ptt_t ptt)
+{
+    struct rig_state *rs = STATE(rig);
+    struct rig_cache *cachep = CACHE(rig);
+    hamlib_port_t *pttp = PTTPORT(rig);
+    int retcode = RIG_OK;
+
+    pthread_mutex_lock(&rs->ptt_mutex);
+
+    switch (pttp->type.ptt)
+    {
+    case RIG_PTT_SERIAL_DTR:
+    case RIG_PTT_SERIAL_RTS:
+
+        /* we want to free the port when PTT is reset and seize the port
+           when PTT is set, this allows limited sharing of the PTT port
+           between applications so long as there is no contention */
+        if (pttp->fd < 0 && RIG_PTT_OFF != ptt)
+        {
+            retcode = rig_ptt_line_open(pttp);
+        }
+
+        if (RIG_OK == retcode)
+        {
+            retcode = pttp->type.ptt == RIG_PTT_SERIAL_DTR ?
+                      ser_set_dtr(pttp, ptt != RIG_PTT_OFF) :
+                      ser_set_rts(pttp, ptt != RIG_PTT_OFF);
+        }
+
+        if (ptt == RIG_PTT_OFF && rs->ptt_share != 0 && pttp->fd >= 0)
+        {
+            /* free the port */
+            ser_close(pttp);
+        }
+
+        break;
+
+    case RIG_PTT_PARALLEL:
+        retcode = par_ptt_set(pttp, ptt);
+        break;
+
+    case RIG_PTT_CM108:
+        retcode = cm108_ptt_set(pttp, ptt);
+        break;
+
+    default:
+        retcode = gpio_ptt_set(pttp, ptt);
+    }
+
+    // a failed switch leaves the line, and so the cache, as it was
+    if (RIG_OK == retcode)
+    {
+        rs->transmit = ptt != RIG_PTT_OFF;
+
+        pthread_mutex_lock(&rs->state_mutex);
+        cachep->ptt = ptt;
+        elapsed_ms(&cachep->time_ptt, HAMLIB_ELAPSED_SET);
+        pthread_mutex_unlock(&rs->state_mutex);
+    }
+
+    pthread_mutex_unlock(&rs->ptt_mutex);
+
+    rig_debug(RIG_DEBUG_VERBOSE, "%s: PTT %d on \"%s\": %s\n", __func__, ptt,
+              pttp->pathname, rigerror(retcode));
+
+    if (RIG_OK == retcode)
+    {
+        rig_cache_notify(rig);
+    }
+
+    // some rigs like the FT-2000 with the SCU-17 need just a bit of time to let the relays work
+    if (ptt != RIG_PTT_ON) { hl_usleep(50 * 1000); }
+
+    if (rs->post_ptt_delay > 0) { hl_usleep(rs->post_ptt_delay * 1000); }
+
+    return retcode;
+}
+
+
 /**
  * \brief set PTT on/off
  * \param rig   The rig handle
@@ -3622,7 +4018,7 @@ int HAMLIB_API rig_set_ptt(RIG *rig, vfo_t vfo, ptt_t ptt)
 {
     const struct rig_caps *caps;
     struct rig_state *rs;
-    hamlib_port_t *rp, *pttp;
+    hamlib_port_t *pttp;
     struct rig_cache *cachep;
     int retcode = RIG_OK;
 
@@ -3632,13 +4028,17 @@ int HAMLIB_API rig_set_ptt(RIG *rig, vfo_t vfo, ptt_t ptt)
         return -RIG_EINVAL;
     }
 
+    if (rig_ptt_line_separate(rig))
+    {
+        return rig_set_ptt_line(rig, ptt);
+    }
+
     ELAPSED1;
     ENTERFUNC;
 
     caps = rig->caps;
     rs = STATE(rig);
     cachep = CACHE(rig);
-    rp = RIGPORT(rig);
     pttp = PTTPORT(rig);
 
     LOCK(1);
@@ -3785,121 +4185,13 @@ int HAMLIB_API rig_set_ptt(RIG *rig, vfo_t vfo, ptt_t ptt)
 
         break;
 
+    // a PTT line on a port of its own takes rig_set_ptt_line()
     case RIG_PTT_SERIAL_DTR:
-
-        /* when the PTT port is not the control port we want to free the
-           port when PTT is reset and seize the port when PTT is set,
-           this allows limited sharing of the PTT port between
-           applications so long as there is no contention */
-        if (strcmp(pttp->pathname, rp->pathname)
-                && pttp->fd < 0
-                && RIG_PTT_OFF != ptt)
-        {
-
-            pttp->fd = ser_open(pttp);
-
-            if (pttp->fd < 0)
-            {
-                rig_debug(RIG_DEBUG_ERR,
-                          "%s: cannot open PTT device \"%s\"\n",
-                          __func__,
-                          pttp->pathname);
-                ELAPSED2;
-                LOCK(0);
-                RETURNFUNC(-RIG_EIO);
-            }
-
-            /* Needed on Linux because the serial port driver sets RTS/DTR
-               high on open - set both since we offer no control of
-               the non-PTT line and low is better than high */
-            retcode = ser_set_rts(pttp, 0);
-
-            if (RIG_OK != retcode)
-            {
-                ELAPSED2;
-                LOCK(0);
-                RETURNFUNC(retcode);
-            }
-        }
-
         retcode = ser_set_dtr(pttp, ptt != RIG_PTT_OFF);
-
-        rig_debug(RIG_DEBUG_TRACE, "%s:  rigport=%s, pttport=%s, ptt_share=%d\n",
-                  __func__, rp->pathname, pttp->pathname, rs->ptt_share);
-
-        if (strcmp(pttp->pathname, rp->pathname)
-                && ptt == RIG_PTT_OFF && rs->ptt_share != 0)
-        {
-            /* free the port */
-            ser_close(pttp);
-        }
-
         break;
 
     case RIG_PTT_SERIAL_RTS:
-
-        /* when the PTT port is not the control port we want to free the
-           port when PTT is reset and seize the port when PTT is set,
-           this allows limited sharing of the PTT port between
-           applications so long as there is no contention */
-        if (strcmp(pttp->pathname, rp->pathname)
-                && pttp->fd < 0
-                && RIG_PTT_OFF != ptt)
-        {
-            rig_debug(RIG_DEBUG_TRACE, "%s: PTT RTS debug#1\n", __func__);
-
-            pttp->fd = ser_open(pttp);
-
-            if (pttp->fd < 0)
-            {
-                rig_debug(RIG_DEBUG_ERR,
-                          "%s: cannot open PTT device \"%s\"\n",
-                          __func__,
-                          pttp->pathname);
-                ELAPSED2;
-                LOCK(0);
-                RETURNFUNC(-RIG_EIO);
-            }
-
-            /* Needed on Linux because the serial port driver sets RTS/DTR
-               high on open - set both since we offer no control of the
-               non-PTT line and low is better than high */
-            retcode = ser_set_dtr(pttp, 0);
-
-            if (RIG_OK != retcode)
-            {
-                rig_debug(RIG_DEBUG_ERR, "%s: ser_set_dtr retcode=%d\n", __func__, retcode);
-                ELAPSED2;
-                LOCK(0);
-                RETURNFUNC(retcode);
-            }
-        }
-
         retcode = ser_set_rts(pttp, ptt != RIG_PTT_OFF);
-
-        rig_debug(RIG_DEBUG_TRACE, "%s:  rigport=%s, pttport=%s, ptt_share=%d\n",
-                  __func__, rp->pathname, pttp->pathname, rs->ptt_share);
-
-        if (strcmp(pttp->pathname, rp->pathname)
-                && ptt == RIG_PTT_OFF && rs->ptt_share != 0)
-        {
-            /* free the port */
-            ser_close(pttp);
-        }
-
-        break;
-
-    case RIG_PTT_PARALLEL:
-        retcode = par_ptt_set(pttp, ptt);
-        break;
-
-    case RIG_PTT_CM108:
-        retcode = cm108_ptt_set(pttp, ptt);
-        break;
-
-    case RIG_PTT_GPIO:
-    case RIG_PTT_GPION:
-        retcode = gpio_ptt_set(pttp, ptt);
         break;
 
     case RIG_PTT_NONE:
@@ -3926,6 +4218,7 @@ int HAMLIB_API rig_set_ptt(RIG *rig, vfo_t vfo, ptt_t ptt)
 
     cachep->ptt = ptt;
     elapsed_ms(&cachep->time_ptt, HAMLIB_ELAPSED_SET);
+    rig_cache_notify(rig);
 
     if (retcode != RIG_OK) { rig_debug(RIG_DEBUG_ERR, "%s: Return code=%d\n", __func__, retcode); }
 
@@ -4001,6 +4294,34 @@ int HAMLIB_API rig_get_ptt(RIG *rig, vfo_t vfo, ptt_t *ptt)
 
     caps = rig->caps;
 
+    // a serial PTT line on a port of its own is read without the CAT lock
+    if (rig_ptt_line_separate(rig) && (pttp->type.ptt == RIG_PTT_SERIAL_RTS
+                                       || pttp->type.ptt == RIG_PTT_SERIAL_DTR))
+    {
+        pthread_mutex_lock(&rs->ptt_mutex);
+
+        if (pttp->fd < 0)
+        {
+            /* port is closed so assume PTT off */
+            *ptt = RIG_PTT_OFF;
+        }
+        else
+        {
+            retcode = pttp->type.ptt == RIG_PTT_SERIAL_RTS ?
+                      ser_get_rts(pttp, &status) : ser_get_dtr(pttp, &status);
+            *ptt = status ? RIG_PTT_ON : RIG_PTT_OFF;
+        }
+
+        pthread_mutex_lock(&rs->state_mutex);
+        cachep->ptt = *ptt;
+        elapsed_ms(&cachep->time_ptt, HAMLIB_ELAPSED_SET);
+        pthread_mutex_unlock(&rs->state_mutex);
+
+        pthread_mutex_unlock(&rs->ptt_mutex);
+        ELAPSED2;
+        RETURNFUNC(retcode);
+    }
+
     LOCK(1);
 
     switch (pttp->type.ptt)
@@ -4263,6 +4584,41 @@ int HAMLIB_API rig_get_ptt(RIG *rig, vfo_t vfo, ptt_t *ptt)
 }
 
 
+/* A DCD line is read under dcd_mutex, or under the CAT lock when it is a
+ * line of the CAT port
+ */
+static void rig_dcd_line_lock(RIG *rig, int lock)
+{
+    const hamlib_port_t *dcdp = DCDPORT(rig);
+    pthread_mutex_t *mutex = &STATE(rig)->dcd_mutex;
+
+    switch (dcdp->type.dcd)
+    {
+    case RIG_DCD_SERIAL_CTS:
+    case RIG_DCD_SERIAL_DSR:
+    case RIG_DCD_SERIAL_CAR:
+        if (!strcmp(dcdp->pathname, RIGPORT(rig)->pathname))
+        {
+            mutex = &STATE(rig)->api_mutex;
+        }
+
+        break;
+
+    default:
+        break;
+    }
+
+    if (lock)
+    {
+        pthread_mutex_lock(mutex);
+    }
+    else
+    {
+        pthread_mutex_unlock(mutex);
+    }
+}
+
+
 /**
  * \brief get the status of the DCD
  * \param rig   The rig handle
@@ -4312,18 +4668,22 @@ int HAMLIB_API rig_get_dcd(RIG *rig, vfo_t vfo, dcd_t *dcd)
             RETURNFUNC(-RIG_ENIMPL);
         }
 
+        LOCK(1);
+
         if (vfo == RIG_VFO_CURR
                 || vfo == rs->current_vfo)
         {
             HAMLIB_TRACE;
             retcode = caps->get_dcd(rig, vfo, dcd);
             ELAPSED2;
+            LOCK(0);
             RETURNFUNC(retcode);
         }
 
         if (!caps->set_vfo)
         {
             ELAPSED2;
+            LOCK(0);
             RETURNFUNC(-RIG_ENAVAIL);
         }
 
@@ -4334,6 +4694,7 @@ int HAMLIB_API rig_get_dcd(RIG *rig, vfo_t vfo, dcd_t *dcd)
         if (retcode != RIG_OK)
         {
             ELAPSED2;
+            LOCK(0);
             RETURNFUNC(retcode);
         }
 
@@ -4349,37 +4710,48 @@ int HAMLIB_API rig_get_dcd(RIG *rig, vfo_t vfo, dcd_t *dcd)
         }
 
         ELAPSED2;
+        LOCK(0);
         RETURNFUNC(retcode);
 
         break;
 
     case RIG_DCD_SERIAL_CTS:
+        rig_dcd_line_lock(rig, 1);
         retcode = ser_get_cts(dcdp, &status);
+        rig_dcd_line_lock(rig, 0);
         *dcd = status ? RIG_DCD_ON : RIG_DCD_OFF;
         ELAPSED2;
         RETURNFUNC(retcode);
 
     case RIG_DCD_SERIAL_DSR:
+        rig_dcd_line_lock(rig, 1);
         retcode = ser_get_dsr(dcdp, &status);
+        rig_dcd_line_lock(rig, 0);
         *dcd = status ? RIG_DCD_ON : RIG_DCD_OFF;
         ELAPSED2;
         RETURNFUNC(retcode);
 
     case RIG_DCD_SERIAL_CAR:
+        rig_dcd_line_lock(rig, 1);
         retcode = ser_get_car(dcdp, &status);
+        rig_dcd_line_lock(rig, 0);
         *dcd = status ? RIG_DCD_ON : RIG_DCD_OFF;
         ELAPSED2;
         RETURNFUNC(retcode);
 
 
     case RIG_DCD_PARALLEL:
+        rig_dcd_line_lock(rig, 1);
         retcode = par_dcd_get(dcdp, dcd);
+        rig_dcd_line_lock(rig, 0);
         ELAPSED2;
         RETURNFUNC(retcode);
 
     case RIG_DCD_GPIO:
     case RIG_DCD_GPION:
+        rig_dcd_line_lock(rig, 1);
         retcode = gpio_dcd_get(dcdp, dcd);
+        rig_dcd_line_lock(rig, 0);
         ELAPSED2;
         RETURNFUNC(retcode);
 
@@ -5893,6 +6265,7 @@ int HAMLIB_API rig_set_split_vfo(RIG *rig,
         }
 
         elapsed_ms(&cachep->time_split, HAMLIB_ELAPSED_SET);
+        rig_cache_notify(rig);
         ELAPSED2;
         RETURNFUNC(retcode);
     }
@@ -5963,6 +6336,7 @@ int HAMLIB_API rig_set_split_vfo(RIG *rig,
     }
 
     elapsed_ms(&cachep->time_split, HAMLIB_ELAPSED_SET);
+    rig_cache_notify(rig);
     ELAPSED2;
     RETURNFUNC(retcode);
 }
@@ -8013,6 +8387,7 @@ int HAMLIB_API rig_get_rig_info(RIG *rig, char *response, int max_response_len)
     int ret;
     int rxa, txa, rxb, txb;
     struct rig_cache *cachep;
+    struct rig_vfo_snapshot snapshot;
 
     if (CHECK_RIG_ARG(rig) || !response)
     {
@@ -8026,9 +8401,8 @@ int HAMLIB_API rig_get_rig_info(RIG *rig, char *response, int max_response_len)
     ELAPSED1;
     ENTERFUNC2;
 
-    vfoA = vfo_fixup(rig, RIG_VFO_A, cachep->split);
-    vfoB = vfo_fixup(rig, RIG_VFO_B, cachep->split);
-    ret = rig_get_vfo_info(rig, vfoA, &freqA, &modeA, &widthA, &split, &satmode);
+    // one snapshot reads both VFOs without swapping them
+    ret = rig_get_vfo_snapshot(rig, &snapshot);
 
     if (ret != RIG_OK)
     {
@@ -8036,26 +8410,16 @@ int HAMLIB_API rig_get_rig_info(RIG *rig, char *response, int max_response_len)
         RETURNFUNC2(ret);
     }
 
-    // we need both vfo and mode targetable to avoid vfo swapping
-    if ((rig->caps->targetable_vfo & RIG_TARGETABLE_FREQ)
-            && (rig->caps->targetable_vfo & RIG_TARGETABLE_MODE))
-    {
-        ret = rig_get_vfo_info(rig, vfoB, &freqB, &modeB, &widthB, &split, &satmode);
-
-        if (ret != RIG_OK)
-        {
-            ELAPSED2;
-            RETURNFUNC2(ret);
-        }
-    }
-    else
-    {
-        // we'll use cached info instead of doing the vfo swapping
-        int cache_ms_freq, cache_ms_mode, cache_ms_width;
-        rig_get_cache(rig, vfoB, &freqB, &cache_ms_freq, &modeB, &cache_ms_mode,
-                      &widthB,
-                      &cache_ms_width);
-    }
+    vfoA = snapshot.vfos[0].vfo;
+    freqA = snapshot.vfos[0].freq;
+    modeA = snapshot.vfos[0].mode;
+    widthA = snapshot.vfos[0].width;
+    vfoB = snapshot.vfos[1].vfo;
+    freqB = snapshot.vfos[1].freq;
+    modeB = snapshot.vfos[1].mode;
+    widthB = snapshot.vfos[1].width;
+    split = snapshot.split;
+    satmode = cachep->satmode;
 
     modeAstr = (char *)rig_strrmode(modeA);
     modeBstr = (char *)rig_strrmode(modeB);
@@ -8443,6 +8807,24 @@ HAMLIB_EXPORT(void) sync_callback(int lock)
 }
 #endif
 
+/* Lock hierarchy of a rig, outermost first:
+ *
+ *  api_mutex    Taken by rig_lock() and the LOCK() macro for the whole of
+ *               a frontend call that talks to the rig, so it is the
+ *               transaction lock of the CAT port and of any PTT or DCD
+ *               line on the CAT port. Recursive, frontend functions call
+ *               each other.
+ *  ptt_mutex    PTT line on a port of its own, held while the line is
+ *               switched or read, see rig_set_ptt_line()
+ *  dcd_mutex    DCD line on a port of its own, held while the line is read
+ *  state_mutex  Cache entries, held by rig_set_cache_freq() and friends
+ *               while they copy fields. No I/O is done and no other lock
+ *               is taken while holding it.
+ *
+ * A lock may be taken while holding one above it, never the other way
+ * round, and the two line locks are not nested. A PTT or DCD line on a
+ * port of its own thus works while a CAT transaction is in progress.
+ */
 void rig_lock(RIG *rig, int lock)
 {
 
@@ -8496,11 +8878,13 @@ static int async_data_handler_start(RIG *rig)
     async_data_handler_priv = (async_data_handler_priv_data *)
                               rs->async_data_handler_priv_data;
     async_data_handler_priv->args.rig = rig;
+    RIGPORT(rig)->asyncio = 1;
     int err = pthread_create(&async_data_handler_priv->thread_id, NULL,
                              async_data_handler, &async_data_handler_priv->args);
 
     if (err)
     {
+        RIGPORT(rig)->asyncio = 0;
         rig_debug(RIG_DEBUG_ERR, "%s: pthread_create error: %s\n", __func__,
                   strerror(errno));
         RETURNFUNC(-RIG_EINTERNAL);
@@ -8579,6 +8963,9 @@ static int async_data_handler_stop(RIG *rig)
             async_data_handler_priv->thread_id = 0;
         }
 
+        // the backend's rig_close() talks to the rig directly again
+        RIGPORT(rig)->asyncio = 0;
+
         free(rs->async_data_handler_priv_data);
         rs->async_data_handler_priv_data = NULL;
     }
@@ -8652,9 +9039,8 @@ static void *async_data_handler(void *arg)
     rig_debug(RIG_DEBUG_VERBOSE, "%s: Starting async data handler thread\n",
               __func__);
 
-    // TODO: check how to enable "transceive" on recent Kenwood/Yaesu rigs
-    // TODO: add initial support for async in Kenwood kenwood_transaction (+one) functions -> add transaction_active flag usage
-    // TODO: add initial support for async in Yaesu newcat_get_cmd/set_cmd (+validate) functions -> add transaction_active flag usage
+    // Frames answering a pending transaction go to the sync pipe, see the
+    // is_async_frame of the Icom, Kenwood and newcat backends
 
     while (rs->async_data_handler_thread_run)
     {
@@ -0,0 +1,354 @@
+/*
+ *  Hamlib Interface - parallel operations on a group of rigs
+ *  Copyright (c) 2000-2025 The Hamlib Group
+ *
+ *
+ *   This library is free software; you can redistribute it and/or
+ *   modify it under the terms of the GNU Lesser General Public
+ *   License as published by the Free Software Foundation; either
+ *   version 2.1 of the License, or (at your option) any later version.
+ *
+ *   This library is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *   Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public
+ *   License along with this library; if not, write to the Free Software
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+/* SPDX-License-Identifier: LGPL-2.1-or-later */
+
+/**
+ * \addtogroup rig
+ * @{
+ */
+
+/**
+ * \file rig_group.c
+ * \brief Parallel operations on a group of rigs
+ *
+ * A station with several rigs, e.g. SO2R, often does the same thing on all
+ * of them: QSY to a band plan, read the frequencies, drop PTT. Run one
+ * after the other the calls take the sum of the link latencies.
+ * rig_group_run() hands one request to the rig_submit() worker of each rig
+ * and waits for all of them, which takes the latency of the slowest link.
+ * Each rig keeps its own lock, the group adds none around the rigs.
+ */
+
+#include "hamlib/config.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+
+#include <pthread.h>
+
+#include "hamlib/rig.h"
+#include "misc.h"
+
+typedef struct rig_group_member_s
+{
+    RIG_GROUP *group;
+    RIG *rig;
+    int id;             /* request of the current run, 0 if none */
+    int done;
+    struct rig_request result;
+} rig_group_member;
+
+struct rig_group
+{
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    int inflight;       /* callbacks still to come, including abandoned runs */
+    int count;
+    int size;
+    rig_group_member **members;
+};
+
+static void rig_group_done(RIG *rig, struct rig_request *req, rig_ptr_t arg)
+{
+    rig_group_member *member = (rig_group_member *) arg;
+    RIG_GROUP *group = member->group;
+
+    pthread_mutex_lock(&group->mutex);
+
+    // a request left behind by a run that timed out is dropped
+    if (req->id == member->id)
+    {
+        member->result = *req;
+        member->done = 1;
+    }
+
+    group->inflight--;
+    pthread_cond_broadcast(&group->cond);
+
+    pthread_mutex_unlock(&group->mutex);
+}
+
+/**
+ * \brief create an empty rig group
+ *
+ * \return the new group, or NULL if out of memory.
+ *
+ * \sa rig_group_add(), rig_group_run(), rig_group_destroy()
+ */
+RIG_GROUP * HAMLIB_API rig_group_create(void)
+{
+    RIG_GROUP *group = calloc(1, sizeof(RIG_GROUP));
+
+    if (group == NULL)
+    {
+        return NULL;
+    }
+
+    pthread_mutex_init(&group->mutex, NULL);
+    pthread_cond_init(&group->cond, NULL);
+
+    return group;
+}
+
+/**
+ * \brief add a rig to a group
+ * \param group  The group
+ * \param rig    The rig handle, opened before the group is run
+ *
+ * The rig gets the next index, starting at 0, which is the index of its
+ * request in rig_group_run().
+ *
+ * \return the index of the rig in the group, or a negative value if an
+ * error occurred.
+ */
+int HAMLIB_API rig_group_add(RIG_GROUP *group, RIG *rig)
+{
+    rig_group_member *member;
+
+    if (!group || !rig)
+    {
+        return -RIG_EINVAL;
+    }
+
+    if (group->count == group->size)
+    {
+        int size = group->size ? group->size * 2 : 4;
+        rig_group_member **members = realloc(group->members,
+                                             size * sizeof(rig_group_member *));
+
+        if (members == NULL)
+        {
+            return -RIG_ENOMEM;
+        }
+
+        group->members = members;
+        group->size = size;
+    }
+
+    // members are not moved, the callbacks point at them
+    member = calloc(1, sizeof(rig_group_member));
+
+    if (member == NULL)
+    {
+        return -RIG_ENOMEM;
+    }
+
+    member->group = group;
+    member->rig = rig;
+    group->members[group->count] = member;
+
+    return group->count++;
+}
+
+/**
+ * \brief number of rigs in a group
+ * \param group  The group
+ *
+ * \return the number of rigs, or a negative value if an error occurred.
+ */
+int HAMLIB_API rig_group_count(const RIG_GROUP *group)
+{
+    if (!group)
+    {
+        return -RIG_EINVAL;
+    }
+
+    return group->count;
+}
+
+/**
+ * \brief run one request on every rig of a group concurrently
+ * \param group      The group
+ * \param requests   One request per rig, in the order the rigs were added.
+ * Results are stored in place.
+ * \param timeout_ms Overall deadline, 0 to wait as long as it takes
+ *
+ *  The requests are submitted with rig_submit() so each rig runs its own on
+ *  its worker thread, and the call returns when all have completed or the
+ *  deadline has passed. The request of a rig that has not completed by
+ *  then gets -RIG_ETIMEOUT; it is cancelled if it has not started yet.
+ *
+ *  The requests may differ between rigs, e.g. the frequencies of a band
+ *  plan, or be copies of one, e.g. RIG_REQ_SET_PTT with RIG_PTT_OFF.
+ *
+ * \return RIG_OK if all the requests succeeded, otherwise the first error
+ * found, with the \a retcode field of each request holding its result.
+ *
+ * \sa rig_submit(), rig_group_add()
+ */
+int HAMLIB_API rig_group_run(RIG_GROUP *group, struct rig_request *requests,
+                             int timeout_ms)
+{
+    struct timespec deadline;
+    int retcode = RIG_OK;
+    int pending = 0;
+    int i;
+
+    if (!group || !requests || timeout_ms < 0)
+    {
+        return -RIG_EINVAL;
+    }
+
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_sec += timeout_ms / 1000;
+    deadline.tv_nsec += (long)(timeout_ms % 1000) * 1000000L;
+
+    if (deadline.tv_nsec >= 1000000000L)
+    {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000L;
+    }
+
+    pthread_mutex_lock(&group->mutex);
+
+    for (i = 0; i < group->count; i++)
+    {
+        rig_group_member *member = group->members[i];
+        int id;
+
+        member->done = 0;
+        member->id = 0;
+        group->inflight++;
+
+        // the callback waits for the mutex, so it sees the id set below
+        id = rig_submit(member->rig, &requests[i], timeout_ms, rig_group_done,
+                        member);
+
+        if (id < 0)
+        {
+            group->inflight--;
+            requests[i].retcode = id;
+            member->done = 1;
+            continue;
+        }
+
+        member->id = id;
+        pending++;
+    }
+
+    for (;;)
+    {
+        int waiting = 0;
+
+        for (i = 0; i < group->count; i++)
+        {
+            rig_group_member *member = group->members[i];
+
+            if (!member->done && member->id != 0)
+            {
+                waiting++;
+            }
+        }
+
+        if (waiting == 0)
+        {
+            break;
+        }
+
+        if (timeout_ms == 0)
+        {
+            pthread_cond_wait(&group->cond, &group->mutex);
+        }
+        else if (pthread_cond_timedwait(&group->cond, &group->mutex,
+                                        &deadline) == ETIMEDOUT)
+        {
+            break;
+        }
+    }
+
+    for (i = 0; i < group->count; i++)
+    {
+        rig_group_member *member = group->members[i];
+
+        if (member->id == 0)
+        {
+            continue;
+        }
+
+        if (member->done)
+        {
+            requests[i] = member->result;
+        }
+        else
+        {
+            rig_cancel(member->rig, member->id);
+            requests[i].retcode = -RIG_ETIMEOUT;
+            requests[i].id = member->id;
+        }
+
+        member->id = 0;
+    }
+
+    pthread_mutex_unlock(&group->mutex);
+
+    for (i = 0; i < group->count; i++)
+    {
+        if (requests[i].retcode != RIG_OK && retcode == RIG_OK)
+        {
+            retcode = requests[i].retcode;
+        }
+    }
+
+    rig_debug(RIG_DEBUG_VERBOSE, "%s: %d rigs, %d submitted: %s\n", __func__,
+              group->count, pending, rigerror(retcode));
+
+    return retcode;
+}
+
+/**
+ * \brief free a rig group
+ * \param group  The group
+ *
+ * Waits for the requests of runs that timed out to complete. The rigs are
+ * not closed.
+ */
+void HAMLIB_API rig_group_destroy(RIG_GROUP *group)
+{
+    int i;
+
+    if (!group)
+    {
+        return;
+    }
+
+    pthread_mutex_lock(&group->mutex);
+
+    while (group->inflight > 0)
+    {
+        pthread_cond_wait(&group->cond, &group->mutex);
+    }
+
+    pthread_mutex_unlock(&group->mutex);
+
+    for (i = 0; i < group->count; i++)
+    {
+        free(group->members[i]);
+    }
+
+    free(group->members);
+    pthread_cond_destroy(&group->cond);
+    pthread_mutex_destroy(&group->mutex);
+    free(group);
+}
+
+/** @} */
@@ -1099,8 +1099,6 @@ int HAMLIB_API ser_set_rts(hamlib_port_t *p, int state)
     unsigned int y = TIOCM_RTS;
     int rc;
 
-    rig_debug(RIG_DEBUG_VERBOSE, "%s: RTS=%d\n", __func__, state);
-
     // ignore this for microHam ports
     if (p->fd == uh_ptt_fd || p->fd == uh_radio_fd)
     {
@@ -1137,6 +1135,9 @@ int HAMLIB_API ser_set_rts(hamlib_port_t *p, int state)
         return (-RIG_EIO);
     }
 
+    // logged after the edge, PTT timing depends on it
+    rig_debug(RIG_DEBUG_VERBOSE, "%s: RTS=%d\n", __func__, state);
+
     return (RIG_OK);
 }
 
@@ -1175,8 +1176,6 @@ int HAMLIB_API ser_set_dtr(hamlib_port_t *p, int state)
     unsigned int y = TIOCM_DTR;
     int rc;
 
-    rig_debug(RIG_DEBUG_VERBOSE, "%s: DTR=%d\n", __func__, state);
-
     // silently ignore on microHam RADIO channel,
     // but (un)set ptt on microHam PTT channel.
     if (p->fd == uh_radio_fd)
@@ -1220,6 +1219,9 @@ int HAMLIB_API ser_set_dtr(hamlib_port_t *p, int state)
         return (-RIG_EIO);
     }
 
+    // logged after the edge, PTT timing depends on it
+    rig_debug(RIG_DEBUG_VERBOSE, "%s: DTR=%d\n", __func__, state);
+
     return (RIG_OK);
 }
 
@@ -7,6 +7,7 @@
 #include "misc.h"
 #include "cache.h"
 #include "snapshot_data.h"
+#include "network_cmd.h"
 #include "hamlibdatetime.h"
 #include "sprintflst.h"
 
@@ -198,13 +199,65 @@ error:
     RETURNFUNC2(-RIG_EINTERNAL);
 }
 
+static int snapshot_serialize_spectrum_signals(cJSON *spectrum_node,
+        const struct rig_spectrum_signals *signals)
+{
+    cJSON *signals_array, *signal_node;
+    cJSON *node;
+    int i;
+
+    node = cJSON_AddNumberToObject(spectrum_node, "noiseFloor",
+                                   signals->noise_floor_db);
+
+    if (node == NULL)
+    {
+        goto error;
+    }
+
+    signals_array = cJSON_AddArrayToObject(spectrum_node, "signals");
+
+    if (signals_array == NULL)
+    {
+        goto error;
+    }
+
+    for (i = 0; i < signals->count; i++)
+    {
+        const struct rig_spectrum_signal *signal = &signals->signals[i];
+
+        signal_node = cJSON_CreateObject();
+
+        if (signal_node == NULL)
+        {
+            goto error;
+        }
+
+        cJSON_AddItemToArray(signals_array, signal_node);
+
+        if (cJSON_AddNumberToObject(signal_node, "freq", signal->freq) == NULL
+                || cJSON_AddNumberToObject(signal_node, "bandwidth", signal->bandwidth) == NULL
+                || cJSON_AddNumberToObject(signal_node, "peak", signal->peak_db) == NULL
+                || cJSON_AddNumberToObject(signal_node, "snr", signal->snr_db) == NULL)
+        {
+            goto error;
+        }
+    }
+
+    return RIG_OK;
+
+error:
+    RETURNFUNC2(-RIG_EINTERNAL);
+}
+
 static int snapshot_serialize_spectrum(cJSON *spectrum_node, RIG *rig,
-                                       struct rig_spectrum_line *spectrum_line)
+                                       struct rig_spectrum_line *spectrum_line,
+                                       const struct rig_spectrum_signals *signals)
 {
     // Spectrum data is represented as a hexadecimal ASCII string where each data byte is represented as 2 ASCII letters
     char spectrum_data_string[HAMLIB_MAX_SPECTRUM_DATA * 2];
     cJSON *node;
     int i;
+    int result;
     struct rig_spectrum_scope *scopes = rig->caps->spectrum_scopes;
     char *name = "?";
 
@@ -319,19 +372,130 @@ static int snapshot_serialize_spectrum(cJSON *spectrum_node, RIG *rig,
         goto error;
     }
 
+    if (signals)
+    {
+        result = snapshot_serialize_spectrum_signals(spectrum_node, signals);
+
+        if (result != RIG_OK)
+        {
+            goto error;
+        }
+    }
+
     return RIG_OK;
 
 error:
     RETURNFUNC2(-RIG_EINTERNAL);
 }
 
+static int snapshot_serialize_command(cJSON *command_node,
+                                      const network_cmd *cmd)
+{
+    cJSON *node;
+    const char *status = "OK";
+
+    if (cmd->superseded)
+    {
+        status = "Superseded";
+    }
+    else if (cmd->status != RIG_OK)
+    {
+        status = "Error";
+    }
+
+    node = cJSON_AddStringToObject(command_node, "id", cmd->id);
+
+    if (node == NULL)
+    {
+        goto error;
+    }
+
+    node = cJSON_AddStringToObject(command_node, "command", cmd->command);
+
+    if (node == NULL)
+    {
+        goto error;
+    }
+
+    node = cJSON_AddStringToObject(command_node, "status", status);
+
+    if (node == NULL)
+    {
+        goto error;
+    }
+
+    node = cJSON_AddNumberToObject(command_node, "error", cmd->status);
+
+    if (node == NULL)
+    {
+        goto error;
+    }
+
+    return RIG_OK;
+
+error:
+    RETURNFUNC2(-RIG_EINTERNAL);
+}
+
+/* Acknowledge the multicast commands executed since the previous snapshot:
+ * "lastCommand" as described in README.multicast, "commands" for the whole batch */
+static int snapshot_serialize_commands(cJSON *root_node, RIG *rig)
+{
+    network_cmd acks[NETWORK_CMD_BATCH_MAX];
+    cJSON *commands_array, *command_node;
+    int count;
+    int i;
+
+    count = network_cmd_take_acks(rig, acks, NETWORK_CMD_BATCH_MAX);
+
+    if (count == 0)
+    {
+        return RIG_OK;
+    }
+
+    command_node = cJSON_AddObjectToObject(root_node, "lastCommand");
+
+    if (command_node == NULL
+            || snapshot_serialize_command(command_node, &acks[count - 1]) != RIG_OK)
+    {
+        RETURNFUNC2(-RIG_EINTERNAL);
+    }
+
+    commands_array = cJSON_AddArrayToObject(root_node, "commands");
+
+    if (commands_array == NULL)
+    {
+        RETURNFUNC2(-RIG_EINTERNAL);
+    }
+
+    for (i = 0; i < count; i++)
+    {
+        command_node = cJSON_CreateObject();
+
+        if (command_node == NULL)
+        {
+            RETURNFUNC2(-RIG_EINTERNAL);
+        }
+
+        cJSON_AddItemToArray(commands_array, command_node);
+
+        if (snapshot_serialize_command(command_node, &acks[i]) != RIG_OK)
+        {
+            RETURNFUNC2(-RIG_EINTERNAL);
+        }
+    }
+
+    return RIG_OK;
+}
+
 void snapshot_init()
 {
     snprintf(snapshot_data_pid, sizeof(snapshot_data_pid), "%d", getpid());
 }
 
 int snapshot_serialize(size_t buffer_length, char *buffer, RIG *rig,
-                       struct rig_spectrum_line *spectrum_line)
+                       struct rig_spectrum_line *spectrum_line,
+                       const struct rig_spectrum_signals *signals)
 {
     cJSON *root_node;
     cJSON *rig_node, *vfos_array, *vfo_node, *spectra_array, *spectrum_node;
@@ -446,7 +610,8 @@ int snapshot_serialize(size_t buffer_length, char *buffer, RIG *rig,
         }
 
         spectrum_node = cJSON_CreateObject();
-        result = snapshot_serialize_spectrum(spectrum_node, rig, spectrum_line);
+        result = snapshot_serialize_spectrum(spectrum_node, rig, spectrum_line,
+                                             signals);
 
         if (result != RIG_OK)
         {
@@ -459,6 +624,13 @@ int snapshot_serialize(size_t buffer_length, char *buffer, RIG *rig,
         cJSON_AddItemToObject(root_node, "spectra", spectra_array);
     }
 
+    result = snapshot_serialize_commands(root_node, rig);
+
+    if (result != RIG_OK)
+    {
+        goto error;
+    }
+
     bool_result = cJSON_PrintPreallocated(root_node, buffer, (int) buffer_length,
                                           0);
 
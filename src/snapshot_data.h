@@ -2,6 +2,7 @@
 #define _SNAPSHOT_DATA_H
 
 void snapshot_init();
-int snapshot_serialize(size_t buffer_length, char *buffer, RIG *rig, struct rig_spectrum_line *spectrum_line);
+int snapshot_serialize(size_t buffer_length, char *buffer, RIG *rig, struct rig_spectrum_line *spectrum_line,
+                       const struct rig_spectrum_signals *signals);
 
 #endif
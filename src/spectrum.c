@@ -0,0 +1,1159 @@
+/*
+ *  Hamlib Interface - spectrum line post-processing
+ *  Copyright (c) 2000-2025 The Hamlib Group
+ *
+ *
+ *   This library is free software; you can redistribute it and/or
+ *   modify it under the terms of the GNU Lesser General Public
+ *   License as published by the Free Software Foundation; either
+ *   version 2.1 of the License, or (at your option) any later version.
+ *
+ *   This library is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *   Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public
+ *   License along with this library; if not, write to the Free Software
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+/* SPDX-License-Identifier: LGPL-2.1-or-later */
+
+/**
+ * \addtogroup rig
+ * @{
+ */
+
+/**
+ * \file spectrum.c
+ * \brief Spectrum line post-processing
+ *
+ * Averaging, peak-hold, decimation and dB scaling of the spectrum lines
+ * delivered by rig_fire_spectrum_event(), so that every consumer does not
+ * have to implement them again.
+ *
+ * The kernels are selected at compile time: AVX2 when building with -mavx2
+ * (or -march=native on a capable CPU), SSE2 on any x86_64, NEON on ARM and a
+ * plain C implementation everywhere else.
+ */
+
+#include "hamlib/config.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#include <pthread.h>
+
+#include "hamlib/rig.h"
+#include "hamlib/rig_state.h"
+#include "spectrum.h"
+#include "misc.h"
+
+#if defined(__AVX2__)
+#  include <immintrin.h>
+#  define SPECTRUM_AVX2 1
+#  define SPECTRUM_SSE2 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#  include <emmintrin.h>
+#  define SPECTRUM_SSE2 1
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#  include <arm_neon.h>
+#  define SPECTRUM_NEON 1
+#endif
+
+#define SPECTRUM_PROC_MAX 16
+
+struct rig_spectrum_proc
+{
+    struct rig_spectrum_proc_config config;
+
+    int length;             /* output width of the current state, 0 if not primed */
+    int id;                 /* scope id and geometry the state belongs to */
+    freq_t center_freq;
+    freq_t span_freq;
+    freq_t low_edge_freq;
+    freq_t high_edge_freq;
+
+    struct timespec last_output;
+
+    float input[HAMLIB_MAX_SPECTRUM_DATA];
+    float decimated[HAMLIB_MAX_SPECTRUM_DATA];
+    float average[HAMLIB_MAX_SPECTRUM_DATA];
+    float peak[HAMLIB_MAX_SPECTRUM_DATA];
+    unsigned char data[HAMLIB_MAX_SPECTRUM_DATA];
+};
+
+typedef struct spectrum_slot_s
+{
+    struct rig_spectrum_proc_output output;
+    unsigned char data[HAMLIB_MAX_SPECTRUM_DATA];
+    float average[HAMLIB_MAX_SPECTRUM_DATA];
+    float peak[HAMLIB_MAX_SPECTRUM_DATA];
+    struct rig_spectrum_signals signals;
+} spectrum_slot;
+
+typedef struct spectrum_subscription_s
+{
+    RIG *rig;
+    spectrum_proc_cb_t cb;
+    rig_ptr_t arg;
+    pthread_t thread_id;
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    int run;
+    int pending;            /* slots[fill] holds a line not yet delivered */
+    int fill;               /* slot the async data handler writes to */
+    unsigned int dropped;   /* lines replaced before delivery */
+    spectrum_slot slots[2];
+} spectrum_subscription;
+
+typedef struct spectrum_proc_entry_s
+{
+    rig_spectrum_proc_t *proc;
+    spectrum_subscription *sub;     /* NULL if the callback is called directly */
+    spectrum_proc_cb_t cb;
+    rig_ptr_t arg;
+} spectrum_proc_entry;
+
+typedef struct spectrum_proc_priv_data_s
+{
+    pthread_mutex_t mutex;
+    spectrum_proc_entry entries[SPECTRUM_PROC_MAX];
+} spectrum_proc_priv_data;
+
+
+/*
+ * Kernels
+ */
+
+/* out[i] = in[i] * scale + offset */
+void spectrum_u8_to_float(float *out, const unsigned char *in, int n,
+                          float scale, float offset)
+{
+    int i = 0;
+
+#if defined(SPECTRUM_AVX2)
+    const __m256 vscale = _mm256_set1_ps(scale);
+    const __m256 voffset = _mm256_set1_ps(offset);
+
+    for (; i + 8 <= n; i += 8)
+    {
+        __m128i b = _mm_loadl_epi64((const __m128i *)(in + i));
+        __m256 f = _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(b));
+        _mm256_storeu_ps(out + i, _mm256_add_ps(_mm256_mul_ps(f, vscale), voffset));
+    }
+
+#elif defined(SPECTRUM_SSE2)
+    const __m128 vscale = _mm_set1_ps(scale);
+    const __m128 voffset = _mm_set1_ps(offset);
+    const __m128i zero = _mm_setzero_si128();
+
+    for (; i + 16 <= n; i += 16)
+    {
+        __m128i b = _mm_loadu_si128((const __m128i *)(in + i));
+        __m128i lo = _mm_unpacklo_epi8(b, zero);
+        __m128i hi = _mm_unpackhi_epi8(b, zero);
+        __m128 f0 = _mm_cvtepi32_ps(_mm_unpacklo_epi16(lo, zero));
+        __m128 f1 = _mm_cvtepi32_ps(_mm_unpackhi_epi16(lo, zero));
+        __m128 f2 = _mm_cvtepi32_ps(_mm_unpacklo_epi16(hi, zero));
+        __m128 f3 = _mm_cvtepi32_ps(_mm_unpackhi_epi16(hi, zero));
+        _mm_storeu_ps(out + i, _mm_add_ps(_mm_mul_ps(f0, vscale), voffset));
+        _mm_storeu_ps(out + i + 4, _mm_add_ps(_mm_mul_ps(f1, vscale), voffset));
+        _mm_storeu_ps(out + i + 8, _mm_add_ps(_mm_mul_ps(f2, vscale), voffset));
+        _mm_storeu_ps(out + i + 12, _mm_add_ps(_mm_mul_ps(f3, vscale), voffset));
+    }
+
+#elif defined(SPECTRUM_NEON)
+    const float32x4_t vscale = vdupq_n_f32(scale);
+    const float32x4_t voffset = vdupq_n_f32(offset);
+
+    for (; i + 8 <= n; i += 8)
+    {
+        uint16x8_t w = vmovl_u8(vld1_u8(in + i));
+        float32x4_t f0 = vcvtq_f32_u32(vmovl_u16(vget_low_u16(w)));
+        float32x4_t f1 = vcvtq_f32_u32(vmovl_u16(vget_high_u16(w)));
+        vst1q_f32(out + i, vmlaq_f32(voffset, f0, vscale));
+        vst1q_f32(out + i + 4, vmlaq_f32(voffset, f1, vscale));
+    }
+
+#endif
+
+    for (; i < n; i++)
+    {
+        out[i] = (float) in[i] * scale + offset;
+    }
+}
+
+/* out[i] = clamp((in[i] - offset) / scale, 0, 255), rounded */
+void spectrum_float_to_u8(unsigned char *out, const float *in, int n,
+                          float scale, float offset)
+{
+    float inv = scale != 0.0f ? 1.0f / scale : 1.0f;
+    int i = 0;
+
+#if defined(SPECTRUM_SSE2)
+    const __m128 vinv = _mm_set1_ps(inv);
+    const __m128 voffset = _mm_set1_ps(offset);
+    const __m128 vhalf = _mm_set1_ps(0.5f);
+    const __m128 vmin = _mm_setzero_ps();
+    const __m128 vmax = _mm_set1_ps(255.0f);
+
+    for (; i + 8 <= n; i += 8)
+    {
+        __m128 f0 = _mm_add_ps(_mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(in + i), voffset),
+                                          vinv), vhalf);
+        __m128 f1 = _mm_add_ps(_mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(in + i + 4), voffset),
+                                          vinv), vhalf);
+        f0 = _mm_min_ps(_mm_max_ps(f0, vmin), vmax);
+        f1 = _mm_min_ps(_mm_max_ps(f1, vmin), vmax);
+        __m128i w = _mm_packs_epi32(_mm_cvttps_epi32(f0), _mm_cvttps_epi32(f1));
+        _mm_storel_epi64((__m128i *)(out + i), _mm_packus_epi16(w, w));
+    }
+
+#elif defined(SPECTRUM_NEON)
+    const float32x4_t vinv = vdupq_n_f32(inv);
+    const float32x4_t voffset = vdupq_n_f32(offset);
+    const float32x4_t vhalf = vdupq_n_f32(0.5f);
+    const float32x4_t vmin = vdupq_n_f32(0.0f);
+    const float32x4_t vmax = vdupq_n_f32(255.0f);
+
+    for (; i + 8 <= n; i += 8)
+    {
+        float32x4_t f0 = vmlaq_f32(vhalf, vsubq_f32(vld1q_f32(in + i), voffset), vinv);
+        float32x4_t f1 = vmlaq_f32(vhalf, vsubq_f32(vld1q_f32(in + i + 4), voffset),
+                                   vinv);
+        f0 = vminq_f32(vmaxq_f32(f0, vmin), vmax);
+        f1 = vminq_f32(vmaxq_f32(f1, vmin), vmax);
+        uint16x8_t w = vcombine_u16(vmovn_u32(vcvtq_u32_f32(f0)),
+                                    vmovn_u32(vcvtq_u32_f32(f1)));
+        vst1_u8(out + i, vmovn_u16(w));
+    }
+
+#endif
+
+    for (; i < n; i++)
+    {
+        float f = (in[i] - offset) * inv + 0.5f;
+
+        if (f < 0.0f) { f = 0.0f; }
+
+        if (f > 255.0f) { f = 255.0f; }
+
+        out[i] = (unsigned char) f;
+    }
+}
+
+static float spectrum_reduce_max(const float *in, int n)
+{
+    float result = in[0];
+    int i = 0;
+
+#if defined(SPECTRUM_AVX2)
+
+    if (n >= 8)
+    {
+        __m256 vmax = _mm256_loadu_ps(in);
+
+        for (i = 8; i + 8 <= n; i += 8)
+        {
+            vmax = _mm256_max_ps(vmax, _mm256_loadu_ps(in + i));
+        }
+
+        __m128 m = _mm_max_ps(_mm256_castps256_ps128(vmax),
+                              _mm256_extractf128_ps(vmax, 1));
+        m = _mm_max_ps(m, _mm_movehl_ps(m, m));
+        m = _mm_max_ss(m, _mm_shuffle_ps(m, m, 1));
+        result = _mm_cvtss_f32(m);
+    }
+
+#elif defined(SPECTRUM_SSE2)
+
+    if (n >= 4)
+    {
+        __m128 m = _mm_loadu_ps(in);
+
+        for (i = 4; i + 4 <= n; i += 4)
+        {
+            m = _mm_max_ps(m, _mm_loadu_ps(in + i));
+        }
+
+        m = _mm_max_ps(m, _mm_movehl_ps(m, m));
+        m = _mm_max_ss(m, _mm_shuffle_ps(m, m, 1));
+        result = _mm_cvtss_f32(m);
+    }
+
+#elif defined(SPECTRUM_NEON)
+
+    if (n >= 4)
+    {
+        float32x4_t m = vld1q_f32(in);
+
+        for (i = 4; i + 4 <= n; i += 4)
+        {
+            m = vmaxq_f32(m, vld1q_f32(in + i));
+        }
+
+        float32x2_t h = vpmax_f32(vget_low_f32(m), vget_high_f32(m));
+        h = vpmax_f32(h, h);
+        result = vget_lane_f32(h, 0);
+    }
+
+#endif
+
+    for (; i < n; i++)
+    {
+        if (in[i] > result) { result = in[i]; }
+    }
+
+    return result;
+}
+
+static float spectrum_reduce_sum(const float *in, int n)
+{
+    float result = 0.0f;
+    int i = 0;
+
+#if defined(SPECTRUM_AVX2)
+
+    if (n >= 8)
+    {
+        __m256 vsum = _mm256_setzero_ps();
+
+        for (; i + 8 <= n; i += 8)
+        {
+            vsum = _mm256_add_ps(vsum, _mm256_loadu_ps(in + i));
+        }
+
+        __m128 s = _mm_add_ps(_mm256_castps256_ps128(vsum),
+                              _mm256_extractf128_ps(vsum, 1));
+        s = _mm_add_ps(s, _mm_movehl_ps(s, s));
+        s = _mm_add_ss(s, _mm_shuffle_ps(s, s, 1));
+        result = _mm_cvtss_f32(s);
+    }
+
+#elif defined(SPECTRUM_SSE2)
+
+    if (n >= 4)
+    {
+        __m128 s = _mm_setzero_ps();
+
+        for (; i + 4 <= n; i += 4)
+        {
+            s = _mm_add_ps(s, _mm_loadu_ps(in + i));
+        }
+
+        s = _mm_add_ps(s, _mm_movehl_ps(s, s));
+        s = _mm_add_ss(s, _mm_shuffle_ps(s, s, 1));
+        result = _mm_cvtss_f32(s);
+    }
+
+#elif defined(SPECTRUM_NEON)
+
+    if (n >= 4)
+    {
+        float32x4_t s = vdupq_n_f32(0.0f);
+
+        for (; i + 4 <= n; i += 4)
+        {
+            s = vaddq_f32(s, vld1q_f32(in + i));
+        }
+
+        float32x2_t h = vadd_f32(vget_low_f32(s), vget_high_f32(s));
+        h = vpadd_f32(h, h);
+        result = vget_lane_f32(h, 0);
+    }
+
+#endif
+
+    for (; i < n; i++)
+    {
+        result += in[i];
+    }
+
+    return result;
+}
+
+/*
+ * Reduce in_length bins to out_length bins, out_length <= in_length
+ * out may be in, bin i is stored at or before the first bin it reduces
+ */
+void spectrum_decimate(float *out, int out_length, const float *in,
+                       int in_length, enum rig_spectrum_decimation_e method)
+{
+    int i;
+
+    if (out_length >= in_length)
+    {
+        if (out != in)
+        {
+            memmove(out, in, in_length * sizeof(float));
+        }
+
+        return;
+    }
+
+    for (i = 0; i < out_length; i++)
+    {
+        int start = (int)((long) i * in_length / out_length);
+        int end = (int)((long)(i + 1) * in_length / out_length);
+        int count = end - start;
+
+        if (method == RIG_SPECTRUM_DECIMATION_MEAN)
+        {
+            out[i] = spectrum_reduce_sum(in + start, count) / (float) count;
+        }
+        else
+        {
+            out[i] = spectrum_reduce_max(in + start, count);
+        }
+    }
+}
+
+/* average[i] += factor * (in[i] - average[i]) */
+void spectrum_average(float *average, const float *in, int n, float factor)
+{
+    int i = 0;
+
+#if defined(SPECTRUM_AVX2)
+    const __m256 vfactor = _mm256_set1_ps(factor);
+
+    for (; i + 8 <= n; i += 8)
+    {
+        __m256 a = _mm256_loadu_ps(average + i);
+        __m256 d = _mm256_sub_ps(_mm256_loadu_ps(in + i), a);
+        _mm256_storeu_ps(average + i, _mm256_add_ps(a, _mm256_mul_ps(d, vfactor)));
+    }
+
+#elif defined(SPECTRUM_SSE2)
+    const __m128 vfactor = _mm_set1_ps(factor);
+
+    for (; i + 4 <= n; i += 4)
+    {
+        __m128 a = _mm_loadu_ps(average + i);
+        __m128 d = _mm_sub_ps(_mm_loadu_ps(in + i), a);
+        _mm_storeu_ps(average + i, _mm_add_ps(a, _mm_mul_ps(d, vfactor)));
+    }
+
+#elif defined(SPECTRUM_NEON)
+    const float32x4_t vfactor = vdupq_n_f32(factor);
+
+    for (; i + 4 <= n; i += 4)
+    {
+        float32x4_t a = vld1q_f32(average + i);
+        float32x4_t d = vsubq_f32(vld1q_f32(in + i), a);
+        vst1q_f32(average + i, vmlaq_f32(a, d, vfactor));
+    }
+
+#endif
+
+    for (; i < n; i++)
+    {
+        average[i] += factor * (in[i] - average[i]);
+    }
+}
+
+/* peak[i] = max(peak[i] - decay, in[i]) */
+void spectrum_peak_hold(float *peak, const float *in, int n, float decay)
+{
+    int i = 0;
+
+#if defined(SPECTRUM_AVX2)
+    const __m256 vdecay = _mm256_set1_ps(decay);
+
+    for (; i + 8 <= n; i += 8)
+    {
+        __m256 p = _mm256_sub_ps(_mm256_loadu_ps(peak + i), vdecay);
+        _mm256_storeu_ps(peak + i, _mm256_max_ps(p, _mm256_loadu_ps(in + i)));
+    }
+
+#elif defined(SPECTRUM_SSE2)
+    const __m128 vdecay = _mm_set1_ps(decay);
+
+    for (; i + 4 <= n; i += 4)
+    {
+        __m128 p = _mm_sub_ps(_mm_loadu_ps(peak + i), vdecay);
+        _mm_storeu_ps(peak + i, _mm_max_ps(p, _mm_loadu_ps(in + i)));
+    }
+
+#elif defined(SPECTRUM_NEON)
+    const float32x4_t vdecay = vdupq_n_f32(decay);
+
+    for (; i + 4 <= n; i += 4)
+    {
+        float32x4_t p = vsubq_f32(vld1q_f32(peak + i), vdecay);
+        vst1q_f32(peak + i, vmaxq_f32(p, vld1q_f32(in + i)));
+    }
+
+#endif
+
+    for (; i < n; i++)
+    {
+        float p = peak[i] - decay;
+        peak[i] = p > in[i] ? p : in[i];
+    }
+}
+
+
+/* quantile[i] += in[i] > quantile[i] ? up : -down */
+void spectrum_track_quantile(float *quantile, const float *in, int n,
+                             float up, float down)
+{
+    int i = 0;
+
+#if defined(SPECTRUM_AVX2)
+    const __m256 vup = _mm256_set1_ps(up);
+    const __m256 vdown = _mm256_set1_ps(-down);
+
+    for (; i + 8 <= n; i += 8)
+    {
+        __m256 q = _mm256_loadu_ps(quantile + i);
+        __m256 above = _mm256_cmp_ps(_mm256_loadu_ps(in + i), q, _CMP_GT_OQ);
+        _mm256_storeu_ps(quantile + i, _mm256_add_ps(q, _mm256_blendv_ps(vdown, vup,
+                         above)));
+    }
+
+#elif defined(SPECTRUM_SSE2)
+    const __m128 vup = _mm_set1_ps(up);
+    const __m128 vdown = _mm_set1_ps(-down);
+
+    for (; i + 4 <= n; i += 4)
+    {
+        __m128 q = _mm_loadu_ps(quantile + i);
+        __m128 above = _mm_cmpgt_ps(_mm_loadu_ps(in + i), q);
+        __m128 step = _mm_or_ps(_mm_and_ps(above, vup), _mm_andnot_ps(above, vdown));
+        _mm_storeu_ps(quantile + i, _mm_add_ps(q, step));
+    }
+
+#elif defined(SPECTRUM_NEON)
+    const float32x4_t vup = vdupq_n_f32(up);
+    const float32x4_t vdown = vdupq_n_f32(-down);
+
+    for (; i + 4 <= n; i += 4)
+    {
+        float32x4_t q = vld1q_f32(quantile + i);
+        uint32x4_t above = vcgtq_f32(vld1q_f32(in + i), q);
+        vst1q_f32(quantile + i, vaddq_f32(q, vbslq_f32(above, vup, vdown)));
+    }
+
+#endif
+
+    for (; i < n; i++)
+    {
+        quantile[i] += in[i] > quantile[i] ? up : -down;
+    }
+}
+
+/* Linear mapping of the data levels of a line to dB */
+void spectrum_level_scale(const struct rig_spectrum_line *line, float *scale,
+                          float *offset)
+{
+    *scale = 1.0f;
+    *offset = 0.0f;
+
+    if (line->data_level_max != line->data_level_min
+            && line->signal_strength_max != line->signal_strength_min)
+    {
+        *scale = (float)((line->signal_strength_max - line->signal_strength_min)
+                         / (line->data_level_max - line->data_level_min));
+        *offset = (float)(line->signal_strength_min - line->data_level_min * *scale);
+    }
+}
+
+
+/*
+ * Processing stage
+ */
+
+/**
+ * \brief Name of the vector kernels compiled into the library
+ *
+ * \return "AVX2", "SSE2", "NEON" or "scalar"
+ */
+const char *HAMLIB_API rig_spectrum_proc_kernel_name(void)
+{
+#if defined(SPECTRUM_AVX2)
+    return "AVX2";
+#elif defined(SPECTRUM_SSE2)
+    return "SSE2";
+#elif defined(SPECTRUM_NEON)
+    return "NEON";
+#else
+    return "scalar";
+#endif
+}
+
+/**
+ * \brief Allocate a spectrum post-processing stage
+ * \param config  The processing configuration, NULL passes lines through unchanged
+ *
+ * All buffers are allocated here, processing a line does not allocate.
+ *
+ * \return a pointer to the stage or NULL on error
+ *
+ * \sa rig_spectrum_proc_process(), rig_spectrum_proc_cleanup()
+ */
+rig_spectrum_proc_t *HAMLIB_API rig_spectrum_proc_init(const struct
+        rig_spectrum_proc_config *config)
+{
+    rig_spectrum_proc_t *proc;
+
+    if (config && (config->output_width < 0 || config->min_interval_ms < 0
+                   || config->average_factor < 0.0f || config->average_factor > 1.0f))
+    {
+        rig_debug(RIG_DEBUG_ERR, "%s: invalid spectrum processing config\n", __func__);
+        return NULL;
+    }
+
+    proc = calloc(1, sizeof(rig_spectrum_proc_t));
+
+    if (proc == NULL)
+    {
+        return NULL;
+    }
+
+    if (config)
+    {
+        proc->config = *config;
+    }
+    else
+    {
+        proc->config.peak_decay = -1.0f;
+    }
+
+    return proc;
+}
+
+/**
+ * \brief Release a spectrum post-processing stage
+ * \param proc  The stage returned by rig_spectrum_proc_init()
+ */
+void HAMLIB_API rig_spectrum_proc_cleanup(rig_spectrum_proc_t *proc)
+{
+    free(proc);
+}
+
+/**
+ * \brief Drop the averaging and peak-hold history of a stage
+ * \param proc  The stage returned by rig_spectrum_proc_init()
+ *
+ * The history is also dropped automatically whenever the scope id, width
+ * or frequency range of the incoming lines changes.
+ */
+void HAMLIB_API rig_spectrum_proc_reset(rig_spectrum_proc_t *proc)
+{
+    if (proc)
+    {
+        proc->length = 0;
+        memset(&proc->last_output, 0, sizeof(proc->last_output));
+    }
+}
+
+/**
+ * \brief Run a spectrum line through a post-processing stage
+ * \param proc    The stage returned by rig_spectrum_proc_init()
+ * \param line    The source line
+ * \param output  Receives the processed line when one is due
+ *
+ * Every line updates the average and peak-hold history, an output line is
+ * produced only when min_interval_ms has elapsed since the previous one.
+ *
+ * \return 1 if \a output was filled, 0 if the line was only accumulated,
+ * or a negative value if an error occurred.
+ */
+int HAMLIB_API rig_spectrum_proc_process(rig_spectrum_proc_t *proc,
+        const struct rig_spectrum_line *line,
+        struct rig_spectrum_proc_output *output)
+{
+    const struct rig_spectrum_proc_config *config;
+    int in_length, out_length;
+    float scale, offset;
+
+    if (!proc || !line || !output || !line->spectrum_data)
+    {
+        return -RIG_EINVAL;
+    }
+
+    config = &proc->config;
+    in_length = (int) line->spectrum_data_length;
+
+    if (in_length <= 0 || in_length > HAMLIB_MAX_SPECTRUM_DATA)
+    {
+        return -RIG_EINVAL;
+    }
+
+    out_length = config->output_width;
+
+    if (out_length <= 0 || out_length > in_length)
+    {
+        out_length = in_length;
+    }
+
+    spectrum_level_scale(line, &scale, &offset);
+
+    spectrum_u8_to_float(proc->input, line->spectrum_data, in_length, scale,
+                         offset);
+    spectrum_decimate(proc->decimated, out_length, proc->input, in_length,
+                      config->decimation);
+
+    if (proc->length != out_length || proc->id != line->id
+            || proc->center_freq != line->center_freq
+            || proc->span_freq != line->span_freq
+            || proc->low_edge_freq != line->low_edge_freq
+            || proc->high_edge_freq != line->high_edge_freq)
+    {
+        // history of another scope or frequency range is meaningless here
+        memcpy(proc->average, proc->decimated, out_length * sizeof(float));
+        memcpy(proc->peak, proc->decimated, out_length * sizeof(float));
+        proc->length = out_length;
+        proc->id = line->id;
+        proc->center_freq = line->center_freq;
+        proc->span_freq = line->span_freq;
+        proc->low_edge_freq = line->low_edge_freq;
+        proc->high_edge_freq = line->high_edge_freq;
+    }
+    else
+    {
+        if (config->average_factor > 0.0f && config->average_factor < 1.0f)
+        {
+            spectrum_average(proc->average, proc->decimated, out_length,
+                             config->average_factor);
+        }
+        else
+        {
+            memcpy(proc->average, proc->decimated, out_length * sizeof(float));
+        }
+
+        if (config->peak_decay >= 0.0f)
+        {
+            spectrum_peak_hold(proc->peak, proc->decimated, out_length,
+                               config->peak_decay);
+        }
+    }
+
+    if (config->min_interval_ms > 0)
+    {
+        if (elapsed_ms(&proc->last_output, HAMLIB_ELAPSED_GET)
+                < config->min_interval_ms)
+        {
+            return 0;
+        }
+
+        elapsed_ms(&proc->last_output, HAMLIB_ELAPSED_SET);
+    }
+
+    spectrum_float_to_u8(proc->data, proc->average, out_length, scale, offset);
+
+    output->line = *line;
+    output->line.spectrum_data_length = out_length;
+    output->line.spectrum_data = proc->data;
+    output->average_db = proc->average;
+    output->peak_db = config->peak_decay >= 0.0f ? proc->peak : NULL;
+    output->dropped = 0;
+    output->signals = NULL;
+
+    return 1;
+}
+
+
+/*
+ * Stages attached to a rig
+ */
+
+/* Latest-line-wins handoff between the async data handler and a subscriber thread */
+static void *spectrum_subscription_thread(void *arg)
+{
+    spectrum_subscription *sub = (spectrum_subscription *) arg;
+
+    pthread_mutex_lock(&sub->mutex);
+
+    while (sub->run)
+    {
+        spectrum_slot *slot;
+
+        if (!sub->pending)
+        {
+            pthread_cond_wait(&sub->cond, &sub->mutex);
+            continue;
+        }
+
+        // the producer fills the other slot while this one is delivered
+        slot = &sub->slots[sub->fill];
+        sub->fill ^= 1;
+        sub->pending = 0;
+        slot->output.dropped = sub->dropped;
+        sub->dropped = 0;
+
+        pthread_mutex_unlock(&sub->mutex);
+        sub->cb(sub->rig, &slot->output, sub->arg);
+        pthread_mutex_lock(&sub->mutex);
+    }
+
+    pthread_mutex_unlock(&sub->mutex);
+
+    return NULL;
+}
+
+static void spectrum_subscription_post(spectrum_subscription *sub,
+                                       const struct rig_spectrum_proc_output *output)
+{
+    int length = (int) output->line.spectrum_data_length;
+    spectrum_slot *slot;
+
+    pthread_mutex_lock(&sub->mutex);
+
+    slot = &sub->slots[sub->fill];
+
+    if (sub->pending)
+    {
+        sub->dropped++;
+    }
+
+    memcpy(slot->data, output->line.spectrum_data, length);
+    memcpy(slot->average, output->average_db, length * sizeof(float));
+
+    if (output->peak_db)
+    {
+        memcpy(slot->peak, output->peak_db, length * sizeof(float));
+    }
+
+    slot->output = *output;
+    slot->output.line.spectrum_data = slot->data;
+    slot->output.average_db = slot->average;
+    slot->output.peak_db = output->peak_db ? slot->peak : NULL;
+
+    // the detector state moves on with the next line, keep the signals of this one
+    if (output->signals)
+    {
+        slot->signals = *output->signals;
+        slot->output.signals = &slot->signals;
+    }
+
+    sub->pending = 1;
+    pthread_cond_signal(&sub->cond);
+    pthread_mutex_unlock(&sub->mutex);
+}
+
+static spectrum_subscription *spectrum_subscription_start(RIG *rig,
+        spectrum_proc_cb_t cb, rig_ptr_t arg)
+{
+    spectrum_subscription *sub = calloc(1, sizeof(spectrum_subscription));
+    int err;
+
+    if (sub == NULL)
+    {
+        return NULL;
+    }
+
+    sub->rig = rig;
+    sub->cb = cb;
+    sub->arg = arg;
+    sub->run = 1;
+    pthread_mutex_init(&sub->mutex, NULL);
+    pthread_cond_init(&sub->cond, NULL);
+
+    err = pthread_create(&sub->thread_id, NULL, spectrum_subscription_thread, sub);
+
+    if (err)
+    {
+        rig_debug(RIG_DEBUG_ERR, "%s: pthread_create error: %s\n", __func__,
+                  strerror(err));
+        pthread_cond_destroy(&sub->cond);
+        pthread_mutex_destroy(&sub->mutex);
+        free(sub);
+        return NULL;
+    }
+
+    return sub;
+}
+
+static void spectrum_subscription_stop(spectrum_subscription *sub)
+{
+    if (sub == NULL)
+    {
+        return;
+    }
+
+    pthread_mutex_lock(&sub->mutex);
+    sub->run = 0;
+    pthread_cond_signal(&sub->cond);
+    pthread_mutex_unlock(&sub->mutex);
+
+    pthread_join(sub->thread_id, NULL);
+
+    pthread_cond_destroy(&sub->cond);
+    pthread_mutex_destroy(&sub->mutex);
+    free(sub);
+}
+
+static spectrum_proc_priv_data *spectrum_proc_priv(RIG *rig, int create)
+{
+    struct rig_state *rs = STATE(rig);
+    static pthread_mutex_t create_mutex = PTHREAD_MUTEX_INITIALIZER;
+    spectrum_proc_priv_data *priv;
+
+    pthread_mutex_lock(&create_mutex);
+
+    priv = (spectrum_proc_priv_data *) rs->spectrum_proc_priv_data;
+
+    if (priv == NULL && create)
+    {
+        priv = calloc(1, sizeof(spectrum_proc_priv_data));
+
+        if (priv)
+        {
+            pthread_mutex_init(&priv->mutex, NULL);
+            rs->spectrum_proc_priv_data = priv;
+        }
+    }
+
+    pthread_mutex_unlock(&create_mutex);
+
+    return priv;
+}
+
+static int spectrum_proc_attach(RIG *rig,
+                                const struct rig_spectrum_proc_config *config,
+                                spectrum_proc_cb_t cb, rig_ptr_t arg, int subscribe)
+{
+    spectrum_proc_priv_data *priv;
+    spectrum_subscription *sub = NULL;
+    rig_spectrum_proc_t *proc;
+    int i;
+
+    priv = spectrum_proc_priv(rig, 1);
+
+    if (priv == NULL)
+    {
+        return -RIG_ENOMEM;
+    }
+
+    proc = rig_spectrum_proc_init(config);
+
+    if (proc == NULL)
+    {
+        return -RIG_EINVAL;
+    }
+
+    if (subscribe)
+    {
+        sub = spectrum_subscription_start(rig, cb, arg);
+
+        if (sub == NULL)
+        {
+            rig_spectrum_proc_cleanup(proc);
+            return -RIG_EINTERNAL;
+        }
+    }
+
+    pthread_mutex_lock(&priv->mutex);
+
+    for (i = 0; i < SPECTRUM_PROC_MAX; i++)
+    {
+        if (priv->entries[i].proc == NULL)
+        {
+            priv->entries[i].proc = proc;
+            priv->entries[i].sub = sub;
+            priv->entries[i].cb = cb;
+            priv->entries[i].arg = arg;
+            break;
+        }
+    }
+
+    pthread_mutex_unlock(&priv->mutex);
+
+    if (i == SPECTRUM_PROC_MAX)
+    {
+        rig_debug(RIG_DEBUG_ERR, "%s: all %d spectrum processing stages in use\n",
+                  __func__, SPECTRUM_PROC_MAX);
+        spectrum_subscription_stop(sub);
+        rig_spectrum_proc_cleanup(proc);
+        return -RIG_ENAVAIL;
+    }
+
+    return i;
+}
+
+/**
+ * \brief Attach a spectrum post-processing stage to a rig
+ * \param rig     The rig handle
+ * \param config  The processing configuration of this consumer
+ * \param cb      The callback receiving the processed lines
+ * \param arg     A pointer to some private data to pass later on to the callback
+ *
+ * Each consumer gets its own stage with its own output width, rate and
+ * averaging. The callback is called in async mode from the thread that
+ * receives the spectrum data, so it must return quickly and must not call
+ * rig_spectrum_proc_remove(). Use rig_spectrum_subscribe() for consumers
+ * that may block.
+ *
+ * \return a handle >= 0 for rig_spectrum_proc_remove(), otherwise a negative
+ * value if an error occurred.
+ *
+ * \sa rig_set_spectrum_callback()
+ */
+int HAMLIB_API rig_spectrum_proc_add(RIG *rig,
+                                     const struct rig_spectrum_proc_config *config,
+                                     spectrum_proc_cb_t cb, rig_ptr_t arg)
+{
+    if (!rig || !rig->caps || !cb)
+    {
+        return -RIG_EINVAL;
+    }
+
+    ENTERFUNC;
+
+    RETURNFUNC(spectrum_proc_attach(rig, config, cb, arg, 0));
+}
+
+/**
+ * \brief Subscribe to processed spectrum lines on a separate thread
+ * \param rig     The rig handle
+ * \param config  The processing configuration of this subscriber
+ * \param cb      The callback receiving the processed lines
+ * \param arg     A pointer to some private data to pass later on to the callback
+ *
+ * Like rig_spectrum_proc_add(), but the callback runs on a thread of its
+ * own. Lines are averaged and rate limited as they arrive; if the callback
+ * is still busy when the next output line is due, the waiting line is
+ * replaced by the newer one and counted in the dropped field. A slow
+ * subscriber therefore never delays the processing of rig data.
+ *
+ * The callback must not call rig_spectrum_proc_remove() for its own handle.
+ *
+ * \return a handle >= 0 for rig_spectrum_proc_remove(), otherwise a negative
+ * value if an error occurred.
+ */
+int HAMLIB_API rig_spectrum_subscribe(RIG *rig,
+                                      const struct rig_spectrum_proc_config *config,
+                                      spectrum_proc_cb_t cb, rig_ptr_t arg)
+{
+    if (!rig || !rig->caps || !cb)
+    {
+        return -RIG_EINVAL;
+    }
+
+    ENTERFUNC;
+
+    RETURNFUNC(spectrum_proc_attach(rig, config, cb, arg, 1));
+}
+
+/**
+ * \brief Detach a spectrum post-processing stage or subscription from a rig
+ * \param rig     The rig handle
+ * \param handle  The handle returned by rig_spectrum_proc_add() or rig_spectrum_subscribe()
+ *
+ * For subscriptions this waits for a callback in progress to return.
+ *
+ * \return RIG_OK if the operation has been successful, otherwise
+ * a negative value if an error occurred.
+ */
+int HAMLIB_API rig_spectrum_proc_remove(RIG *rig, int handle)
+{
+    spectrum_proc_priv_data *priv;
+    spectrum_proc_entry entry;
+
+    if (!rig || !rig->caps)
+    {
+        return -RIG_EINVAL;
+    }
+
+    ENTERFUNC;
+
+    priv = spectrum_proc_priv(rig, 0);
+
+    if (priv == NULL || handle < 0 || handle >= SPECTRUM_PROC_MAX)
+    {
+        RETURNFUNC(-RIG_EINVAL);
+    }
+
+    pthread_mutex_lock(&priv->mutex);
+    entry = priv->entries[handle];
+    memset(&priv->entries[handle], 0, sizeof(priv->entries[handle]));
+    pthread_mutex_unlock(&priv->mutex);
+
+    if (entry.proc == NULL)
+    {
+        RETURNFUNC(-RIG_EINVAL);
+    }
+
+    spectrum_subscription_stop(entry.sub);
+    rig_spectrum_proc_cleanup(entry.proc);
+
+    RETURNFUNC(RIG_OK);
+}
+
+/* Run a line through every attached stage, called by rig_fire_spectrum_event()
+ * signals are the detector results for this line, NULL if the detector is off */
+int spectrum_proc_fire(RIG *rig, const struct rig_spectrum_line *line,
+                       const struct rig_spectrum_signals *signals)
+{
+    spectrum_proc_priv_data *priv = (spectrum_proc_priv_data *)
+                                    STATE(rig)->spectrum_proc_priv_data;
+    struct rig_spectrum_proc_output output;
+    int i;
+
+    if (priv == NULL)
+    {
+        return RIG_OK;
+    }
+
+    pthread_mutex_lock(&priv->mutex);
+
+    for (i = 0; i < SPECTRUM_PROC_MAX; i++)
+    {
+        spectrum_proc_entry *entry = &priv->entries[i];
+
+        if (entry->proc == NULL)
+        {
+            continue;
+        }
+
+        if (rig_spectrum_proc_process(entry->proc, line, &output) != 1)
+        {
+            continue;
+        }
+
+        output.signals = signals;
+
+        if (entry->sub)
+        {
+            spectrum_subscription_post(entry->sub, &output);
+        }
+        else
+        {
+            entry->cb(rig, &output, entry->arg);
+        }
+    }
+
+    pthread_mutex_unlock(&priv->mutex);
+
+    return RIG_OK;
+}
+
+/* Release all attached stages, called by rig_cleanup() */
+void spectrum_proc_cleanup_all(RIG *rig)
+{
+    struct rig_state *rs = STATE(rig);
+    spectrum_proc_priv_data *priv = (spectrum_proc_priv_data *)
+                                    rs->spectrum_proc_priv_data;
+    int i;
+
+    if (priv == NULL)
+    {
+        return;
+    }
+
+    for (i = 0; i < SPECTRUM_PROC_MAX; i++)
+    {
+        spectrum_subscription_stop(priv->entries[i].sub);
+        rig_spectrum_proc_cleanup(priv->entries[i].proc);
+    }
+
+    pthread_mutex_destroy(&priv->mutex);
+    free(priv);
+    rs->spectrum_proc_priv_data = NULL;
+}
+
+/** @} */
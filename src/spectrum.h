@@ -0,0 +1,55 @@
+/*
+ *  Hamlib Interface - spectrum line post-processing
+ *  Copyright (c) 2000-2025 The Hamlib Group
+ *
+ *
+ *   This library is free software; you can redistribute it and/or
+ *   modify it under the terms of the GNU Lesser General Public
+ *   License as published by the Free Software Foundation; either
+ *   version 2.1 of the License, or (at your option) any later version.
+ *
+ *   This library is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *   Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public
+ *   License along with this library; if not, write to the Free Software
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+/* SPDX-License-Identifier: LGPL-2.1-or-later */
+
+#ifndef _SPECTRUM_H
+#define _SPECTRUM_H 1
+
+#include "hamlib/rig.h"
+
+__BEGIN_DECLS
+
+/* Vector kernels, SSE2/AVX2/NEON when the compiler targets them, scalar otherwise */
+void spectrum_u8_to_float(float *out, const unsigned char *in, int n,
+                          float scale, float offset);
+void spectrum_float_to_u8(unsigned char *out, const float *in, int n,
+                          float scale, float offset);
+void spectrum_decimate(float *out, int out_length, const float *in,
+                       int in_length, enum rig_spectrum_decimation_e method);
+void spectrum_average(float *average, const float *in, int n, float factor);
+void spectrum_peak_hold(float *peak, const float *in, int n, float decay);
+void spectrum_track_quantile(float *quantile, const float *in, int n,
+                             float up, float down);
+
+void spectrum_level_scale(const struct rig_spectrum_line *line, float *scale,
+                          float *offset);
+
+/* Hamlib internal use, see event.c and rig.c */
+int spectrum_proc_fire(RIG *rig, const struct rig_spectrum_line *line,
+                       const struct rig_spectrum_signals *signals);
+void spectrum_proc_cleanup_all(RIG *rig);
+int spectrum_detector_fire(RIG *rig, const struct rig_spectrum_line *line,
+                           struct rig_spectrum_signals *signals);
+void spectrum_detector_cleanup_all(RIG *rig);
+
+__END_DECLS
+
+#endif /* _SPECTRUM_H */
@@ -0,0 +1,562 @@
+/*
+ *  Hamlib Interface - spectrum signal detector
+ *  Copyright (c) 2000-2025 The Hamlib Group
+ *
+ *
+ *   This library is free software; you can redistribute it and/or
+ *   modify it under the terms of the GNU Lesser General Public
+ *   License as published by the Free Software Foundation; either
+ *   version 2.1 of the License, or (at your option) any later version.
+ *
+ *   This library is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *   Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public
+ *   License along with this library; if not, write to the Free Software
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+/* SPDX-License-Identifier: LGPL-2.1-or-later */
+
+/**
+ * \addtogroup rig
+ * @{
+ */
+
+/**
+ * \file spectrum_detector.c
+ * \brief Spectrum signal detector
+ *
+ * Turns spectrum scope lines into lists of occupied channels.
+ *
+ * Each bin keeps a running percentile of its level history (a median by
+ * default), which averages out the noise. The noise floor is the lower
+ * quartile of those estimates over blocks of neighbouring bins, so that
+ * carriers that never go away do not raise the floor under themselves.
+ * Bins standing out of the floor by the threshold are occupied, and runs of
+ * occupied bins form one signal.
+ */
+
+#include "hamlib/config.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include <pthread.h>
+
+#include "hamlib/rig.h"
+#include "hamlib/rig_state.h"
+#include "spectrum.h"
+#include "misc.h"
+
+#define DETECTOR_BLOCK_SIZE 32
+#define DETECTOR_MAX_BLOCKS (HAMLIB_MAX_SPECTRUM_DATA / DETECTOR_BLOCK_SIZE)
+
+struct rig_spectrum_detector
+{
+    struct rig_spectrum_detector_config config;
+
+    int length;             /* width of the current noise estimate, 0 if not primed */
+    int id;                 /* scope id and geometry the estimate belongs to */
+    freq_t center_freq;
+    freq_t span_freq;
+    freq_t low_edge_freq;
+    freq_t high_edge_freq;
+
+    float level[HAMLIB_MAX_SPECTRUM_DATA];
+    float noise[HAMLIB_MAX_SPECTRUM_DATA];
+    float floor[HAMLIB_MAX_SPECTRUM_DATA];
+    float block_floor[DETECTOR_MAX_BLOCKS];
+};
+
+typedef struct spectrum_detector_priv_data_s
+{
+    pthread_mutex_t mutex;
+    int enabled;
+    struct rig_spectrum_detector_config config;
+    spectrum_signals_cb_t cb;
+    rig_ptr_t arg;
+    rig_spectrum_detector_t *detectors[HAMLIB_MAX_SPECTRUM_SCOPES];
+} spectrum_detector_priv_data;
+
+
+static int compare_float(const void *a, const void *b)
+{
+    float fa = *(const float *) a;
+    float fb = *(const float *) b;
+
+    return (fa > fb) - (fa < fb);
+}
+
+static int compare_signal_freq(const void *a, const void *b)
+{
+    freq_t fa = ((const struct rig_spectrum_signal *) a)->freq;
+    freq_t fb = ((const struct rig_spectrum_signal *) b)->freq;
+
+    return (fa > fb) - (fa < fb);
+}
+
+/* Lower quartile of each block, interpolated between block centers */
+static float detector_update_floor(rig_spectrum_detector_t *detector, int n)
+{
+    float sorted[DETECTOR_MAX_BLOCKS];
+    float block[DETECTOR_BLOCK_SIZE];
+    int block_size = n < DETECTOR_BLOCK_SIZE ? n : DETECTOR_BLOCK_SIZE;
+    int blocks = n / block_size;
+    int b, i;
+
+    for (b = 0; b < blocks; b++)
+    {
+        int start = b * n / blocks;
+        int count = (b + 1) * n / blocks - start;
+
+        if (count > DETECTOR_BLOCK_SIZE)
+        {
+            count = DETECTOR_BLOCK_SIZE;
+        }
+
+        memcpy(block, detector->noise + start, count * sizeof(float));
+        qsort(block, count, sizeof(float), compare_float);
+        detector->block_floor[b] = block[count / 4];
+    }
+
+    for (i = 0; i < n; i++)
+    {
+        // position of the bin relative to the block centers
+        float pos = ((float) i + 0.5f) * blocks / n - 0.5f;
+        int b0 = (int) floorf(pos);
+        float frac = pos - b0;
+
+        if (b0 < 0)
+        {
+            detector->floor[i] = detector->block_floor[0];
+        }
+        else if (b0 >= blocks - 1)
+        {
+            detector->floor[i] = detector->block_floor[blocks - 1];
+        }
+        else
+        {
+            detector->floor[i] = detector->block_floor[b0] + frac *
+                                 (detector->block_floor[b0 + 1] - detector->block_floor[b0]);
+        }
+    }
+
+    memcpy(sorted, detector->block_floor, blocks * sizeof(float));
+    qsort(sorted, blocks, sizeof(float), compare_float);
+
+    return sorted[blocks / 2];
+}
+
+static void detector_add_signal(struct rig_spectrum_signals *signals,
+                                const struct rig_spectrum_signal *signal)
+{
+    int weakest = 0;
+    int i;
+
+    if (signals->count < HAMLIB_MAX_SPECTRUM_SIGNALS)
+    {
+        signals->signals[signals->count++] = *signal;
+        return;
+    }
+
+    for (i = 1; i < signals->count; i++)
+    {
+        if (signals->signals[i].snr_db < signals->signals[weakest].snr_db)
+        {
+            weakest = i;
+        }
+    }
+
+    if (signal->snr_db > signals->signals[weakest].snr_db)
+    {
+        signals->signals[weakest] = *signal;
+    }
+}
+
+/**
+ * \brief Allocate a spectrum signal detector
+ * \param config  The detector configuration, NULL selects the defaults
+ *
+ * \return a pointer to the detector or NULL on error
+ *
+ * \sa rig_spectrum_detector_process(), rig_set_spectrum_detector()
+ */
+rig_spectrum_detector_t *HAMLIB_API rig_spectrum_detector_init(
+    const struct rig_spectrum_detector_config *config)
+{
+    rig_spectrum_detector_t *detector;
+
+    if (config && (config->threshold_db < 0.0f || config->noise_percentile < 0.0f
+                   || config->noise_percentile >= 1.0f || config->noise_step_db < 0.0f
+                   || config->merge_gap < 0))
+    {
+        rig_debug(RIG_DEBUG_ERR, "%s: invalid spectrum detector config\n", __func__);
+        return NULL;
+    }
+
+    detector = calloc(1, sizeof(rig_spectrum_detector_t));
+
+    if (detector == NULL)
+    {
+        return NULL;
+    }
+
+    if (config)
+    {
+        detector->config = *config;
+    }
+
+    if (detector->config.threshold_db == 0.0f)
+    {
+        detector->config.threshold_db = 6.0f;
+    }
+
+    if (detector->config.noise_percentile == 0.0f)
+    {
+        detector->config.noise_percentile = 0.5f;
+    }
+
+    if (detector->config.noise_step_db == 0.0f)
+    {
+        detector->config.noise_step_db = 0.5f;
+    }
+
+    return detector;
+}
+
+/**
+ * \brief Release a spectrum signal detector
+ * \param detector  The detector returned by rig_spectrum_detector_init()
+ */
+void HAMLIB_API rig_spectrum_detector_cleanup(rig_spectrum_detector_t *detector)
+{
+    free(detector);
+}
+
+/**
+ * \brief Find the occupied channels of a spectrum line
+ * \param detector  The detector returned by rig_spectrum_detector_init()
+ * \param line      The spectrum line
+ * \param signals   Receives the signals found in the line
+ *
+ * The noise estimate adapts over successive lines of the same scope and
+ * frequency range and starts over when they change.
+ *
+ * \return the number of signals found, or a negative value if an error occurred.
+ */
+int HAMLIB_API rig_spectrum_detector_process(rig_spectrum_detector_t *detector,
+        const struct rig_spectrum_line *line,
+        struct rig_spectrum_signals *signals)
+{
+    const struct rig_spectrum_detector_config *config;
+    float scale, offset, threshold;
+    freq_t low_freq, bin_width;
+    int n, i;
+
+    if (!detector || !line || !signals || !line->spectrum_data)
+    {
+        return -RIG_EINVAL;
+    }
+
+    config = &detector->config;
+    n = (int) line->spectrum_data_length;
+
+    if (n <= 0 || n > HAMLIB_MAX_SPECTRUM_DATA)
+    {
+        return -RIG_EINVAL;
+    }
+
+    spectrum_level_scale(line, &scale, &offset);
+    spectrum_u8_to_float(detector->level, line->spectrum_data, n, scale, offset);
+
+    if (detector->length != n || detector->id != line->id
+            || detector->center_freq != line->center_freq
+            || detector->span_freq != line->span_freq
+            || detector->low_edge_freq != line->low_edge_freq
+            || detector->high_edge_freq != line->high_edge_freq)
+    {
+        memcpy(detector->noise, detector->level, n * sizeof(float));
+        detector->length = n;
+        detector->id = line->id;
+        detector->center_freq = line->center_freq;
+        detector->span_freq = line->span_freq;
+        detector->low_edge_freq = line->low_edge_freq;
+        detector->high_edge_freq = line->high_edge_freq;
+    }
+    else
+    {
+        spectrum_track_quantile(detector->noise, detector->level, n,
+                                config->noise_step_db * config->noise_percentile,
+                                config->noise_step_db * (1.0f - config->noise_percentile));
+    }
+
+    memset(signals, 0, sizeof(*signals));
+    signals->id = line->id;
+    signals->noise_floor_db = detector_update_floor(detector, n);
+
+    if (line->spectrum_mode == RIG_SPECTRUM_MODE_CENTER)
+    {
+        low_freq = line->center_freq - line->span_freq / 2;
+        bin_width = line->span_freq / n;
+    }
+    else
+    {
+        low_freq = line->low_edge_freq;
+        bin_width = (line->high_edge_freq - line->low_edge_freq) / n;
+    }
+
+    threshold = config->threshold_db;
+
+    for (i = 0; i < n;)
+    {
+        struct rig_spectrum_signal signal;
+        double weight_sum = 0, weighted_bin = 0;
+        int first, last, peak, gap, j;
+
+        if (detector->level[i] - detector->floor[i] < threshold)
+        {
+            i++;
+            continue;
+        }
+
+        first = last = peak = i;
+
+        for (j = i + 1, gap = 0; j < n; j++)
+        {
+            if (detector->level[j] - detector->floor[j] >= threshold)
+            {
+                last = j;
+                gap = 0;
+            }
+            else if (++gap > config->merge_gap)
+            {
+                break;
+            }
+        }
+
+        for (j = first; j <= last; j++)
+        {
+            float snr = detector->level[j] - detector->floor[j];
+
+            if (detector->level[j] > detector->level[peak])
+            {
+                peak = j;
+            }
+
+            if (snr > 0.0f)
+            {
+                double weight = pow(10.0, snr / 10.0);
+                weight_sum += weight;
+                weighted_bin += weight * j;
+            }
+        }
+
+        signal.freq = low_freq + (weighted_bin / weight_sum + 0.5) * bin_width;
+        signal.bandwidth = (last - first + 1) * bin_width;
+        signal.peak_db = detector->level[peak];
+        signal.snr_db = detector->level[peak] - detector->floor[peak];
+        detector_add_signal(signals, &signal);
+
+        i = last + 1;
+    }
+
+    if (signals->count == HAMLIB_MAX_SPECTRUM_SIGNALS)
+    {
+        // replacing weaker signals does not keep the frequency order
+        qsort(signals->signals, signals->count, sizeof(struct rig_spectrum_signal),
+              compare_signal_freq);
+    }
+
+    return signals->count;
+}
+
+/*
+ * The private data of the detector, created on first use under a lock so
+ * that the async data handler never sees it half set up
+ */
+static spectrum_detector_priv_data *spectrum_detector_priv(RIG *rig,
+        int create)
+{
+    struct rig_state *rs = STATE(rig);
+    static pthread_mutex_t create_mutex = PTHREAD_MUTEX_INITIALIZER;
+    spectrum_detector_priv_data *priv;
+
+    pthread_mutex_lock(&create_mutex);
+
+    priv = (spectrum_detector_priv_data *) rs->spectrum_detector_priv_data;
+
+    if (priv == NULL && create)
+    {
+        priv = calloc(1, sizeof(spectrum_detector_priv_data));
+
+        if (priv)
+        {
+            pthread_mutex_init(&priv->mutex, NULL);
+            rs->spectrum_detector_priv_data = priv;
+        }
+    }
+
+    pthread_mutex_unlock(&create_mutex);
+
+    return priv;
+}
+
+/**
+ * \brief Enable the spectrum signal detector of a rig
+ * \param rig     The rig handle
+ * \param config  The detector configuration, NULL disables the detector
+ * \param cb      The callback receiving the signals of every line, may be NULL
+ * \param arg     A pointer to some private data to pass later on to the callback
+ *
+ * Every spectrum line received in async mode is run through the detector,
+ * one per scope. The signals are passed to the callback and included in the
+ * spectrum entries of the multicast snapshot stream.
+ *
+ * \return RIG_OK if the operation has been successful, otherwise
+ * a negative value if an error occurred.
+ *
+ * \sa rig_set_spectrum_callback()
+ */
+int HAMLIB_API rig_set_spectrum_detector(RIG *rig,
+        const struct rig_spectrum_detector_config *config,
+        spectrum_signals_cb_t cb, rig_ptr_t arg)
+{
+    spectrum_detector_priv_data *priv;
+    rig_spectrum_detector_t *check;
+    int i;
+
+    if (!rig || !rig->caps)
+    {
+        return -RIG_EINVAL;
+    }
+
+    ENTERFUNC;
+
+    // validate the config before touching a running detector
+    if (config)
+    {
+        check = rig_spectrum_detector_init(config);
+
+        if (check == NULL)
+        {
+            RETURNFUNC(-RIG_EINVAL);
+        }
+
+        rig_spectrum_detector_cleanup(check);
+    }
+
+    priv = spectrum_detector_priv(rig, config != NULL);
+
+    if (priv == NULL)
+    {
+        RETURNFUNC(config == NULL ? RIG_OK : -RIG_ENOMEM);
+    }
+
+    // the async data handler may be running, so the private data stays
+    // allocated until rig_cleanup() even when the detector is disabled
+    pthread_mutex_lock(&priv->mutex);
+
+    priv->enabled = config != NULL;
+
+    if (config)
+    {
+        priv->config = *config;
+    }
+
+    priv->cb = cb;
+    priv->arg = arg;
+
+    for (i = 0; i < HAMLIB_MAX_SPECTRUM_SCOPES; i++)
+    {
+        rig_spectrum_detector_cleanup(priv->detectors[i]);
+        priv->detectors[i] = NULL;
+    }
+
+    pthread_mutex_unlock(&priv->mutex);
+
+    RETURNFUNC(RIG_OK);
+}
+
+/* Run a line through the detector of its scope, called by rig_fire_spectrum_event()
+ * Returns 1 with the signals of this line in *signals, 0 if the detector is off */
+int spectrum_detector_fire(RIG *rig, const struct rig_spectrum_line *line,
+                           struct rig_spectrum_signals *signals)
+{
+    spectrum_detector_priv_data *priv = spectrum_detector_priv(rig, 0);
+    spectrum_signals_cb_t cb;
+    rig_ptr_t arg;
+    int id = line->id;
+    int result;
+
+    if (priv == NULL || id < 0 || id >= HAMLIB_MAX_SPECTRUM_SCOPES)
+    {
+        return 0;
+    }
+
+    pthread_mutex_lock(&priv->mutex);
+
+    if (!priv->enabled)
+    {
+        pthread_mutex_unlock(&priv->mutex);
+        return 0;
+    }
+
+    if (priv->detectors[id] == NULL)
+    {
+        priv->detectors[id] = rig_spectrum_detector_init(&priv->config);
+    }
+
+    result = rig_spectrum_detector_process(priv->detectors[id], line, signals);
+
+    cb = priv->cb;
+    arg = priv->arg;
+
+    pthread_mutex_unlock(&priv->mutex);
+
+    if (result < 0)
+    {
+        rig_debug(RIG_DEBUG_ERR, "%s: spectrum detector failed: %s\n", __func__,
+                  rigerror(result));
+        return result;
+    }
+
+    rig_debug(RIG_DEBUG_TRACE, "%s: %d signals on scope %d, noise floor %.1f dB\n",
+              __func__, signals->count, id, signals->noise_floor_db);
+
+    if (cb)
+    {
+        cb(rig, signals, arg);
+    }
+
+    return 1;
+}
+
+/* Release the detectors, called by rig_cleanup() */
+void spectrum_detector_cleanup_all(RIG *rig)
+{
+    struct rig_state *rs = STATE(rig);
+    spectrum_detector_priv_data *priv = (spectrum_detector_priv_data *)
+                                        rs->spectrum_detector_priv_data;
+    int i;
+
+    if (priv == NULL)
+    {
+        return;
+    }
+
+    rs->spectrum_detector_priv_data = NULL;
+
+    for (i = 0; i < HAMLIB_MAX_SPECTRUM_SCOPES; i++)
+    {
+        rig_spectrum_detector_cleanup(priv->detectors[i]);
+    }
+
+    pthread_mutex_destroy(&priv->mutex);
+    free(priv);
+}
+
+/** @} */
@@ -145,6 +145,14 @@
 #define TOK_FREQ_SKIP  TOKEN_FRONTEND(136)
 /** \brief rig: Client ID of WSJTX or GPREDICT */
 #define TOK_CLIENT  TOKEN_FRONTEND(137)
+/** \brief rig: Trust a successful set_freq instead of reading the frequency back */
+#define TOK_TRUSTED_SET  TOKEN_FRONTEND(138)
+/** \brief rig: Delay in ms before a trusted set_freq is verified, 0 disables verification */
+#define TOK_TRUSTED_SET_VERIFY  TOKEN_FRONTEND(139)
+/** \brief rig: Execute the commands received by the multicast command server, default off */
+#define TOK_MULTICAST_CMD_EXEC  TOKEN_FRONTEND(140)
+/** \brief rig: Minimum time in ms between two published rig state changes, default 50 */
+#define TOK_MULTICAST_MIN_INTERVAL  TOKEN_FRONTEND(141)
 
 /*
  * rotator specific tokens
@@ -0,0 +1,289 @@
+/*
+ *  Hamlib Interface - background verification of trusted frequency sets
+ *  Copyright (c) 2000-2025 The Hamlib Group
+ *
+ *
+ *   This library is free software; you can redistribute it and/or
+ *   modify it under the terms of the GNU Lesser General Public
+ *   License as published by the Free Software Foundation; either
+ *   version 2.1 of the License, or (at your option) any later version.
+ *
+ *   This library is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *   Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public
+ *   License along with this library; if not, write to the Free Software
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+/* SPDX-License-Identifier: LGPL-2.1-or-later */
+
+
+/**
+ * \addtogroup rig
+ * @{
+ */
+
+/**
+ * \file trusted_set.c
+ * \brief Background verification of trusted frequency sets
+ *
+ * With the trusted_set option a successful rig_set_freq() puts the
+ * requested frequency in the cache instead of reading it back, so a client
+ * that sets and then polls the frequency costs one transaction instead of
+ * two. When trusted_set_verify is not 0, the frequency is read back by a
+ * background thread once the VFO has not been set for that many ms, which
+ * corrects the cache if the rig rounded or refused the value.
+ */
+
+#include "hamlib/config.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#include <pthread.h>
+
+#include "hamlib/rig.h"
+#include "hamlib/rig_state.h"
+#include "trusted_set.h"
+#include "cache.h"
+#include "misc.h"
+
+#define TRUSTED_SET_SLOTS 8
+
+typedef struct trusted_set_slot_s
+{
+    vfo_t vfo;              /* RIG_VFO_NONE if the slot is free */
+    freq_t freq;            /* frequency of the last trusted set */
+    int pending;            /* freq has not been verified yet */
+    struct timespec due;    /* when to verify */
+} trusted_set_slot;
+
+typedef struct trusted_set_priv_data_s
+{
+    RIG *rig;
+    pthread_t thread_id;
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    int run;
+    trusted_set_slot slots[TRUSTED_SET_SLOTS];
+} trusted_set_priv_data;
+
+static int trusted_set_before(const struct timespec *a,
+                              const struct timespec *b)
+{
+    return a->tv_sec < b->tv_sec
+           || (a->tv_sec == b->tv_sec && a->tv_nsec < b->tv_nsec);
+}
+
+static void trusted_set_check(RIG *rig, vfo_t vfo, freq_t freq)
+{
+    freq_t actual;
+    int retval;
+
+    // force the read to go to the rig
+    rig_set_cache_freq(rig, vfo, (freq_t)0);
+
+    retval = rig_get_freq(rig, vfo, &actual);
+
+    if (retval != RIG_OK)
+    {
+        rig_debug(RIG_DEBUG_WARN, "%s: get_freq %s failed: %s\n", __func__,
+                  rig_strvfo(vfo), rigerror(retval));
+    }
+    else if (actual != freq)
+    {
+        rig_debug(RIG_DEBUG_WARN, "%s: %s asked for %.0f, rig has %.0f\n", __func__,
+                  rig_strvfo(vfo), freq, actual);
+    }
+}
+
+static void *trusted_set_verifier(void *arg)
+{
+    trusted_set_priv_data *priv = (trusted_set_priv_data *) arg;
+    RIG *rig = priv->rig;
+
+    pthread_mutex_lock(&priv->mutex);
+
+    while (priv->run)
+    {
+        trusted_set_slot *slot = NULL;
+        struct timespec now;
+        vfo_t vfo;
+        freq_t freq;
+        int i;
+
+        for (i = 0; i < TRUSTED_SET_SLOTS; i++)
+        {
+            if (priv->slots[i].pending
+                    && (slot == NULL || trusted_set_before(&priv->slots[i].due, &slot->due)))
+            {
+                slot = &priv->slots[i];
+            }
+        }
+
+        if (slot == NULL)
+        {
+            pthread_cond_wait(&priv->cond, &priv->mutex);
+            continue;
+        }
+
+        clock_gettime(CLOCK_REALTIME, &now);
+
+        if (trusted_set_before(&now, &slot->due))
+        {
+            // a newer set moves the due time, so look again after waking up
+            pthread_cond_timedwait(&priv->cond, &priv->mutex, &slot->due);
+            continue;
+        }
+
+        vfo = slot->vfo;
+        freq = slot->freq;
+        slot->pending = 0;
+
+        pthread_mutex_unlock(&priv->mutex);
+        trusted_set_check(rig, vfo, freq);
+        pthread_mutex_lock(&priv->mutex);
+    }
+
+    pthread_mutex_unlock(&priv->mutex);
+
+    return NULL;
+}
+
+static trusted_set_priv_data *trusted_set_priv(RIG *rig)
+{
+    struct rig_state *rs = STATE(rig);
+    static pthread_mutex_t create_mutex = PTHREAD_MUTEX_INITIALIZER;
+    trusted_set_priv_data *priv;
+    int err;
+
+    pthread_mutex_lock(&create_mutex);
+
+    priv = (trusted_set_priv_data *) rs->trusted_set_priv_data;
+
+    if (priv == NULL)
+    {
+        priv = calloc(1, sizeof(trusted_set_priv_data));
+
+        if (priv == NULL)
+        {
+            pthread_mutex_unlock(&create_mutex);
+            return NULL;
+        }
+
+        priv->rig = rig;
+        priv->run = 1;
+        pthread_mutex_init(&priv->mutex, NULL);
+        pthread_cond_init(&priv->cond, NULL);
+
+        err = pthread_create(&priv->thread_id, NULL, trusted_set_verifier, priv);
+
+        if (err)
+        {
+            rig_debug(RIG_DEBUG_ERR, "%s: pthread_create error: %s\n", __func__,
+                      strerror(err));
+            pthread_cond_destroy(&priv->cond);
+            pthread_mutex_destroy(&priv->mutex);
+            free(priv);
+            priv = NULL;
+        }
+
+        rs->trusted_set_priv_data = priv;
+    }
+
+    pthread_mutex_unlock(&create_mutex);
+
+    return priv;
+}
+
+/* Schedule the read back of a trusted set, called by rig_set_freq()
+ * Only the last set of a VFO is verified, trusted_set_verify_ms after it
+ */
+void trusted_set_verify(RIG *rig, vfo_t vfo, freq_t freq)
+{
+    int verify_ms = STATE(rig)->trusted_set_verify_ms;
+    trusted_set_priv_data *priv;
+    trusted_set_slot *slot = NULL;
+    int i;
+
+    if (verify_ms <= 0)
+    {
+        return;
+    }
+
+    priv = trusted_set_priv(rig);
+
+    if (priv == NULL)
+    {
+        return;
+    }
+
+    pthread_mutex_lock(&priv->mutex);
+
+    for (i = 0; i < TRUSTED_SET_SLOTS; i++)
+    {
+        if (priv->slots[i].vfo == vfo)
+        {
+            slot = &priv->slots[i];
+            break;
+        }
+
+        if (slot == NULL && priv->slots[i].vfo == RIG_VFO_NONE)
+        {
+            slot = &priv->slots[i];
+        }
+    }
+
+    if (slot != NULL)
+    {
+        slot->vfo = vfo;
+        slot->freq = freq;
+        slot->pending = 1;
+
+        clock_gettime(CLOCK_REALTIME, &slot->due);
+        slot->due.tv_sec += verify_ms / 1000;
+        slot->due.tv_nsec += (long)(verify_ms % 1000) * 1000000L;
+
+        if (slot->due.tv_nsec >= 1000000000L)
+        {
+            slot->due.tv_sec++;
+            slot->due.tv_nsec -= 1000000000L;
+        }
+
+        pthread_cond_signal(&priv->cond);
+    }
+
+    pthread_mutex_unlock(&priv->mutex);
+}
+
+/* Drop the pending verifications and stop the verifier, called by rig_close() */
+void trusted_set_stop(RIG *rig)
+{
+    struct rig_state *rs = STATE(rig);
+    trusted_set_priv_data *priv = (trusted_set_priv_data *)
+                                  rs->trusted_set_priv_data;
+
+    if (priv == NULL)
+    {
+        return;
+    }
+
+    pthread_mutex_lock(&priv->mutex);
+    priv->run = 0;
+    pthread_cond_signal(&priv->cond);
+    pthread_mutex_unlock(&priv->mutex);
+
+    pthread_join(priv->thread_id, NULL);
+
+    rs->trusted_set_priv_data = NULL;
+
+    pthread_cond_destroy(&priv->cond);
+    pthread_mutex_destroy(&priv->mutex);
+    free(priv);
+}
+
+/** @} */
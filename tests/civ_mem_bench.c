@@ -0,0 +1,315 @@
+/*
+ * Hamlib civ_mem_bench program
+ *
+ * Runs the IC-746PRO backend against a local CI-V stand-in on a network
+ * port, without echo as on USB, that delays every read of the socket as a
+ * slow link would. Reports the time taken to read all memory channels
+ * one rig_get_channel() at a time, then through rig_get_chan_all_cb()
+ * with several 0x1a 0x00 requests in flight, and checks both agree.
+ *
+ * Usage: civ_mem_bench [delay_ms]
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/time.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#include "hamlib/rig.h"
+#include "hamlib/port.h"
+
+#define RIG_ADDR 0x66
+#define CTRL_ADDR 0xe0
+#define MEM_LEN 46      /* flag, rx and tx settings, name */
+
+static int delay_ms = 10;
+
+static int listen_fd = -1;
+static volatile int reads;
+static volatile int frames;
+
+static channel_t channels[103];
+
+static double now_ms(void)
+{
+    struct timeval tv;
+
+    gettimeofday(&tv, NULL);
+
+    return tv.tv_sec * 1e3 + tv.tv_usec / 1e3;
+}
+
+/* Little endian BCD, two digits per byte */
+static void to_bcd_le(unsigned char *bcd, unsigned long long val, int len)
+{
+    int i;
+
+    for (i = 0; i < len; i++, val /= 100)
+    {
+        bcd[i] = (val % 10) | ((val / 10 % 10) << 4);
+    }
+}
+
+/* Channels 1 to 40 programmed, the others empty */
+static int mem_content(int ch, unsigned char *mem)
+{
+    if (ch < 1 || ch > 40)
+    {
+        return 0;
+    }
+
+    memset(mem, 0, MEM_LEN);
+    mem[0] = ch % 2 ? 0x01 : 0x00;                  // scan skip
+    to_bcd_le(mem + 1, 7000000ULL + ch * 1000, 5);  // rx frequency
+    mem[6] = ch % 2 ? 0x01 : 0x00;                  // USB or LSB
+    mem[7] = 0x01;                                  // FIL1
+    to_bcd_le(mem + 18, 7000000ULL + ch * 1000, 5); // tx frequency
+    mem[23] = mem[6];
+    mem[24] = 0x01;
+    snprintf((char *) mem + 35, 10, "CH%-7d", ch);
+
+    return MEM_LEN;
+}
+
+/* Appends the reply to one CI-V command, body from cmd to before 0xfd */
+static void answer(const unsigned char *body, int body_len, unsigned char *out,
+                   int *out_len)
+{
+    unsigned char *p = out + *out_len;
+    int n = 0;
+
+    frames++;
+
+    p[n++] = 0xfe;
+    p[n++] = 0xfe;
+    p[n++] = CTRL_ADDR;
+    p[n++] = RIG_ADDR;
+
+    if (body[0] == 0x03)
+    {
+        p[n++] = 0x03;
+        to_bcd_le(p + n, 14074000, 5);
+        n += 5;
+    }
+    else if (body[0] == 0x1a && body_len == 4 && body[1] == 0x00)
+    {
+        int ch = (body[2] >> 4) * 1000 + (body[2] & 0x0f) * 100
+                 + (body[3] >> 4) * 10 + (body[3] & 0x0f);
+
+        memcpy(p + n, body, 4);
+        n += 4;
+        n += mem_content(ch, p + n);
+
+        if (n == 8) { p[n++] = 0xff; }    // blank channel
+    }
+    else if (body[0] == 0x1a && body_len == 3 && body[1] == 0x05)
+    {
+        // band default duplex offset, 600 kHz
+        memcpy(p + n, body, 3);
+        n += 3;
+        to_bcd_le(p + n, 6000, 3);
+        n += 3;
+    }
+    else
+    {
+        p[n++] = 0xfa;
+    }
+
+    p[n++] = 0xfd;
+    *out_len += n;
+}
+
+/* One CI-V link, every read of the socket delayed */
+static void *server(void *arg)
+{
+    unsigned char in[4096];
+    int in_len = 0;
+    int fd;
+
+    fd = accept(listen_fd, NULL, NULL);
+
+    for (;;)
+    {
+        unsigned char out[16384];
+        int out_len = 0;
+        int start = 0, i;
+        int len = read(fd, in + in_len, sizeof(in) - in_len);
+
+        if (len <= 0)
+        {
+            break;
+        }
+
+        reads++;
+        usleep(delay_ms * 1000);
+
+        in_len += len;
+
+        for (i = 0; i < in_len; i++)
+        {
+            if (in[i] != 0xfd) { continue; }
+
+            // fe fe to from cmd ... fd
+            while (start < i && in[start] == 0xfe) { start++; }
+
+            if (i - start > 2 && in[start] == RIG_ADDR)
+            {
+                answer(in + start + 2, i - start - 2, out, &out_len);
+            }
+
+            start = i + 1;
+        }
+
+        in_len -= start;
+        memmove(in, in + start, in_len);
+
+        if (out_len > 0 && write(fd, out, out_len) < 0)
+        {
+            break;
+        }
+    }
+
+    close(fd);
+
+    return NULL;
+}
+
+static void report(const char *name, double ms)
+{
+    printf("%-22s %8.1f ms %6d round trips %6d frames\n", name, ms, reads, frames);
+}
+
+static int chan_cb(RIG *rig, vfo_t vfo, channel_t **chan, int channel_num,
+                   const chan_t *chan_list, rig_ptr_t arg)
+{
+    if (channel_num < 0 || channel_num >= 103)
+    {
+        return -RIG_EINVAL;
+    }
+
+    *chan = &channels[channel_num];
+
+    return RIG_OK;
+}
+
+int main(int argc, const char *argv[])
+{
+    struct sockaddr_in addr;
+    socklen_t addr_len = sizeof(addr);
+    pthread_t thread;
+    channel_t chan;
+    char path[64];
+    double start;
+    RIG *rig;
+    int ch, errors = 0;
+
+    if (argc > 1) { delay_ms = atoi(argv[1]); }
+
+    if (delay_ms < 0)
+    {
+        fprintf(stderr, "Usage: %s [delay_ms]\n", argv[0]);
+        return 1;
+    }
+
+    rig_set_debug(RIG_DEBUG_NONE);
+
+    listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    if (listen_fd < 0
+            || bind(listen_fd, (struct sockaddr *) &addr, sizeof(addr)) < 0
+            || listen(listen_fd, 1) < 0
+            || getsockname(listen_fd, (struct sockaddr *) &addr, &addr_len) < 0)
+    {
+        perror("server");
+        return 1;
+    }
+
+    pthread_create(&thread, NULL, server, NULL);
+
+    rig = rig_init(RIG_MODEL_IC746PRO);
+
+    if (rig == NULL)
+    {
+        fprintf(stderr, "rig_init failed\n");
+        return 1;
+    }
+
+    snprintf(path, sizeof(path), "localhost:%d", ntohs(addr.sin_port));
+    strncpy(HAMLIB_RIGPORT(rig)->pathname, path, HAMLIB_FILPATHLEN - 1);
+    // no background polling to share the link with
+    rig_set_conf(rig, rig_token_lookup(rig, "poll_interval"), "0");
+
+    if (rig_open(rig) != RIG_OK)
+    {
+        fprintf(stderr, "rig_open failed\n");
+        return 1;
+    }
+
+    printf("CI-V stand-in: %d ms per read\n", delay_ms);
+
+    reads = frames = 0;
+    start = now_ms();
+
+    for (ch = 1; ch <= 102; ch++)
+    {
+        memset(&chan, 0, sizeof(chan));
+        chan.vfo = RIG_VFO_MEM;
+        chan.channel_num = ch;
+
+        if (rig_get_channel(rig, RIG_VFO_MEM, &chan, 1) != RIG_OK)
+        {
+            fprintf(stderr, "rig_get_channel %d failed\n", ch);
+            return 1;
+        }
+
+        channels[ch] = chan;
+    }
+
+    report("one by one", now_ms() - start);
+
+    reads = frames = 0;
+    start = now_ms();
+
+    if (rig_get_chan_all_cb(rig, RIG_VFO_MEM, chan_cb, NULL) != RIG_OK)
+    {
+        fprintf(stderr, "rig_get_chan_all_cb failed\n");
+        return 1;
+    }
+
+    report("rig_get_chan_all_cb", now_ms() - start);
+
+    for (ch = 1; ch <= 102; ch++)
+    {
+        memset(&chan, 0, sizeof(chan));
+        chan.vfo = RIG_VFO_MEM;
+        chan.channel_num = ch;
+
+        // the pipelined readout must match one read on its own
+        if (rig_get_channel(rig, RIG_VFO_MEM, &chan, 1) != RIG_OK
+                || chan.freq != channels[ch].freq || chan.mode != channels[ch].mode
+                || chan.flags != channels[ch].flags
+                || chan.rptr_offs != channels[ch].rptr_offs
+                || strcmp(chan.channel_desc, channels[ch].channel_desc) != 0
+                || (ch <= 40 && chan.freq != 7000000 + ch * 1000))
+        {
+            fprintf(stderr, "channel %d differs\n", ch);
+            errors++;
+        }
+    }
+
+    rig_close(rig);
+    rig_cleanup(rig);
+
+    pthread_join(thread, NULL);
+    close(listen_fd);
+
+    return errors ? 1 : 0;
+}
@@ -0,0 +1,161 @@
+/*
+ * Hamlib freq_coalesce_bench program
+ *
+ * Sweeps the frequency of a dummy rig like a tuning knob, with every
+ * backend write delayed to simulate a slow CAT link, and reports how far
+ * the rig lags behind the knob with and without rig_set_freq_coalescing().
+ *
+ * Usage: freq_coalesce_bench [link_ms [knob_events [knob_period_ms]]]
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/time.h>
+
+#include "hamlib/rig.h"
+
+#define MAX_EVENTS 10000
+#define BASE_FREQ 14000000
+#define STEP_FREQ 10
+
+static int link_ms = 30;
+static int knob_events = 200;
+static int knob_period_ms = 10;
+
+static int (*backend_set_freq)(RIG *rig, vfo_t vfo, freq_t freq);
+static double write_time[MAX_EVENTS];
+static freq_t write_freq[MAX_EVENTS];
+static int writes;
+
+static double now_ms(void)
+{
+    struct timeval tv;
+
+    gettimeofday(&tv, NULL);
+
+    return tv.tv_sec * 1e3 + tv.tv_usec / 1e3;
+}
+
+static int slow_set_freq(RIG *rig, vfo_t vfo, freq_t freq)
+{
+    int retval;
+
+    usleep(link_ms * 1000);
+    retval = backend_set_freq(rig, vfo, freq);
+
+    if (writes < MAX_EVENTS)
+    {
+        write_time[writes] = now_ms();
+        write_freq[writes] = freq;
+        writes++;
+    }
+
+    return retval;
+}
+
+static void sweep(const char *name, int coalesce)
+{
+    static struct rig_caps slow_caps;
+    double knob_time[MAX_EVENTS];
+    double start, blocked = 0, total_lag = 0, max_lag = 0, final_lag = 0;
+    RIG *rig;
+    int i, w;
+
+    rig = rig_init(RIG_MODEL_DUMMY);
+
+    if (rig == NULL)
+    {
+        fprintf(stderr, "rig_init failed\n");
+        exit(1);
+    }
+
+    slow_caps = *rig->caps;
+    backend_set_freq = slow_caps.set_freq;
+    slow_caps.set_freq = slow_set_freq;
+    rig->caps = &slow_caps;
+
+    if (rig_open(rig) != RIG_OK)
+    {
+        fprintf(stderr, "rig_open failed\n");
+        exit(1);
+    }
+
+    if (coalesce)
+    {
+        rig_set_freq_coalescing(rig, 0);
+    }
+
+    writes = 0;
+    start = now_ms();
+
+    for (i = 0; i < knob_events; i++)
+    {
+        double t;
+
+        knob_time[i] = start + (double) i * knob_period_ms;
+        t = now_ms();
+
+        if (t < knob_time[i])
+        {
+            usleep((useconds_t)((knob_time[i] - t) * 1000));
+        }
+
+        t = now_ms();
+        rig_set_freq(rig, RIG_VFO_A, BASE_FREQ + i * STEP_FREQ);
+        blocked += now_ms() - t;
+    }
+
+    rig_wait_set_freq(rig, RIG_VFO_A, 60000);
+
+    // the sweep only goes up, so the first write at or above a knob position shows it
+    for (i = 0, w = 0; i < knob_events; i++)
+    {
+        double lag;
+
+        while (w < writes && write_freq[w] < BASE_FREQ + i * STEP_FREQ)
+        {
+            w++;
+        }
+
+        lag = w < writes ? write_time[w] - knob_time[i] : 0;
+        total_lag += lag;
+        max_lag = lag > max_lag ? lag : max_lag;
+        final_lag = lag;
+    }
+
+    printf("%-12s %6d writes %9.2f ms/call blocked %9.1f ms avg lag %9.1f ms max lag %9.1f ms final lag\n",
+           name, writes, blocked / knob_events, total_lag / knob_events, max_lag,
+           final_lag);
+
+    rig_close(rig);
+    rig_cleanup(rig);
+}
+
+int main(int argc, const char *argv[])
+{
+    if (argc > 1) { link_ms = atoi(argv[1]); }
+
+    if (argc > 2) { knob_events = atoi(argv[2]); }
+
+    if (argc > 3) { knob_period_ms = atoi(argv[3]); }
+
+    if (link_ms < 0 || knob_events < 1 || knob_events > MAX_EVENTS
+            || knob_period_ms < 0)
+    {
+        fprintf(stderr, "Usage: %s [link_ms [knob_events [knob_period_ms]]]\n",
+                argv[0]);
+        return 1;
+    }
+
+    rig_set_debug(RIG_DEBUG_NONE);
+
+    printf("Knob sweep: %d events every %d ms, %d ms per CAT write\n",
+           knob_events, knob_period_ms, link_ms);
+
+    sweep("direct", 0);
+    sweep("coalescing", 1);
+
+    return 0;
+}
@@ -0,0 +1,180 @@
+/*
+ * Hamlib ptt_bench program
+ *
+ * Measures the time from rig_set_ptt() to the change of a serial RTS PTT
+ * line while another thread keeps a slow CAT link busy. The line is
+ * watched through a second descriptor of the same device.
+ *
+ * Usage: ptt_bench [ptt_device [cat_ms [samples]]]
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/ioctl.h>
+#include <sys/time.h>
+
+#include "hamlib/rig.h"
+
+#define MAX_SAMPLES 1000
+
+static const char *ptt_device = "/dev/ttyS0";
+static int cat_ms = 50;
+static int samples = 50;
+
+static int (*backend_get_freq)(RIG *rig, vfo_t vfo, freq_t *freq);
+static volatile int cat_run;
+
+static double now_us(void)
+{
+    struct timeval tv;
+
+    gettimeofday(&tv, NULL);
+
+    return tv.tv_sec * 1e6 + tv.tv_usec;
+}
+
+static int slow_get_freq(RIG *rig, vfo_t vfo, freq_t *freq)
+{
+    usleep(cat_ms * 1000);
+    return backend_get_freq(rig, vfo, freq);
+}
+
+static void *cat_load(void *arg)
+{
+    RIG *rig = (RIG *) arg;
+    freq_t freq;
+
+    while (cat_run)
+    {
+        rig_get_freq(rig, RIG_VFO_A, &freq);
+    }
+
+    return NULL;
+}
+
+/* Microseconds from the call to the RTS line reading the new state */
+static double key(RIG *rig, int watch_fd, ptt_t ptt)
+{
+    int want = ptt != RIG_PTT_OFF;
+    double start = now_us();
+    int lines;
+
+    rig_set_ptt(rig, RIG_VFO_CURR, ptt);
+
+    do
+    {
+        if (ioctl(watch_fd, TIOCMGET, &lines) < 0)
+        {
+            return -1;
+        }
+    }
+    while (((lines & TIOCM_RTS) != 0) != want && now_us() - start < 1e6);
+
+    return now_us() - start;
+}
+
+static void run(RIG *rig, int watch_fd, const char *name)
+{
+    double total = 0, max = 0;
+    int i;
+
+    for (i = 0; i < samples; i++)
+    {
+        double t = key(rig, watch_fd, RIG_PTT_ON);
+
+        key(rig, watch_fd, RIG_PTT_OFF);
+
+        if (t < 0)
+        {
+            fprintf(stderr, "cannot read the RTS line of %s\n", ptt_device);
+            exit(1);
+        }
+
+        total += t;
+        max = t > max ? t : max;
+
+        // lands the next key-down at a different point of the CAT read
+        usleep((useconds_t)(rand() % (cat_ms + 1)) * 1000);
+    }
+
+    printf("%-12s %9.1f us avg %9.1f us max PTT on latency\n", name,
+           total / samples, max);
+}
+
+int main(int argc, const char *argv[])
+{
+    static struct rig_caps slow_caps;
+    pthread_t cat_thread;
+    int watch_fd;
+    RIG *rig;
+
+    if (argc > 1) { ptt_device = argv[1]; }
+
+    if (argc > 2) { cat_ms = atoi(argv[2]); }
+
+    if (argc > 3) { samples = atoi(argv[3]); }
+
+    if (cat_ms < 0 || samples < 1 || samples > MAX_SAMPLES)
+    {
+        fprintf(stderr, "Usage: %s [ptt_device [cat_ms [samples]]]\n", argv[0]);
+        return 1;
+    }
+
+    rig_set_debug(RIG_DEBUG_NONE);
+
+    rig = rig_init(RIG_MODEL_DUMMY);
+
+    if (rig == NULL)
+    {
+        fprintf(stderr, "rig_init failed\n");
+        return 1;
+    }
+
+    slow_caps = *rig->caps;
+    backend_get_freq = slow_caps.get_freq;
+    slow_caps.get_freq = slow_get_freq;
+    rig->caps = &slow_caps;
+
+    rig_set_conf(rig, rig_token_lookup(rig, "ptt_type"), "RTS");
+    rig_set_conf(rig, rig_token_lookup(rig, "ptt_pathname"), ptt_device);
+
+    if (rig_open(rig) != RIG_OK)
+    {
+        fprintf(stderr, "rig_open failed, is %s a serial port?\n", ptt_device);
+        return 1;
+    }
+
+    // every CAT read goes to the rig
+    rig_set_cache_timeout_ms(rig, HAMLIB_CACHE_ALL, 0);
+
+    watch_fd = open(ptt_device, O_RDWR | O_NOCTTY | O_NONBLOCK);
+
+    if (watch_fd < 0)
+    {
+        fprintf(stderr, "cannot open %s\n", ptt_device);
+        return 1;
+    }
+
+    printf("PTT on RTS of %s, %d samples, %d ms per CAT read\n", ptt_device,
+           samples, cat_ms);
+
+    run(rig, watch_fd, "idle");
+
+    cat_run = 1;
+    pthread_create(&cat_thread, NULL, cat_load, rig);
+
+    run(rig, watch_fd, "CAT load");
+
+    cat_run = 0;
+    pthread_join(cat_thread, NULL);
+
+    close(watch_fd);
+    rig_close(rig);
+    rig_cleanup(rig);
+
+    return 0;
+}
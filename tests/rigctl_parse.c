@@ -29,6 +29,7 @@
 #include "hamlib/config.h"
 
 #include <stdint.h>
+#include <stdarg.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -236,6 +237,8 @@ declare_proto_rig(get_info);
 declare_proto_rig(dump_caps);
 declare_proto_rig(dump_conf);
 declare_proto_rig(dump_state);
+declare_proto_rig(dump_state_hash);
+declare_proto_rig(dump_state_blob);
 declare_proto_rig(set_ant);
 declare_proto_rig(get_ant);
 declare_proto_rig(reset);
@@ -365,6 +368,8 @@ static struct test_table test_list[] =
     { '1',  "dump_caps",        ACTION(dump_caps),      ARG_NOVFO },
     { '3',  "dump_conf",        ACTION(dump_conf),      ARG_NOVFO },
     { 0x8f, "dump_state",       ACTION(dump_state),     ARG_OUT | ARG_NOVFO },
+    { 0xae, "dump_state_hash",  ACTION(dump_state_hash), ARG_OUT | ARG_NOVFO },
+    { 0xaf, "dump_state_blob",  ACTION(dump_state_blob), ARG_OUT | ARG_NOVFO },
     { 0xf0, "chk_vfo",          ACTION(chk_vfo),        ARG_NOVFO, "ChkVFO" },   /* rigctld only--check for VFO mode */
     { 0xf2, "set_vfo_opt",      ACTION(set_vfo_opt),    ARG_NOVFO | ARG_IN, "Status" }, /* turn vfo option on/off */
     { 0xf3, "get_vfo_info",     ACTION(get_vfo_info),   ARG_IN1 | ARG_NOVFO | ARG_OUT5, "VFO", "Freq", "Mode", "Width", "Split", "SatMode" }, /* get several vfo parameters at once */
@@ -1832,6 +1837,8 @@ readline_repeat:
                 && cmd_entry->cmd != '1' // dump_caps
                 && cmd_entry->cmd != '3' // dump_conf
                 && cmd_entry->cmd != 0x8f // dump_state
+                && cmd_entry->cmd != 0xae // dump_state_hash
+                && cmd_entry->cmd != 0xaf // dump_state_blob
                 && cmd_entry->cmd != 0xf0 // chk_vfo
                 && cmd_entry->cmd != 0x87 // set_powerstat
                 && cmd_entry->cmd != 0x88 // get_powerstat
@@ -4671,31 +4678,75 @@ declare_proto_rig(dump_caps)
 }
 
 
-/* For rigctld internal use */
-declare_proto_rig(dump_state)
+/* Growable buffer the dump_state answer is rendered into */
+struct dump_buf
+{
+    char *text;
+    size_t len;
+    size_t size;
+    int error;
+};
+
+static void dump_buf_printf(struct dump_buf *out, const char *fmt, ...)
+{
+    va_list ap;
+    int n;
+
+    while (!out->error)
+    {
+        size_t avail = out->size - out->len;
+        char *text;
+
+        va_start(ap, fmt);
+        n = vsnprintf(out->text ? out->text + out->len : NULL, avail, fmt, ap);
+        va_end(ap);
+
+        if (n < 0)
+        {
+            out->error = 1;
+        }
+        else if ((size_t) n < avail)
+        {
+            out->len += n;
+            return;
+        }
+        else if ((text = realloc(out->text, out->len + n + 4096)) == NULL)
+        {
+            out->error = 1;
+        }
+        else
+        {
+            out->text = text;
+            out->size = out->len + n + 4096;
+        }
+    }
+}
+
+/* Renders the dump_state answer, on success the caller frees out->text */
+static int dump_state_render(RIG *rig, struct dump_buf *out)
 {
     int i;
     struct rig_state *rs = STATE(rig);
     char buf[1024];
 
-    ENTERFUNC2;
+    memset(out, 0, sizeof(*out));
 
     /*
      * - Protocol version
      */
 #define RIGCTLD_PROT_VER 1
-    fprintf(fout, "%d\n", RIGCTLD_PROT_VER);
-    fprintf(fout, "%d\n", rig->caps->rig_model);
+    dump_buf_printf(out, "%d\n", RIGCTLD_PROT_VER);
+    dump_buf_printf(out, "%d\n", rig->caps->rig_model);
 #if 0 // deprecated -- not one rig uses this
-    fprintf(fout, "%d\n", rs->itu_region);
+    dump_buf_printf(out, "%d\n", rs->itu_region);
 #else  // need to print something to maintain backward compatibility
-    fprintf(fout, "%d\n", 0);
+    dump_buf_printf(out, "%d\n", 0);
 #endif
 
     for (i = 0; i < HAMLIB_FRQRANGESIZ
             && !RIG_IS_FRNG_END(rs->rx_range_list[i]); i++)
     {
-        fprintf(fout,
+        dump_buf_printf(out,
                 "%"FREQFMT" %"FREQFMT" 0x%"PRXll" %d %d 0x%x 0x%x\n",
                 rs->rx_range_list[i].startf,
                 rs->rx_range_list[i].endf,
@@ -4706,12 +4757,12 @@ declare_proto_rig(dump_state)
                 rs->rx_range_list[i].ant);
     }
 
-    fprintf(fout, "0 0 0 0 0 0 0\n");
+    dump_buf_printf(out, "0 0 0 0 0 0 0\n");
 
     for (i = 0; i < HAMLIB_FRQRANGESIZ
             && !RIG_IS_FRNG_END(rs->tx_range_list[i]); i++)
     {
-        fprintf(fout,
+        dump_buf_printf(out,
                 "%"FREQFMT" %"FREQFMT" 0x%"PRXll" %d %d 0x%x 0x%x\n",
                 rs->tx_range_list[i].startf,
                 rs->tx_range_list[i].endf,
@@ -4722,57 +4773,57 @@ declare_proto_rig(dump_state)
                 rs->tx_range_list[i].ant);
     }
 
-    fprintf(fout, "0 0 0 0 0 0 0\n");
+    dump_buf_printf(out, "0 0 0 0 0 0 0\n");
 
     for (i = 0; i < HAMLIB_TSLSTSIZ && !RIG_IS_TS_END(rs->tuning_steps[i]); i++)
     {
-        fprintf(fout,
+        dump_buf_printf(out,
                 "0x%"PRXll" %ld\n",
                 rs->tuning_steps[i].modes,
                 rs->tuning_steps[i].ts);
     }
 
-    fprintf(fout, "0 0\n");
+    dump_buf_printf(out, "0 0\n");
 
     for (i = 0; i < HAMLIB_FLTLSTSIZ && !RIG_IS_FLT_END(rs->filters[i]); i++)
     {
-        fprintf(fout,
+        dump_buf_printf(out,
                 "0x%"PRXll" %ld\n",
                 rs->filters[i].modes,
                 rs->filters[i].width);
     }
 
-    fprintf(fout, "0 0\n");
+    dump_buf_printf(out, "0 0\n");
 
 #if 0
     chan_t chan_list[HAMLIB_CHANLSTSIZ]; /*!< Channel list, zero ended */
 #endif
 
-    fprintf(fout, "%ld\n", rs->max_rit);
-    fprintf(fout, "%ld\n", rs->max_xit);
-    fprintf(fout, "%ld\n", rs->max_ifshift);
-    fprintf(fout, "%d\n", rs->announces);
+    dump_buf_printf(out, "%ld\n", rs->max_rit);
+    dump_buf_printf(out, "%ld\n", rs->max_xit);
+    dump_buf_printf(out, "%ld\n", rs->max_ifshift);
+    dump_buf_printf(out, "%d\n", rs->announces);
 
     for (i = 0; i < HAMLIB_MAXDBLSTSIZ && rs->preamp[i]; i++)
     {
-        fprintf(fout, "%d ", rs->preamp[i]);
+        dump_buf_printf(out, "%d ", rs->preamp[i]);
     }
 
-    fprintf(fout, "\n");
+    dump_buf_printf(out, "\n");
 
     for (i = 0; i < HAMLIB_MAXDBLSTSIZ && rs->attenuator[i]; i++)
     {
-        fprintf(fout, "%d ", rs->attenuator[i]);
+        dump_buf_printf(out, "%d ", rs->attenuator[i]);
     }
 
-    fprintf(fout, "\n");
+    dump_buf_printf(out, "\n");
 
-    fprintf(fout, "0x%"PRXll"\n", rs->has_get_func);
-    fprintf(fout, "0x%"PRXll"\n", rs->has_set_func);
-    fprintf(fout, "0x%"PRXll"\n", rs->has_get_level);
-    fprintf(fout, "0x%"PRXll"\n", rs->has_set_level);
-    fprintf(fout, "0x%"PRXll"\n", rs->has_get_parm);
-    fprintf(fout, "0x%"PRXll"\n", rs->has_set_parm);
+    dump_buf_printf(out, "0x%"PRXll"\n", rs->has_get_func);
+    dump_buf_printf(out, "0x%"PRXll"\n", rs->has_set_func);
+    dump_buf_printf(out, "0x%"PRXll"\n", rs->has_get_level);
+    dump_buf_printf(out, "0x%"PRXll"\n", rs->has_set_level);
+    dump_buf_printf(out, "0x%"PRXll"\n", rs->has_get_parm);
+    dump_buf_printf(out, "0x%"PRXll"\n", rs->has_set_parm);
 
     // protocol 1 fields are "setting=value"
     // protocol 1 allows fields can be listed/processed in any order
@@ -4783,65 +4834,65 @@ declare_proto_rig(dump_state)
 
     if (chk_vfo_executed) // for 3.3 compatibility
     {
-        fprintf(fout, "vfo_ops=0x%x\n", rig->caps->vfo_ops);
-        fprintf(fout, "ptt_type=0x%x\n",
+        dump_buf_printf(out, "vfo_ops=0x%x\n", rig->caps->vfo_ops);
+        dump_buf_printf(out, "ptt_type=0x%x\n",
                 PTTPORT(rig)->type.ptt);
-        fprintf(fout, "targetable_vfo=0x%x\n", rig->caps->targetable_vfo);
-        fprintf(fout, "has_set_vfo=%d\n", rig->caps->set_vfo != NULL);
-        fprintf(fout, "has_get_vfo=%d\n", rig->caps->get_vfo != NULL);
-        fprintf(fout, "has_set_freq=%d\n", rig->caps->set_freq != NULL);
-        fprintf(fout, "has_get_freq=%d\n", rig->caps->get_freq != NULL);
-        fprintf(fout, "has_set_conf=%d\n", rig->caps->set_conf != NULL);
-        fprintf(fout, "has_get_conf=%d\n", rig->caps->get_conf != NULL);
+        dump_buf_printf(out, "targetable_vfo=0x%x\n", rig->caps->targetable_vfo);
+        dump_buf_printf(out, "has_set_vfo=%d\n", rig->caps->set_vfo != NULL);
+        dump_buf_printf(out, "has_get_vfo=%d\n", rig->caps->get_vfo != NULL);
+        dump_buf_printf(out, "has_set_freq=%d\n", rig->caps->set_freq != NULL);
+        dump_buf_printf(out, "has_get_freq=%d\n", rig->caps->get_freq != NULL);
+        dump_buf_printf(out, "has_set_conf=%d\n", rig->caps->set_conf != NULL);
+        dump_buf_printf(out, "has_get_conf=%d\n", rig->caps->get_conf != NULL);
 #if 0
-        fprintf(fout, "has_set_parm=%d\n", rig->caps->set_parm != NULL);
-        fprintf(fout, "has_get_parm=%d\n", rig->caps->get_parm != NULL);
-        fprintf(fout, "parm_gran=0x%x\n", rig->caps->parm_gran);
+        dump_buf_printf(out, "has_set_parm=%d\n", rig->caps->set_parm != NULL);
+        dump_buf_printf(out, "has_get_parm=%d\n", rig->caps->get_parm != NULL);
+        dump_buf_printf(out, "parm_gran=0x%x\n", rig->caps->parm_gran);
 #endif
         // for the future
 //        fprintf(fout, "has_set_trn=%d\n", rig->caps->set_trn != NULL);
 //        fprintf(fout, "has_get_trn=%d\n", rig->caps->get_trn != NULL);
-        fprintf(fout, "has_power2mW=%d\n", rig->caps->power2mW != NULL);
-        fprintf(fout, "has_mW2power=%d\n", rig->caps->mW2power != NULL);
-        fprintf(fout, "has_get_ant=%d\n", rig->caps->get_ant != NULL);
-        fprintf(fout, "has_set_ant=%d\n", rig->caps->set_ant != NULL);
-        fprintf(fout, "timeout=%d\n", rig->caps->timeout);
-        fprintf(fout, "rig_model=%d\n", rig->caps->rig_model);
-        fprintf(fout, "rigctld_version=%s\n", hamlib_version2);
+        dump_buf_printf(out, "has_power2mW=%d\n", rig->caps->power2mW != NULL);
+        dump_buf_printf(out, "has_mW2power=%d\n", rig->caps->mW2power != NULL);
+        dump_buf_printf(out, "has_get_ant=%d\n", rig->caps->get_ant != NULL);
+        dump_buf_printf(out, "has_set_ant=%d\n", rig->caps->set_ant != NULL);
+        dump_buf_printf(out, "timeout=%d\n", rig->caps->timeout);
+        dump_buf_printf(out, "rig_model=%d\n", rig->caps->rig_model);
+        dump_buf_printf(out, "rigctld_version=%s\n", hamlib_version2);
         rig_sprintf_agc_levels(rig, buf, sizeof(buf));
 
-        if (strlen(buf) > 0) { fprintf(fout, "agc_levels=%s\n", buf); }
+        if (strlen(buf) > 0) { dump_buf_printf(out, "agc_levels=%s\n", buf); }
 
         if (rig->caps->ctcss_list)
         {
-            fprintf(fout, "ctcss_list=");
+            dump_buf_printf(out, "ctcss_list=");
 
             for (i = 0; i < CTCSS_LIST_SIZE && rig->caps->ctcss_list[i] != 0; i++)
             {
-                fprintf(fout,
+                dump_buf_printf(out,
                         " %u.%1u",
                         rig->caps->ctcss_list[i] / 10, rig->caps->ctcss_list[i] % 10);
             }
 
-            fprintf(fout, "\n");
+            dump_buf_printf(out, "\n");
         }
 
         if (rig->caps->dcs_list)
         {
-            fprintf(fout, "dcs_list=");
+            dump_buf_printf(out, "dcs_list=");
 
             for (i = 0; i < DCS_LIST_SIZE && rig->caps->dcs_list[i] != 0; i++)
             {
-                fprintf(fout,
+                dump_buf_printf(out,
                         " %u",
                         rig->caps->dcs_list[i]);
             }
 
-            fprintf(fout, "\n");
+            dump_buf_printf(out, "\n");
         }
 
 
-        fprintf(fout, "level_gran=");
+        dump_buf_printf(out, "level_gran=");
 
         for (i = 0; i < RIG_SETTING_MAX; ++i)
         {
@@ -4849,17 +4900,17 @@ declare_proto_rig(dump_state)
 
             if (RIG_LEVEL_IS_FLOAT(level))
             {
-                fprintf(fout, "%d=%g,%g,%g;", i, rs->level_gran[i].min.f,
+                dump_buf_printf(out, "%d=%g,%g,%g;", i, rs->level_gran[i].min.f,
                         rs->level_gran[i].max.f, rs->level_gran[i].step.f);
             }
             else
             {
-                fprintf(fout, "%d=%d,%d,%d;", i, rs->level_gran[i].min.i,
+                dump_buf_printf(out, "%d=%d,%d,%d;", i, rs->level_gran[i].min.i,
                         rs->level_gran[i].max.i, rs->level_gran[i].step.i);
             }
         }
 
-        fprintf(fout, "\nparm_gran=");
+        dump_buf_printf(out, "\nparm_gran=");
 
         for (i = 0; i < RIG_SETTING_MAX; ++i)
         {
@@ -4867,28 +4918,126 @@ declare_proto_rig(dump_state)
 
             if (RIG_PARM_IS_FLOAT(parm))
             {
-                fprintf(fout, "%d=%g,%g,%g;", i, rs->parm_gran[i].min.f,
+                dump_buf_printf(out, "%d=%g,%g,%g;", i, rs->parm_gran[i].min.f,
                         rs->parm_gran[i].max.f, rs->parm_gran[i].step.f);
             }
             else if (RIG_PARM_IS_STRING(parm))
             {
-                fprintf(fout, "%d=%s;", i, rs->parm_gran[i].step.cs);
+                dump_buf_printf(out, "%d=%s;", i, rs->parm_gran[i].step.cs);
             }
             else
             {
-                fprintf(fout, "%d=%d,%d,%d;", i, rs->level_gran[i].min.i,
+                dump_buf_printf(out, "%d=%d,%d,%d;", i, rs->level_gran[i].min.i,
                         rs->level_gran[i].max.i, rs->level_gran[i].step.i);
             }
         }
 
-        fprintf(fout, "\n");
+        dump_buf_printf(out, "\n");
 
         rs->rig_model = rig->caps->rig_model;
-        fprintf(fout, "rig_model=%d\n", rs->rig_model);
-        fprintf(fout, "hamlib_version=%s\n", hamlib_version2);
-        fprintf(fout, "done\n");
+        dump_buf_printf(out, "rig_model=%d\n", rs->rig_model);
+        dump_buf_printf(out, "hamlib_version=%s\n", hamlib_version2);
+        dump_buf_printf(out, "done\n");
+    }
+
+    if (out->error || out->len == 0)
+    {
+        free(out->text);
+        out->text = NULL;
+        return -RIG_ENOMEM;
+    }
+
+    return RIG_OK;
+}
+
+
+/* For rigctld internal use */
+declare_proto_rig(dump_state)
+{
+    struct dump_buf out;
+    int retval;
+
+    ENTERFUNC2;
+
+    retval = dump_state_render(rig, &out);
+
+    if (retval == RIG_OK)
+    {
+        fwrite(out.text, 1, out.len, fout);
+        free(out.text);
     }
 
+    RETURNFUNC2(retval);
+}
+
+
+/*
+ * The \dump_state answer as one block, for the client to hash and cache.
+ * Returns a malloc'ed copy, NULL on error.
+ */
+#define DUMP_STATE_BLOB_VER 1
+static char *dump_state_text(RIG *rig, size_t *len)
+{
+    struct dump_buf out;
+
+    if (dump_state_render(rig, &out) != RIG_OK)
+    {
+        rig_debug(RIG_DEBUG_ERR, "%s: out of memory\n", __func__);
+        return NULL;
+    }
+
+    *len = out.len;
+
+    return out.text;
+}
+
+
+/* For rigctld internal use -- "version model hash" of the dump_state blob */
+declare_proto_rig(dump_state_hash)
+{
+    char *text;
+    size_t len;
+
+    ENTERFUNC2;
+
+    text = dump_state_text(rig, &len);
+
+    if (text == NULL)
+    {
+        RETURNFUNC2(-RIG_EINTERNAL);
+    }
+
+    fprintf(fout, "%d %d 0x%08lx\n", DUMP_STATE_BLOB_VER, rig->caps->rig_model,
+            (unsigned long) CRC32_function((uint8_t *) text, len));
+    free(text);
+
+    RETURNFUNC2(RIG_OK);
+}
+
+
+/*
+ * For rigctld internal use -- "version model hash length" line followed by
+ * length bytes of the dump_state answer
+ */
+declare_proto_rig(dump_state_blob)
+{
+    char *text;
+    size_t len;
+
+    ENTERFUNC2;
+
+    text = dump_state_text(rig, &len);
+
+    if (text == NULL)
+    {
+        RETURNFUNC2(-RIG_EINTERNAL);
+    }
+
+    fprintf(fout, "%d %d 0x%08lx %lu\n", DUMP_STATE_BLOB_VER, rig->caps->rig_model,
+            (unsigned long) CRC32_function((uint8_t *) text, len), (unsigned long) len);
+    fwrite(text, 1, len, fout);
+    free(text);
+
     RETURNFUNC2(RIG_OK);
 }
 
@@ -0,0 +1,360 @@
+/*
+ * Hamlib rigctl_pipe_bench program
+ *
+ * Runs the netrigctl backend against a local rigctld stand-in that delays
+ * every read of the socket, as a slow network would, and reports the time
+ * taken by rig_open() and by the VFO state read with one command per
+ * round trip, then pipelined through rig_get_vfo_snapshot().
+ * rig_open() is timed against a server without \dump_state_hash, like an
+ * older rigctld, then with it, before and after the answer is cached.
+ *
+ * Usage: rigctl_pipe_bench [delay_ms [rounds]]
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/time.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#include "hamlib/rig.h"
+#include "hamlib/port.h"
+#include "misc.h"
+
+static int delay_ms = 20;
+static int rounds = 20;
+
+static int listen_fd = -1;
+static volatile int commands;
+static volatile int reads;
+static int old_server;
+
+static const char dump_state[] =
+    "1\n"
+    "1\n"
+    "0\n"
+    "150000.000000 1500000000.000000 0x1ff -1 -1 0x3 0x0\n"
+    "0 0 0 0 0 0 0\n"
+    "150000.000000 1500000000.000000 0x1ff 5000 100000 0x3 0x0\n"
+    "0 0 0 0 0 0 0\n"
+    "0x1ff 1\n"
+    "0 0\n"
+    "0x1ff 2400\n"
+    "0 0\n"
+    "0\n"
+    "0\n"
+    "0\n"
+    "0\n"
+    "0\n"
+    "0\n"
+    "0x0\n"
+    "0x0\n"
+    "0x0\n"
+    "0x0\n"
+    "0x0\n"
+    "0x0\n"
+    "vfo_ops=0x0\n"
+    "ptt_type=0x1\n"
+    "done\n";
+
+static double now_ms(void)
+{
+    struct timeval tv;
+
+    gettimeofday(&tv, NULL);
+
+    return tv.tv_sec * 1e3 + tv.tv_usec / 1e3;
+}
+
+/* Appends the answer to one command line */
+static void answer(const char *line, char *out, size_t out_len)
+{
+    size_t len = strlen(out);
+    int vfob = strstr(line, "VFOB") != NULL;
+
+    commands++;
+
+    switch (line[0])
+    {
+    case '\\':
+        if (strcmp(line, "\\chk_vfo") == 0)
+        {
+            snprintf(out + len, out_len - len, "1\n");
+        }
+        else if (strcmp(line, "\\dump_state") == 0)
+        {
+            snprintf(out + len, out_len - len, "%s", dump_state);
+        }
+        else if (old_server && strncmp(line, "\\dump_state_", 12) == 0)
+        {
+            // not known to an older rigctld, which answers nothing
+        }
+        else if (strcmp(line, "\\dump_state_hash") == 0)
+        {
+            snprintf(out + len, out_len - len, "1 1 0x%08lx\n",
+                     (unsigned long) CRC32_function((const uint8_t *) dump_state,
+                             strlen(dump_state)));
+        }
+        else if (strcmp(line, "\\dump_state_blob") == 0)
+        {
+            snprintf(out + len, out_len - len, "1 1 0x%08lx %lu\n%s",
+                     (unsigned long) CRC32_function((const uint8_t *) dump_state,
+                             strlen(dump_state)), (unsigned long) strlen(dump_state), dump_state);
+        }
+        else
+        {
+            snprintf(out + len, out_len - len, "RPRT %d\n",
+                     strncmp(line, "\\get_", 5) == 0 ? -RIG_ENAVAIL : RIG_OK);
+        }
+
+        break;
+
+    case 'v': snprintf(out + len, out_len - len, "VFOA\n"); break;
+
+    case 'f': snprintf(out + len, out_len - len, "%s\n",
+                           vfob ? "7074000" : "14074000"); break;
+
+    case 'm': snprintf(out + len, out_len - len, "%s\n2400\n",
+                           vfob ? "LSB" : "USB"); break;
+
+    case 's': snprintf(out + len, out_len - len, "0\nVFOA\n"); break;
+
+    case 't': snprintf(out + len, out_len - len, "0\n"); break;
+
+    default:
+        snprintf(out + len, out_len - len, "RPRT %d\n",
+                 line[0] >= 'a' && line[0] <= 'z' ? -RIG_ENAVAIL : RIG_OK);
+    }
+}
+
+/* One rigctld connection, every read of the socket delayed */
+static void *server(void *arg)
+{
+    char in[4096];
+    size_t in_len = 0;
+    int fd;
+
+    fd = accept(listen_fd, NULL, NULL);
+
+    for (;;)
+    {
+        char out[8192] = "";
+        char *line, *eol;
+        int len = read(fd, in + in_len, sizeof(in) - in_len - 1);
+
+        if (len <= 0)
+        {
+            break;
+        }
+
+        reads++;
+        usleep(delay_ms * 1000);
+
+        in_len += len;
+        in[in_len] = '\0';
+
+        for (line = in; (eol = strchr(line, '\n')) != NULL; line = eol + 1)
+        {
+            *eol = '\0';
+
+            if (eol > line && eol[-1] == '\r') { eol[-1] = '\0'; }
+
+            answer(line, out, sizeof(out));
+        }
+
+        in_len -= line - in;
+        memmove(in, line, in_len);
+
+        if (out[0] && write(fd, out, strlen(out)) < 0)
+        {
+            break;
+        }
+    }
+
+    close(fd);
+
+    return NULL;
+}
+
+static void report(const char *name, double ms, int n)
+{
+    printf("%-22s %8.1f ms %6.1f round trips %6.1f commands\n", name, ms / n,
+           (double) reads / n, (double) commands / n);
+}
+
+/* Connects to a new server thread, NULL on error */
+static RIG *open_rig(const char *name, int port, pthread_t *thread)
+{
+    char path[64];
+    double start;
+    RIG *rig;
+
+    pthread_create(thread, NULL, server, NULL);
+
+    rig = rig_init(RIG_MODEL_NETRIGCTL);
+
+    if (rig == NULL)
+    {
+        fprintf(stderr, "rig_init failed\n");
+        return NULL;
+    }
+
+    snprintf(path, sizeof(path), "localhost:%d", port);
+    strncpy(HAMLIB_RIGPORT(rig)->pathname, path, HAMLIB_FILPATHLEN - 1);
+    // no background polling to share the link with
+    rig_set_conf(rig, rig_token_lookup(rig, "poll_interval"), "0");
+
+    commands = reads = 0;
+    start = now_ms();
+
+    if (rig_open(rig) != RIG_OK)
+    {
+        fprintf(stderr, "%s failed\n", name);
+        return NULL;
+    }
+
+    report(name, now_ms() - start, 1);
+
+    return rig;
+}
+
+static int close_rig(RIG *rig, pthread_t thread)
+{
+    rig_close(rig);
+    rig_cleanup(rig);
+
+    return pthread_join(thread, NULL);
+}
+
+int main(int argc, const char *argv[])
+{
+    struct sockaddr_in addr;
+    socklen_t addr_len = sizeof(addr);
+    struct rig_vfo_snapshot snapshot;
+    pthread_t thread;
+    char cache[] = "/tmp/rigctl_pipe_benchXXXXXX";
+    char path[128];
+    double start;
+    RIG *rig;
+    int i;
+
+    if (argc > 1) { delay_ms = atoi(argv[1]); }
+
+    if (argc > 2) { rounds = atoi(argv[2]); }
+
+    if (delay_ms < 0 || rounds < 1)
+    {
+        fprintf(stderr, "Usage: %s [delay_ms [rounds]]\n", argv[0]);
+        return 1;
+    }
+
+    rig_set_debug(RIG_DEBUG_NONE);
+
+    listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    if (listen_fd < 0
+            || bind(listen_fd, (struct sockaddr *) &addr, sizeof(addr)) < 0
+            || listen(listen_fd, 1) < 0
+            || getsockname(listen_fd, (struct sockaddr *) &addr, &addr_len) < 0)
+    {
+        perror("server");
+        return 1;
+    }
+
+    // the \dump_state answer is cached in a directory of our own
+    if (mkdtemp(cache) == NULL)
+    {
+        perror("mkdtemp");
+        return 1;
+    }
+
+    setenv("XDG_CACHE_HOME", cache, 1);
+
+    printf("rigctld stand-in: %d ms per read, %d rounds\n", delay_ms, rounds);
+
+    old_server = 1;
+    rig = open_rig("rig_open older rigctld", ntohs(addr.sin_port), &thread);
+
+    if (rig == NULL) { return 1; }
+
+    close_rig(rig, thread);
+
+    old_server = 0;
+    rig = open_rig("rig_open not cached", ntohs(addr.sin_port), &thread);
+
+    if (rig == NULL) { return 1; }
+
+    close_rig(rig, thread);
+
+    rig = open_rig("rig_open cached", ntohs(addr.sin_port), &thread);
+
+    if (rig == NULL) { return 1; }
+
+    // every read goes to the server
+    rig_set_cache_timeout_ms(rig, HAMLIB_CACHE_ALL, 0);
+
+    commands = reads = 0;
+    start = now_ms();
+
+    for (i = 0; i < rounds; i++)
+    {
+        freq_t freq;
+        rmode_t mode;
+        pbwidth_t width;
+        split_t split;
+        vfo_t vfo;
+        ptt_t ptt;
+
+        if (rig_get_vfo(rig, &vfo) != RIG_OK
+                || rig_get_freq(rig, RIG_VFO_A, &freq) != RIG_OK
+                || rig_get_mode(rig, RIG_VFO_A, &mode, &width) != RIG_OK
+                || rig_get_freq(rig, RIG_VFO_B, &freq) != RIG_OK
+                || rig_get_mode(rig, RIG_VFO_B, &mode, &width) != RIG_OK
+                || rig_get_split_vfo(rig, RIG_VFO_CURR, &split, &vfo) != RIG_OK
+                || rig_get_ptt(rig, RIG_VFO_CURR, &ptt) != RIG_OK)
+        {
+            fprintf(stderr, "one by one failed\n");
+            return 1;
+        }
+    }
+
+    report("one by one", now_ms() - start, rounds);
+
+    commands = reads = 0;
+    start = now_ms();
+
+    for (i = 0; i < rounds; i++)
+    {
+        if (rig_get_vfo_snapshot(rig, &snapshot) != RIG_OK)
+        {
+            fprintf(stderr, "rig_get_vfo_snapshot failed\n");
+            return 1;
+        }
+    }
+
+    report("rig_get_vfo_snapshot", now_ms() - start, rounds);
+
+    if (snapshot.vfos[0].freq != 14074000 || snapshot.vfos[1].freq != 7074000
+            || snapshot.vfos[1].mode != RIG_MODE_LSB || snapshot.vfos[1].width != 2400)
+    {
+        fprintf(stderr, "rig_get_vfo_snapshot returned wrong values\n");
+        return 1;
+    }
+
+    close_rig(rig, thread);
+    close(listen_fd);
+
+    snprintf(path, sizeof(path), "%s/hamlib_netrigctl_localhost_%d.dump", cache,
+             ntohs(addr.sin_port));
+    unlink(path);
+    rmdir(cache);
+
+    return 0;
+}
@@ -0,0 +1,163 @@
+/*
+ * Hamlib spectrum_bench program
+ *
+ * Measures the spectrum post-processing stage and the signal detector on
+ * synthetic scope lines, compared to the plain max aggregation loop
+ * consumers used to write.
+ *
+ * Usage: spectrum_bench [line_length [output_width [loops]]]
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <sys/time.h>
+
+#include "hamlib/rig.h"
+
+#define LOOP_COUNT 100000
+
+static double elapsed_us(const struct timeval *tv1, const struct timeval *tv2)
+{
+    return (tv2->tv_sec - tv1->tv_sec) * 1e6 + (tv2->tv_usec - tv1->tv_usec);
+}
+
+static int reference_max(unsigned char *out, const unsigned char *in,
+                         int in_length, int out_length)
+{
+    int i, j;
+
+    for (i = 0; i < out_length; i++)
+    {
+        int start = i * in_length / out_length;
+        int end = (i + 1) * in_length / out_length;
+        unsigned char max = 0;
+
+        for (j = start; j < end; j++)
+        {
+            max = in[j] > max ? in[j] : max;
+        }
+
+        out[i] = max;
+    }
+
+    return out[0];
+}
+
+static void bench(const char *name, const struct rig_spectrum_proc_config *config,
+                  struct rig_spectrum_line *line, int loops)
+{
+    struct rig_spectrum_proc_output output;
+    rig_spectrum_proc_t *proc = rig_spectrum_proc_init(config);
+    struct timeval tv1, tv2;
+    int i;
+
+    gettimeofday(&tv1, NULL);
+
+    for (i = 0; i < loops; i++)
+    {
+        line->spectrum_data[i % line->spectrum_data_length] ^= 1;
+        rig_spectrum_proc_process(proc, line, &output);
+    }
+
+    gettimeofday(&tv2, NULL);
+
+    printf("%-28s %8.3f us/line\n", name, elapsed_us(&tv1, &tv2) / loops);
+
+    rig_spectrum_proc_cleanup(proc);
+}
+
+int main(int argc, const char *argv[])
+{
+    struct rig_spectrum_proc_config config;
+    struct rig_spectrum_line line;
+    unsigned char data[HAMLIB_MAX_SPECTRUM_DATA];
+    unsigned char out[HAMLIB_MAX_SPECTRUM_DATA];
+    int length = 689;
+    int width = 256;
+    int loops = LOOP_COUNT;
+    struct timeval tv1, tv2;
+    int sink = 0;
+    int i;
+
+    if (argc > 1) { length = atoi(argv[1]); }
+
+    if (argc > 2) { width = atoi(argv[2]); }
+
+    if (argc > 3) { loops = atoi(argv[3]); }
+
+    if (length < 1 || length > HAMLIB_MAX_SPECTRUM_DATA || width < 1
+            || width > length || loops < 1)
+    {
+        fprintf(stderr, "Usage: %s [line_length [output_width [loops]]]\n", argv[0]);
+        return 1;
+    }
+
+    for (i = 0; i < length; i++)
+    {
+        data[i] = (unsigned char)(rand() % 160);
+    }
+
+    memset(&line, 0, sizeof(line));
+    line.data_level_max = 160;
+    line.signal_strength_min = -80;
+    line.spectrum_mode = RIG_SPECTRUM_MODE_CENTER;
+    line.center_freq = 14074000;
+    line.span_freq = 50000;
+    line.spectrum_data_length = length;
+    line.spectrum_data = data;
+
+    printf("Kernels: %s, line length %d, output width %d, %d loops\n",
+           rig_spectrum_proc_kernel_name(), length, width, loops);
+
+    gettimeofday(&tv1, NULL);
+
+    for (i = 0; i < loops; i++)
+    {
+        data[i % length] ^= 1;
+        sink += reference_max(out, data, length, width);
+    }
+
+    gettimeofday(&tv2, NULL);
+
+    printf("%-28s %8.3f us/line (%d)\n", "scalar max aggregation",
+           elapsed_us(&tv1, &tv2) / loops, sink & 1);
+
+    memset(&config, 0, sizeof(config));
+    config.peak_decay = -1;
+    config.output_width = width;
+    bench("max decimation", &config, &line, loops);
+
+    config.decimation = RIG_SPECTRUM_DECIMATION_MEAN;
+    bench("mean decimation", &config, &line, loops);
+
+    config.decimation = RIG_SPECTRUM_DECIMATION_MAX;
+    config.average_factor = 0.2f;
+    config.peak_decay = 0.5f;
+    bench("max + average + peak-hold", &config, &line, loops);
+
+    config.output_width = 0;
+    bench("full width average + peak", &config, &line, loops);
+
+    {
+        struct rig_spectrum_signals signals;
+        rig_spectrum_detector_t *detector = rig_spectrum_detector_init(NULL);
+
+        gettimeofday(&tv1, NULL);
+
+        for (i = 0; i < loops; i++)
+        {
+            data[i % length] ^= 1;
+            rig_spectrum_detector_process(detector, &line, &signals);
+        }
+
+        gettimeofday(&tv2, NULL);
+
+        printf("%-28s %8.3f us/line (%d signals)\n", "signal detector",
+               elapsed_us(&tv1, &tv2) / loops, signals.count);
+
+        rig_spectrum_detector_cleanup(detector);
+    }
+
+    return 0;
+}
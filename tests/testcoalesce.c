@@ -0,0 +1,164 @@
+/*  This program checks that rig_set_freq_coalescing() writes the last
+ *  frequency requested for a VFO, that currVFO shares the slot of the VFO
+ *  it refers to, and that disabling coalescing flushes the pending writes
+ *  before a direct rig_set_freq()
+ *  To run:
+ *      ./testcoalesce
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "hamlib/rig.h"
+
+#define MAX_WRITES 100
+
+static int (*backend_set_freq)(RIG *rig, vfo_t vfo, freq_t freq);
+static vfo_t write_vfo[MAX_WRITES];
+static freq_t write_freq[MAX_WRITES];
+static volatile int writes;
+
+static int slow_set_freq(RIG *rig, vfo_t vfo, freq_t freq)
+{
+    // a slow link, so that requests pile up behind the first write
+    usleep(50 * 1000);
+
+    if (writes < MAX_WRITES)
+    {
+        write_vfo[writes] = vfo;
+        write_freq[writes] = freq;
+        writes++;
+    }
+
+    return backend_set_freq(rig, vfo, freq);
+}
+
+static int check(int ok, const char *what)
+{
+    if (!ok)
+    {
+        printf("FAIL: %s\n", what);
+        return 1;
+    }
+
+    return 0;
+}
+
+/* Index of the last write to vfo, -1 if none */
+static int last_write(vfo_t vfo)
+{
+    int i;
+
+    for (i = writes - 1; i >= 0; i--)
+    {
+        if (write_vfo[i] == vfo)
+        {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+int main(int argc, char *argv[])
+{
+    static struct rig_caps caps;
+    int errors = 0;
+    freq_t freq = 0;
+    RIG *rig;
+    int i, a, b;
+
+    rig_set_debug(RIG_DEBUG_NONE);
+
+    rig = rig_init(RIG_MODEL_DUMMY);
+
+    if (rig == NULL)
+    {
+        printf("FAIL: rig_init\n");
+        return 1;
+    }
+
+    caps = *rig->caps;
+    backend_set_freq = caps.set_freq;
+    caps.set_freq = slow_set_freq;
+    rig->caps = &caps;
+
+    rig_set_conf(rig, rig_token_lookup(rig, "poll_interval"), "0");
+
+    if (rig_open(rig) != RIG_OK)
+    {
+        printf("FAIL: rig_open\n");
+        return 1;
+    }
+
+    rig_set_vfo(rig, RIG_VFO_A);
+
+    errors += check(rig_set_freq_coalescing(rig, 0) == RIG_OK,
+                    "enable coalescing");
+
+    // last writer wins: the burst behind the first write is one write
+    writes = 0;
+    rig_set_freq(rig, RIG_VFO_A, 14000000);
+    usleep(10 * 1000);
+
+    for (i = 1; i <= 10; i++)
+    {
+        rig_set_freq(rig, RIG_VFO_A, 14000000 + i * 1000);
+    }
+
+    // currVFO is VFOA and replaces the VFOA request
+    rig_set_freq(rig, RIG_VFO_CURR, 14020000);
+
+    errors += check(rig_wait_set_freq(rig, RIG_VFO_A, 2000) == RIG_OK,
+                    "wait for VFOA");
+    errors += check(writes == 2, "burst written in two writes");
+    errors += check(write_freq[0] == 14000000, "first write goes out at once");
+    errors += check(writes > 1 && write_freq[writes - 1] == 14020000,
+                    "last requested frequency written last");
+    errors += check(last_write(RIG_VFO_CURR) < 0,
+                    "currVFO resolved before choosing the slot");
+
+    rig_get_freq(rig, RIG_VFO_A, &freq);
+    errors += check(freq == 14020000, "cache holds the last frequency");
+
+    // disabling flushes both VFOs before returning
+    writes = 0;
+    rig_set_freq(rig, RIG_VFO_A, 7000000);
+    rig_set_freq(rig, RIG_VFO_B, 7100000);
+    rig_set_freq(rig, RIG_VFO_A, 7050000);
+
+    errors += check(rig_set_freq_coalescing(rig, -1) == RIG_OK,
+                    "disable coalescing");
+
+    a = last_write(RIG_VFO_A);
+    b = last_write(RIG_VFO_B);
+    errors += check(a >= 0 && write_freq[a] == 7050000, "VFOA flushed");
+    errors += check(b >= 0 && write_freq[b] == 7100000, "VFOB flushed");
+
+    // a direct write after disabling is not overtaken by a stale one
+    rig_set_freq(rig, RIG_VFO_A, 7200000);
+    usleep(100 * 1000);
+
+    a = last_write(RIG_VFO_A);
+    errors += check(a == writes - 1 && write_freq[a] == 7200000,
+                    "direct write after the flush");
+
+    // rig_close() flushes as well
+    rig_set_freq_coalescing(rig, 0);
+    writes = 0;
+    rig_set_freq(rig, RIG_VFO_B, 3500000);
+    rig_close(rig);
+
+    b = last_write(RIG_VFO_B);
+    errors += check(b >= 0 && write_freq[b] == 3500000, "flushed by rig_close");
+
+    rig_cleanup(rig);
+
+    if (errors == 0)
+    {
+        printf("testcoalesce: all checks passed\n");
+    }
+
+    return errors ? 1 : 0;
+}
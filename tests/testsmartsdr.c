@@ -0,0 +1,289 @@
+/*  This program checks the SmartSDR backend against a fake radio: the
+ *  status of the subscribed slice, transmitter and interlock kept from the
+ *  S lines the radio pushes, and R replies matched to their commands by
+ *  sequence number when the radio answers pipelined commands out of order
+ *  To run:
+ *      ./testsmartsdr
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#include "hamlib/rig.h"
+#include "hamlib/port.h"
+
+#define HANDLE "S12345678|"
+
+static int listen_fd = -1;
+static int client_fd = -1;
+static pthread_mutex_t client_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static int check(int ok, const char *what)
+{
+    if (!ok)
+    {
+        printf("FAIL: %s\n", what);
+        return 1;
+    }
+
+    return 0;
+}
+
+static void radio_send(const char *s)
+{
+    pthread_mutex_lock(&client_mutex);
+
+    if (client_fd >= 0 && write(client_fd, s, strlen(s)) < 0)
+    {
+        perror("write");
+    }
+
+    pthread_mutex_unlock(&client_mutex);
+}
+
+/* The full slice status is longer than one frame of the async handler,
+ * the frequency comes last
+ */
+static void radio_slice_status(double freq)
+{
+    char s[2048];
+
+    snprintf(s, sizeof(s), HANDLE "slice 0 in_use=1 sample_rate=24000 "
+             "client_handle=0x76AF7C73 index_letter=A "
+             "rit_on=0 rit_freq=0 xit_on=0 xit_freq=0 rxant=ANT2 mode=DIGU wide=0 "
+             "filter_lo=0 filter_hi=3510 step=10 step_list=1,5,10,20,100,250,500,1000 "
+             "agc_mode=fast agc_threshold=65 agc_off_level=10 pan=0x40000000 "
+             "txant=ANT2 loopa=0 loopb=0 qsk=0 dax=1 dax_clients=1 lock=0 tx=1 "
+             "active=1 audio_level=100 audio_pan=51 audio_mute=1 record=0 "
+             "play=disabled record_time=0.0 anf=0 anf_level=0 nr=0 nr_level=0 nb=0 "
+             "nb_level=50 wnb=0 wnb_level=100 apf=0 apf_level=0 squelch=1 "
+             "squelch_level=20 diversity=0 diversity_parent=0 diversity_child=0 "
+             "diversity_index=1342177293 ant_list=ANT1,ANT2,RX_A,RX_B,XVTA,XVTB "
+             "mode_list=LSB,USB,AM,CW,DIGL,DIGU,SAM,FM,NFM,DFM,RTTY fm_tone_mode=OFF "
+             "fm_tone_value=67.0 fm_repeater_offset_freq=0.000000 "
+             "tx_offset_freq=0.000000 repeater_offset_dir=SIMPLEX fm_tone_burst=0 "
+             "fm_deviation=5000 dfm_pre_de_emphasis=0 post_demod_low=300 "
+             "post_demod_high=3300 rtty_mark=2125 rtty_shift=170 digl_offset=2210 "
+             "digu_offset=1500 post_demod_bypass=0 rfgain=24 "
+             "tx_ant_list=ANT1,ANT2,XVTA,XVTB RF_frequency=%.6f\n", freq);
+    radio_send(s);
+}
+
+/* Status first, the reply text is returned */
+static const char *radio_command(const char *cmd)
+{
+    char s[256];
+    double freq;
+    int n;
+
+    if (strcmp(cmd, "sub slice 0") == 0)
+    {
+        radio_slice_status(10.137);
+    }
+    else if (strcmp(cmd, "sub tx all") == 0)
+    {
+        radio_send(HANDLE "transmit rfpower=50 tunepower=10\n");
+        radio_send(HANDLE "interlock state=READY source=\n");
+    }
+    else if (sscanf(cmd, "slice tune 0 %lf", &freq) == 1)
+    {
+        snprintf(s, sizeof(s), HANDLE "slice 0 RF_frequency=%.6f\n", freq);
+        radio_send(s);
+    }
+    else if (sscanf(cmd, "xmit %d", &n) == 1)
+    {
+        radio_send(n ? HANDLE "interlock state=TRANSMITTING source=SW\n" :
+                   HANDLE "interlock state=READY source=\n");
+    }
+    else if (sscanf(cmd, "transmit set rfpower=%d", &n) == 1 && n <= 100)
+    {
+        snprintf(s, sizeof(s), HANDLE "transmit rfpower=%d\n", n);
+        radio_send(s);
+    }
+    else if (strncmp(cmd, "slice set 0 ", 12) != 0
+             && strncmp(cmd, "dax audio set ", 14) != 0)
+    {
+        return "50000015|Unknown command";
+    }
+
+    return "0|";
+}
+
+/* Answers the commands of one read in reverse order */
+static void *radio(void *arg)
+{
+    char buf[4096];
+    int fd;
+
+    fd = accept(listen_fd, NULL, NULL);
+
+    pthread_mutex_lock(&client_mutex);
+    client_fd = fd;
+    pthread_mutex_unlock(&client_mutex);
+
+    radio_send("V1.4.0.0\nH12345678\n");
+
+    for (;;)
+    {
+        char replies[16][300];
+        char *line, *saveptr = NULL;
+        int count = 0;
+        int len = read(fd, buf, sizeof(buf) - 1);
+
+        if (len <= 0)
+        {
+            break;
+        }
+
+        buf[len] = 0;
+
+        for (line = strtok_r(buf, "\n", &saveptr); line && count < 16;
+                line = strtok_r(NULL, "\n", &saveptr))
+        {
+            int seq;
+            char cmd[256];
+
+            if (sscanf(line, "C%d|%255[^\n]", &seq, cmd) == 2)
+            {
+                snprintf(replies[count++], sizeof(replies[0]), "R%d|%s\n", seq,
+                         radio_command(cmd));
+            }
+        }
+
+        while (count > 0)
+        {
+            radio_send(replies[--count]);
+        }
+    }
+
+    close(fd);
+
+    return NULL;
+}
+
+static int check_rig(int port, const char *async)
+{
+    pthread_t thread;
+    char path[64];
+    freq_t freq;
+    rmode_t mode;
+    pbwidth_t width;
+    ptt_t ptt;
+    value_t val;
+    RIG *rig;
+    int errors = 0;
+
+    pthread_create(&thread, NULL, radio, NULL);
+
+    rig = rig_init(RIG_MODEL_SMARTSDR_A);
+
+    if (rig == NULL)
+    {
+        printf("FAIL: rig_init\n");
+        return 1;
+    }
+
+    // rig_pathname forces port 4992 and the backend refuses 127.0.0.1,
+    // neither suits a fake radio
+    snprintf(path, sizeof(path), "localhost:%d", port);
+    strncpy(HAMLIB_RIGPORT(rig)->pathname, path, HAMLIB_FILPATHLEN - 1);
+    rig_set_conf(rig, rig_token_lookup(rig, "async"), async);
+
+    if (rig_open(rig) != RIG_OK)
+    {
+        printf("FAIL: rig_open\n");
+        return 1;
+    }
+
+    errors += check(rig_get_freq(rig, RIG_VFO_A, &freq) == RIG_OK
+                    && freq == 10137000, "frequency from subscription");
+    errors += check(rig_get_mode(rig, RIG_VFO_A, &mode, &width) == RIG_OK
+                    && mode == RIG_MODE_PKTUSB && width == 3510, "mode from subscription");
+
+    if (strcmp(async, "1") == 0)
+    {
+        radio_slice_status(21.074);
+        usleep(300 * 1000);
+
+        errors += check(rig_get_freq(rig, RIG_VFO_A, &freq) == RIG_OK
+                        && freq == 21074000, "pushed full status");
+
+        radio_send(HANDLE "slice 0 mode=USB filter_lo=100 filter_hi=2900\n");
+        radio_send(HANDLE "slice 0 RF_frequency=14.074000\n");
+        radio_send(HANDLE "slice 1 RF_frequency=7.074000\n");
+        usleep(300 * 1000);
+
+        errors += check(rig_get_freq(rig, RIG_VFO_A, &freq) == RIG_OK
+                        && freq == 14074000, "pushed frequency");
+        errors += check(rig_get_mode(rig, RIG_VFO_A, &mode, &width) == RIG_OK
+                        && mode == RIG_MODE_USB && width == 2800, "pushed mode");
+    }
+
+    // three commands outstanding, answered in reverse order
+    errors += check(rig_set_ptt(rig, RIG_VFO_A, RIG_PTT_ON) == RIG_OK,
+                    "pipelined set_ptt");
+    errors += check(rig_get_ptt(rig, RIG_VFO_A, &ptt) == RIG_OK
+                    && ptt == RIG_PTT_ON, "ptt from interlock status");
+    errors += check(rig_set_ptt(rig, RIG_VFO_A, RIG_PTT_OFF) == RIG_OK,
+                    "set_ptt off");
+
+    val.f = 0.3f;
+    errors += check(rig_set_level(rig, RIG_VFO_A, RIG_LEVEL_RFPOWER,
+                                  val) == RIG_OK, "set rfpower");
+    errors += check(rig_get_level(rig, RIG_VFO_A, RIG_LEVEL_RFPOWER,
+                                  &val) == RIG_OK
+                    && val.f > 0.29 && val.f < 0.31, "rfpower from transmit status");
+
+    val.f = 2;
+    errors += check(rig_set_level(rig, RIG_VFO_A, RIG_LEVEL_RFPOWER,
+                                  val) == -RIG_EPROTO, "error reply");
+
+    rig_close(rig);
+    rig_cleanup(rig);
+
+    pthread_join(thread, NULL);
+    client_fd = -1;
+
+    return errors;
+}
+
+int main(int argc, char *argv[])
+{
+    struct sockaddr_in addr;
+    socklen_t addr_len = sizeof(addr);
+    int errors = 0;
+
+    rig_set_debug(RIG_DEBUG_NONE);
+
+    listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    if (listen_fd < 0
+            || bind(listen_fd, (struct sockaddr *) &addr, sizeof(addr)) < 0
+            || listen(listen_fd, 1) < 0
+            || getsockname(listen_fd, (struct sockaddr *) &addr, &addr_len) < 0)
+    {
+        perror("fake radio");
+        return 1;
+    }
+
+    errors += check_rig(ntohs(addr.sin_port), "1");
+    errors += check_rig(ntohs(addr.sin_port), "0");
+
+    close(listen_fd);
+
+    if (errors == 0)
+    {
+        printf("SmartSDR OK\n");
+    }
+
+    return errors ? 1 : 0;
+}
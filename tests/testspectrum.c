@@ -0,0 +1,286 @@
+/*  This program checks the spectrum post-processing stage
+ *  against plain C reference results, the signal detector
+ *  against a synthetic line and the coalescing of lines for
+ *  a slow subscriber
+ *  To run:
+ *      ./testspectrum
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <unistd.h>
+
+#include "hamlib/rig.h"
+#include "event.h"
+
+#define LINE_LENGTH 475
+
+static unsigned char data[LINE_LENGTH];
+
+static void fill_line(struct rig_spectrum_line *line, int seed)
+{
+    int i;
+
+    for (i = 0; i < LINE_LENGTH; i++)
+    {
+        data[i] = (unsigned char)((i * 7 + seed * 13) % 160);
+    }
+
+    data[100] = 160; // a narrow carrier that max decimation must keep
+
+    memset(line, 0, sizeof(*line));
+    line->data_level_min = 0;
+    line->data_level_max = 160;
+    line->signal_strength_min = -80;
+    line->signal_strength_max = 0;
+    line->spectrum_mode = RIG_SPECTRUM_MODE_CENTER;
+    line->center_freq = 14074000;
+    line->span_freq = 50000;
+    line->spectrum_data_length = LINE_LENGTH;
+    line->spectrum_data = data;
+}
+
+static int check(int ok, const char *what)
+{
+    if (!ok)
+    {
+        printf("FAIL: %s\n", what);
+        return 1;
+    }
+
+    return 0;
+}
+
+static int test_detector(void)
+{
+    struct rig_spectrum_signals signals;
+    struct rig_spectrum_line line;
+    rig_spectrum_detector_t *detector;
+    int errors = 0;
+    int i, k;
+
+    detector = rig_spectrum_detector_init(NULL);
+    fill_line(&line, 0);
+    srand(1);
+
+    for (k = 0; k < 50; k++)
+    {
+        for (i = 0; i < LINE_LENGTH; i++)
+        {
+            data[i] = (unsigned char)(20 + rand() % 8);    // noise around -68 dB
+        }
+
+        // a 5 bin wide signal around bin 200 and a carrier on bin 400
+        for (i = 198; i <= 202; i++)
+        {
+            data[i] = 80;
+        }
+
+        data[400] = 120;
+
+        rig_spectrum_detector_process(detector, &line, &signals);
+    }
+
+    errors += check(signals.count == 2, "detected signal count");
+
+    if (signals.count == 2)
+    {
+        double bin_width = line.span_freq / LINE_LENGTH;
+        double low_freq = line.center_freq - line.span_freq / 2;
+
+        errors += check(fabs(signals.signals[0].freq - (low_freq + 200.5 * bin_width)) <
+                        bin_width, "wide signal frequency");
+        errors += check(fabs(signals.signals[0].bandwidth - 5 * bin_width) < 1,
+                        "wide signal bandwidth");
+        errors += check(fabs(signals.signals[1].freq - (low_freq + 400.5 * bin_width)) <
+                        bin_width, "carrier frequency");
+        errors += check(signals.signals[1].snr_db > 40, "carrier SNR");
+    }
+
+    errors += check(signals.noise_floor_db > -70 && signals.noise_floor_db < -66,
+                    "noise floor");
+
+    rig_spectrum_detector_cleanup(detector);
+
+    return errors;
+}
+
+static int subscriber_calls;
+static unsigned int subscriber_dropped;
+static int subscriber_last;
+
+static int slow_subscriber(RIG *rig, const struct rig_spectrum_proc_output *output,
+                           rig_ptr_t arg)
+{
+    if (subscriber_calls++ == 0)
+    {
+        usleep(100 * 1000);
+    }
+
+    subscriber_dropped += output->dropped;
+    subscriber_last = output->line.spectrum_data[0];
+
+    return RIG_OK;
+}
+
+static int test_subscription(void)
+{
+    struct rig_spectrum_line line;
+    RIG *rig;
+    int errors = 0;
+    int handle;
+    int k;
+
+    rig = rig_init(RIG_MODEL_DUMMY);
+
+    if (rig == NULL)
+    {
+        return check(0, "rig_init");
+    }
+
+    handle = rig_spectrum_subscribe(rig, NULL, slow_subscriber, NULL);
+    errors += check(handle >= 0, "subscribe");
+
+    fill_line(&line, 0);
+
+    // the subscriber sleeps in its first call while all lines arrive
+    for (k = 0; k < 10; k++)
+    {
+        data[0] = (unsigned char) k;
+        rig_fire_spectrum_event(rig, &line);
+    }
+
+    usleep(300 * 1000);
+
+    errors += check(rig_spectrum_proc_remove(rig, handle) == RIG_OK,
+                    "unsubscribe");
+    errors += check(subscriber_calls < 10, "slow subscriber lines coalesced");
+    errors += check(subscriber_calls + (int) subscriber_dropped == 10,
+                    "dropped line count");
+    errors += check(subscriber_last == 9, "latest line delivered");
+
+    rig_cleanup(rig);
+
+    return errors;
+}
+
+int main(int argc, char *argv[])
+{
+    struct rig_spectrum_proc_config config;
+    struct rig_spectrum_proc_output output;
+    struct rig_spectrum_line line;
+    rig_spectrum_proc_t *proc;
+    float first[LINE_LENGTH];
+    int errors = 0;
+    int i;
+
+    printf("Spectrum kernels: %s\n", rig_spectrum_proc_kernel_name());
+
+    // pass-through keeps the line unchanged
+    proc = rig_spectrum_proc_init(NULL);
+    fill_line(&line, 0);
+    errors += check(rig_spectrum_proc_process(proc, &line, &output) == 1,
+                    "pass-through output");
+    errors += check(output.line.spectrum_data_length == LINE_LENGTH,
+                    "pass-through length");
+    errors += check(memcmp(output.line.spectrum_data, data, LINE_LENGTH) == 0,
+                    "pass-through data");
+    errors += check(output.peak_db == NULL, "pass-through has no peak-hold");
+    errors += check(fabsf(output.average_db[100] - 0.0f) < 0.01f
+                    && fabsf(output.average_db[0] + 80.0f) < 0.01f, "dB scaling");
+    rig_spectrum_proc_cleanup(proc);
+
+    // max decimation keeps the carrier, mean decimation matches a plain loop
+    memset(&config, 0, sizeof(config));
+    config.output_width = 100;
+    config.peak_decay = -1;
+    proc = rig_spectrum_proc_init(&config);
+    rig_spectrum_proc_process(proc, &line, &output);
+    errors += check(output.line.spectrum_data_length == 100, "decimated length");
+    errors += check(output.line.spectrum_data[100 * 100 / LINE_LENGTH] == 160,
+                    "max decimation keeps carrier");
+    rig_spectrum_proc_cleanup(proc);
+
+    config.decimation = RIG_SPECTRUM_DECIMATION_MEAN;
+    proc = rig_spectrum_proc_init(&config);
+    rig_spectrum_proc_process(proc, &line, &output);
+
+    for (i = 0; i < 100; i++)
+    {
+        int start = i * LINE_LENGTH / 100;
+        int end = (i + 1) * LINE_LENGTH / 100;
+        float sum = 0;
+        int j;
+
+        for (j = start; j < end; j++)
+        {
+            sum += data[j] * 0.5f - 80.0f;
+        }
+
+        if (fabsf(output.average_db[i] - sum / (end - start)) > 0.01f)
+        {
+            errors += check(0, "mean decimation");
+            break;
+        }
+    }
+
+    rig_spectrum_proc_cleanup(proc);
+
+    // averaging and peak-hold follow the recurrences
+    memset(&config, 0, sizeof(config));
+    config.average_factor = 0.25f;
+    config.peak_decay = 1.0f;
+    proc = rig_spectrum_proc_init(&config);
+    rig_spectrum_proc_process(proc, &line, &output);
+    memcpy(first, output.average_db, sizeof(first));
+    fill_line(&line, 1);
+    rig_spectrum_proc_process(proc, &line, &output);
+
+    for (i = 0; i < LINE_LENGTH; i++)
+    {
+        float in = data[i] * 0.5f - 80.0f;
+        float average = first[i] + 0.25f * (in - first[i]);
+        float peak = first[i] - 1.0f > in ? first[i] - 1.0f : in;
+
+        if (fabsf(output.average_db[i] - average) > 0.01f)
+        {
+            errors += check(0, "exponential average");
+            break;
+        }
+
+        if (fabsf(output.peak_db[i] - peak) > 0.01f)
+        {
+            errors += check(0, "peak-hold decay");
+            break;
+        }
+    }
+
+    // a new frequency range drops the history
+    line.center_freq = 7074000;
+    rig_spectrum_proc_process(proc, &line, &output);
+    errors += check(fabsf(output.average_db[0] - (data[0] * 0.5f - 80.0f)) < 0.01f,
+                    "history reset on QSY");
+    rig_spectrum_proc_cleanup(proc);
+
+    // rate limiting only delivers the first of two back-to-back lines
+    memset(&config, 0, sizeof(config));
+    config.min_interval_ms = 1000;
+    proc = rig_spectrum_proc_init(&config);
+    errors += check(rig_spectrum_proc_process(proc, &line, &output) == 1,
+                    "first rate limited line");
+    errors += check(rig_spectrum_proc_process(proc, &line, &output) == 0,
+                    "second rate limited line");
+    rig_spectrum_proc_cleanup(proc);
+
+    errors += test_detector();
+    errors += test_subscription();
+
+    if (errors == 0)
+    {
+        printf("All spectrum processing tests passed\n");
+    }
+
+    return errors ? 1 : 0;
+}
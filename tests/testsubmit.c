@@ -0,0 +1,216 @@
+/*  This program checks rig_submit(): completion by callback and by polling
+ *  the request fd, cancellation and deadlines of queued requests, and that
+ *  rig_group_run() runs the requests of several rigs concurrently
+ *  To run:
+ *      ./testsubmit
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <poll.h>
+#include <sys/time.h>
+
+#include "hamlib/rig.h"
+
+static int (*backend_set_freq)(RIG *rig, vfo_t vfo, freq_t freq);
+static volatile int callbacks;
+static volatile int callback_retcode = 1;
+
+static int slow_set_freq(RIG *rig, vfo_t vfo, freq_t freq)
+{
+    usleep(200 * 1000);
+    return backend_set_freq(rig, vfo, freq);
+}
+
+static void done_cb(RIG *rig, struct rig_request *req, rig_ptr_t arg)
+{
+    callback_retcode = req->retcode;
+    callbacks++;
+}
+
+static int check(int ok, const char *what)
+{
+    if (!ok)
+    {
+        printf("FAIL: %s\n", what);
+        return 1;
+    }
+
+    return 0;
+}
+
+static double now_ms(void)
+{
+    struct timeval tv;
+
+    gettimeofday(&tv, NULL);
+
+    return tv.tv_sec * 1e3 + tv.tv_usec / 1e3;
+}
+
+/* Three slow rigs set in parallel take about as long as one */
+static int check_group(struct rig_caps *caps)
+{
+    struct rig_request requests[3];
+    RIG_GROUP *group;
+    RIG *rigs[3];
+    double start, elapsed;
+    int errors = 0;
+    int i;
+
+    group = rig_group_create();
+
+    for (i = 0; i < 3; i++)
+    {
+        rigs[i] = rig_init(RIG_MODEL_DUMMY);
+        rigs[i]->caps = caps;
+        rig_open(rigs[i]);
+        errors += check(rig_group_add(group, rigs[i]) == i, "rig_group_add");
+
+        memset(&requests[i], 0, sizeof(requests[i]));
+        requests[i].type = RIG_REQ_SET_FREQ;
+        requests[i].vfo = RIG_VFO_A;
+        requests[i].freq = 7000000 + i * 1000;
+    }
+
+    start = now_ms();
+    errors += check(rig_group_run(group, requests, 2000) == RIG_OK,
+                    "rig_group_run");
+    elapsed = now_ms() - start;
+    errors += check(elapsed < 450, "rig_group_run in parallel");
+
+    // a deadline shorter than the links
+    errors += check(rig_group_run(group, requests, 50) == -RIG_ETIMEOUT,
+                    "rig_group_run deadline");
+
+    for (i = 0; i < 3; i++)
+    {
+        errors += check(requests[i].retcode == -RIG_ETIMEOUT, "rig timed out");
+    }
+
+    rig_group_destroy(group);
+
+    for (i = 0; i < 3; i++)
+    {
+        freq_t freq = 0;
+
+        rig_get_freq(rigs[i], RIG_VFO_A, &freq);
+        errors += check(freq == 7000000 + i * 1000, "rig_group_run result");
+        rig_close(rigs[i]);
+        rig_cleanup(rigs[i]);
+    }
+
+    return errors;
+}
+
+static int find(struct rig_request *done, int count, int id)
+{
+    int i;
+
+    for (i = 0; i < count; i++)
+    {
+        if (done[i].id == id) { return i; }
+    }
+
+    return -1;
+}
+
+int main(int argc, char *argv[])
+{
+    static struct rig_caps caps;
+    struct rig_request req, done[8];
+    struct pollfd pfd;
+    int slow_id, get_id, cancel_id, late_id;
+    int count = 0;
+    int errors = 0;
+    int fd, i;
+    RIG *rig;
+
+    rig_set_debug(RIG_DEBUG_NONE);
+
+    rig = rig_init(RIG_MODEL_DUMMY);
+
+    if (rig == NULL)
+    {
+        printf("FAIL: rig_init\n");
+        return 1;
+    }
+
+    caps = *rig->caps;
+    backend_set_freq = caps.set_freq;
+    caps.set_freq = slow_set_freq;
+    rig->caps = &caps;
+
+    if (rig_open(rig) != RIG_OK)
+    {
+        printf("FAIL: rig_open\n");
+        return 1;
+    }
+
+    fd = rig_request_fd(rig);
+    errors += check(fd >= 0, "rig_request_fd");
+
+    // the slow write keeps the worker busy while the others queue up
+    memset(&req, 0, sizeof(req));
+    req.type = RIG_REQ_SET_FREQ;
+    req.vfo = RIG_VFO_A;
+    req.freq = 14074000;
+    slow_id = rig_submit(rig, &req, 0, NULL, NULL);
+
+    req.type = RIG_REQ_GET_FREQ;
+    get_id = rig_submit(rig, &req, 0, NULL, NULL);
+    cancel_id = rig_submit(rig, &req, 0, NULL, NULL);
+    late_id = rig_submit(rig, &req, 50, NULL, NULL);
+
+    errors += check(slow_id > 0 && get_id > 0 && cancel_id > 0 && late_id > 0,
+                    "rig_submit ids");
+    errors += check(rig_cancel(rig, cancel_id) == RIG_OK, "rig_cancel");
+
+    pfd.fd = fd;
+    pfd.events = POLLIN;
+
+    for (i = 0; i < 20 && count < 4; i++)
+    {
+        if (poll(&pfd, 1, 100) > 0)
+        {
+            count += rig_request_reap(rig, &done[count], 8 - count);
+        }
+    }
+
+    errors += check(count == 4, "4 completions");
+    errors += check(rig_cancel(rig, cancel_id) == -RIG_EINVAL,
+                    "cancel after completion");
+
+    i = find(done, count, slow_id);
+    errors += check(i >= 0 && done[i].retcode == RIG_OK, "set_freq completed");
+    i = find(done, count, get_id);
+    errors += check(i >= 0 && done[i].retcode == RIG_OK
+                    && done[i].freq == 14074000, "get_freq after set_freq");
+    i = find(done, count, cancel_id);
+    errors += check(i >= 0 && done[i].retcode == -RIG_ECANCELED, "cancelled");
+    i = find(done, count, late_id);
+    errors += check(i >= 0 && done[i].retcode == -RIG_ETIMEOUT, "deadline");
+
+    rig_submit(rig, &req, 0, done_cb, NULL);
+
+    for (i = 0; i < 20 && callbacks == 0; i++)
+    {
+        usleep(10 * 1000);
+    }
+
+    errors += check(callbacks == 1 && callback_retcode == RIG_OK, "callback");
+    errors += check(rig_request_reap(rig, done, 8) == 0, "callback not reaped");
+
+    rig_close(rig);
+    rig_cleanup(rig);
+
+    errors += check_group(&caps);
+
+    if (errors == 0)
+    {
+        printf("rig_submit OK\n");
+    }
+
+    return errors ? 1 : 0;
+}
@@ -0,0 +1,458 @@
+/*  This program checks the TCI backend against a fake server speaking
+ *  WebSocket: the state kept from the messages the server pushes, binary
+ *  frames skipped, and the TCI commands the setters send
+ *  To run:
+ *      ./testtci
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#include "hamlib/rig.h"
+#include "hamlib/port.h"
+
+static int listen_fd = -1;
+static int client_fd = -1;
+static pthread_mutex_t client_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+/* Commands received, each one ';' terminated */
+static char received[16384];
+
+/* Server state */
+static double vfo_freq[2];
+static char modulation[16];
+static int filter_lo, filter_hi;
+static int trx, split, drive;
+
+static int check(int ok, const char *what)
+{
+    if (!ok)
+    {
+        printf("FAIL: %s\n", what);
+        return 1;
+    }
+
+    return 0;
+}
+
+/* Sends an unmasked server frame */
+static void server_frame(int opcode, const char *payload, size_t len)
+{
+    unsigned char hdr[4];
+    size_t n = 0;
+
+    hdr[n++] = 0x80 | opcode;
+
+    if (len < 126)
+    {
+        hdr[n++] = len;
+    }
+    else
+    {
+        hdr[n++] = 126;
+        hdr[n++] = len >> 8;
+        hdr[n++] = len & 0xff;
+    }
+
+    pthread_mutex_lock(&client_mutex);
+
+    if (client_fd >= 0
+            && (write(client_fd, hdr, n) < 0 || write(client_fd, payload, len) < 0))
+    {
+        perror("write");
+    }
+
+    pthread_mutex_unlock(&client_mutex);
+}
+
+static void server_send(const char *s)
+{
+    server_frame(1, s, strlen(s));
+}
+
+static int read_full(int fd, unsigned char *buf, size_t len)
+{
+    while (len > 0)
+    {
+        int n = read(fd, buf, len);
+
+        if (n <= 0)
+        {
+            return -1;
+        }
+
+        buf += n;
+        len -= n;
+    }
+
+    return 0;
+}
+
+/* Reads a masked client text frame */
+static int server_read(int fd, char *buf, size_t buf_len)
+{
+    unsigned char hdr[2], ext[2], mask[4];
+    size_t len, i;
+
+    if (read_full(fd, hdr, 2) < 0)
+    {
+        return -1;
+    }
+
+    len = hdr[1] & 0x7f;
+
+    if (len == 126)
+    {
+        if (read_full(fd, ext, 2) < 0)
+        {
+            return -1;
+        }
+
+        len = ext[0] << 8 | ext[1];
+    }
+
+    if (!(hdr[1] & 0x80) || len >= buf_len
+            || read_full(fd, mask, 4) < 0
+            || read_full(fd, (unsigned char *) buf, len) < 0)
+    {
+        return -1;
+    }
+
+    for (i = 0; i < len; i++)
+    {
+        buf[i] ^= mask[i % 4];
+    }
+
+    buf[len] = 0;
+
+    return (int) len;
+}
+
+/* Answers a query, or applies a command and echoes it as TCI servers do */
+static void server_command(const char *msg)
+{
+    char s[256];
+    char word[16];
+    double freq;
+    int chan, lo, hi, n;
+
+    pthread_mutex_lock(&client_mutex);
+    strncat(received, msg, sizeof(received) - strlen(received) - 2);
+    strcat(received, ";");
+    pthread_mutex_unlock(&client_mutex);
+
+    s[0] = 0;
+
+    if (strcmp(msg, "device") == 0)
+    {
+        strcpy(s, "device:SunSDR2PRO;");
+    }
+    else if (strcmp(msg, "receive_only") == 0)
+    {
+        strcpy(s, "receive_only:false;");
+    }
+    else if (strcmp(msg, "trx_count") == 0)
+    {
+        strcpy(s, "trx_count:2;");
+    }
+    else if (sscanf(msg, "vfo:0,%d,%lf", &chan, &freq) == 2 && chan >= 0
+             && chan <= 1)
+    {
+        vfo_freq[chan] = freq;
+        snprintf(s, sizeof(s), "vfo:0,%d,%.0f;", chan, freq);
+    }
+    else if (sscanf(msg, "vfo:0,%d", &chan) == 1 && chan >= 0 && chan <= 1)
+    {
+        snprintf(s, sizeof(s), "vfo:0,%d,%.0f;", chan, vfo_freq[chan]);
+    }
+    else if (sscanf(msg, "modulation:0,%15s", word) == 1)
+    {
+        strcpy(modulation, word);
+        snprintf(s, sizeof(s), "modulation:0,%s;", modulation);
+    }
+    else if (strcmp(msg, "modulation:0") == 0)
+    {
+        snprintf(s, sizeof(s), "modulation:0,%s;", modulation);
+    }
+    else if (sscanf(msg, "rx_filter_band:0,%d,%d", &lo, &hi) == 2)
+    {
+        filter_lo = lo;
+        filter_hi = hi;
+        snprintf(s, sizeof(s), "rx_filter_band:0,%d,%d;", lo, hi);
+    }
+    else if (strcmp(msg, "rx_filter_band:0") == 0)
+    {
+        snprintf(s, sizeof(s), "rx_filter_band:0,%d,%d;", filter_lo, filter_hi);
+    }
+    else if (sscanf(msg, "trx:0,%15s", word) == 1)
+    {
+        trx = strcmp(word, "true") == 0;
+        snprintf(s, sizeof(s), "trx:0,%s;", trx ? "true" : "false");
+    }
+    else if (strcmp(msg, "trx:0") == 0)
+    {
+        snprintf(s, sizeof(s), "trx:0,%s;", trx ? "true" : "false");
+    }
+    else if (sscanf(msg, "split_enable:0,%15s", word) == 1)
+    {
+        split = strcmp(word, "true") == 0;
+        snprintf(s, sizeof(s), "split_enable:0,%s;", split ? "true" : "false");
+    }
+    else if (strcmp(msg, "split_enable:0") == 0)
+    {
+        snprintf(s, sizeof(s), "split_enable:0,%s;", split ? "true" : "false");
+    }
+    else if (strcmp(msg, "drive:0") == 0)
+    {
+        snprintf(s, sizeof(s), "drive:0,%d;", drive);
+    }
+    else if (sscanf(msg, "drive:%d", &n) == 1)
+    {
+        drive = n;
+        snprintf(s, sizeof(s), "drive:%d;", drive);
+    }
+    else if (strcmp(msg, "rx_smeter:0,0") == 0)
+    {
+        strcpy(s, "rx_smeter:0,0,-73;");
+    }
+
+    if (s[0])
+    {
+        server_send(s);
+    }
+}
+
+static void *server(void *arg)
+{
+    char buf[4096];
+    char iq[1024];
+    const char *upgrade = "HTTP/1.1 101 Switching Protocols\r\n"
+                          "Upgrade: websocket\r\nConnection: Upgrade\r\n"
+                          "Sec-WebSocket-Accept: s3pPLMBiTxaQ9kYGzzhZRbK+xOo=\r\n\r\n";
+    char *msg, *saveptr;
+    int fd, len = 0;
+
+    fd = accept(listen_fd, NULL, NULL);
+
+    // the upgrade request ends with a blank line
+    while (len < (int) sizeof(buf) - 1)
+    {
+        int n = read(fd, buf + len, 1);
+
+        if (n <= 0)
+        {
+            close(fd);
+            return NULL;
+        }
+
+        buf[++len] = 0;
+
+        if (len >= 4 && strcmp(buf + len - 4, "\r\n\r\n") == 0)
+        {
+            break;
+        }
+    }
+
+    pthread_mutex_lock(&client_mutex);
+    client_fd = fd;
+    pthread_mutex_unlock(&client_mutex);
+
+    // the backend does not check the accept key
+    if (write(fd, upgrade, strlen(upgrade)) < 0)
+    {
+        perror("write");
+    }
+
+    // the initial state, IQ data in between and two messages in one frame
+    server_send("protocol:ExpertSDR3,1.5;");
+    server_send("vfo:0,0,14074000;");
+    memset(iq, 0x55, sizeof(iq));
+    server_frame(2, iq, sizeof(iq));
+    server_send("vfo:0,1,14080000;modulation:0,usb;");
+    server_send("rx_filter_band:0,100,2800;");
+    server_send("trx:0,false;");
+    server_send("split_enable:0,false;");
+    server_send("drive:0,50;");
+    server_send("ready;");
+
+    while ((len = server_read(fd, buf, sizeof(buf))) >= 0)
+    {
+        saveptr = NULL;
+
+        for (msg = strtok_r(buf, ";", &saveptr); msg != NULL;
+                msg = strtok_r(NULL, ";", &saveptr))
+        {
+            server_command(msg);
+        }
+    }
+
+    pthread_mutex_lock(&client_mutex);
+    client_fd = -1;
+    pthread_mutex_unlock(&client_mutex);
+
+    close(fd);
+
+    return NULL;
+}
+
+/* True once the server has received cmd */
+static int server_received(const char *cmd)
+{
+    int i, found = 0;
+
+    for (i = 0; i < 100 && !found; i++)
+    {
+        pthread_mutex_lock(&client_mutex);
+        found = strstr(received, cmd) != NULL;
+        pthread_mutex_unlock(&client_mutex);
+
+        if (!found)
+        {
+            usleep(10 * 1000);
+        }
+    }
+
+    return found;
+}
+
+static int check_rig(int port, const char *async)
+{
+    pthread_t thread;
+    char path[64];
+    freq_t freq;
+    rmode_t mode;
+    pbwidth_t width;
+    ptt_t ptt;
+    split_t split_on;
+    vfo_t tx_vfo;
+    value_t val;
+    RIG *rig;
+    int errors = 0;
+
+    received[0] = 0;
+    vfo_freq[0] = 14074000;
+    vfo_freq[1] = 14080000;
+    strcpy(modulation, "usb");
+    filter_lo = 100;
+    filter_hi = 2800;
+    trx = split = 0;
+    drive = 50;
+
+    pthread_create(&thread, NULL, server, NULL);
+
+    rig = rig_init(RIG_MODEL_TCI1X);
+
+    if (rig == NULL)
+    {
+        printf("FAIL: rig_init\n");
+        return 1;
+    }
+
+    snprintf(path, sizeof(path), "localhost:%d", port);
+    strncpy(HAMLIB_RIGPORT(rig)->pathname, path, HAMLIB_FILPATHLEN - 1);
+    rig_set_conf(rig, rig_token_lookup(rig, "async"), async);
+    rig_set_conf(rig, rig_token_lookup(rig, "poll_interval"), "0");
+
+    if (rig_open(rig) != RIG_OK)
+    {
+        printf("FAIL: rig_open\n");
+        return 1;
+    }
+
+    errors += check(rig_get_freq(rig, RIG_VFO_A, &freq) == RIG_OK
+                    && freq == 14074000, "VFOA from the initial state");
+    errors += check(rig_get_freq(rig, RIG_VFO_B, &freq) == RIG_OK
+                    && freq == 14080000, "VFOB after a binary frame");
+    errors += check(rig_get_mode(rig, RIG_VFO_A, &mode, &width) == RIG_OK
+                    && mode == RIG_MODE_USB && width == 2700, "mode from the initial state");
+
+    if (strcmp(async, "1") == 0)
+    {
+        server_send("vfo:0,0,21074000;");
+        usleep(300 * 1000);
+
+        errors += check(rig_get_freq(rig, RIG_VFO_A, &freq) == RIG_OK
+                        && freq == 21074000, "pushed frequency");
+    }
+
+    errors += check(rig_set_freq(rig, RIG_VFO_A, 7074000) == RIG_OK
+                    && server_received("vfo:0,0,7074000;"), "set_freq");
+    errors += check(rig_get_freq(rig, RIG_VFO_A, &freq) == RIG_OK
+                    && freq == 7074000, "frequency after set_freq");
+
+    errors += check(rig_set_mode(rig, RIG_VFO_A, RIG_MODE_LSB, 2400) == RIG_OK
+                    && server_received("modulation:0,lsb;")
+                    && server_received("rx_filter_band:0,-2400,0;"), "set_mode");
+    errors += check(rig_get_mode(rig, RIG_VFO_A, &mode, &width) == RIG_OK
+                    && mode == RIG_MODE_LSB && width == 2400, "mode after set_mode");
+
+    errors += check(rig_set_ptt(rig, RIG_VFO_A, RIG_PTT_ON) == RIG_OK
+                    && server_received("trx:0,true;"), "set_ptt on");
+    errors += check(rig_get_ptt(rig, RIG_VFO_A, &ptt) == RIG_OK
+                    && ptt == RIG_PTT_ON, "ptt after set_ptt");
+    errors += check(rig_set_ptt(rig, RIG_VFO_A, RIG_PTT_OFF) == RIG_OK
+                    && server_received("trx:0,false;"), "set_ptt off");
+
+    errors += check(rig_set_split_vfo(rig, RIG_VFO_A, RIG_SPLIT_ON,
+                                      RIG_VFO_B) == RIG_OK
+                    && server_received("split_enable:0,true;"), "set_split_vfo");
+    errors += check(rig_get_split_vfo(rig, RIG_VFO_A, &split_on, &tx_vfo) == RIG_OK
+                    && split_on == RIG_SPLIT_ON && tx_vfo == RIG_VFO_B,
+                    "split after set_split_vfo");
+
+    val.f = 0.3f;
+    errors += check(rig_set_level(rig, RIG_VFO_A, RIG_LEVEL_RFPOWER,
+                                  val) == RIG_OK
+                    && server_received("drive:30;"), "set rfpower");
+    errors += check(rig_get_level(rig, RIG_VFO_A, RIG_LEVEL_RFPOWER,
+                                  &val) == RIG_OK
+                    && val.f > 0.29 && val.f < 0.31, "rfpower after set");
+
+    rig_close(rig);
+    rig_cleanup(rig);
+
+    pthread_join(thread, NULL);
+
+    return errors;
+}
+
+int main(int argc, char *argv[])
+{
+    struct sockaddr_in addr;
+    socklen_t addr_len = sizeof(addr);
+    int errors = 0;
+
+    rig_set_debug(RIG_DEBUG_NONE);
+
+    listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    if (listen_fd < 0
+            || bind(listen_fd, (struct sockaddr *) &addr, sizeof(addr)) < 0
+            || listen(listen_fd, 1) < 0
+            || getsockname(listen_fd, (struct sockaddr *) &addr, &addr_len) < 0)
+    {
+        perror("fake server");
+        return 1;
+    }
+
+    errors += check_rig(ntohs(addr.sin_port), "1");
+    errors += check_rig(ntohs(addr.sin_port), "0");
+
+    close(listen_fd);
+
+    if (errors == 0)
+    {
+        printf("TCI OK\n");
+    }
+
+    return errors ? 1 : 0;
+}
@@ -0,0 +1,115 @@
+/*  This program checks that rig_vfo_batch() groups requests by VFO on
+ *  a rig that cannot target VFOs, and counts the VFO swaps it saves
+ *  To run:
+ *      ./testvfobatch
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "hamlib/rig.h"
+
+static int (*backend_set_vfo)(RIG *rig, vfo_t vfo);
+static int set_vfo_calls;
+
+static int counting_set_vfo(RIG *rig, vfo_t vfo)
+{
+    set_vfo_calls++;
+    return backend_set_vfo(rig, vfo);
+}
+
+static int check(int ok, const char *what)
+{
+    if (!ok)
+    {
+        printf("FAIL: %s\n", what);
+        return 1;
+    }
+
+    return 0;
+}
+
+static void request(struct rig_request *req, rig_request_type_t type,
+                    vfo_t vfo)
+{
+    memset(req, 0, sizeof(*req));
+    req->type = type;
+    req->vfo = vfo;
+}
+
+int main(int argc, char *argv[])
+{
+    static struct rig_caps caps;
+    struct rig_request requests[6];
+    int swaps_saved = -1;
+    int errors = 0;
+    vfo_t vfo;
+    RIG *rig;
+    int i;
+
+    rig_set_debug(RIG_DEBUG_NONE);
+
+    rig = rig_init(RIG_MODEL_DUMMY);
+
+    if (rig == NULL)
+    {
+        printf("FAIL: rig_init\n");
+        return 1;
+    }
+
+    // a dummy that has to select a VFO for everything
+    caps = *rig->caps;
+    caps.targetable_vfo = RIG_TARGETABLE_NONE;
+    backend_set_vfo = caps.set_vfo;
+    caps.set_vfo = counting_set_vfo;
+    rig->caps = &caps;
+
+    if (rig_open(rig) != RIG_OK)
+    {
+        printf("FAIL: rig_open\n");
+        return 1;
+    }
+
+    rig_set_vfo(rig, RIG_VFO_B);
+    rig_set_freq(rig, RIG_VFO_B, 7074000);
+    rig_set_vfo(rig, RIG_VFO_A);
+    rig_set_freq(rig, RIG_VFO_A, 14074000);
+
+    // A and B mixed, as several clients would ask
+    request(&requests[0], RIG_REQ_GET_FREQ, RIG_VFO_A);
+    request(&requests[1], RIG_REQ_GET_FREQ, RIG_VFO_B);
+    request(&requests[2], RIG_REQ_GET_LEVEL, RIG_VFO_B);
+    requests[2].setting = RIG_LEVEL_AF;
+    request(&requests[3], RIG_REQ_GET_FREQ, RIG_VFO_CURR);
+    request(&requests[4], RIG_REQ_GET_LEVEL, RIG_VFO_A);
+    requests[4].setting = RIG_LEVEL_AF;
+    request(&requests[5], RIG_REQ_GET_MODE, RIG_VFO_B);
+
+    set_vfo_calls = 0;
+
+    errors += check(rig_vfo_batch(rig, requests, 6, &swaps_saved) == RIG_OK,
+                    "batch result");
+
+    for (i = 0; i < 6; i++)
+    {
+        errors += check(requests[i].retcode == RIG_OK, "request result");
+    }
+
+    errors += check(requests[0].freq == 14074000, "VFOA frequency");
+    errors += check(requests[1].freq == 7074000, "VFOB frequency");
+    errors += check(requests[3].freq == 14074000, "current VFO frequency");
+    errors += check(set_vfo_calls == 2, "one swap to VFOB and one back");
+    errors += check(swaps_saved == 4, "swaps saved");
+    errors += check(rig_get_vfo(rig, &vfo) == RIG_OK && vfo == RIG_VFO_A,
+                    "VFOA restored");
+
+    rig_close(rig);
+    rig_cleanup(rig);
+
+    if (errors == 0)
+    {
+        printf("All VFO batch tests passed\n");
+    }
+
+    return errors ? 1 : 0;
+}